@@ -0,0 +1,35 @@
+#include "equivalence_checker.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using naturalselection::EquivalenceChecker;
+using naturalselection::EquivalenceReport;
+using naturalselection::SweepJob;
+
+// Usage: equivalence_check <seed> [creatures per type] [food count] [generations] [tick|generation] [collisions]
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <seed> [creatures per type] [food count] [generations] [tick|generation] [collisions]"
+                  << std::endl;
+        return 1;
+    }
+
+    SweepJob job;
+    job.seed = (uint32_t) strtoul(argv[1], nullptr, 10);
+    job.creatures_per_type = argc > 2 ? (size_t) atoi(argv[2]) : 0;
+    job.food_count = argc > 3 ? (size_t) atoi(argv[3]) : 20;
+    job.generations = argc > 4 ? (size_t) atoi(argv[4]) : 5;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.both_type_creatures = true;
+    job.collisions_enabled = argc > 6 && strcmp(argv[6], "collisions") == 0;
+    job.max_ticks = 1000000;
+
+    int granularity = argc > 5 && strcmp(argv[5], "tick") == 0 ? naturalselection::COMPARE_EVERY_TICK
+                                                                : naturalselection::COMPARE_EVERY_GENERATION;
+    EquivalenceReport report = EquivalenceChecker::Run(job, granularity);
+    std::cout << report.Describe() << std::endl;
+    return report.equivalent ? 0 : 1;
+}
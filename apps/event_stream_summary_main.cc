@@ -0,0 +1,69 @@
+#include "event_stream.h"
+#include <iostream>
+
+using naturalselection::EventStreamReader;
+using naturalselection::LifeEvent;
+
+// Usage: event_stream_summary <event stream file>
+// Prints, per generation, how many creatures were born, died and ate, and the traits their children were born with.
+// The file is what the app writes when NATURALSELECTION_EVENT_STREAM names one; its layout is in event_stream.h.
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: event_stream_summary <event stream file>" << std::endl;
+        return 1;
+    }
+    EventStreamReader reader;
+    if (!reader.Open(argv[1])) {
+        std::cerr << argv[1] << " is not an event stream" << std::endl;
+        return 1;
+    }
+
+    size_t generation = 0;
+    size_t births = 0;
+    size_t deaths = 0;
+    size_t meals = 0;
+    size_t children = 0;
+    double child_max_velocity = 0;
+    double child_vision_radius = 0;
+    auto print_generation = [&]() {
+        std::cout << "generation " << generation << ": " << meals << " meals, " << deaths << " deaths, " << births
+                  << " births";
+        if (children > 0) {
+            std::cout << ", children's mean max velocity " << child_max_velocity / (double) children
+                      << " and vision radius " << child_vision_radius / (double) children;
+        }
+        std::cout << std::endl;
+    };
+
+    for (const LifeEvent &event : reader) {
+        switch (event.type) {
+            case naturalselection::EVENT_MEAL:
+                meals++;
+                break;
+            case naturalselection::EVENT_BIRTH:
+                births++;
+                if (event.other_id != 0) { // Not added by hand
+                    children++;
+                    child_max_velocity += event.max_velocity;
+                    child_vision_radius += event.vision_radius;
+                }
+                break;
+            case naturalselection::EVENT_DEATH:
+                deaths++;
+                break;
+            case naturalselection::EVENT_GENERATION:
+                // A generation's turnover is recorded just before its marker, so it still counts towards the old one.
+                print_generation();
+                generation = event.creature_id;
+                births = 0;
+                deaths = 0;
+                meals = 0;
+                children = 0;
+                child_max_velocity = 0;
+                child_vision_radius = 0;
+                break;
+        }
+    }
+    print_generation();
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "environment.h"
+#include "generation_model.h"
+#include "headless_runner.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using naturalselection::Environment;
+using naturalselection::FastForwardReport;
+using naturalselection::HeadlessRunner;
+using naturalselection::PopulationCount;
+using naturalselection::SweepJob;
+
+// Per-generation populations across seeds, for one way of running them.
+struct Trajectories {
+    std::vector<std::vector<double>> totals; // [generation][seed]
+    std::vector<std::vector<double>> speed_shares;
+    double seconds = 0;
+    uint64_t ticks = 0;
+    std::vector<FastForwardReport> reports;
+};
+
+static void Record(const Environment &environment, size_t generations, Trajectories &trajectories) {
+    const std::vector<PopulationCount> &history = environment.GetPopulationHistory();
+    for (size_t generation = 0; generation <= generations; generation++) {
+        // An extinct population stops adding to its history.
+        PopulationCount count = generation < history.size() ? history[generation] : PopulationCount();
+        int total = count.GetTotal();
+        trajectories.totals[generation].push_back(total);
+        trajectories.speed_shares[generation].push_back(total > 0 ? (double) count.speed_count / total : 0);
+    }
+}
+
+static void Run(const SweepJob &job, Trajectories &trajectories) {
+    srand(job.seed);
+    Environment environment = Environment();
+    HeadlessRunner::SetUp(job, environment);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t frames = 0;
+    while (!HeadlessRunner::IsFinished(job, environment) && frames < job.max_ticks) {
+        HeadlessRunner::StepFrame(environment);
+        frames++;
+    }
+    trajectories.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    trajectories.ticks += environment.GetTick();
+    Record(environment, job.generations, trajectories);
+    const std::vector<FastForwardReport> &reports = environment.GetFastForwardReports();
+    trajectories.reports.insert(trajectories.reports.end(), reports.begin(), reports.end());
+}
+
+static void MeanAndError(const std::vector<double> &values, double &mean, double &standard_error) {
+    mean = 0;
+    for (double value : values) {
+        mean += value;
+    }
+    mean /= values.size();
+    double variance = 0;
+    for (double value : values) {
+        variance += (value - mean) * (value - mean);
+    }
+    variance /= values.size() > 1 ? values.size() - 1 : 1;
+    standard_error = std::sqrt(variance / values.size());
+}
+
+// Runs the same seeds in full and fast-forwarded, and compares where their populations go. Differences
+// of more than about two standard errors are more than chance, so fast-forwarding that far is not safe.
+// Usage: fast_forward_check [seeds] [generations] [calibration] [skipped] [creatures per type] [food count]
+int main(int argc, char **argv) {
+    size_t seeds = argc > 1 ? (size_t) atoi(argv[1]) : 10;
+    SweepJob job;
+    job.generations = argc > 2 ? (size_t) atoi(argv[2]) : 20;
+    size_t calibration = argc > 3 ? (size_t) atoi(argv[3]) : 3;
+    size_t skipped = argc > 4 ? (size_t) atoi(argv[4]) : 5;
+    job.creatures_per_type = argc > 5 ? (size_t) atoi(argv[5]) : 30;
+    job.food_count = argc > 6 ? (size_t) atoi(argv[6]) : 40;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.max_ticks = 10000000;
+
+    Trajectories full;
+    Trajectories fast;
+    full.totals.resize(job.generations + 1);
+    full.speed_shares.resize(job.generations + 1);
+    fast.totals.resize(job.generations + 1);
+    fast.speed_shares.resize(job.generations + 1);
+    for (size_t seed = 1; seed <= seeds; seed++) {
+        job.seed = (uint32_t) seed;
+        job.fast_forward_skipped = 0;
+        Run(job, full);
+        job.fast_forward_calibration = calibration;
+        job.fast_forward_skipped = skipped;
+        Run(job, fast);
+    }
+
+    printf("%zu seeds, %zu in full then %zu fast-forwarded, mean +- standard error\n", seeds, calibration, skipped);
+    printf("%10s %20s %20s %8s %16s %16s %8s\n", "generation", "full population", "fast population", "z",
+           "full speed share", "fast speed share", "z");
+    for (size_t generation = 0; generation <= job.generations; generation++) {
+        double values[4][2];
+        MeanAndError(full.totals[generation], values[0][0], values[0][1]);
+        MeanAndError(fast.totals[generation], values[1][0], values[1][1]);
+        MeanAndError(full.speed_shares[generation], values[2][0], values[2][1]);
+        MeanAndError(fast.speed_shares[generation], values[3][0], values[3][1]);
+        double population_error = std::sqrt(values[0][1] * values[0][1] + values[1][1] * values[1][1]);
+        double share_error = std::sqrt(values[2][1] * values[2][1] + values[3][1] * values[3][1]);
+        printf("%10zu %12.1f +- %5.1f %12.1f +- %5.1f %8.2f %9.3f +- %4.3f %9.3f +- %4.3f %8.2f\n", generation,
+               values[0][0], values[0][1], values[1][0], values[1][1],
+               population_error > 0 ? (values[1][0] - values[0][0]) / population_error : 0.0,
+               values[2][0], values[2][1], values[3][0], values[3][1],
+               share_error > 0 ? (values[3][0] - values[2][0]) / share_error : 0.0);
+    }
+
+    // Each report is the model's forecast for a generation then run in full.
+    double survivor_error = 0;
+    double birth_error = 0;
+    double skill = 0;
+    for (const FastForwardReport &report : fast.reports) {
+        survivor_error += std::abs(report.expected_survivors - report.survivors) / report.population;
+        birth_error += std::abs(report.expected_births - report.births) / report.population;
+        skill += report.baseline_brier_score > 0 ? 1 - report.brier_score / report.baseline_brier_score : 0;
+    }
+    size_t report_count = fast.reports.empty() ? 1 : fast.reports.size();
+    printf("\n%zu forecasts checked against full generations:\n", fast.reports.size());
+    printf("  mean survivor error %.1f%% of the population, birth error %.1f%%, Brier skill %.3f\n",
+           100 * survivor_error / report_count, 100 * birth_error / report_count, skill / report_count);
+    printf("  full: %.2f s, %llu ticks; fast-forwarded: %.2f s, %llu ticks\n", full.seconds,
+           (unsigned long long) full.ticks, fast.seconds, (unsigned long long) fast.ticks);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "environment.h"
+#include "headless_runner.h"
+#include "metrics_server.h"
+#include "software_renderer.h"
+#include "task_scheduler.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using naturalselection::Environment;
+using naturalselection::FrameLayout;
+using naturalselection::FrameRecorder;
+using naturalselection::HeadlessRunner;
+using naturalselection::MetricsServer;
+using naturalselection::SimulationMetrics;
+using naturalselection::SweepJob;
+using naturalselection::TaskScheduler;
+using naturalselection::WorldBounds;
+using naturalselection::WorldSnapshot;
+
+// Usage: render_frames <output directory> [ticks per frame] [seed] [creatures per type] [food count] [generations]
+//                      [metrics port]
+// The directory has to exist. Frames can be joined with: ffmpeg -i <directory>/frame_%06d.png run.mp4
+// With a metrics port, Prometheus can scrape http://127.0.0.1:<port>/metrics while the run goes on.
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output directory> [ticks per frame] [seed] [creatures per type] [food count] [generations]"
+                  << " [metrics port]" << std::endl;
+        return 1;
+    }
+
+    uint64_t interval = argc > 2 ? (uint64_t) atoll(argv[2]) : 10;
+    SweepJob job;
+    job.seed = argc > 3 ? (uint32_t) strtoul(argv[3], nullptr, 10) : 1;
+    job.creatures_per_type = argc > 4 ? (size_t) atoi(argv[4]) : 0;
+    job.food_count = argc > 5 ? (size_t) atoi(argv[5]) : 20;
+    job.generations = argc > 6 ? (size_t) atoi(argv[6]) : 5;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.both_type_creatures = true;
+    job.max_ticks = 1000000;
+    uint16_t metrics_port = argc > 7 ? (uint16_t) atoi(argv[7]) : 0;
+
+    srand(job.seed);
+    Environment environment = Environment();
+    HeadlessRunner::SetUp(job, environment);
+
+    FrameLayout layout = FrameLayout::AroundArena(
+            WorldBounds{naturalselection::DEFAULT_X_COOR, naturalselection::DEFAULT_Y_COOR,
+                        naturalselection::DEFAULT_WIDTH, naturalselection::DEFAULT_HEIGHT});
+    FrameRecorder recorder(argv[1], interval, layout, &TaskScheduler::Shared());
+
+    SimulationMetrics metrics;
+    MetricsServer metrics_server(metrics);
+    if (metrics_port != 0) {
+        if (!metrics_server.Start(metrics_port)) {
+            std::cerr << "Could not serve metrics on port " << metrics_port << std::endl;
+            return 1;
+        }
+        std::cout << "Serving metrics at http://127.0.0.1:" << metrics_server.GetPort() << "/metrics" << std::endl;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    double simulate_seconds = 0;
+    double render_seconds = 0;
+    for (uint64_t frame = 0; frame < job.max_ticks && !HeadlessRunner::IsFinished(job, environment); frame++) {
+        Clock::time_point start = Clock::now();
+        HeadlessRunner::StepFrame(environment);
+        Clock::time_point simulated = Clock::now();
+        // The recorder is this app's one reader of the snapshots, and the metrics go by the same frame.
+        const WorldSnapshot &snapshot = environment.GetSnapshot();
+        metrics.Record(snapshot, simulated);
+        if (!recorder.Capture(snapshot)) {
+            std::cerr << "Could not write to " << argv[1] << std::endl;
+            return 1;
+        }
+        Clock::time_point rendered = Clock::now();
+
+        simulate_seconds += std::chrono::duration<double>(simulated - start).count();
+        render_seconds += std::chrono::duration<double>(rendered - simulated).count();
+    }
+
+    std::cout << "Wrote " << recorder.GetFramesWritten() << " frames of " << layout.width << "x" << layout.height
+              << ", simulating took " << simulate_seconds << " s and rendering " << render_seconds << " s"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "creature.h"
+#include "shared_world.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+using naturalselection::SharedWorldFrame;
+using naturalselection::SharedWorldReader;
+
+// Usage: shared_world_reader [segment name]
+// Attaches to a running simulation's shared memory and prints a summary of the newest tick once a second.
+// Other tools can map the same segment directly; its layout is described in shared_world.h.
+int main(int argc, char **argv) {
+    std::string name = argc > 1 ? argv[1] : naturalselection::DEFAULT_SHARED_WORLD_NAME;
+    SharedWorldReader reader;
+    if (!reader.Open(name)) {
+        std::cerr << "No simulation is publishing to " << name << std::endl;
+        return 1;
+    }
+
+    SharedWorldFrame frame;
+    while (true) {
+        if (reader.ReadLatest(frame)) {
+            size_t type_counts[3] = {0, 0, 0};
+            double total_speed = 0;
+            for (size_t i = 0; i < frame.creatures.size(); i++) {
+                const naturalselection::SharedCreature &creature = frame.creatures[i];
+                if (creature.creature_type >= 0 && creature.creature_type < 3) {
+                    type_counts[creature.creature_type]++;
+                }
+                total_speed += std::sqrt(creature.velocity_x * creature.velocity_x +
+                                         creature.velocity_y * creature.velocity_y);
+            }
+
+            std::cout << "tick " << frame.tick << ", generation " << frame.generation << ": "
+                      << type_counts[SPEED] << " speed, " << type_counts[INTELLIGENCE] << " intelligence, "
+                      << type_counts[BOTH] << " both, " << frame.food.size() << " food, mean speed "
+                      << (frame.creatures.empty() ? 0 : total_speed / (double) frame.creatures.size()) << std::endl;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
@@ -0,0 +1,55 @@
+#include "creature.h"
+#include "sweep_coordinator.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using naturalselection::SweepCoordinator;
+using naturalselection::SweepGrid;
+using naturalselection::SweepOptions;
+
+// Usage: sweep_coordinator <output.csv> [workers] [generations] [replicas] [job timeout seconds]
+//                          [carrying capacity] [uniform|fitness] [first metrics port]
+// With a metrics port, Prometheus can scrape worker i's current job at http://127.0.0.1:<port + i>/metrics.
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output.csv> [workers] [generations] [replicas] [job timeout seconds]"
+                  << " [carrying capacity] [uniform|fitness] [first metrics port]" << std::endl;
+        return 1;
+    }
+
+    SweepOptions options;
+    options.worker_count = argc > 2 ? (size_t) atoi(argv[2]) : 0;
+    options.job_timeout_seconds = argc > 5 ? atoi(argv[5]) : 0;
+    options.metrics_port = argc > 8 ? (uint16_t) atoi(argv[8]) : 0;
+
+    SweepGrid grid;
+    grid.food_counts = {5, 10, 20, 40, 80};
+    for (int mask = 1; mask < (1 << 3); mask++) { // Every non-empty mix of SPEED, INTELLIGENCE and BOTH
+        grid.creature_type_masks.push_back(mask);
+    }
+    grid.collisions = {false, true};
+    grid.generations = argc > 3 ? (size_t) atoi(argv[3]) : 10;
+    grid.replicas = argc > 4 ? (size_t) atoi(argv[4]) : 4;
+    grid.carrying_capacity = argc > 6 ? (size_t) atoi(argv[6]) : 0;
+    grid.capacity_policy = argc > 7 && std::string(argv[7]) == "fitness" ? naturalselection::CAPACITY_FITNESS
+                                                                         : naturalselection::CAPACITY_UNIFORM;
+
+    std::ofstream output(argv[1]);
+    if (!output) {
+        std::cerr << "Could not open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    SweepCoordinator coordinator(grid.Expand(), options);
+    bool succeeded = coordinator.Run(output);
+    std::cerr << "Retried " << coordinator.GetRetryCount() << " jobs, "
+              << coordinator.GetFailedJobs().size() << " failed" << std::endl;
+    for (size_t i = 0; i < coordinator.GetFailedJobs().size(); i++) {
+        std::cerr << "Failed job " << coordinator.GetFailedJobs().at(i) << std::endl;
+    }
+
+    return succeeded ? 0 : 1;
+}
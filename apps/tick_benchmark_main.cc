@@ -0,0 +1,261 @@
+#include "creature.h"
+#include "food.h"
+#include "food_field.h"
+#include "food_field_tick.h"
+#include "food_grid.h"
+#include "morton_order.h"
+#include "sweep_and_prune.h"
+#include "task_scheduler.h"
+#include "tick_graph.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace naturalselection {
+
+static const size_t THREAD_COUNTS[] = {1, 2, 4, 8, 16, 32, 64};
+static const size_t CHUNK_SIZE = 1024;
+static const WorldBounds BOUNDS = WorldBounds{(float) DEFAULT_X_COOR, (float) DEFAULT_Y_COOR,
+                                              (float) DEFAULT_WIDTH, (float) DEFAULT_HEIGHT};
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The same random world for every benchmark: a third of each type, with intelligence and
+// both type creatures seeing four times as far, and food spawned after from the same seed.
+static std::vector<Creature> MakeCreatures(size_t creature_count) {
+    srand(1);
+    std::vector<Creature> creatures;
+    for (size_t i = 0; i < creature_count; i++) {
+        int type = (int) (i % 3);
+        glm::vec2 position = glm::vec2((float) (rand() % DEFAULT_WIDTH + DEFAULT_X_COOR),
+                                       (float) (rand() % DEFAULT_HEIGHT + DEFAULT_Y_COOR));
+        double vision_radius = type == SPEED ? DEFAULT_VISION_RADIUS : DEFAULT_VISION_RADIUS * 4;
+        creatures.push_back(Creature(type, position, glm::vec2(0, 0), DEFAULT_CREATURE_RADIUS,
+                                     DEFAULT_CREATURE_MASS, DEFAULT_ENERGY_CAPACITY, 0,
+                                     vision_radius, DEFAULT_ENERGY_SPEND, DEFAULT_MAX_VELOCITY));
+    }
+    return creatures;
+}
+
+// Times every phase of a tick on its own, then the whole task graph, for 1 to 64 threads.
+static void RunTickBenchmark(size_t creature_count, size_t food_count, size_t tick_count) {
+    std::vector<Creature> creatures = MakeCreatures(creature_count);
+    std::vector<Food> food = Food::SpawnParticles(food_count, ci::Color("Green"), 2.0f, 20);
+
+    printf("%zu creatures, %zu food, %zu ticks, ms per tick\n", creature_count, food_count, tick_count);
+    printf("%8s", "threads");
+    for (int phase = 0; phase < TickGraph::PHASE_COUNT; phase++) {
+        printf(" %19s", TickGraph::GetPhaseName(phase));
+    }
+    printf(" %12s %8s\n", "whole tick", "speedup");
+
+    double single_thread_tick = 0;
+    SteeringBatch batch;
+    SweepAndPrune broad_phase;
+    TickGraph tick_graph;
+    TaskGraph tasks;
+    for (size_t t = 0; t < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); t++) {
+        TaskScheduler scheduler(THREAD_COUNTS[t]);
+        double phase_times[TickGraph::PHASE_COUNT] = {};
+        double tick_time = 0;
+
+        for (size_t tick = 0; tick < tick_count; tick++) {
+            // Every tick starts from the same world so thread counts are compared on equal work.
+            batch.Gather(creatures);
+            tick_graph.Prepare(&batch, &food, nullptr, BOUNDS, &broad_phase, CHUNK_SIZE);
+            tick_graph.InvalidateSensing(); // Every creature searches, as on the first tick
+            for (int phase = 0; phase < TickGraph::PHASE_COUNT; phase++) {
+                tasks.Clear();
+                tick_graph.BuildPhaseGraph(phase, tasks);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                scheduler.Run(tasks);
+                phase_times[phase] += MillisecondsSince(start);
+            }
+
+            batch.Gather(creatures);
+            tick_graph.Prepare(&batch, &food, nullptr, BOUNDS, &broad_phase, CHUNK_SIZE);
+            tick_graph.InvalidateSensing();
+            tasks.Clear();
+            tick_graph.BuildGraph(tasks);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            scheduler.Run(tasks);
+            tick_time += MillisecondsSince(start);
+        }
+
+        tick_time /= tick_count;
+        if (t == 0) {
+            single_thread_tick = tick_time;
+        }
+
+        printf("%8zu", THREAD_COUNTS[t]);
+        for (int phase = 0; phase < TickGraph::PHASE_COUNT; phase++) {
+            printf(" %19.2f", phase_times[phase] / tick_count);
+        }
+        printf(" %12.2f %7.2fx\n", tick_time, single_thread_tick / tick_time);
+    }
+}
+
+// Runs consecutive ticks of one world on a single thread, once searching for food every
+// tick and once reusing remembered targets, and compares the sensing phase.
+static void RunSensingBenchmark(size_t creature_count, size_t food_count, size_t tick_count) {
+    printf("\n%zu consecutive ticks, sensing phase on one thread\n", tick_count);
+    printf("%10s %16s %16s\n", "targets", "searches/tick", "ms per tick");
+
+    for (int remember = 0; remember < 2; remember++) {
+        std::vector<Creature> creatures = MakeCreatures(creature_count);
+        std::vector<Food> food = Food::SpawnParticles(food_count, ci::Color("Green"), 2.0f, 20);
+        std::vector<Food> remaining;
+
+        SteeringBatch batch;
+        TickGraph tick_graph;
+        TaskGraph tasks;
+        size_t searches = 0;
+        double sense_time = 0;
+        for (size_t tick = 0; tick < tick_count; tick++) {
+            batch.Gather(creatures);
+            tick_graph.Prepare(&batch, &food, nullptr, BOUNDS, nullptr, CHUNK_SIZE);
+            if (!remember) {
+                tick_graph.InvalidateSensing();
+            }
+
+            for (int phase = 0; phase < TickGraph::PHASE_COUNT; phase++) {
+                if (phase == TickGraph::PHASE_RESOLVE_COLLISIONS) {
+                    continue;
+                }
+                tasks.Clear();
+                tick_graph.BuildPhaseGraph(phase, tasks);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                tasks.RunInline();
+                if (phase == TickGraph::PHASE_SENSE_NEAREST_FOOD) {
+                    sense_time += MillisecondsSince(start);
+                }
+            }
+            searches += tick_graph.GetSenseCount();
+
+            tick_graph.CollectRemainingFood(remaining);
+            food.swap(remaining);
+            batch.Scatter(creatures);
+        }
+
+        printf("%10s %16.0f %16.2f\n", remember ? "remembered" : "searched", (double) searches / tick_count,
+               sense_time / tick_count);
+    }
+}
+
+
+// Times a full nearest-food search and collision resolution on one thread, with the creatures
+// and food in spawn order and then re-sorted by Morton key. Nothing eats, so both orders do
+// exactly the same searches and only their memory access differs.
+static void RunLocalityBenchmark(size_t creature_count, size_t food_count, size_t tick_count) {
+    printf("\n%zu creatures, %zu food, one thread, ms per tick\n", creature_count, food_count);
+    printf("%10s %16s %19s %19s\n", "order", "searches/tick", "sense nearest food", "resolve collisions");
+
+    for (int sorted = 0; sorted < 2; sorted++) {
+        std::vector<Creature> creatures = MakeCreatures(creature_count);
+        std::vector<Food> food = Food::SpawnParticles(food_count, ci::Color("Green"), 2.0f, 20);
+        if (sorted) {
+            MortonSorter sorter;
+            sorter.Sort(creatures, BOUNDS);
+            sorter.Sort(food, BOUNDS);
+        }
+
+        SteeringBatch batch;
+        SweepAndPrune broad_phase;
+        TickGraph tick_graph;
+        TaskGraph tasks;
+        double phase_times[2] = {};
+        size_t searches = 0;
+        const int phases[2] = {TickGraph::PHASE_SENSE_NEAREST_FOOD, TickGraph::PHASE_RESOLVE_COLLISIONS};
+        for (size_t tick = 0; tick < tick_count; tick++) {
+            batch.Gather(creatures);
+            tick_graph.Prepare(&batch, &food, nullptr, BOUNDS, &broad_phase, CHUNK_SIZE);
+            tick_graph.InvalidateSensing();
+            for (int phase = 0; phase < TickGraph::PHASE_COUNT; phase++) {
+                if (phase == TickGraph::PHASE_FIND_TOUCHING_FOOD) { // Skipped so nothing eats, see above
+                    continue;
+                }
+                tasks.Clear();
+                tick_graph.BuildPhaseGraph(phase, tasks);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                tasks.RunInline();
+                for (int p = 0; p < 2; p++) {
+                    if (phase == phases[p]) {
+                        phase_times[p] += MillisecondsSince(start);
+                    }
+                }
+            }
+            searches += tick_graph.GetSenseCount();
+        }
+
+        printf("%10s %16.0f %19.2f %19.2f\n", sorted ? "morton" : "spawn", (double) searches / tick_count,
+               phase_times[0] / tick_count, phase_times[1] / tick_count);
+    }
+}
+
+// Runs consecutive ticks of one world on the shared scheduler, once with food particles and once
+// with the same food seeded as a field, and compares what a tick costs.
+static void RunFoodFieldBenchmark(size_t creature_count, size_t food_count, size_t tick_count) {
+    printf("\n%zu creatures, %zu food, %zu consecutive ticks, %zu threads\n", creature_count, food_count, tick_count,
+           TaskScheduler::Shared().GetThreadCount());
+    printf("%10s %16s %16s\n", "food", "ms per tick", "meals");
+
+    for (int mode = FOOD_MODE_PARTICLES; mode <= FOOD_MODE_FIELD; mode++) {
+        std::vector<Creature> creatures = MakeCreatures(creature_count);
+        std::vector<Food> food = Food::SpawnParticles(food_count, ci::Color("Green"), 2.0f, 20);
+        std::vector<Food> remaining;
+        FoodGrid food_grid;
+        food_grid.Build(food, BOUNDS, 16.0f);
+        FoodField field;
+        field.Build(BOUNDS, 16.0f);
+        field.Seed(food);
+        std::vector<float> meal_progress(creature_count, 0);
+
+        SteeringBatch batch;
+        batch.Gather(creatures);
+        TickGraph tick_graph;
+        FoodFieldTick field_tick;
+        TaskGraph tasks;
+        size_t meals = 0;
+        double tick_time = 0;
+        for (size_t tick = 0; tick < tick_count; tick++) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            tasks.Clear();
+            if (mode == FOOD_MODE_FIELD) {
+                field_tick.Prepare(&batch, &field, &meal_progress, BOUNDS, nullptr, CHUNK_SIZE, 1.0f, 0.02f, 0.01f);
+                field_tick.BuildGraph(tasks);
+                TaskScheduler::Shared().Run(tasks);
+                field_tick.Finish();
+                meals += field_tick.GetMeals().size();
+            } else {
+                tick_graph.Prepare(&batch, &food, &food_grid, BOUNDS, nullptr, CHUNK_SIZE);
+                tick_graph.BuildGraph(tasks);
+                TaskScheduler::Shared().Run(tasks);
+                meals += tick_graph.GetMeals().size();
+                tick_graph.CollectRemainingFood(remaining);
+                if (remaining.size() != food.size()) { // As Environment keeps its grid up to date
+                    food_grid.Build(remaining, BOUNDS, 16.0f);
+                }
+                food.swap(remaining);
+            }
+            tick_time += MillisecondsSince(start);
+        }
+
+        printf("%10s %16.2f %16zu\n", mode == FOOD_MODE_FIELD ? "field" : "particles", tick_time / tick_count, meals);
+    }
+}
+
+}
+
+// Usage: tick_benchmark [creatures] [food] [ticks]
+int main(int argc, char **argv) {
+    size_t creature_count = argc > 1 ? (size_t) atoi(argv[1]) : 100000;
+    size_t food_count = argc > 2 ? (size_t) atoi(argv[2]) : 1000;
+    size_t tick_count = argc > 3 ? (size_t) atoi(argv[3]) : 5;
+    naturalselection::RunTickBenchmark(creature_count, food_count, tick_count);
+    naturalselection::RunSensingBenchmark(creature_count, food_count, tick_count * 20);
+    naturalselection::RunLocalityBenchmark(creature_count, food_count, tick_count * 4);
+    naturalselection::RunFoodFieldBenchmark(creature_count, food_count, tick_count * 20);
+    return 0;
+}
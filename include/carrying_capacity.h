@@ -0,0 +1,68 @@
+#pragma once
+
+#include "creature.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * How the carrying capacity picks who stays when a generation would outgrow it.
+ */
+enum CapacityPolicy {
+    CAPACITY_UNIFORM = 0, // Every survivor and child is equally likely to stay
+    CAPACITY_FITNESS = 1 // Odds proportional to food eaten, a child counting its parent's food
+};
+
+/**
+ * Optional upper bound on the population. With plenty of food every creature
+ * eats twice and the population doubles each generation, so an unattended run
+ * eventually runs out of memory and frame time. When a new generation would be
+ * bigger than the limit, a single reservoir-sampling pass over it keeps
+ * exactly limit creatures, in their original order. GenerationTurnover does
+ * the sampling before it builds the generation, so creatures that would be
+ * culled are never made and memory and tick cost never grow past what limit
+ * creatures need.
+ *
+ * A limit of 0 turns the cap off.
+ */
+struct CarryingCapacity {
+    size_t limit = 0;
+    int policy = CAPACITY_UNIFORM;
+
+    bool IsEnabled() const;
+
+    static const char *GetPolicyName(int policy);
+
+    /**
+     * Reduces next_generation, as GenerationTurnover::Run built it from parents, to at
+     * most limit creatures. Returns how many were removed. The draws only depend on seed.
+     */
+    size_t Apply(const std::vector<Creature> &parents, std::vector<Creature> &next_generation,
+                 uint64_t seed) const;
+
+    /**
+     * Picks which of the count creatures GenerationTurnover::Run builds from parents stay,
+     * as indices into that generation in increasing order, without the generation having
+     * to exist yet. Returns false, with chosen empty, when all of them fit.
+     */
+    bool Choose(const std::vector<Creature> &parents, size_t count, uint64_t seed,
+                std::vector<size_t> &chosen) const;
+
+    /**
+     * Reservoir sampling (Algorithm R): picks sample_size of count indices, each equally
+     * likely, and returns them in increasing order.
+     */
+    static void SampleUniform(size_t count, size_t sample_size, uint64_t seed, std::vector<size_t> &chosen);
+
+    /**
+     * Weighted reservoir sampling (Efraimidis and Spirakis' A-Res): picks sample_size
+     * indices without replacement, each with odds proportional to its weight, and returns
+     * them in increasing order. Indices with weight 0 are only picked to fill the sample.
+     */
+    static void SampleWeighted(const std::vector<float> &weights, size_t sample_size, uint64_t seed,
+                               std::vector<size_t> &chosen);
+};
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace naturalselection {
+
+class Creature;
+
+/**
+ * A creature packed into 32 bytes, for keeping whole populations around, such
+ * as the record of every generation, without paying for a full Creature each.
+ *
+ * Only what varies between creatures is stored. Radius and mass are the same
+ * for every creature the simulation spawns, the energy spend follows from the
+ * type and traits through the Genome, and the colour follows from the type and
+ * food, so all of them are derived when needed instead. Intelligence children
+ * pay for the vision they inherited, which isn't kept, so theirs is recomputed
+ * from their own vision.
+ */
+struct CompactCreature {
+    float x;
+    float y;
+    float x_velocity;
+    float y_velocity;
+    float energy;
+    float max_velocity;
+    float vision_radius;
+    uint32_t flags; // Type in the low byte, food in the next 16 bits, then the needs-movement bit
+
+    static CompactCreature Pack(const Creature &creature);
+
+    /**
+     * Replaces packed with one compact record per creature, in the same order.
+     */
+    static void PackAll(const std::vector<Creature> &creatures, std::vector<CompactCreature> &packed);
+
+    /**
+     * A full creature with the default radius and mass and its energy spend recomputed from its traits.
+     */
+    Creature Unpack() const;
+
+    int GetCreatureType() const;
+    int GetFood() const;
+    bool GetNeedsMovement() const;
+    double GetEnergySpend() const;
+    ci::Color GetColor() const;
+};
+
+static_assert(sizeof(CompactCreature) == 32, "CompactCreature should stay two to a cache line");
+
+/**
+ * One generation's population as it was recorded. Never changes once made, so the
+ * environment and every graph drawing it share the same copy.
+ */
+typedef std::shared_ptr<const std::vector<CompactCreature>> GenerationRecord;
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "creature.h"
+#include "steering_kernel.h"
+#include "world_snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * Layers of a DensityGrid: one per creature type, numbered by type, then food.
+ */
+enum DensityChannel {
+    DENSITY_SPEED = SPEED,
+    DENSITY_INTELLIGENCE = INTELLIGENCE,
+    DENSITY_BOTH = BOTH,
+    DENSITY_FOOD = 3,
+    DENSITY_CHANNEL_COUNT = 4
+};
+
+/**
+ * Level-of-detail stand-in for drawing every creature and food as circles.
+ * Counts how many of each fall in every cell of a coarse grid over a region of
+ * the arena, and turns those counts into an RGBA image with one pixel per cell,
+ * so a crowded arena costs one texture upload and one quad to draw instead of
+ * thousands of circles. Everything here runs on the CPU, so it can be tested
+ * without a GL context.
+ */
+class DensityGrid {
+public:
+    /**
+     * Counts the snapshot's creatures and food in a columns x rows grid over region.
+     * Anything outside region is left out.
+     */
+    void Rasterize(const WorldSnapshot &snapshot, const WorldBounds &region, size_t columns, size_t rows);
+
+    size_t GetColumns() const;
+    size_t GetRows() const;
+
+    uint32_t GetCount(int channel, size_t column, size_t row) const;
+
+    /**
+     * The most crowded cell's count over every creature channel, or over food.
+     */
+    uint32_t GetMaxCreatureCount() const;
+    uint32_t GetMaxFoodCount() const;
+
+    /**
+     * Writes the grid as 8-bit RGBA, row by row from the top. A cell with creatures
+     * gets the colour of its types mixed by count, brighter the more crowded it is
+     * on a log scale; a cell with only food is green; an empty cell is transparent.
+     */
+    void FillPixels(std::vector<uint8_t> &rgba) const;
+
+    /**
+     * How many creatures and food lie inside region, to decide whether it is worth drawing them one by one.
+     */
+    static size_t CountInside(const WorldSnapshot &snapshot, const WorldBounds &region);
+
+private:
+    bool CellOf(glm::vec2 position, size_t &cell) const;
+
+    WorldBounds region_ = WorldBounds{0, 0, 0, 0};
+    size_t columns_ = 0;
+    size_t rows_ = 0;
+    float cells_per_x_ = 0;
+    float cells_per_y_ = 0;
+    std::vector<uint32_t> counts_[DENSITY_CHANNEL_COUNT];
+    uint32_t max_creature_count_ = 0;
+    uint32_t max_food_count_ = 0;
+};
+
+}
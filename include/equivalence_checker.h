@@ -0,0 +1,81 @@
+#pragma once
+
+#include "headless_runner.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace naturalselection {
+
+class Creature;
+class Environment;
+class Food;
+
+/**
+ * How often the two engines' states are compared.
+ */
+enum EquivalenceGranularity {
+    COMPARE_EVERY_TICK = 0,
+    COMPARE_EVERY_GENERATION = 1
+};
+
+/**
+ * Outcome of an equivalence check. When the engines disagree, frame is the first
+ * frame after which their states differ, and subject, field and the two values
+ * say where.
+ */
+struct EquivalenceReport {
+    bool equivalent = true;
+    uint64_t frames_compared = 0;
+    size_t checkpoints_compared = 0;
+
+    uint64_t frame = 0;
+    std::string subject;
+    std::string field;
+    std::string reference_value;
+    std::string optimized_value;
+
+    std::string Describe() const;
+};
+
+/**
+ * Runs a SweepJob once on the reference tick engine and once on the optimized
+ * one, from the same seed, and checks they compute the same world.
+ *
+ * Both runs draw from the global rand(), so they can't be interleaved. The
+ * reference run only keeps a hash of its state at every checkpoint, and the
+ * optimized run is compared against those as it goes. Only once they differ
+ * are the runs replayed to find the exact frame and keep full copies of both
+ * states there.
+ */
+class EquivalenceChecker {
+public:
+    static EquivalenceReport Run(const SweepJob &job, int granularity);
+
+    /**
+     * Hash of every creature field and food position. Positive and negative zero hash the same.
+     */
+    static uint64_t HashState(const std::vector<Creature> &creatures, const std::vector<Food> &food);
+
+    /**
+     * Fills in where report's two states first differ, creatures before food and fields
+     * in a fixed order. Returns false if they are the same.
+     */
+    static bool FindFirstDifference(const std::vector<Creature> &reference_creatures,
+                                    const std::vector<Food> &reference_food,
+                                    const std::vector<Creature> &optimized_creatures,
+                                    const std::vector<Food> &optimized_food, EquivalenceReport &report);
+
+private:
+    // Called after every frame, and once for the starting state as frame 0. Returning false stops the run.
+    typedef std::function<bool(uint64_t frame, Environment &environment)> FrameVisitor;
+
+    /**
+     * Runs job from its seed on the given engine. Returns the number of frames run.
+     */
+    static uint64_t Replay(const SweepJob &job, int engine, const FrameVisitor &visit);
+};
+
+}
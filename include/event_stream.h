@@ -0,0 +1,155 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace naturalselection {
+
+class Creature;
+
+/**
+ * Layout of an event stream file, so tools in any language can read it: an
+ * EventStreamHeader, then LifeEvents back to back in the order they happened.
+ * Everything is little-endian and naturally aligned. A file cut short by a
+ * crash ends in at most one partial event, which readers ignore.
+ */
+static const uint32_t EVENT_STREAM_MAGIC = 0x4E534556; // "NSEV"
+static const uint32_t EVENT_STREAM_VERSION = 1;
+
+enum LifeEventType {
+    EVENT_MEAL = 1,
+    EVENT_BIRTH = 2,
+    EVENT_DEATH = 3,
+    EVENT_GENERATION = 4
+};
+
+enum DeathCause {
+    DEATH_STARVED = 0, // Came home with no food
+    DEATH_CULLED = 1, // Removed by the carrying capacity
+    DEATH_REMOVED = 2 // Removed by hand
+};
+
+struct EventStreamHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t event_bytes; // sizeof(LifeEvent), so a reader can tell a layout it doesn't know
+    uint32_t reserved;
+};
+
+struct LifeEvent {
+    uint64_t tick;
+    // Meal: the creature that ate. Birth: the child. Death: who died. Generation: the new generation's number.
+    uint32_t creature_id;
+    // Meal: the food's id, 0 for food from a FoodField. Birth: the parent's id, 0 for creatures added by hand.
+    // Generation: its population.
+    uint32_t other_id;
+    float max_velocity; // Birth only: the child's traits, after mutation
+    float vision_radius;
+    uint8_t type; // A LifeEventType
+    uint8_t detail; // Birth: the creature type. Death: a DeathCause.
+    uint8_t reserved[6];
+};
+
+/**
+ * Appends life events to a file from a background thread. Recording one only
+ * copies it into an in-memory buffer; when the buffer fills, it is handed to
+ * the writer thread and recording carries on into a spare one, so the tick
+ * loop never waits on the disk unless the writer falls a whole queue behind.
+ */
+class EventStreamWriter {
+public:
+    static const size_t DEFAULT_BUFFER_EVENTS = 16384;
+    static const size_t MAX_QUEUED_BUFFERS = 8; // Past this, recording waits for the writer
+
+    EventStreamWriter() = default;
+    ~EventStreamWriter();
+
+    EventStreamWriter(const EventStreamWriter &) = delete;
+    EventStreamWriter &operator=(const EventStreamWriter &) = delete;
+
+    /**
+     * Creates, or truncates, the file at path and starts the writer thread. Returns false if it can't be created.
+     */
+    bool Open(const std::string &path, size_t buffer_events = DEFAULT_BUFFER_EVENTS);
+
+    void RecordMeal(uint64_t tick, uint32_t creature_id, uint32_t food_id);
+    void RecordBirth(uint64_t tick, const Creature &child);
+    void RecordDeath(uint64_t tick, uint32_t creature_id, int cause);
+    void RecordGeneration(uint64_t tick, size_t generation, size_t population);
+
+    /**
+     * Hands over whatever is buffered and waits until all of it is in the file.
+     */
+    void Flush();
+
+    /**
+     * Flushes, stops the writer thread and closes the file. Called by the destructor.
+     */
+    void Close();
+
+    bool IsOpen() const;
+    uint64_t GetEventsRecorded() const;
+
+    /**
+     * Whether any write to the file failed, in which case the events in it were lost.
+     */
+    bool GetWriteFailed() const;
+
+private:
+    void Record(const LifeEvent &event);
+    void HandOff(); // Queues the filling buffer for the writer and takes a spare one
+    void Write();
+
+    FILE *file_ = nullptr;
+    size_t buffer_events_ = DEFAULT_BUFFER_EVENTS;
+    std::vector<LifeEvent> filling_; // Only touched by the recording thread
+    uint64_t events_recorded_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_; // Something was queued, or it is time to stop
+    std::condition_variable written_; // A buffer was written, so one more is spare
+    std::vector<std::vector<LifeEvent>> queued_;
+    std::vector<std::vector<LifeEvent>> spare_;
+    bool writing_ = false; // The writer has taken a buffer off the queue and not finished it
+    bool stopping_ = false;
+    bool write_failed_ = false;
+    std::thread thread_;
+};
+
+/**
+ * Maps an event stream file read-only, so any part of it can be iterated
+ * without reading it all in. It sees the events written before Open; open it
+ * again to see more.
+ */
+class EventStreamReader {
+public:
+    EventStreamReader() = default;
+    ~EventStreamReader();
+
+    EventStreamReader(const EventStreamReader &) = delete;
+    EventStreamReader &operator=(const EventStreamReader &) = delete;
+
+    /**
+     * Returns false if there is no such file or it is not a version this reader understands.
+     */
+    bool Open(const std::string &path);
+    void Close();
+
+    size_t Size() const;
+    const LifeEvent &operator[](size_t index) const;
+    const LifeEvent *begin() const;
+    const LifeEvent *end() const;
+
+private:
+    const uint8_t *mapping_ = nullptr;
+    size_t mapping_bytes_ = 0;
+    size_t event_count_ = 0;
+};
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "memory_ledger.h"
+#include "steering_kernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+class Food;
+
+/**
+ * How the environment represents food: as individual Food particles that
+ * creatures search for, or as a FoodField that trades them for throughput.
+ */
+enum FoodMode {
+    FOOD_MODE_PARTICLES = 0,
+    FOOD_MODE_FIELD = 1
+};
+
+/**
+ * Food as a coarse density over the arena instead of individual particles:
+ * each cell of a uniform grid holds how many food's worth is spread over it.
+ * Creatures eat from the cell they are in, a bite a tick, and sense which way
+ * the field rises within their vision from a summed-area table, so a tick
+ * costs the same however much food there is or however far creatures see.
+ * Each tick the field also spreads to its neighbours and grows back towards
+ * what was first seeded, in one stencil pass over whole rows.
+ */
+class FoodField {
+public:
+    /**
+     * Lays an empty grid of cell_size cells over bounds.
+     */
+    void Build(const WorldBounds &bounds, float cell_size);
+
+    /**
+     * Empties the field and puts one meal in the cell of each food. That is also what it grows back towards.
+     */
+    void Seed(const std::vector<Food> &food);
+
+    /**
+     * Adds amount to the cell at (x, y), without changing what the field grows back towards.
+     */
+    void Deposit(float x, float y, float amount);
+
+    /**
+     * Takes amount out of the whole field, the same fraction from every cell.
+     */
+    void RemoveEvenly(float amount);
+
+    /**
+     * One creature after another, in order, each one that isn't full takes a quarter of a meal
+     * from its cell, or whatever is left there, into meal_progress. A creature whose bites add up to
+     * a meal eats it, as it would a food particle, and its index is added to fed.
+     */
+    void Feed(SteeringBatch &batch, std::vector<float> &meal_progress, std::vector<uint32_t> &fed);
+
+    /**
+     * Builds the summed-area table SteerUpGradient reads. Call after the field changes.
+     */
+    void BuildSums();
+
+    /**
+     * Turns creatures with a non-zero mask entry that aren't full up the field, comparing what
+     * lies on either side of their cell within vision along each axis, at full speed. A creature
+     * that sees no difference keeps its velocity. Reads the sums, not the field, so the field
+     * can be stepped meanwhile.
+     */
+    void SteerUpGradient(SteeringBatch &batch, const std::vector<uint8_t> &mask, size_t begin, size_t end) const;
+
+    /**
+     * Spreads each cell towards its neighbours by diffusion, which is stable up to 0.25, and moves
+     * it regrowth of the way back to what was seeded. Walls reflect, so spreading loses nothing.
+     */
+    void Step(float diffusion, float regrowth);
+
+    /**
+     * Step for rows [row_begin, row_end) only, into a second buffer, so bands of rows can be
+     * stepped at once. FinishStep swaps it in once every row is done.
+     */
+    void StepRows(float diffusion, float regrowth, size_t row_begin, size_t row_end);
+    void FinishStep();
+
+    size_t GetColumns() const;
+    size_t GetRows() const;
+    float GetDensity(size_t column, size_t row) const;
+    float GetDensityAt(float x, float y) const;
+
+    /**
+     * How much food there is in the whole field, in meals.
+     */
+    double GetTotal() const;
+
+    MemoryFootprint GetMemoryFootprint() const;
+
+private:
+    size_t ColumnOf(float x) const;
+    size_t RowOf(float y) const;
+
+    // Total over columns [column_begin, column_end) and rows [row_begin, row_end), 0 if either is empty.
+    double SumBox(size_t column_begin, size_t column_end, size_t row_begin, size_t row_end) const;
+
+    WorldBounds bounds_ = WorldBounds{0, 0, 0, 0};
+    float inverse_cell_size_ = 0;
+    size_t columns_ = 0;
+    size_t rows_ = 0;
+    std::vector<float> density_; // Row by row
+    std::vector<float> capacity_; // What each cell grows back towards
+    std::vector<float> next_density_;
+    std::vector<double> row_totals_; // Of next_density_, filled in by StepRows
+    std::vector<double> sums_; // (columns_ + 1) x (rows_ + 1), with a row and column of zeros first
+    double total_ = 0;
+};
+
+}
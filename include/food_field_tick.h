@@ -0,0 +1,75 @@
+#pragma once
+
+#include "food_field.h"
+#include "steering_kernel.h"
+#include "sweep_and_prune.h"
+#include "task_scheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * One tick of a world whose food is a FoodField, as a TaskGraph in the same
+ * shape as TickGraph's. Creatures steer for the corner, eat from their cells
+ * in one short serial pass, then steer up the field and home and move in
+ * parallel chunks, while the field is stepped in bands of rows beside them.
+ * There is nothing to search for, so a tick costs about the same per
+ * creature however much food there is.
+ *
+ * Whether any food is left is decided once at the start of the tick rather
+ * than as each creature eats, since no one creature eats the last of it.
+ */
+class FoodFieldTick {
+public:
+    /**
+     * Points the tick at this tick's creatures and field. meal_progress holds each creature's
+     * bites towards its next meal and must have one entry per creature. broad_phase is null
+     * when collisions are off. The field spreads by diffusion and grows back by regrowth.
+     */
+    void Prepare(SteeringBatch *batch, FoodField *field, std::vector<float> *meal_progress,
+                 const WorldBounds &bounds, SweepAndPrune *broad_phase, size_t chunk_size, float time_step,
+                 float diffusion, float regrowth);
+
+    size_t GetChunkCount() const;
+
+    /**
+     * Adds the whole tick to graph, each task only waiting on what it reads.
+     */
+    void BuildGraph(TaskGraph &graph);
+
+    /**
+     * Swaps the stepped field in. Call once the graph has run.
+     */
+    void Finish();
+
+    /**
+     * The creatures that ate a meal this tick, as indices into the batch, in the order they ate.
+     */
+    const std::vector<uint32_t> &GetMeals() const;
+
+private:
+    void SteerToCorner(size_t begin, size_t end);
+    void SteerHome(size_t begin, size_t end);
+    void ResolveCollisions();
+    void Move(size_t begin, size_t end);
+
+    SteeringBatch *batch_ = nullptr;
+    FoodField *field_ = nullptr;
+    std::vector<float> *meal_progress_ = nullptr;
+    WorldBounds bounds_ = WorldBounds{0, 0, 0, 0};
+    SweepAndPrune *broad_phase_ = nullptr;
+    size_t chunk_size_ = 1;
+    size_t chunk_count_ = 0;
+    float time_step_ = 1.0f;
+    float diffusion_ = 0;
+    float regrowth_ = 0;
+
+    std::vector<uint8_t> food_empty_; // Per creature, all the same, as the steering kernels take masks
+    std::vector<uint8_t> food_left_;
+    std::vector<uint32_t> meals_;
+    std::vector<CollisionPair> collision_pairs_;
+};
+
+}
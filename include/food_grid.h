@@ -0,0 +1,91 @@
+#pragma once
+
+#include "steering_kernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+class Food;
+
+/**
+ * Uniform grid over the food of one tick, stored as a counting sort: the
+ * indices of the food in each cell are contiguous, so building it is two
+ * passes over the food and a query only touches the cells it overlaps.
+ *
+ * Every cell is laid out with some room to spare, so food added to the end of
+ * the food list or taken out of it only touches its own cell. Only when a cell
+ * fills up is everything laid out again, from the cells already known.
+ */
+class FoodGrid {
+public:
+    void Build(const std::vector<Food> &food, const WorldBounds &bounds, float cell_size);
+
+    /**
+     * Adds food as the next index after the ones already in the grid. Build first.
+     */
+    void Add(const Food &food);
+
+    /**
+     * Takes the food at index out of the grid, and gives the food with the highest index
+     * its place, as swapping it with the last and popping that does to the food list.
+     */
+    void Remove(size_t index);
+
+    /**
+     * Takes the food with the highest index out of the grid.
+     */
+    void RemoveLast();
+
+    /**
+     * Number of food the grid was built from.
+     */
+    size_t Size() const;
+
+    /**
+     * Calls visit(food_index) for every food in a cell overlapping the square of
+     * half-width reach around (x, y), in no particular order. It may also visit
+     * food further away than reach, so callers still check the real distance.
+     */
+    template <typename Visitor>
+    void ForEachNear(float x, float y, float reach, Visitor visit) const {
+        if (food_count_ == 0) {
+            return;
+        }
+
+        size_t first_column = CellColumn(x - reach);
+        size_t last_column = CellColumn(x + reach);
+        size_t first_row = CellRow(y - reach);
+        size_t last_row = CellRow(y + reach);
+        for (size_t row = first_row; row <= last_row; row++) {
+            for (size_t column = first_column; column <= last_column; column++) {
+                size_t cell = row * columns_ + column;
+                uint32_t end = cell_starts_[cell] + cell_counts_[cell];
+                for (uint32_t i = cell_starts_[cell]; i < end; i++) {
+                    visit((size_t) food_indices_[i]);
+                }
+            }
+        }
+    }
+
+private:
+    size_t CellColumn(float x) const;
+    size_t CellRow(float y) const;
+    // Places every food in its cell from food_cells_, leaving room in each cell.
+    void Layout();
+
+    float min_x_ = 0;
+    float min_y_ = 0;
+    float inverse_cell_size_ = 1;
+    size_t columns_ = 1;
+    size_t rows_ = 1;
+    size_t food_count_ = 0;
+    std::vector<uint32_t> cell_starts_; // A cell's room runs up to the next cell's start
+    std::vector<uint32_t> cell_counts_;
+    std::vector<uint32_t> food_indices_;
+    std::vector<uint32_t> food_cells_;
+    std::vector<uint32_t> food_slots_; // Where each food's index is in food_indices_
+};
+
+}
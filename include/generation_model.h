@@ -0,0 +1,132 @@
+#pragma once
+
+#include "creature.h"
+#include "random_stream.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * How well a GenerationModel foresaw one fully simulated generation: what it
+ * expected of each creature against how the creature actually fared.
+ */
+struct FastForwardReport {
+    size_t generation = 0; // The fully simulated generation it was checked against
+    size_t generations_skipped = 0; // Fast-forwarded just before it
+    size_t population = 0;
+    double expected_survivors = 0;
+    size_t survivors = 0;
+    double expected_births = 0;
+    size_t births = 0;
+    // Mean over creatures of the squared error of the predicted chances of ending with 0, 1 and 2
+    // food. 0 is perfect. The baseline gives every creature the calibration's overall rates, so a
+    // model worth using scores below it.
+    double brier_score = 0;
+    double baseline_brier_score = 0;
+};
+
+/**
+ * Per-generation fate of a creature as a function of its type, its speed, its
+ * vision, and how crowded the world is, fitted to recent fully simulated
+ * generations. A creature ends a generation with 0, 1 or 2 food, which is all
+ * GenerationTurnover needs to know, so the model is two logistic regressions:
+ * whether it eats at all, and whether a creature that ate eats twice. Each
+ * takes a quadratic in the two traits, so an optimum in between can be fitted,
+ * the creature's type, and the log of creatures per food, so the population
+ * can't outgrow the food for long.
+ *
+ * Fates swing a lot from one small generation to the next, so the regressions
+ * can do worse than the window's overall rates. Fit first checks them on each
+ * generation in turn, fitted to the others, and if they lose to the others'
+ * overall rates, every creature gets the overall rates instead.
+ */
+class GenerationModel {
+public:
+    static const size_t FEATURE_COUNT = 9;
+    static const size_t MIN_FIT_SAMPLES = 50; // Fewer creatures than this in the window, and Fit gives up
+
+    /**
+     * How many of the most recent observed generations are kept to fit to.
+     */
+    void SetWindow(size_t generations);
+    size_t GetWindow() const;
+
+    /**
+     * Adds a generation that was simulated in full, as its creatures came home, with food_count
+     * food spawned for it. Drops the oldest one past the window.
+     */
+    void Observe(const std::vector<Creature> &creatures, size_t food_count);
+
+    /**
+     * Fits both regressions to the generations in the window. Returns false, keeping any
+     * earlier fit, if there are too few creatures to go on.
+     */
+    bool Fit();
+    bool IsFitted() const;
+
+    /**
+     * Whether the last fit lost to the overall rates on the generations held out from it, so
+     * Predict gives every creature those rates.
+     */
+    bool IsUsingBaseRates() const;
+
+    /**
+     * Chances that creature ends a generation with 0, 1 and 2 food, in a generation of
+     * population creatures with food_count food.
+     */
+    std::array<double, 3> Predict(const Creature &creature, size_t population, size_t food_count) const;
+
+    /**
+     * Food each of creatures ends a generation with, drawn from Predict under one seed, into food.
+     * Creatures draw on their own, but a food can only be eaten once, so if the draws come to more
+     * than meal_budget meals, creatures likelier to eat keep theirs first and the rest go without.
+     */
+    void DrawOutcomes(const std::vector<Creature> &creatures, size_t food_count, size_t meal_budget,
+                      uint64_t seed, std::vector<int> &food) const;
+
+    /**
+     * Checks the fit against a generation it wasn't fitted to, given as its creatures came home.
+     */
+    FastForwardReport Score(const std::vector<Creature> &creatures, size_t food_count) const;
+
+    size_t GetObservedCount() const;
+    void Clear();
+
+private:
+    struct Sample {
+        float speed;
+        float vision;
+        float crowding; // log of creatures per food that generation
+        uint8_t type;
+        uint8_t food;
+    };
+
+    typedef std::array<double, FEATURE_COUNT> Features;
+
+    // Fits the regressions and base rates to every generation in the window but held_out.
+    void FitTo(size_t held_out);
+
+    Features GetFeatures(float speed, float vision, float crowding, int type) const;
+
+    std::array<double, 3> PredictFeatures(const Features &features) const;
+
+    // Ridge-regularized logistic regression of labels on rows by Newton's method.
+    static Features FitLogistic(const std::vector<Features> &rows, const std::vector<uint8_t> &labels);
+
+    static float GetCrowding(size_t population, size_t food_count);
+
+    size_t window_ = 5;
+    std::vector<std::vector<Sample>> generations_; // Oldest first
+    bool fitted_ = false;
+    bool using_base_rates_ = false;
+    std::array<float, 3> means_ = {}; // Of speed, vision and crowding, which features are scaled by
+    std::array<float, 3> scales_ = {1, 1, 1};
+    Features survival_weights_ = {};
+    Features reproduction_weights_ = {};
+    std::array<double, 3> base_rates_ = {}; // How often the window ended with 0, 1 and 2 food
+};
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "carrying_capacity.h"
+#include "creature.h"
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * End-of-generation turnover written as a parallel stream compaction. Each
+ * chunk of the population counts its survivors (food > 0) and births
+ * (food > 1), an exclusive scan over those counts gives every chunk its
+ * output offsets, and then all chunks write survivors and mutated children
+ * into the next generation at the same time.
+ *
+ * The output order matches the sequential version: all survivors in their
+ * original order, followed by one child per well-fed survivor in the same
+ * order. Each child's mutation comes from the RandomStream for its parent's
+ * index, so the result only depends on the seed, never on the thread count.
+ */
+class GenerationTurnover {
+public:
+    /**
+     * Fills next_generation from parents. thread_count 0 uses every hardware thread.
+     */
+    static void Run(const std::vector<Creature> &parents, std::vector<Creature> &next_generation,
+                    uint64_t seed, size_t thread_count = 0);
+
+    /**
+     * Run with capacity applied as the generation is built: who stays is picked from the
+     * counts alone, and only they are written, so next_generation never holds more than
+     * capacity.limit creatures. Keeps the same creatures, in the same order, as Run
+     * followed by capacity.Apply. Returns how many were left out.
+     */
+    static size_t Run(const std::vector<Creature> &parents, std::vector<Creature> &next_generation,
+                      uint64_t seed, const CarryingCapacity &capacity, size_t thread_count = 0);
+
+    static bool Survives(const Creature &creature);
+
+    static bool Reproduces(const Creature &creature);
+};
+
+}
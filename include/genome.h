@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+class Creature;
+
+/**
+ * Heritable traits. Adding a trait means adding an entry here and a TraitSpec
+ * in genome.cpp; mutation and energy cost pick it up automatically.
+ */
+enum GenomeTrait {
+    TRAIT_MAX_VELOCITY = 0,
+    TRAIT_VISION_RADIUS = 1,
+    TRAIT_COUNT = 2
+};
+
+/**
+ * Energy spend multiplier as a function of how far a trait is from its
+ * default, expressed as the ratio value / default. Sampled into a lookup table
+ * once at start up instead of calling pow/log on every birth.
+ */
+class CostTable {
+public:
+    typedef double (*CostCurve)(double ratio);
+
+    CostTable(CostCurve curve, double max_ratio, size_t resolution);
+
+    /**
+     * Linearly interpolated multiplier. Ratios past the end of the table fall back to the curve itself.
+     */
+    float Lookup(float ratio) const;
+
+private:
+    CostCurve curve_;
+    float max_ratio_;
+    float samples_per_unit_;
+    std::vector<float> samples_;
+};
+
+/**
+ * How a single trait mutates and what it costs.
+ */
+struct TraitSpec {
+    const char *name;
+    float default_value;
+    float mutation_margin; // Children vary by up to this fraction of the parent's value, either way.
+    CostTable::CostCurve cost_curve;
+};
+
+/**
+ * The heritable traits of one creature.
+ */
+class Genome {
+public:
+    Genome();
+
+    static Genome FromCreature(const Creature &creature);
+
+    /**
+     * The genome a child of parent starts from before mutating: the parent's, except for
+     * traits the parent's type doesn't pass on, which start from their defaults.
+     */
+    static Genome Inherit(const Creature &parent);
+
+    /**
+     * Bit mask of the traits children of the given type take from their parent. BOTH
+     * creatures have always mutated their vision from the default rather than their
+     * parent's, so only their speed is inherited.
+     */
+    static uint32_t GetInheritedTraits(int creature_type);
+
+    static const TraitSpec &GetTraitSpec(int trait);
+
+    /**
+     * Bit mask of the traits that mutate for the given creature type.
+     */
+    static uint32_t GetActiveTraits(int creature_type);
+
+    /**
+     * Bit mask of the traits children of the given type pay energy for. BOTH children
+     * have always paid the default spend, whatever their traits.
+     */
+    static uint32_t GetCostedTraits(int creature_type);
+
+    /**
+     * Of the costed traits, those paid for at the value the child inherited rather than
+     * the one it mutated to. Intelligence children have always paid for their parent's vision.
+     */
+    static uint32_t GetInheritedCostTraits(int creature_type);
+
+    /**
+     * Energy multiplier for one trait value, read from that trait's precomputed table.
+     */
+    static float GetCostMultiplier(int trait, float value);
+
+    float GetTrait(int trait) const;
+    void SetTrait(int trait, float value);
+
+    /**
+     * Mutates every trait that is active for creature_type. unit_samples holds one
+     * uniform value in [0, 1] per trait, indexed by trait; inactive entries are ignored.
+     */
+    void Mutate(int creature_type, const float *unit_samples);
+
+    /**
+     * Energy spent per tick by a child of the given type carrying this genome, mutated from inherited.
+     */
+    double CalculateEnergySpend(int creature_type, const Genome &inherited) const;
+
+    /**
+     * Energy spent per tick by a creature of the given type carrying this genome, as if
+     * it had inherited the genome unchanged.
+     */
+    double CalculateEnergySpend(int creature_type) const;
+
+    /**
+     * A newborn with this genome, mutated from inherited, taking everything else from the parent.
+     */
+    Creature CreateCreature(const Creature &parent, int creature_type, const Genome &inherited) const;
+
+private:
+    std::array<float, TRAIT_COUNT> traits_;
+};
+
+/**
+ * Structure-of-arrays genomes for mutating many children at once.
+ */
+struct GenomeBatch {
+    std::array<std::vector<float>, TRAIT_COUNT> traits;
+    std::array<std::vector<float>, TRAIT_COUNT> unit_samples;
+    std::vector<int> creature_type;
+    std::vector<double> energy_spend;
+
+    void Resize(size_t count);
+    size_t Size() const;
+
+    /**
+     * Mutates every genome using the samples in unit_samples, one trait at a time
+     * so each pass is a straight vectorizable loop, then fills energy_spend.
+     */
+    void Mutate();
+
+    Genome GetGenome(size_t index) const;
+
+    /**
+     * The child at index after Mutate, inheriting everything else from the parent.
+     */
+    Creature CreateCreature(size_t index, const Creature &parent) const;
+};
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "carrying_capacity.h"
+#include "food_field.h"
+#include "memory_ledger.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace naturalselection {
+
+class Environment;
+
+/**
+ * One configuration of a parameter sweep: which creature types start in the
+ * world, how much food spawns, and how many generations to run for.
+ */
+struct SweepJob {
+    size_t id = 0;
+    size_t attempt = 0; // Set by the coordinator, 0 on the first try.
+    uint32_t seed = 0;
+    size_t food_count = 0;
+    bool speed_creatures = false;
+    bool intelligence_creatures = false;
+    bool both_type_creatures = false;
+    size_t creatures_per_type = 0; // 0 spawns as many as the app does
+    bool collisions_enabled = false;
+    size_t generations = 0;
+    uint64_t max_ticks = 0; // Gives up on a run that never finishes a generation.
+    size_t carrying_capacity = 0; // 0 lets the population grow without bound
+    int capacity_policy = CAPACITY_UNIFORM;
+    int food_mode = FOOD_MODE_PARTICLES;
+    uint16_t metrics_port = 0; // Serves the run's metrics on 127.0.0.1 while it goes on, 0 doesn't
+    float time_step = 1.0f; // How far creatures move per tick, as Environment::SetTimeStep. Must be above 0
+    float food_regrowth_rate = 0; // Food grown back per tick, 0 spawns it all at the start of a generation
+    size_t fast_forward_calibration = 0; // Generations run in full between fast-forwards
+    size_t fast_forward_skipped = 0; // Generations the model stands in for each time, 0 runs them all in full
+
+    /**
+     * Single line, no trailing newline, so jobs can be sent over a pipe or socket.
+     */
+    std::string Serialize() const;
+    static bool Parse(const std::string &line, SweepJob &job);
+};
+
+/**
+ * Population counts at the end of a SweepJob, the carrying capacity it ran under and how many
+ * creatures that removed, and the most memory each subsystem held along the way.
+ */
+struct SweepResult {
+    size_t job_id = 0;
+    uint32_t seed = 0;
+    size_t generations_run = 0;
+    uint64_t ticks = 0;
+    int speed_count = 0;
+    int intelligence_count = 0;
+    int both_type_count = 0;
+    bool hit_tick_limit = false;
+    size_t carrying_capacity = 0;
+    int capacity_policy = CAPACITY_UNIFORM;
+    size_t capacity_removed = 0;
+    size_t peak_memory_bytes = 0;
+    std::array<size_t, MEMORY_SUBSYSTEM_COUNT> peak_subsystem_bytes = {};
+
+    std::string Serialize() const;
+    static bool Parse(const std::string &line, SweepResult &result);
+
+    static const char *CsvHeader();
+    std::string ToCsvRow() const;
+};
+
+/**
+ * Runs an Environment to completion without a window, for batch studies.
+ */
+class HeadlessRunner {
+public:
+    /**
+     * Runs job from a fresh Environment seeded with job.seed. Stops after
+     * job.generations generations, when every creature has died, or at job.max_ticks.
+     * With a job.metrics_port, Prometheus can scrape the run until it stops; a port
+     * that can't be bound only costs the metrics, not the run.
+     */
+    static SweepResult Run(const SweepJob &job);
+
+    /**
+     * Adds the job's food and creatures to a freshly constructed environment. Run seeds
+     * rand() with job.seed before constructing it, since the constructor spawns food.
+     */
+    static void SetUp(const SweepJob &job, Environment &environment);
+
+    /**
+     * Whether the job's generations are done or every creature has died. Ignores max_ticks.
+     */
+    static bool IsFinished(const SweepJob &job, Environment &environment);
+
+    /**
+     * Advances one frame, first pressing return if the previous generation is home.
+     */
+    static void StepFrame(Environment &environment);
+};
+
+}
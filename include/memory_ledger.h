@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * The parts of the simulation whose memory is accounted for separately.
+ */
+enum MemorySubsystem {
+    MEMORY_CREATURES = 0,
+    MEMORY_FOOD = 1,
+    MEMORY_POPULATION_RECORDS = 2,
+    MEMORY_SPEED_HISTOGRAMS = 3,
+    MEMORY_INTELLIGENCE_HISTOGRAMS = 4,
+    MEMORY_SCATTER_PLOTS = 5,
+    MEMORY_POPULATION_GRAPHS = 6,
+    MEMORY_PHYLOGENY = 7,
+    MEMORY_SUBSYSTEM_COUNT = 8
+};
+
+/**
+ * Heap memory held by a set of containers: the bytes they have reserved and how
+ * many separate blocks that takes. Counts capacity, not size, since that is what
+ * the allocator actually handed out.
+ */
+struct MemoryFootprint {
+    size_t bytes = 0;
+    size_t allocations = 0;
+
+    template <typename T>
+    void Add(const std::vector<T> &values) {
+        if (values.capacity() > 0) {
+            bytes += values.capacity() * sizeof(T);
+            allocations++;
+        }
+    }
+
+    template <typename T>
+    void Add(const std::vector<std::vector<T>> &values) {
+        if (values.capacity() > 0) {
+            bytes += values.capacity() * sizeof(std::vector<T>);
+            allocations++;
+        }
+        for (size_t i = 0; i < values.size(); i++) {
+            Add(values[i]);
+        }
+    }
+
+    void Add(const MemoryFootprint &other);
+};
+
+/**
+ * Current and highest-seen memory of one subsystem.
+ */
+struct MemoryUsage {
+    size_t bytes = 0;
+    size_t peak_bytes = 0;
+    size_t allocations = 0;
+    size_t peak_allocations = 0;
+};
+
+/**
+ * Keeps the memory usage of every subsystem, and of all of them together,
+ * across a run. The containers themselves stay plain std::vectors; whoever
+ * owns them measures their footprint and records it here, so the ledger sees
+ * the same memory an allocator hook would without every signature that takes
+ * a std::vector<Creature> having to change.
+ */
+class MemoryLedger {
+public:
+    static const char *GetSubsystemName(int subsystem);
+
+    /**
+     * Records every subsystem at once, so the total peak is a state that really existed.
+     */
+    void Record(const std::array<MemoryFootprint, MEMORY_SUBSYSTEM_COUNT> &footprints);
+
+    const MemoryUsage &GetUsage(int subsystem) const;
+    const MemoryUsage &GetTotal() const;
+
+    /**
+     * One line per subsystem followed by the total, for logs and the Display() overlay.
+     */
+    std::vector<std::string> FormatLines() const;
+
+private:
+    std::array<MemoryUsage, MEMORY_SUBSYSTEM_COUNT> usage_;
+    MemoryUsage total_;
+};
+
+}
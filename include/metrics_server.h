@@ -0,0 +1,103 @@
+#pragma once
+
+#include "memory_ledger.h"
+#include "world_snapshot.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace naturalselection {
+
+class Environment;
+
+/**
+ * Counters for watching a long run from outside the process. The simulation
+ * thread records a snapshot after each tick, which only stores atomics, and any
+ * other thread can format them at any time without waiting on the simulation.
+ * Each value is read on its own, so a scrape can mix two consecutive ticks.
+ */
+class SimulationMetrics {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    SimulationMetrics();
+
+    /**
+     * Only the simulation thread may call this. now is taken as when the snapshot's tick finished.
+     */
+    void Record(const WorldSnapshot &snapshot, Clock::time_point now = Clock::now());
+
+    /**
+     * Same, straight from the environment, for runs that don't publish snapshots to a reader.
+     */
+    void Record(const Environment &environment, Clock::time_point now = Clock::now());
+
+    /**
+     * The counters in Prometheus' text exposition format.
+     */
+    std::string Format() const;
+
+private:
+    void Store(uint64_t tick, uint64_t generation, int speed_count, int intelligence_count, int both_type_count,
+               size_t food_remaining, const MemoryLedger &memory, Clock::time_point now);
+
+    std::atomic<uint64_t> tick_;
+    std::atomic<uint64_t> generation_;
+    std::atomic<double> ticks_per_second_;
+    std::atomic<int> speed_count_;
+    std::atomic<int> intelligence_count_;
+    std::atomic<int> both_type_count_;
+    std::atomic<size_t> food_remaining_;
+    std::array<std::atomic<size_t>, MEMORY_SUBSYSTEM_COUNT> memory_bytes_;
+    std::array<std::atomic<size_t>, MEMORY_SUBSYSTEM_COUNT> peak_memory_bytes_;
+
+    // Owned by the simulation thread: where the current ticks per second window started.
+    bool has_window_ = false;
+    Clock::time_point window_start_;
+    uint64_t window_start_tick_ = 0;
+};
+
+/**
+ * Serves SimulationMetrics over HTTP on 127.0.0.1 for a Prometheus scraper,
+ * from a background thread. Requests are answered one at a time; GET /metrics
+ * gets the counters and anything else gets a 404.
+ */
+class MetricsServer {
+public:
+    explicit MetricsServer(const SimulationMetrics &metrics);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    /**
+     * Starts listening on port, or on any free port if it is 0. Returns false if the port can't be bound.
+     */
+    bool Start(uint16_t port);
+
+    /**
+     * Stops the server thread and closes the socket. Called by the destructor.
+     */
+    void Stop();
+
+    /**
+     * The port actually listened on, once started.
+     */
+    uint16_t GetPort() const;
+
+private:
+    void Serve();
+    void Respond(int connection);
+
+    const SimulationMetrics &metrics_;
+    int listen_socket_ = -1;
+    int wake_pipe_[2] = {-1, -1}; // Written to by Stop() so the server thread leaves poll()
+    uint16_t port_ = 0;
+    std::thread thread_;
+};
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "steering_kernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * Sorts keyed, with a 32-bit key in the high half of each entry, by key. Ties keep their order,
+ * so with the index in the low half and indices in order to begin with, ties go by index.
+ * scratch is reused storage.
+ */
+void SortByKeyHalf(std::vector<uint64_t> &keyed, std::vector<uint64_t> &scratch);
+
+/**
+ * Sorts creatures or food by the Z-order (Morton) key of their position, so
+ * things that are close in the arena are close in memory. Interleaving the
+ * bits of x and y walks the arena in ever larger squares, so a spatial query
+ * over a small area touches only a few runs of the array instead of entries
+ * scattered across all of it.
+ */
+class MortonSorter {
+public:
+    /**
+     * 16 bits of x interleaved with 16 bits of y, over positions clamped to bounds.
+     */
+    static uint32_t GetKey(glm::vec2 position, const WorldBounds &bounds);
+
+    /**
+     * Reorders items, which have GetPosition(), by key. Ties keep their relative order.
+     * Returns false, leaving items alone, if they were already in order.
+     */
+    template <typename T>
+    bool Sort(std::vector<T> &items, const WorldBounds &bounds) {
+        keyed_.resize(items.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            keyed_[i] = ((uint64_t) GetKey(items[i].GetPosition(), bounds) << 32) | i;
+        }
+        if (!ComputeOrder()) {
+            return false;
+        }
+
+        std::vector<T> sorted;
+        sorted.reserve(items.size());
+        for (size_t i = 0; i < order_.size(); i++) {
+            sorted.push_back(std::move(items[order_[i]]));
+        }
+        items.swap(sorted);
+        return true;
+    }
+
+    /**
+     * After a Sort that moved anything, the old index of the item now at each index.
+     */
+    const std::vector<uint32_t> &GetOrder() const;
+
+private:
+    // Sorts keyed_ (key in the high half, index in the low half) and fills order_ from it.
+    // Returns false if it was already sorted.
+    bool ComputeOrder();
+
+    std::vector<uint64_t> keyed_;
+    std::vector<uint64_t> scratch_;
+    std::vector<uint32_t> order_;
+};
+
+}
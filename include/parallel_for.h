@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace naturalselection {
+
+inline std::atomic<size_t> &ThreadBudget() {
+    static std::atomic<size_t> budget(0);
+    return budget;
+}
+
+/**
+ * Caps DefaultThreadCount for the rest of this process, for processes that share the
+ * machine with siblings (e.g. sweep workers). 0 removes the cap. Set it before
+ * TaskScheduler::Shared() is first used, since that sizes its pool only once.
+ */
+inline void SetThreadBudget(size_t thread_count) {
+    ThreadBudget() = thread_count;
+}
+
+/**
+ * Number of threads to use when the caller asks for 0 (i.e. "as many as make sense").
+ */
+inline size_t DefaultThreadCount() {
+    size_t hardware_threads = std::thread::hardware_concurrency();
+    size_t thread_count = hardware_threads > 0 ? hardware_threads : 1;
+    size_t budget = ThreadBudget();
+    return budget > 0 ? std::min(thread_count, budget) : thread_count;
+}
+
+/**
+ * Splits [0, count) into chunk_count contiguous chunks of nearly equal size
+ * and calls body(chunk_index, begin, end) for each, one thread per chunk. The
+ * calling thread runs the first chunk itself. Chunk boundaries only depend on
+ * count and chunk_count, so callers can precompute per-chunk results.
+ */
+template <typename Body>
+void ParallelForChunks(size_t count, size_t chunk_count, Body body) {
+    if (chunk_count <= 1) {
+        body((size_t) 0, (size_t) 0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunk_count - 1);
+    for (size_t chunk = 1; chunk < chunk_count; chunk++) {
+        size_t begin = count * chunk / chunk_count;
+        size_t end = count * (chunk + 1) / chunk_count;
+        workers.emplace_back([&body, chunk, begin, end]() { body(chunk, begin, end); });
+    }
+
+    body((size_t) 0, (size_t) 0, count / chunk_count);
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+/**
+ * How many chunks to split count items into, so that no chunk is smaller than
+ * min_chunk_size and there is at most one chunk per thread.
+ */
+inline size_t ChunkCountFor(size_t count, size_t thread_count, size_t min_chunk_size) {
+    if (thread_count == 0) {
+        thread_count = DefaultThreadCount();
+    }
+
+    size_t chunks = count / std::max(min_chunk_size, (size_t) 1);
+    return std::max((size_t) 1, std::min(chunks, thread_count));
+}
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "memory_ledger.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * How the living population splits between founders' lineages at the start of one generation.
+ */
+struct LineageCensus {
+    size_t generation = 0;
+    size_t lineage_count = 0; // Founders with any living descendants
+    std::vector<std::pair<uint32_t, size_t>> largest; // (founder id, living descendants), largest first
+};
+
+/**
+ * The family tree of the living creatures, by creature id. Only ancestors
+ * that still matter are kept: each kept creature counts its kept children,
+ * plus one while it is alive, and is dropped as soon as that reaches zero, so
+ * extinct lineages free themselves. Compact also splices out dead ancestors
+ * with a single kept child, since no two living creatures can have one of
+ * those as their most recent common ancestor. After that every dead creature
+ * left is a branch point, so the tree holds fewer than twice as many
+ * creatures as are alive, however many have been born.
+ */
+class Phylogeny {
+public:
+    static const size_t CENSUS_LINEAGES = 16; // How many of the largest lineages each census keeps
+
+    /**
+     * Adds a living creature with no known parent, such as one added by hand. It starts its own lineage.
+     */
+    void AddFounder(uint32_t id);
+
+    /**
+     * Adds a living creature born to parent_id, which must be alive. An unknown parent makes it a founder.
+     */
+    void AddBirth(uint32_t id, uint32_t parent_id);
+
+    /**
+     * Marks id dead, dropping it and any ancestors left with no living descendants.
+     */
+    void RemoveCreature(uint32_t id);
+
+    /**
+     * Splices out dead ancestors that have only one kept child. Takes time in proportion to the
+     * creatures kept, so it is meant to run now and then, such as once a generation.
+     */
+    void Compact();
+
+    /**
+     * Records how many living creatures descend from each founder, keeping the largest lineages.
+     */
+    void TakeCensus(size_t generation);
+
+    void Clear();
+
+    bool IsAlive(uint32_t id) const;
+
+    /**
+     * The most recent creature both descend from, where a creature counts as its own ancestor,
+     * or 0 if they come from different founders or either isn't known. Steps up from whichever
+     * is younger, as a child's id is always higher than its parent's, so it takes about as many
+     * steps as there are branch points between the two.
+     */
+    uint32_t FindCommonAncestor(uint32_t first_id, uint32_t second_id) const;
+
+    /**
+     * The founder id leads back to, or 0 if id isn't known.
+     */
+    uint32_t GetFounder(uint32_t id) const;
+
+    /**
+     * How many living creatures descend from founder_id, counting itself if alive.
+     */
+    size_t GetLineageSize(uint32_t founder_id) const;
+
+    /**
+     * How many founders have any living descendants.
+     */
+    size_t GetLineageCount() const;
+
+    const std::vector<LineageCensus> &GetCensuses() const;
+    size_t GetLivingCount() const;
+
+    /**
+     * Creatures kept, living or not.
+     */
+    size_t GetNodeCount() const;
+
+    MemoryFootprint GetMemoryFootprint() const;
+
+private:
+    static const uint32_t NO_NODE = UINT32_MAX;
+
+    struct Node {
+        uint32_t id;
+        uint32_t parent; // Index of the nearest kept ancestor, or NO_NODE
+        uint32_t founder;
+        uint32_t references; // Kept children, plus one while alive. 0 once the slot is free.
+        bool alive;
+    };
+
+    uint32_t AddNode(uint32_t id, uint32_t parent, uint32_t founder);
+    void Release(uint32_t node); // Frees node, and then its ancestors, while nothing references them
+    uint32_t FindNode(uint32_t id) const;
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    std::unordered_map<uint32_t, uint32_t> node_by_id_;
+    std::unordered_map<uint32_t, size_t> lineage_sizes_; // Founder id to living descendants, never 0
+    std::vector<LineageCensus> censuses_;
+    size_t living_count_ = 0;
+};
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "task_scheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * Minimal PNG encoder for 8-bit RGBA frames, so headless runs can write images
+ * without an image library. Compression only looks for repeated pixels, which
+ * is nearly all of a frame of the arena's black background, so encoding stays
+ * a single fast pass over the pixels, split into groups of rows that can be
+ * compressed on different threads.
+ */
+class PngWriter {
+public:
+    /**
+     * Encodes width x height RGBA pixels, stored row by row from the top, into png.
+     * scheduler may be null, to compress on the calling thread.
+     */
+    static void Encode(const uint8_t *rgba, size_t width, size_t height, std::vector<uint8_t> &png,
+                       TaskScheduler *scheduler = nullptr);
+
+    /**
+     * Encodes and writes to path. Returns false if the file could not be written.
+     */
+    static bool Write(const std::string &path, const uint8_t *rgba, size_t width, size_t height,
+                      TaskScheduler *scheduler = nullptr);
+
+    static uint32_t Crc32(const uint8_t *data, size_t size, uint32_t crc = 0);
+};
+
+}
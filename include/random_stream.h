@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace naturalselection {
+
+/**
+ * Small, fast random number generator (PCG32) that can be split into
+ * independent streams. Giving each creature its own stream, derived from a
+ * shared seed and the creature's index, makes the random draws independent of
+ * the order or thread the creature is processed on.
+ */
+class RandomStream {
+public:
+    RandomStream();
+    RandomStream(uint64_t seed, uint64_t stream_id);
+
+    /**
+     * Returns the stream for the given creature index under the given seed.
+     */
+    static RandomStream ForCreature(uint64_t seed, uint64_t creature_index);
+
+    uint32_t NextUInt();
+
+    /**
+     * Uniform float in [0, 1).
+     */
+    float NextUnitFloat();
+
+private:
+    uint64_t state_;
+    uint64_t increment_;
+};
+
+}
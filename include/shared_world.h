@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace naturalselection {
+
+class Creature;
+class Food;
+
+/**
+ * Layout of the shared-memory segment, so tools in any language can map it:
+ * a SharedWorldHeader, then slot_count slots of slot_bytes each. A slot is a
+ * SharedWorldSlot followed by max_creatures SharedCreatures and then max_food
+ * SharedFoods. Everything is little-endian and naturally aligned.
+ */
+static const uint32_t SHARED_WORLD_MAGIC = 0x4E534D57; // "NSMW"
+static const uint32_t SHARED_WORLD_VERSION = 2;
+// Where the app publishes, unless told otherwise.
+static const char *const DEFAULT_SHARED_WORLD_NAME = "/naturalselection_world";
+
+struct SharedWorldHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t max_creatures;
+    uint32_t max_food;
+    uint32_t reserved;
+    uint64_t slot_bytes;
+    std::atomic<uint64_t> latest_frame; // Frames published so far. Frame n lives in slot (n - 1) % slot_count.
+};
+
+struct SharedWorldSlot {
+    // Seqlock: odd while the writer is filling the slot, 2 * frame once frame is complete.
+    std::atomic<uint64_t> sequence;
+    uint64_t tick;
+    uint64_t generation;
+    uint32_t creature_count; // How many were written, at most max_creatures
+    uint32_t food_count;
+    uint32_t dropped_creatures; // Alive but beyond max_creatures
+    uint32_t dropped_food;
+};
+
+struct SharedCreature {
+    float x;
+    float y;
+    float velocity_x;
+    float velocity_y;
+    float radius;
+    float vision_radius;
+    int32_t creature_type;
+    int32_t food;
+    uint32_t id; // Stays with the creature while the arrays are re-sorted
+    uint32_t reserved;
+};
+
+struct SharedFood {
+    float x;
+    float y;
+    float radius;
+};
+
+/**
+ * One consistent frame, as copied out by SharedWorldReader.
+ */
+struct SharedWorldFrame {
+    uint64_t frame = 0;
+    uint64_t tick = 0;
+    uint64_t generation = 0;
+    size_t dropped_creatures = 0;
+    size_t dropped_food = 0;
+    std::vector<SharedCreature> creatures;
+    std::vector<SharedFood> food;
+};
+
+/**
+ * Publishes every tick's creatures and food into a POSIX shared-memory ring
+ * that other processes can map read-only. The writer never waits: it fills the
+ * next slot in the ring, bracketing the write with the slot's sequence number,
+ * and a reader that was part way through copying that slot sees the number
+ * change and tries again with a newer frame. A ring of several slots gives a
+ * slow reader that many ticks to finish a copy before it is overwritten.
+ */
+class SharedWorldPublisher {
+public:
+    static const size_t DEFAULT_MAX_CREATURES = 65536;
+    static const size_t DEFAULT_MAX_FOOD = 16384;
+    static const size_t DEFAULT_SLOT_COUNT = 4;
+
+    SharedWorldPublisher() = default;
+    ~SharedWorldPublisher();
+
+    SharedWorldPublisher(const SharedWorldPublisher &) = delete;
+    SharedWorldPublisher &operator=(const SharedWorldPublisher &) = delete;
+
+    /**
+     * Creates the segment called name (which starts with a slash, as shm_open wants). Never
+     * replaces one that exists, since another process may be publishing there and its readers
+     * would silently switch over. Returns false, with errno saying why (EEXIST if the name is
+     * taken), if it could not be created or mapped.
+     */
+    bool Create(const std::string &name, size_t max_creatures = DEFAULT_MAX_CREATURES,
+                size_t max_food = DEFAULT_MAX_FOOD, size_t slot_count = DEFAULT_SLOT_COUNT);
+
+    /**
+     * Writes the next frame. Creatures and food beyond the segment's capacity are left out and counted.
+     */
+    void Publish(const std::vector<Creature> &creatures, const std::vector<Food> &food, uint64_t tick,
+                 size_t generation);
+
+    /**
+     * Unmaps and removes the segment. Readers that already mapped it keep their mapping.
+     */
+    void Close();
+
+    bool IsOpen() const;
+    uint64_t GetFramesPublished() const;
+
+private:
+    std::string name_;
+    uint8_t *mapping_ = nullptr;
+    size_t mapping_bytes_ = 0;
+    uint64_t frames_published_ = 0;
+};
+
+/**
+ * Maps a segment made by SharedWorldPublisher read-only and copies out frames.
+ */
+class SharedWorldReader {
+public:
+    SharedWorldReader() = default;
+    ~SharedWorldReader();
+
+    SharedWorldReader(const SharedWorldReader &) = delete;
+    SharedWorldReader &operator=(const SharedWorldReader &) = delete;
+
+    /**
+     * Returns false if there is no such segment or it is not a version this reader understands.
+     */
+    bool Open(const std::string &name);
+    void Close();
+
+    /**
+     * Copies the newest complete frame into frame. Returns false if nothing has been published yet,
+     * or if the writer kept overwriting the slot being read for max_attempts tries in a row.
+     */
+    bool ReadLatest(SharedWorldFrame &frame, size_t max_attempts = 100) const;
+
+    /**
+     * The newest frame number published, without copying anything. 0 before the first.
+     */
+    uint64_t GetLatestFrame() const;
+
+private:
+    const uint8_t *mapping_ = nullptr;
+    size_t mapping_bytes_ = 0;
+};
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "steering_kernel.h"
+#include "task_scheduler.h"
+#include "world_snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * Where things go in a software-rendered frame, in frame pixels. Arena
+ * coordinates map one to one onto frame pixels, as they do onto the app window.
+ */
+struct FrameLayout {
+    size_t width = 0;
+    size_t height = 0;
+    WorldBounds arena = WorldBounds{0, 0, 0, 0};
+    WorldBounds population_graph = WorldBounds{0, 0, 0, 0};
+
+    /**
+     * The arena with the population graph to its right, and a margin of the arena's offset around both.
+     */
+    static FrameLayout AroundArena(const WorldBounds &arena);
+};
+
+/**
+ * Draws what Environment::Display() draws, from the same WorldSnapshot, into
+ * an RGBA buffer on the CPU, for machines with no display or GPU. The frame is
+ * split into bands of rows that are rasterized in parallel; every band draws
+ * every shape clipped to its own rows, so bands never share pixels and the
+ * image does not depend on how many threads drew it.
+ *
+ * Text is left out, since there is no font rasterizer; the counts it would
+ * show are in the run's output anyway.
+ */
+class SoftwareRenderer {
+public:
+    /**
+     * scheduler may be null, in which case every band is drawn on the calling thread.
+     */
+    explicit SoftwareRenderer(const FrameLayout &layout, TaskScheduler *scheduler = nullptr);
+
+    void Render(const WorldSnapshot &snapshot);
+
+    size_t GetWidth() const;
+    size_t GetHeight() const;
+
+    /**
+     * 8-bit RGBA, row by row from the top.
+     */
+    const std::vector<uint8_t> &GetPixels() const;
+
+    /**
+     * The pixel at (x, y) packed as 0xRRGGBBAA.
+     */
+    uint32_t GetPixel(size_t x, size_t y) const;
+
+private:
+    void RenderBand(const WorldSnapshot &snapshot, size_t first_row, size_t end_row);
+    void DrawPopulationGraph(const std::vector<PopulationCount> &history, size_t first_row, size_t end_row);
+
+    void FillRect(float left, float top, float right, float bottom, uint32_t color, size_t first_row, size_t end_row);
+    void StrokeRect(float left, float top, float right, float bottom, uint32_t color, size_t first_row,
+                    size_t end_row);
+    void FillCircle(glm::vec2 center, float radius, uint32_t color, size_t first_row, size_t end_row);
+    void StrokeCircle(glm::vec2 center, float radius, uint32_t color, size_t first_row, size_t end_row);
+    void FillSpan(size_t row, long first_column, long last_column, uint32_t color);
+
+    FrameLayout layout_;
+    TaskScheduler *scheduler_;
+    std::vector<uint8_t> pixels_;
+    TaskGraph band_tasks_;
+};
+
+/**
+ * Renders every interval-th tick of a run to numbered PNG files in a directory.
+ */
+class FrameRecorder {
+public:
+    FrameRecorder(const std::string &directory, uint64_t interval, const FrameLayout &layout,
+                  TaskScheduler *scheduler = nullptr);
+
+    /**
+     * Writes the snapshot as the next frame if its tick is due and has not been written yet.
+     * Returns false only if a due frame could not be written.
+     */
+    bool Capture(const WorldSnapshot &snapshot);
+
+    size_t GetFramesWritten() const;
+
+    /**
+     * frame_000000.png, frame_000001.png and so on, so video encoders can read them in order.
+     */
+    static std::string GetFramePath(const std::string &directory, size_t frame);
+
+private:
+    std::string directory_;
+    uint64_t interval_;
+    TaskScheduler *scheduler_;
+    SoftwareRenderer renderer_;
+    size_t frames_written_ = 0;
+    bool wrote_any_ = false;
+    uint64_t last_tick_ = 0;
+};
+
+}
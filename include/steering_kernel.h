@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+class Creature;
+
+/**
+ * The rectangle creatures live in, used for wall hit detection.
+ */
+struct WorldBounds {
+    float x_coor;
+    float y_coor;
+    float width;
+    float height;
+};
+
+/**
+ * Structure-of-arrays copy of the per-creature state that steering reads and writes.
+ * Every vector has one entry per creature, in the same order as the creature vector.
+ */
+struct SteeringBatch {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> previous_x; // Where the last move started, so contacts anywhere along it count
+    std::vector<float> previous_y;
+    std::vector<float> x_velocity;
+    std::vector<float> y_velocity;
+    std::vector<float> max_velocity;
+    std::vector<float> radius;
+    std::vector<float> mass;
+    std::vector<double> energy;
+    std::vector<double> energy_spend;
+    std::vector<double> vision_radius;
+    std::vector<int> food;
+    std::vector<uint8_t> needs_movement;
+
+    size_t Size() const;
+
+    /**
+     * Copies the creature state into the arrays, reusing the existing storage.
+     */
+    void Gather(const std::vector<Creature> &creatures);
+
+    /**
+     * Writes positions, previous positions, velocities, energies, food and movement flags back to the creatures.
+     */
+    void Scatter(std::vector<Creature> &creatures) const;
+};
+
+/**
+ * Branch-free versions of the Creature steering methods and Environment wall
+ * handling. Each function runs over the whole batch in one pass of straight-line
+ * code so the compiler can vectorize it, and produces exactly the same velocities
+ * as the per-creature methods. Functions that take a mask only touch creatures
+ * whose mask entry is non-zero. Every function also comes in a version that
+ * only updates creatures in [begin, end), for running a tick chunk by chunk.
+ */
+class SteeringKernel {
+public:
+    /**
+     * Batch version of Creature::ChangeVelocityTowardsFurthestCorner().
+     */
+    static void TowardsFurthestCorner(SteeringBatch &batch, const std::vector<uint8_t> &mask);
+    static void TowardsFurthestCorner(SteeringBatch &batch, const std::vector<uint8_t> &mask,
+                                      size_t begin, size_t end);
+
+    /**
+     * Batch version of Creature::ChangeVelocityTowardsNearestWall().
+     */
+    static void TowardsNearestWall(SteeringBatch &batch, const std::vector<uint8_t> &mask);
+    static void TowardsNearestWall(SteeringBatch &batch, const std::vector<uint8_t> &mask,
+                                   size_t begin, size_t end);
+
+    /**
+     * Batch version of Creature::ChangeVelocityIfNotEnoughEnergy().
+     */
+    static void IfNotEnoughEnergy(SteeringBatch &batch, const std::vector<uint8_t> &mask);
+    static void IfNotEnoughEnergy(SteeringBatch &batch, const std::vector<uint8_t> &mask,
+                                  size_t begin, size_t end);
+
+    /**
+     * Batch version of Creature::ChangeVelocityIfEnoughFood().
+     */
+    static void IfEnoughFood(SteeringBatch &batch);
+    static void IfEnoughFood(SteeringBatch &batch, size_t begin, size_t end);
+
+    /**
+     * Batch version of Environment::DetectSpeedCreatureWallHits(). food_empty holds,
+     * per creature, whether the food vector was empty when that creature was updated.
+     */
+    static void ResolveWallHits(SteeringBatch &batch, const WorldBounds &bounds,
+                                const std::vector<uint8_t> &food_empty);
+    static void ResolveWallHits(SteeringBatch &batch, const WorldBounds &bounds,
+                                const std::vector<uint8_t> &food_empty, size_t begin, size_t end);
+
+    /**
+     * Batch version of Creature::Move(time_step), except that a move crossing a wall stops
+     * at it, as Environment does after Creature::Move(). The wall hit is then handled at
+     * the start of the next move, however far the creature would have overshot.
+     */
+    static void Move(SteeringBatch &batch, const WorldBounds &bounds, float time_step);
+    static void Move(SteeringBatch &batch, const WorldBounds &bounds, float time_step, size_t begin, size_t end);
+
+    /**
+     * Where a move along one axis from `from` to `to` ends, once walls at low_wall and
+     * high_wall stop it. Something already outside a wall can't get any further out.
+     */
+    static inline float StopAtWalls(float from, float to, float low_wall, float high_wall) {
+        return std::min(std::max(to, std::min(from, low_wall)), std::max(from, high_wall));
+    }
+
+    /**
+     * Distance from (point_x, point_y) to the nearest point of the move from (from_x, from_y)
+     * to (to_x, to_y), worked out the way Creature::CalculateDistance is. Contact tests use
+     * it so that a creature moving faster than its own size can't pass over what it touches.
+     */
+    static float SweptDistance(float from_x, float from_y, float to_x, float to_y, float point_x, float point_y);
+};
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "steering_kernel.h"
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * Two creatures whose bounding boxes overlap. first is always the smaller index.
+ */
+struct CollisionPair {
+    uint32_t first;
+    uint32_t second;
+};
+
+/**
+ * Sort-and-sweep broad phase for creature-creature collisions. Creatures are
+ * kept sorted by the left edge of their bounding box along x. The order is
+ * remembered between ticks, and since creatures only move a few units per
+ * tick it is almost sorted already, so an insertion sort restores it in
+ * close to linear time. The sweep itself runs in bands along y two radii
+ * tall, so a creature is only checked against the creatures beside it
+ * rather than the whole column of the arena that shares its x.
+ *
+ * The cost is then about linear in creatures plus pairs found. At densities
+ * where every creature touches dozens of others, the pairs themselves make a
+ * tick slow, however they are found.
+ */
+class SweepAndPrune {
+public:
+    /**
+     * Fills pairs with every pair of creatures whose bounding boxes overlap.
+     */
+    void FindCandidatePairs(const SteeringBatch &batch, std::vector<CollisionPair> &pairs);
+
+    /**
+     * Narrow phase: bounces every candidate pair that is actually touching and
+     * moving towards each other, updating the batch velocities in place.
+     * Returns the number of collisions resolved.
+     */
+    static size_t ResolveCollisions(SteeringBatch &batch, const std::vector<CollisionPair> &pairs);
+
+    /**
+     * Renames the remembered order after the creatures are reordered, so the next
+     * insertion sort still starts from nearly sorted. order gives the old index of the
+     * creature now at each index.
+     */
+    void Renumber(const std::vector<uint32_t> &order);
+
+private:
+    // Sorts order_ by min_x_, breaking ties by index so the result never depends on the previous order.
+    void SortByMinX();
+
+    // A creature's bounding box, stored contiguously in sweep order.
+    struct SweepEntry {
+        float min_x;
+        float max_x;
+        float y;
+        float radius;
+        uint32_t index;
+    };
+
+    // Checks the creatures of one band against those of the next band up.
+    void SweepAcross(size_t begin, size_t end, size_t next_begin, size_t next_end,
+                     std::vector<CollisionPair> &pairs) const;
+    static void AddIfOverlapping(const SweepEntry &a, const SweepEntry &b, std::vector<CollisionPair> &pairs);
+
+    std::vector<uint32_t> order_;
+    std::vector<float> min_x_;
+    std::vector<uint64_t> keyed_; // Scratch for SortByMinX
+    std::vector<uint64_t> scratch_;
+    std::vector<uint32_t> band_; // Of each creature, by index
+    std::vector<size_t> band_start_; // Where each band starts in sorted_, plus the end
+    std::vector<size_t> band_fill_;
+    std::vector<SweepEntry> sorted_; // Band by band, each in sweep order
+};
+
+}
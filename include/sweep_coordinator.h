@@ -0,0 +1,101 @@
+#pragma once
+
+#include "headless_runner.h"
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * Cartesian product of sweep parameters. Every combination is run once per replica, each with its own seed.
+ */
+struct SweepGrid {
+    std::vector<size_t> food_counts;
+    std::vector<int> creature_type_masks; // Bits (1 << SPEED) | (1 << INTELLIGENCE) | (1 << BOTH)
+    std::vector<bool> collisions;
+    size_t replicas = 1;
+    size_t generations = 10;
+    uint64_t max_ticks = 1000000;
+    uint32_t base_seed = 1;
+    size_t carrying_capacity = 0; // Same cap and policy for every job
+    int capacity_policy = CAPACITY_UNIFORM;
+    float time_step = 1.0f; // And the same time step, regrowth and fast-forward
+    float food_regrowth_rate = 0;
+    size_t fast_forward_calibration = 0;
+    size_t fast_forward_skipped = 0;
+
+    std::vector<SweepJob> Expand() const;
+};
+
+struct SweepOptions {
+    size_t worker_count = 0; // 0 starts one worker per hardware thread
+    size_t threads_per_worker = 0; // 0 splits the hardware threads evenly between the workers
+    size_t max_attempts = 3; // A job that crashes or times out this many times is given up on
+    int job_timeout_seconds = 0; // 0 never times out
+    uint16_t metrics_port = 0; // Worker i serves its current job's metrics on metrics_port + i, 0 serves none
+};
+
+/**
+ * Runs sweep jobs in forked worker processes so that a crash in one run only
+ * costs that job. Each worker talks to the coordinator over its own UNIX
+ * domain socket pair, one line per job and one line per result. Workers that
+ * die or time out are replaced and their job is retried, and results are
+ * written to the output as soon as they arrive, in completion order.
+ */
+class SweepCoordinator {
+public:
+    typedef std::function<SweepResult(const SweepJob &)> JobRunner;
+
+    SweepCoordinator(const std::vector<SweepJob> &jobs, const SweepOptions &options,
+                     JobRunner runner = HeadlessRunner::Run);
+    ~SweepCoordinator();
+
+    /**
+     * Runs every job, writing a CSV header and then one row per finished job. Returns
+     * false if any job ran out of attempts or a worker could not be started.
+     */
+    bool Run(std::ostream &output);
+
+    const std::vector<size_t> &GetFailedJobs() const;
+    size_t GetRetryCount() const;
+
+private:
+    struct Worker {
+        pid_t pid = -1;
+        int socket = -1;
+        bool busy = false;
+        size_t job_index = 0;
+        time_t started_at = 0;
+        std::string read_buffer;
+    };
+
+    bool SpawnWorker(Worker &worker);
+    void StopWorker(Worker &worker, bool kill_process);
+    void HandleWorkerLoss(Worker &worker);
+    bool DispatchJob(Worker &worker, size_t job_index);
+    bool ReadResults(Worker &worker, std::ostream &output);
+    void RequeueOrFail(size_t job_index);
+
+    /**
+     * Body of a worker process: runs jobs from the socket until the coordinator closes it.
+     */
+    static void WorkerLoop(int socket, const JobRunner &runner);
+
+    std::vector<SweepJob> jobs_;
+    SweepOptions options_;
+    JobRunner runner_;
+    std::vector<Worker> workers_;
+    size_t worker_thread_budget_ = 1;
+    std::deque<size_t> pending_jobs_;
+    std::vector<size_t> attempts_;
+    std::vector<size_t> failed_jobs_;
+    size_t finished_count_ = 0;
+    size_t retry_count_ = 0;
+};
+
+}
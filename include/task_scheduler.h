@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * A set of tasks and the order they have to run in. Dependencies must point
+ * from an earlier task to a later one, so insertion order is always a valid
+ * sequential schedule.
+ */
+class TaskGraph {
+public:
+    typedef size_t TaskId;
+
+    TaskId AddTask(std::function<void()> work);
+
+    /**
+     * after will not start until before has finished. before must have been added first.
+     */
+    void AddDependency(TaskId before, TaskId after);
+
+    size_t Size() const;
+    void Clear();
+
+    /**
+     * Runs every task on the calling thread, in insertion order.
+     */
+    void RunInline();
+
+private:
+    friend class TaskScheduler;
+
+    struct Task {
+        std::function<void()> work;
+        std::vector<TaskId> successors;
+        size_t dependency_count = 0;
+    };
+
+    std::vector<Task> tasks_;
+};
+
+/**
+ * Runs task graphs on a fixed pool of threads. Every thread has its own deque
+ * of ready tasks: it pushes the tasks it unblocks onto the back and pops from
+ * the back, so dependent work tends to stay on the thread whose cache already
+ * holds its data, and idle threads steal from the front of other deques so
+ * uneven chunks even out.
+ */
+class TaskScheduler {
+public:
+    /**
+     * thread_count includes the thread that calls Run, so 1 starts no extra threads.
+     */
+    explicit TaskScheduler(size_t thread_count);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    size_t GetThreadCount() const;
+
+    /**
+     * Runs graph to completion, with the calling thread working alongside the pool.
+     * Callers on different threads take turns, and a task that calls Run on the
+     * scheduler running it gets its graph run inline.
+     */
+    void Run(TaskGraph &graph);
+
+    /**
+     * Process-wide scheduler with DefaultThreadCount() threads, started on first use.
+     * Don't use it before fork(), since the children would have no workers.
+     */
+    static TaskScheduler &Shared();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<TaskGraph::TaskId> tasks;
+    };
+
+    void WorkerMain(size_t worker);
+    void Push(size_t worker, TaskGraph::TaskId task);
+    bool TryRunOne(size_t worker);
+    void WorkUntilDone(size_t worker);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex run_mutex_; // One graph at a time
+
+    TaskGraph *graph_ = nullptr;
+    std::unique_ptr<std::atomic<size_t>[]> pending_dependencies_;
+    size_t pending_capacity_ = 0;
+    std::atomic<size_t> remaining_tasks_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    uint64_t run_count_ = 0;
+    size_t active_workers_ = 0;
+    bool stopping_ = false;
+};
+
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "food_grid.h"
+#include "steering_kernel.h"
+#include "sweep_and_prune.h"
+#include "task_scheduler.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naturalselection {
+
+class Food;
+
+/**
+ * Which implementation of a tick Environment runs. The reference engine is the
+ * original one-creature-at-a-time loop, kept to check the optimized one against.
+ */
+enum TickEngine {
+    TICK_ENGINE_OPTIMIZED = 0,
+    TICK_ENGINE_REFERENCE = 1
+};
+
+/**
+ * One tick of Environment::AdvanceOneFrame split into phases over chunks of
+ * creatures, so that it can run as a TaskGraph.
+ *
+ * Eating used to be the reason a tick was sequential: each creature only
+ * sees the food the creatures before it left behind. The phases keep that
+ * exactly. Finding which food each creature touches is parallel, deciding
+ * who gets it is a short serial pass over those candidates in creature
+ * order, and sensing is parallel again, with each creature ignoring food
+ * eaten by itself or any creature before it.
+ *
+ * Sensing is the expensive part of a steady tick, and its answer rarely
+ * changes: food never moves, and the nearest food only changes if it is eaten
+ * or the creature moves far enough for something else to overtake it. So every
+ * creature remembers its target and how much room it had, and only searches
+ * again once that room might be used up, its target is eaten, or it eats.
+ */
+class TickGraph {
+public:
+    enum Phase {
+        PHASE_STEER_TO_CORNER,
+        PHASE_FIND_TOUCHING_FOOD,
+        PHASE_RESOLVE_EATING,
+        PHASE_SENSE_NEAREST_FOOD,
+        PHASE_STEER_HOME,
+        PHASE_RESOLVE_COLLISIONS,
+        PHASE_MOVE,
+        PHASE_COUNT
+    };
+
+    static const char *GetPhaseName(int phase);
+
+    /**
+     * Serial phases run as a single task over every creature.
+     */
+    static bool IsSerialPhase(int phase);
+
+    /**
+     * Points the graph at this tick's creatures and food. food_grid may be null, or
+     * out of date, in which case the graph builds its own. broad_phase is null when
+     * collisions are off. Creatures move time_step times their velocity this tick.
+     */
+    void Prepare(SteeringBatch *batch, const std::vector<Food> *food, const FoodGrid *food_grid,
+                 const WorldBounds &bounds, SweepAndPrune *broad_phase, size_t chunk_size,
+                 float time_step = 1.0f);
+
+    size_t GetChunkCount() const;
+
+    /**
+     * Runs one chunk of a phase. Serial phases ignore chunk.
+     */
+    void RunPhase(int phase, size_t chunk);
+
+    /**
+     * Adds every phase of the tick to graph, each chunk only waiting on what it reads.
+     */
+    void BuildGraph(TaskGraph &graph);
+
+    /**
+     * Adds the chunks of a single phase with no dependencies, for timing phases one at a time.
+     */
+    void BuildPhaseGraph(int phase, TaskGraph &graph);
+
+    /**
+     * Runs the prepared tick a round of chunks at a time, phase after phase, until it is done
+     * or deadline has passed, and returns whether it is done. The next call carries on where
+     * this one stopped, and the tick comes out exactly as BuildGraph would have run it. A
+     * round is one chunk per scheduler thread, or one chunk when scheduler is null. At least
+     * one round runs per call, and serial phases always run whole.
+     */
+    bool RunSliced(TaskScheduler *scheduler, std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Which creature ate which food this tick, as (creature, food) indices into the batch and
+     * the food the tick was prepared with, in the order they were eaten. Valid once the tick
+     * has run, until the next one is prepared.
+     */
+    const std::vector<std::pair<uint32_t, uint32_t>> &GetMeals() const;
+
+    /**
+     * The food left after this tick, in its original order. Remembered targets are
+     * renumbered to match, so the next tick must be prepared with remaining.
+     */
+    void CollectRemainingFood(std::vector<Food> &remaining);
+
+    /**
+     * Forgets every remembered target. Call whenever the food changes other than by a
+     * tick of this graph. Creatures may change freely: a remembered target is only
+     * reused while the creature is close enough to where it was found.
+     */
+    void InvalidateSensing();
+
+    /**
+     * Carries remembered targets over a reordering of the creatures or the food, so
+     * the next tick can still reuse them. Each order gives the old index of what is now
+     * at each index, and is null for the side that didn't move.
+     */
+    void Reorder(const std::vector<uint32_t> *creature_order, const std::vector<uint32_t> *food_order);
+
+    /**
+     * Keeps remembered targets over food appended to the end since the last tick, with
+     * first_added its first index. Each creature's room is narrowed to the nearest new
+     * food, so only creatures it might have overtaken search again. A lot of new food at
+     * once forgets everything instead, as searching again is cheaper than checking it all.
+     */
+    void AddFood(const std::vector<Food> &food, size_t first_added);
+
+    /**
+     * Keeps remembered targets over food taken off the end, leaving food_count. Only
+     * creatures whose target went search again: the rest can only have gained room.
+     */
+    void TruncateFood(size_t food_count);
+
+    /**
+     * Keeps remembered targets over food taken out from anywhere, with food_order the old
+     * index of the food now at each index. Creatures whose target went search again, and
+     * the rest follow their target to its new index.
+     */
+    void RemoveFood(const std::vector<uint32_t> &food_order);
+
+    /**
+     * Number of creatures that searched for food in the last tick, rather than
+     * reusing their remembered target.
+     */
+    size_t GetSenseCount() const;
+
+private:
+    void SteerToCorner(size_t begin, size_t end);
+    void FindTouchingFood(size_t chunk, size_t begin, size_t end);
+    void ResolveEating();
+    void SenseNearestFood(size_t begin, size_t end);
+    void SteerHome(size_t begin, size_t end);
+    void ResolveCollisions();
+    void Move(size_t begin, size_t end);
+
+    size_t FindNextUneaten(size_t food_index);
+    bool IsSensingCurrent(size_t creature) const;
+    void Sense(size_t creature);
+
+    SteeringBatch *batch_ = nullptr;
+    const std::vector<Food> *food_ = nullptr;
+    const FoodGrid *food_grid_ = nullptr;
+    FoodGrid own_food_grid_;
+    WorldBounds bounds_ = WorldBounds{0, 0, 0, 0};
+    SweepAndPrune *broad_phase_ = nullptr;
+    size_t chunk_size_ = 1;
+    size_t chunk_count_ = 0;
+    float time_step_ = 1;
+
+    std::vector<float> food_x_;
+    std::vector<float> food_y_;
+    std::vector<float> food_radius_;
+    float max_food_radius_ = 0;
+
+    // Per chunk, (creature, food) pairs that touch at the start of the tick, in creature then food order.
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> touching_;
+    std::vector<uint32_t> eaten_by_;
+    std::vector<std::pair<uint32_t, uint32_t>> meals_;
+    std::vector<uint32_t> next_uneaten_; // Union-find links that skip over eaten food
+
+    std::vector<uint8_t> food_empty_before_eating_;
+    std::vector<uint8_t> food_left_before_eating_;
+    std::vector<uint8_t> food_empty_after_eating_;
+
+    // Per creature, what the last search found and where the creature was at the time.
+    // nearest is the target's distance, or a lower bound on every food's distance when
+    // there was no target in vision; runner_up bounds every other food's distance.
+    std::vector<uint32_t> sense_target_;
+    std::vector<uint8_t> sense_current_;
+    std::vector<float> sensed_x_;
+    std::vector<float> sensed_y_;
+    std::vector<float> sensed_nearest_;
+    std::vector<float> sensed_runner_up_;
+    size_t expected_food_count_ = 0;
+    std::vector<size_t> sense_counts_; // Per chunk
+    std::vector<CollisionPair> collision_pairs_;
+
+    // Where RunSliced got to: the next chunk of the next phase to run.
+    int slice_phase_ = 0;
+    size_t slice_chunk_ = 0;
+    TaskGraph slice_tasks_;
+};
+
+}
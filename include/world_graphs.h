@@ -0,0 +1,23 @@
+#pragma once
+
+#include "both_scatter_plot.h"
+#include "intelligence_histogram.h"
+#include "population_graph.h"
+#include "speed_histogram.h"
+#include <vector>
+
+namespace naturalselection {
+
+/**
+ * The graphs drawn around the arena. They only change between generations or
+ * when creatures are added or removed, so published snapshots share one copy,
+ * and the simulation copies it before changing anything a snapshot still holds.
+ */
+struct WorldGraphs {
+    std::vector<SpeedHistogram> speed_histograms;
+    std::vector<IntelligenceHistogram> intelligence_histograms;
+    std::vector<BothScatterPlot> scatter_plots;
+    std::vector<PopulationGraph> population_graphs;
+};
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "memory_ledger.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace naturalselection {
+
+class Creature;
+class Food;
+struct WorldGraphs;
+
+/**
+ * Colour of a creature of the given type that has eaten food so far. Creatures
+ * don't store a colour; every path that draws one derives it here.
+ */
+ci::Color GetCreatureColor(int creature_type, int food);
+
+/**
+ * The render-relevant state of a single creature at the end of a tick.
+ */
+struct CreatureRenderState {
+    glm::vec2 position;
+    float radius;
+    float vision_radius;
+    int creature_type;
+    int food;
+
+    ci::Color GetColor() const;
+};
+
+/**
+ * The render-relevant state of a single food particle at the end of a tick.
+ */
+struct FoodRenderState {
+    glm::vec2 position;
+    float radius;
+};
+
+/**
+ * How many creatures of each type started one generation, for the population graph.
+ */
+struct PopulationCount {
+    int speed_count = 0;
+    int intelligence_count = 0;
+    int both_type_count = 0;
+
+    int GetTotal() const;
+};
+
+/**
+ * Immutable copy of everything Environment::Display() needs to draw the arena.
+ */
+struct WorldSnapshot {
+    uint64_t tick = 0;
+    size_t trials_run = 0;
+    int speed_count = 0;
+    int intelligence_count = 0;
+    int both_type_count = 0;
+    std::vector<CreatureRenderState> creatures;
+    std::vector<FoodRenderState> food;
+    std::vector<PopulationCount> population_history; // One per generation so far, oldest first
+    MemoryLedger memory; // Copied in as of this tick, for the memory overlay.
+    std::shared_ptr<const WorldGraphs> graphs; // Shared with other snapshots until the graphs change
+
+    /**
+     * Overwrites this snapshot with the given world state, reusing the existing storage.
+     */
+    void Capture(const std::vector<Creature> &creatures, const std::vector<Food> &food,
+                 uint64_t current_tick, size_t current_trials_run);
+};
+
+/**
+ * Lock-free triple buffer of world snapshots. Exactly one thread publishes
+ * (the simulation) and exactly one thread reads (the renderer). The writer
+ * never waits on the reader, and the reader always sees the most recently
+ * completed snapshot. A second reader would swap out the slot the first one
+ * is still drawing from, so code on the simulation side never reads it.
+ */
+class SnapshotBuffer {
+public:
+    SnapshotBuffer();
+    SnapshotBuffer(const SnapshotBuffer &other);
+    SnapshotBuffer &operator=(const SnapshotBuffer &other);
+
+    /**
+     * Returns the back buffer, which only the writer may touch until Publish().
+     */
+    WorldSnapshot &BeginWrite();
+
+    /**
+     * Makes the back buffer visible to the reader and takes ownership of a free slot.
+     */
+    void Publish();
+
+    /**
+     * Returns the newest published snapshot. The reference stays valid until the next Acquire().
+     */
+    const WorldSnapshot &Acquire() const;
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH_BIT = 0x4;
+
+    std::array<WorldSnapshot, 3> slots_;
+    mutable std::atomic<uint8_t> middle_; // Slot shared between the writer and reader, plus a fresh bit.
+    uint8_t back_;                // Slot owned by the writer.
+    mutable uint8_t front_;       // Slot owned by the reader.
+};
+
+}
@@ -75,6 +75,12 @@ void BothScatterPlot::SetParticles(std::vector<Creature> new_particles) {
     creatures_ = intelligence_creatures;
 }
 
+MemoryFootprint BothScatterPlot::GetMemoryFootprint() const {
+    MemoryFootprint footprint;
+    footprint.Add(creatures_);
+    return footprint;
+}
+
 // Source: https://www.codegrepper.com/code-examples/cpp/c%2B%2B+round+float+to+2+decimal+places
 std::string BothScatterPlot::FloatToStringPrecision(float value, unsigned char prec) const {
     std::stringstream ss;
@@ -0,0 +1,133 @@
+#include "carrying_capacity.h"
+#include "generation_turnover.h"
+#include "random_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace naturalselection {
+
+// Keeps the capacity's draws apart from the per-creature mutation streams under the same seed.
+static const uint64_t CAPACITY_STREAM_ID = 0x6361706163697479ULL;
+
+// Uniform integer in [0, bound), by multiplying instead of dividing. The bias is far below a
+// sample's own noise for any population that fits in memory.
+static size_t NextIndexBelow(RandomStream &stream, size_t bound) {
+    return (size_t) (((uint64_t) stream.NextUInt() * (uint64_t) bound) >> 32);
+}
+
+bool CarryingCapacity::IsEnabled() const {
+    return limit > 0;
+}
+
+const char *CarryingCapacity::GetPolicyName(int policy) {
+    switch (policy) {
+        case CAPACITY_UNIFORM:
+            return "uniform";
+        case CAPACITY_FITNESS:
+            return "fitness";
+        default:
+            return "unknown";
+    }
+}
+
+size_t CarryingCapacity::Apply(const std::vector<Creature> &parents, std::vector<Creature> &next_generation,
+                               uint64_t seed) const {
+    size_t count = next_generation.size();
+    std::vector<size_t> chosen;
+    if (!Choose(parents, count, seed, chosen)) {
+        return 0;
+    }
+
+    // chosen is increasing, so every creature moves down or stays put.
+    for (size_t i = 0; i < chosen.size(); i++) {
+        next_generation[i] = next_generation[chosen[i]];
+    }
+    next_generation.resize(chosen.size());
+    return count - chosen.size();
+}
+
+bool CarryingCapacity::Choose(const std::vector<Creature> &parents, size_t count, uint64_t seed,
+                              std::vector<size_t> &chosen) const {
+    chosen.clear();
+    if (!IsEnabled() || count <= limit) {
+        return false;
+    }
+
+    if (policy == CAPACITY_FITNESS) {
+        // Same order the turnover writes in: survivors, then one child per breeder.
+        std::vector<float> weights;
+        weights.reserve(count);
+        for (size_t i = 0; i < parents.size(); i++) {
+            if (GenerationTurnover::Survives(parents[i])) {
+                weights.push_back((float) parents[i].GetFood());
+            }
+        }
+        for (size_t i = 0; i < parents.size(); i++) {
+            if (GenerationTurnover::Reproduces(parents[i])) {
+                weights.push_back((float) parents[i].GetFood());
+            }
+        }
+        weights.resize(count, 1.0f);
+        SampleWeighted(weights, limit, seed, chosen);
+    } else {
+        SampleUniform(count, limit, seed, chosen);
+    }
+    return true;
+}
+
+void CarryingCapacity::SampleUniform(size_t count, size_t sample_size, uint64_t seed,
+                                     std::vector<size_t> &chosen) {
+    sample_size = std::min(sample_size, count);
+    chosen.resize(sample_size);
+    for (size_t i = 0; i < sample_size; i++) {
+        chosen[i] = i;
+    }
+
+    // Item i replaces a random slot with probability sample_size / (i + 1).
+    RandomStream stream(seed, CAPACITY_STREAM_ID);
+    for (size_t i = sample_size; i < count; i++) {
+        size_t slot = NextIndexBelow(stream, i + 1);
+        if (slot < sample_size) {
+            chosen[slot] = i;
+        }
+    }
+
+    std::sort(chosen.begin(), chosen.end());
+}
+
+void CarryingCapacity::SampleWeighted(const std::vector<float> &weights, size_t sample_size, uint64_t seed,
+                                      std::vector<size_t> &chosen) {
+    size_t count = weights.size();
+    sample_size = std::min(sample_size, count);
+    chosen.clear();
+    if (sample_size == 0) {
+        return;
+    }
+
+    // Each item gets the key u^(1 / weight), kept as log(u) / weight, and the sample is the
+    // sample_size largest keys. The heap's top is the smallest key kept so far.
+    typedef std::pair<float, size_t> Keyed;
+    std::priority_queue<Keyed, std::vector<Keyed>, std::greater<Keyed>> reservoir;
+    RandomStream stream(seed, CAPACITY_STREAM_ID);
+    for (size_t i = 0; i < count; i++) {
+        float unit = ((float) (stream.NextUInt() >> 8) + 0.5f) / (float) (1u << 24); // Never 0 or 1
+        float key = weights[i] > 0 ? std::log(unit) / weights[i] : -std::numeric_limits<float>::infinity();
+        if (reservoir.size() < sample_size) {
+            reservoir.push(Keyed(key, i));
+        } else if (key > reservoir.top().first) {
+            reservoir.pop();
+            reservoir.push(Keyed(key, i));
+        }
+    }
+
+    while (!reservoir.empty()) {
+        chosen.push_back(reservoir.top().second);
+        reservoir.pop();
+    }
+    std::sort(chosen.begin(), chosen.end());
+}
+
+}
@@ -0,0 +1,71 @@
+#include "compact_creature.h"
+#include "creature.h"
+#include "genome.h"
+#include "world_snapshot.h"
+#include <algorithm>
+
+namespace naturalselection {
+
+static const uint32_t TYPE_MASK = 0xFFu;
+static const uint32_t FOOD_SHIFT = 8;
+static const uint32_t FOOD_MASK = 0xFFFFu;
+static const uint32_t NEEDS_MOVEMENT_FLAG = 1u << 24;
+
+CompactCreature CompactCreature::Pack(const Creature &creature) {
+    CompactCreature packed;
+    packed.x = creature.GetPosition().x;
+    packed.y = creature.GetPosition().y;
+    packed.x_velocity = creature.GetVelocity().x;
+    packed.y_velocity = creature.GetVelocity().y;
+    packed.energy = (float) creature.GetEnergy();
+    packed.max_velocity = creature.GetMaxVelocity();
+    packed.vision_radius = (float) creature.GetVisionRadius();
+
+    // Food saturates rather than spilling into the flag bits.
+    uint32_t food = (uint32_t) std::min(std::max(creature.GetFood(), 0), (int) FOOD_MASK);
+    packed.flags = ((uint32_t) creature.GetCreatureType() & TYPE_MASK) | (food << FOOD_SHIFT);
+    if (creature.GetNeedsMovement()) {
+        packed.flags |= NEEDS_MOVEMENT_FLAG;
+    }
+    return packed;
+}
+
+void CompactCreature::PackAll(const std::vector<Creature> &creatures, std::vector<CompactCreature> &packed) {
+    packed.resize(creatures.size());
+    for (size_t i = 0; i < creatures.size(); i++) {
+        packed[i] = Pack(creatures[i]);
+    }
+}
+
+Creature CompactCreature::Unpack() const {
+    Creature creature(GetCreatureType(), glm::vec2(x, y), glm::vec2(x_velocity, y_velocity),
+                      DEFAULT_CREATURE_RADIUS, DEFAULT_CREATURE_MASS, energy, GetFood(),
+                      (double) vision_radius, GetEnergySpend(), max_velocity);
+    creature.SetNeedsMovement(GetNeedsMovement());
+    return creature;
+}
+
+int CompactCreature::GetCreatureType() const {
+    return (int) (flags & TYPE_MASK);
+}
+
+int CompactCreature::GetFood() const {
+    return (int) ((flags >> FOOD_SHIFT) & FOOD_MASK);
+}
+
+bool CompactCreature::GetNeedsMovement() const {
+    return (flags & NEEDS_MOVEMENT_FLAG) != 0;
+}
+
+double CompactCreature::GetEnergySpend() const {
+    Genome genome;
+    genome.SetTrait(TRAIT_MAX_VELOCITY, max_velocity);
+    genome.SetTrait(TRAIT_VISION_RADIUS, vision_radius);
+    return genome.CalculateEnergySpend(GetCreatureType());
+}
+
+ci::Color CompactCreature::GetColor() const {
+    return GetCreatureColor(GetCreatureType(), GetFood());
+}
+
+}
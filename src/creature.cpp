@@ -1,4 +1,8 @@
 #include "creature.h"
+#include "genome.h"
+#include "random_stream.h"
+#include "steering_kernel.h"
+#include "world_snapshot.h"
 
 
 namespace naturalselection {
@@ -10,13 +14,13 @@ Creature::Creature() {
 }
 
 Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, float new_radius,
-                   float new_mass, ci::Color new_color, double current_energy, int current_food) {
+                   float new_mass, double current_energy, int current_food) {
     creature_type_ = creature_type;
     position_ = new_position;
+    previous_position_ = new_position;
     velocity_ = new_velocity;
     radius_ = new_radius;
     mass_ = new_mass;
-    color_ = new_color;
     current_energy_ = current_energy;
     current_food_ = current_food;
     max_velocity_ = DEFAULT_MAX_VELOCITY;
@@ -26,13 +30,13 @@ Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, floa
 }
 
 Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, float new_radius,
-                   float new_mass, ci::Color new_color, double current_energy, int current_food, float max_velocity, double energy_spend) {
+                   float new_mass, double current_energy, int current_food, float max_velocity, double energy_spend) {
     creature_type_ = creature_type;
     position_ = new_position;
+    previous_position_ = new_position;
     velocity_ = new_velocity;
     radius_ = new_radius;
     mass_ = new_mass;
-    color_ = new_color;
     current_energy_ = current_energy;
     current_food_ = current_food;
     max_velocity_ = max_velocity;
@@ -42,14 +46,14 @@ Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, floa
 }
 
 Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, float new_radius,
-                   float new_mass, ci::Color new_color, double current_energy, int current_food, double vision_radius,
+                   float new_mass, double current_energy, int current_food, double vision_radius,
                    double energy_spend) {
     creature_type_ = creature_type;
     position_ = new_position;
+    previous_position_ = new_position;
     velocity_ = new_velocity;
     radius_ = new_radius;
     mass_ = new_mass;
-    color_ = new_color;
     current_energy_ = current_energy;
     current_food_ = current_food;
     max_velocity_ = DEFAULT_MAX_VELOCITY;
@@ -59,14 +63,14 @@ Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, floa
 }
 
 Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, float new_radius,
-                   float new_mass, ci::Color new_color, double current_energy, int current_food, double vision_radius,
+                   float new_mass, double current_energy, int current_food, double vision_radius,
                    double energy_spend, float max_velocity) {
     creature_type_ = creature_type;
     position_ = new_position;
+    previous_position_ = new_position;
     velocity_ = new_velocity;
     radius_ = new_radius;
     mass_ = new_mass;
-    color_ = new_color;
     current_energy_ = current_energy;
     current_food_ = current_food;
     max_velocity_ = DEFAULT_MAX_VELOCITY;
@@ -76,7 +80,7 @@ Creature::Creature(int creature_type, vec2 new_position, vec2 new_velocity, floa
     max_velocity_ = max_velocity;
 }
 
-std::vector<Creature> Creature::SpawnCreatures(int creature_type, size_t count, ci::Color color, float radius, float mass,
+std::vector<Creature> Creature::SpawnCreatures(int creature_type, size_t count, float radius, float mass,
                                                double current_energy, int current_food) {
     std::vector<Creature> particles;
     for (size_t i = 0; i < count; i++) {
@@ -115,7 +119,7 @@ std::vector<Creature> Creature::SpawnCreatures(int creature_type, size_t count,
         vec2 velocity = vec2(x_vel, y_vel);
 
         Creature new_particle = Creature(creature_type, position, velocity, radius,
-                                         mass, color, current_energy, current_food);
+                                         mass, current_energy, current_food);
 
         // Add particle to vector.
         particles.push_back(new_particle);
@@ -241,6 +245,13 @@ bool Creature::IsTouchingSpecificFood(Food food) {
         return true;
     }
 
+    // A fast creature can pass right over food between ticks, so anywhere along its last move counts.
+    if (previous_position_ != position_ &&
+        SteeringKernel::SweptDistance(previous_position_.x, previous_position_.y, x_pos_1, y_pos_1,
+                                      x_pos_2, y_pos_2) <= radius_1 + radius_2) {
+        return true;
+    }
+
     return false;
 }
 
@@ -298,6 +309,10 @@ glm::vec2 Creature::GetPosition() const {
     return position_;
 }
 
+glm::vec2 Creature::GetPreviousPosition() const {
+    return previous_position_;
+}
+
 glm::vec2 Creature::GetVelocity() const {
     return velocity_;
 }
@@ -311,7 +326,7 @@ float Creature::GetRadius() const {
 }
 
 ci::Color Creature::GetColor() const {
-    return color_;
+    return GetCreatureColor(creature_type_, current_food_);
 }
 
 double Creature::GetEnergy() const {
@@ -338,37 +353,26 @@ int Creature::GetCreatureType() const {
     return creature_type_;
 }
 
+uint32_t Creature::GetId() const {
+    return id_;
+}
+
 double Creature::GetEnergySpend() const {
     return energy_spend_;
 }
 
 void Creature::AddFood() {
     current_food_++;
-    if (creature_type_ == SPEED) {
-        if (current_food_ == 1) {
-            color_ = ci::Color(1.0f, 0.4f, 0.4f);
-        } else if (current_food_ == 2) {
-            color_ = ci::Color(1.0f, 0.6f, 0.6f);
-        }
-    } else if (creature_type_ == INTELLIGENCE) {
-        if (current_food_ == 1) {
-            color_ = ci::Color(0.4f, 0.4f, 1.0f);
-        } else if (current_food_ == 2) {
-            color_ = ci::Color(0.6f, 0.6f, 1.0f);
-        }
-    } else if (creature_type_ == BOTH) {
-        if (current_food_ == 1) {
-            color_ = ci::Color(0.8f, 0.4f, 0.8f);
-        } else if (current_food_ == 2) {
-            color_ = ci::Color(0.8f, 0.6f, 0.8f);
-        }
-    }
 }
 
 void Creature::SetPosition(glm::vec2 new_position) {
     position_ = new_position;
 }
 
+void Creature::SetPreviousPosition(glm::vec2 previous_position) {
+    previous_position_ = previous_position;
+}
+
 void Creature::SetVelocity(glm::vec2 new_velocity) {
     velocity_ = new_velocity;
 }
@@ -381,10 +385,6 @@ void Creature::SetRadius(float new_radius) {
     radius_ = new_radius;
 }
 
-void Creature::SetColor(ci::Color new_color) {
-    color_ = new_color;
-}
-
 void Creature::SetEnergy(double new_energy) {
     current_energy_ = new_energy;
 }
@@ -401,11 +401,24 @@ void Creature::SetVisionRadius(double new_radius) {
     vision_radius_ = new_radius;
 }
 
-void Creature::Move() {
+void Creature::SetId(uint32_t id) {
+    id_ = id;
+}
+
+uint32_t Creature::GetParentId() const {
+    return parent_id_;
+}
+
+void Creature::SetParentId(uint32_t parent_id) {
+    parent_id_ = parent_id;
+}
+
+void Creature::Move(float time_step) {
     if (current_energy_ > 0) {
-        current_energy_ -= energy_spend_; // 1000 / 2.5
+        current_energy_ -= energy_spend_ * time_step; // 1000 / 2.5
     }
-    position_ += velocity_;
+    previous_position_ = position_;
+    position_ += velocity_ * time_step;
 }
 
 void Creature::ResetCreaturePosition() {
@@ -444,110 +457,51 @@ void Creature::ResetCreaturePosition() {
     vec2 velocity = vec2(x_vel, y_vel);
 
     position_ = position;
+    previous_position_ = position; // A new start, not a move
     velocity_ = velocity;
 }
 
 void Creature::ResetAllCreatures(std::vector<Creature> &creatures) {
     for (size_t i = 0; i < creatures.size(); i++) {
         creatures.at(i).ResetCreaturePosition();
-        if (creatures.at(i).GetCreatureType() == SPEED) {
-            creatures.at(i).SetColor(ci::Color("Red"));
-        } else if (creatures.at(i).GetCreatureType() == INTELLIGENCE) {
-            creatures.at(i).SetColor(ci::Color("Blue"));
-        } else if (creatures.at(i).GetCreatureType() == BOTH) {
-            creatures.at(i).SetColor(ci::Color(ci::Color(0.8f, 0.0f, 0.8f)));
-        }
         creatures.at(i).SetEnergy(DEFAULT_ENERGY_CAPACITY);
         creatures.at(i).SetFood(0);
     }
 }
 
-Creature Creature::CreateChild(int creature_type) {
-    if (creature_type == SPEED) { // SPEED CHILD
-        float max_velocity = GetMaxVelocity();
-        float margins = max_velocity / 10; // 10% faster or slower
-        float new_max_velocity = RandomFloatRange(max_velocity - margins, max_velocity + margins); // Random mutation
-        double new_energy_spend = DEFAULT_ENERGY_SPEND;
-
-        float difference = new_max_velocity - DEFAULT_MAX_VELOCITY; // Difference from default velocity
-
-        if (difference > 0) { // Increase in speed: Exponentially increased cost
-            double multiplier = (1 + (difference / DEFAULT_MAX_VELOCITY)); // Percentage change
-            new_energy_spend = DEFAULT_ENERGY_SPEND * pow(multiplier, 2);
-        } else if (difference < 0) { // Decrease in speed: Logarithmically decreasing cost
-            float log_value = 1 + (-difference / DEFAULT_MAX_VELOCITY);
-            float energy_decrease = (float) DEFAULT_ENERGY_SPEND * log(log_value);
-            new_energy_spend = DEFAULT_ENERGY_SPEND - energy_decrease;
-        }
+// Builds a child of the given type from the parent. unit_samples holds one uniform
+// value in [0, 1] per genome trait; only the traits this type mutates are read.
+static Creature BuildChild(const Creature &parent, int creature_type, const float *unit_samples) {
+    if (Genome::GetActiveTraits(creature_type) == 0) {
+        return Creature();
+    }
 
-        return Creature(SPEED, vec2(0, 0), vec2(0, 0), GetRadius(),
-                             GetMass(), GetColor(), 0.0, 0,
-                        new_max_velocity, new_energy_spend);
-    } else if (creature_type == INTELLIGENCE) { // INTELLIGENCE CHILD
-        double vision_radius = GetVisionRadius();
-        double margins = vision_radius / 2; // 50% faster or slower
-        double new_vision_radius = (double) RandomFloatRange((float) (vision_radius - margins), (float)(vision_radius + margins)); // Random mutation
-        double new_energy_spend = DEFAULT_ENERGY_SPEND;
-
-        double difference = vision_radius - DEFAULT_VISION_RADIUS; // Difference from default velocity
-
-        if (difference > 0) { // Increase in vision: Logarithmically increased cost
-            float log_value = 1 + (float) (difference / DEFAULT_VISION_RADIUS);
-            float energy_increase = (float) DEFAULT_ENERGY_SPEND * log(log_value);
-            new_energy_spend = DEFAULT_ENERGY_SPEND + energy_increase;
-        } else if (difference < 0) { // Decrease in vision: Logarithmically decreasing cost
-            float log_value = 1 + (float) (-difference / DEFAULT_VISION_RADIUS);
-            float energy_decrease = (float) DEFAULT_ENERGY_SPEND * log(log_value);
-            new_energy_spend = DEFAULT_ENERGY_SPEND - energy_decrease;
-        }
+    Genome inherited = Genome::Inherit(parent);
+    Genome genome = inherited;
+    genome.Mutate(creature_type, unit_samples);
+    return genome.CreateCreature(parent, creature_type, inherited);
+}
 
-        return Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), GetRadius(),
-                        GetMass(), GetColor(), 0.0, 0,
-                        new_vision_radius, new_energy_spend);
-    } else if (creature_type == BOTH) {
-        float max_velocity = GetMaxVelocity();
-        float margins = max_velocity / 10; // 10% faster or slower
-        float new_max_velocity = RandomFloatRange(max_velocity - margins, max_velocity + margins); // Random mutation
-        double new_energy_spend = DEFAULT_ENERGY_SPEND;
-
-        float difference = new_max_velocity - DEFAULT_MAX_VELOCITY; // Difference from default velocity
-
-        if (difference > 0) { // Increase in speed: Exponentially increased cost
-            double multiplier = (1 + (difference / DEFAULT_MAX_VELOCITY)); // Percentage change
-            new_energy_spend = DEFAULT_ENERGY_SPEND * pow(multiplier, 2);
-        } else if (difference < 0) { // Decrease in speed: Logarithmically decreasing cost
-            float log_value = 1 + (-difference / DEFAULT_MAX_VELOCITY);
-            float energy_decrease = (float) DEFAULT_ENERGY_SPEND * log(log_value);
-            new_energy_spend = DEFAULT_ENERGY_SPEND - energy_decrease;
+Creature Creature::CreateChild(int creature_type) {
+    uint32_t active_traits = Genome::GetActiveTraits(creature_type);
+    float unit_samples[TRAIT_COUNT] = {};
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        if (active_traits & (1u << trait)) { // Only draw for traits that mutate.
+            unit_samples[trait] = (float) rand() / RAND_MAX;
         }
+    }
 
-        Creature middle = Creature(SPEED, vec2(0, 0), vec2(0, 0), GetRadius(),
-                        GetMass(), GetColor(), 0.0, 0,
-                        new_max_velocity, new_energy_spend);
-
-        double vision_radius = middle.GetVisionRadius();
-        double margins_middle = vision_radius / 2; // 50% faster or slower
-        double new_vision_radius_middle = (double) RandomFloatRange((float) (vision_radius - margins_middle), (float)(vision_radius + margins_middle)); // Random mutation
-        double new_energy_spend_middle = DEFAULT_ENERGY_SPEND;
-
-        double difference_middle = vision_radius - DEFAULT_VISION_RADIUS; // Difference from default velocity
-
-        if (difference_middle > 0) { // Increase in vision: Logarithmically increased cost
-            float log_value = 1 + (float) (difference_middle / DEFAULT_VISION_RADIUS);
-            float energy_increase = (float) DEFAULT_ENERGY_SPEND * log(log_value);
-            new_energy_spend_middle = DEFAULT_ENERGY_SPEND + energy_increase;
-        } else if (difference_middle < 0) { // Decrease in vision: Logarithmically decreasing cost
-            float log_value = 1 + (float) (-difference_middle / DEFAULT_VISION_RADIUS);
-            float energy_decrease = (float) DEFAULT_ENERGY_SPEND * log(log_value);
-            new_energy_spend_middle = DEFAULT_ENERGY_SPEND - energy_decrease;
-        }
+    return BuildChild(*this, creature_type, unit_samples);
+}
 
-        return Creature(BOTH, vec2(0, 0), vec2(0, 0), GetRadius(),
-                        GetMass(), GetColor(), 0.0, 0,
-                        new_vision_radius_middle, new_energy_spend_middle, new_max_velocity);
-    } else {
-        return Creature();
+Creature Creature::CreateChild(int creature_type, RandomStream &stream) const {
+    // Always one draw per trait, so a child comes out the same as from GenomeBatch.
+    float unit_samples[TRAIT_COUNT];
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        unit_samples[trait] = stream.NextUnitFloat();
     }
+
+    return BuildChild(*this, creature_type, unit_samples);
 }
 
 float Creature::RandomFloatRange(float a, float b) {
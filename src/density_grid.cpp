@@ -0,0 +1,140 @@
+#include "density_grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace naturalselection {
+
+// Even a cell with a single creature has to stand out against the black arena.
+static const float MIN_CELL_BRIGHTNESS = 0.35f;
+// Food stays dimmer than creatures, as the circles it stands in for are smaller.
+static const float MAX_FOOD_BRIGHTNESS = 0.6f;
+
+static inline bool IsInside(glm::vec2 position, const WorldBounds &region) {
+    return position.x >= region.x_coor && position.x < region.x_coor + region.width &&
+           position.y >= region.y_coor && position.y < region.y_coor + region.height;
+}
+
+// Log scale, so a handful of creatures and a dense clump are both visible.
+static inline float Brightness(uint32_t count, uint32_t max_count) {
+    return std::log1p((float) count) / std::log1p((float) std::max(max_count, (uint32_t) 1));
+}
+
+static inline uint8_t ToByte(float value) {
+    return (uint8_t) std::min(std::max(value * 255.0f + 0.5f, 0.0f), 255.0f);
+}
+
+void DensityGrid::Rasterize(const WorldSnapshot &snapshot, const WorldBounds &region, size_t columns,
+                            size_t rows) {
+    region_ = region;
+    columns_ = std::max(columns, (size_t) 1);
+    rows_ = std::max(rows, (size_t) 1);
+    cells_per_x_ = region.width > 0 ? (float) columns_ / region.width : 0;
+    cells_per_y_ = region.height > 0 ? (float) rows_ / region.height : 0;
+    for (int channel = 0; channel < DENSITY_CHANNEL_COUNT; channel++) {
+        counts_[channel].assign(columns_ * rows_, 0);
+    }
+
+    size_t cell = 0;
+    for (size_t i = 0; i < snapshot.creatures.size(); i++) {
+        const CreatureRenderState &creature = snapshot.creatures[i];
+        if (creature.creature_type >= DENSITY_SPEED && creature.creature_type <= DENSITY_BOTH &&
+            CellOf(creature.position, cell)) {
+            counts_[creature.creature_type][cell]++;
+        }
+    }
+
+    for (size_t i = 0; i < snapshot.food.size(); i++) {
+        if (CellOf(snapshot.food[i].position, cell)) {
+            counts_[DENSITY_FOOD][cell]++;
+        }
+    }
+
+    max_creature_count_ = 0;
+    max_food_count_ = 0;
+    for (size_t i = 0; i < columns_ * rows_; i++) {
+        uint32_t creatures = counts_[DENSITY_SPEED][i] + counts_[DENSITY_INTELLIGENCE][i] + counts_[DENSITY_BOTH][i];
+        max_creature_count_ = std::max(max_creature_count_, creatures);
+        max_food_count_ = std::max(max_food_count_, counts_[DENSITY_FOOD][i]);
+    }
+}
+
+size_t DensityGrid::GetColumns() const {
+    return columns_;
+}
+
+size_t DensityGrid::GetRows() const {
+    return rows_;
+}
+
+uint32_t DensityGrid::GetCount(int channel, size_t column, size_t row) const {
+    return counts_[channel].at(row * columns_ + column);
+}
+
+uint32_t DensityGrid::GetMaxCreatureCount() const {
+    return max_creature_count_;
+}
+
+uint32_t DensityGrid::GetMaxFoodCount() const {
+    return max_food_count_;
+}
+
+void DensityGrid::FillPixels(std::vector<uint8_t> &rgba) const {
+    ci::Color type_colors[DENSITY_FOOD];
+    for (int type = DENSITY_SPEED; type <= DENSITY_BOTH; type++) {
+        type_colors[type] = GetCreatureColor(type, 0);
+    }
+
+    rgba.assign(columns_ * rows_ * 4, 0);
+    for (size_t i = 0; i < columns_ * rows_; i++) {
+        uint8_t *pixel = &rgba[i * 4];
+        uint32_t creatures = counts_[DENSITY_SPEED][i] + counts_[DENSITY_INTELLIGENCE][i] + counts_[DENSITY_BOTH][i];
+        if (creatures > 0) {
+            float r = 0, g = 0, b = 0;
+            for (int type = DENSITY_SPEED; type <= DENSITY_BOTH; type++) {
+                float share = (float) counts_[type][i] / (float) creatures;
+                r += type_colors[type].r * share;
+                g += type_colors[type].g * share;
+                b += type_colors[type].b * share;
+            }
+
+            float brightness = MIN_CELL_BRIGHTNESS +
+                               (1.0f - MIN_CELL_BRIGHTNESS) * Brightness(creatures, max_creature_count_);
+            pixel[0] = ToByte(r * brightness);
+            pixel[1] = ToByte(g * brightness);
+            pixel[2] = ToByte(b * brightness);
+            pixel[3] = 255;
+        } else if (counts_[DENSITY_FOOD][i] > 0) {
+            float brightness = MIN_CELL_BRIGHTNESS +
+                               (MAX_FOOD_BRIGHTNESS - MIN_CELL_BRIGHTNESS) *
+                               Brightness(counts_[DENSITY_FOOD][i], max_food_count_);
+            pixel[1] = ToByte(brightness);
+            pixel[3] = 255;
+        }
+    }
+}
+
+size_t DensityGrid::CountInside(const WorldSnapshot &snapshot, const WorldBounds &region) {
+    size_t count = 0;
+    for (size_t i = 0; i < snapshot.creatures.size(); i++) {
+        count += IsInside(snapshot.creatures[i].position, region) ? 1 : 0;
+    }
+    for (size_t i = 0; i < snapshot.food.size(); i++) {
+        count += IsInside(snapshot.food[i].position, region) ? 1 : 0;
+    }
+
+    return count;
+}
+
+bool DensityGrid::CellOf(glm::vec2 position, size_t &cell) const {
+    if (!IsInside(position, region_)) {
+        return false;
+    }
+
+    // The min() catches positions a rounding error short of the far edge.
+    size_t column = std::min((size_t) ((position.x - region_.x_coor) * cells_per_x_), columns_ - 1);
+    size_t row = std::min((size_t) ((position.y - region_.y_coor) * cells_per_y_), rows_ - 1);
+    cell = row * columns_ + column;
+    return true;
+}
+
+}
@@ -1,12 +1,53 @@
 #include "environment.h"
+#include "carrying_capacity.h"
+#include "compact_creature.h"
 #include "creature.h"
+#include "density_grid.h"
+#include "event_stream.h"
+#include "food_field.h"
+#include "food_field_tick.h"
+#include "food_grid.h"
+#include "generation_model.h"
+#include "generation_turnover.h"
+#include "memory_ledger.h"
+#include "morton_order.h"
+#include "phylogeny.h"
 #include "physics.h"
+#include "shared_world.h"
 #include "speed_histogram.h"
+#include "steering_kernel.h"
+#include "sweep_and_prune.h"
+#include "task_scheduler.h"
+#include "tick_graph.h"
+#include "world_graphs.h"
+#include "world_snapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
 
 namespace naturalselection {
 
 using glm::vec2;
 
+// Creatures per task in the tick graph. Small enough that uneven chunks can be stolen.
+static const size_t TICK_CHUNK_SIZE = 1024;
+// Below this many creatures the whole tick runs on the calling thread.
+static const size_t PARALLEL_TICK_MIN_CREATURES = 8192;
+// About one default vision radius, so sensing usually looks at a handful of cells.
+static const float FOOD_GRID_CELL_SIZE = 16.0f;
+static const float FOOD_RADIUS = 2.0f;
+// Food never spawns closer than this to a wall.
+static const int FOOD_EDGE_BUFFER = 20;
+// Coarse enough that a cell holds a good part of a meal, and about one default vision radius.
+static const float FOOD_FIELD_CELL_SIZE = 16.0f;
+// How far the food field spreads each tick, well inside the stencil's stable 0.25.
+static const float FOOD_FIELD_DIFFUSION = 0.02f;
+// Arena pixels per side of a density cell when the arena is drawn as a density texture.
+static const size_t DENSITY_CELL_PIXELS = 4;
+static const float MAX_VIEW_ZOOM = 16.0f;
+
 Environment::Environment() {
     width_ = DEFAULT_WIDTH;
     height_ = DEFAULT_HEIGHT;
@@ -15,16 +56,31 @@ Environment::Environment() {
     is_running_ = false;
     needs_reset = false;
     food_count_ = DEFAULT_FOOD_COUNT;
-
-    food_ = Food::SpawnParticles(DEFAULT_FOOD_COUNT, ci::Color("Green"), 2.0f, 20);
+    tick_count_ = 0;
+    collisions_enabled_ = false;
+    show_memory_overlay_ = false;
+    tick_engine_ = TICK_ENGINE_OPTIMIZED;
+    food_mode_ = FOOD_MODE_PARTICLES;
+    lod_entity_threshold_ = DEFAULT_LOD_ENTITY_THRESHOLD;
+    view_zoom_ = 1;
+    spatial_sort_interval_ = DEFAULT_SPATIAL_SORT_INTERVAL;
+    next_creature_id_ = 1;
+    next_food_id_ = 1;
+    food_regrowth_rate_ = 0;
+    food_regrowth_due_ = 0;
+    food_added_since_sort_ = false;
+    time_step_ = DEFAULT_TIME_STEP;
+
+    SpawnFood();
 
     // Population Graph
-    std::vector<std::vector<Creature>> population_records;
-    population_records.push_back(creatures_);
-    population_records_.insert(population_records_.end(), population_records.begin(), population_records.end());
-    population_graphs_.push_back(PopulationGraph("Trials", DEFAULT_HISTOGRAM_WIDTH * 2,
+    graphs_ = std::make_shared<WorldGraphs>();
+    population_records_.push_back(std::make_shared<const std::vector<CompactCreature>>());
+    population_history_.push_back(PopulationCount());
+    graphs_->population_graphs.push_back(PopulationGraph("Trials", DEFAULT_HISTOGRAM_WIDTH * 2,
                                                  DEFAULT_HISTOGRAM_HEIGHT * 2, 1000,
                                                  DEFAULT_Y_COOR * 2 + DEFAULT_HISTOGRAM_MARGINS, population_records_));
+    PublishSnapshot();
 }
 
 Environment::Environment(std::vector<Creature> particles) { // For testing.
@@ -32,6 +88,7 @@ Environment::Environment(std::vector<Creature> particles) { // For testing.
     height_ = DEFAULT_HEIGHT;
     x_coor_ = DEFAULT_X_COOR;
     y_coor_ = DEFAULT_Y_COOR;
+    graphs_ = std::make_shared<WorldGraphs>();
 }
 
 Environment::Environment(size_t width, size_t height, int x_coor, int y_coor, std::vector<Creature> particles) { // For testing.
@@ -39,41 +96,62 @@ Environment::Environment(size_t width, size_t height, int x_coor, int y_coor, st
     height_ = height;
     x_coor_ = x_coor;
     y_coor_ = y_coor;
+    graphs_ = std::make_shared<WorldGraphs>();
 }
 
 void Environment::Display() const {
+  // Creatures, food, and counts come from the latest published snapshot so
+  // that drawing never reads the vectors the simulation is mutating.
+  const WorldSnapshot &snapshot = snapshots_.Acquire();
+
   // Displays Title.
   ci::gl::drawStringCentered("Natural Selection", vec2(x_coor_ + (width_ / 2), y_coor_ - 90),
                              ci::Color("white"), ci::Font("Arial", DEFAULT_TITLE_FONT_SIZE));
 
-  ci::gl::drawStringCentered("Speed Count: " + std::to_string(GetSpeedCount()) +
-                                ", Intelligence Count: " + std::to_string(GetIntelligenceCount()) +
-                                ", Both Count: " + std::to_string(GetBothTypeCount()) +
-                             ", Food Count: " + std::to_string(food_.size()) +
-                             ", Trials Run: " + std::to_string(population_records_.size() - 1),
+  ci::gl::drawStringCentered("Speed Count: " + std::to_string(snapshot.speed_count) +
+                                ", Intelligence Count: " + std::to_string(snapshot.intelligence_count) +
+                                ", Both Count: " + std::to_string(snapshot.both_type_count) +
+                             ", Food Count: " + std::to_string(snapshot.food.size()) +
+                             ", Trials Run: " + std::to_string(snapshot.trials_run),
                              vec2(x_coor_ + (width_ / 2), y_coor_ - 55),
                                ci::Color("white"), ci::Font("Arial", DEFAULT_SMALL_FONT_SIZE));
 
   ci::gl::drawString(std::string("Welcome to the Natural Selection Simulator. We have two creature types: speed and intelligence. \n") +
                     "Both traits have an energy cost change for either change in trait. " + "Press 0 to introduce speed creatures \n" +
                     "and press 1 to introduce intelligent creatures. Press the up and down arrows to adjust the amount of food \n" +
-                    "resources within the environment. Press enter to simulate each generation.",
+                    "resources within the environment, and g to let food grow back during a generation. \n" +
+                    "Press enter to simulate each generation.",
                     vec2(1000, y_coor_), ci::Color("white"), ci::Font("Arial", DEFAULT_SMALL_FONT_SIZE));
 
-  // Displays all speed creatures.
-  for (size_t i = 0; i < creatures_.size(); i++) {
-      Creature curr_particle = creatures_.at(i);
-      ci::gl::color(curr_particle.GetColor());
-      ci::gl::drawSolidCircle(curr_particle.GetPosition(), curr_particle.GetRadius());
-      ci::gl::drawStrokedCircle(curr_particle.GetPosition(),
-                                (float) curr_particle.GetVisionRadius(), 0.2f);
-  }
+  // The arena shows view, scaled up by the zoom to fill it. At zoom 1 the view is the whole arena.
+  WorldBounds view = GetViewBounds();
+  vec2 view_origin = vec2(view.x_coor, view.y_coor);
+  vec2 arena_origin = vec2(x_coor_, y_coor_);
+  if (ShouldDrawDensity(snapshot, view)) {
+      DrawDensity(snapshot, view);
+  } else {
+      // Displays all creatures.
+      for (size_t i = 0; i < snapshot.creatures.size(); i++) {
+          const CreatureRenderState &curr_particle = snapshot.creatures[i];
+          if (view_zoom_ > 1 && !IsInView(curr_particle.position, view)) {
+              continue;
+          }
+          vec2 position = arena_origin + (curr_particle.position - view_origin) * view_zoom_;
+          ci::gl::color(curr_particle.GetColor());
+          ci::gl::drawSolidCircle(position, curr_particle.radius * view_zoom_);
+          ci::gl::drawStrokedCircle(position, curr_particle.vision_radius * view_zoom_, 0.2f);
+      }
 
-  // Displays food particles.
-  for (size_t i = 0; i < food_.size(); i++) {
-      Food curr_particle = food_.at(i);
-      ci::gl::color(curr_particle.GetColor());
-      ci::gl::drawSolidCircle(curr_particle.GetPosition(), curr_particle.GetRadius());
+      // Displays food particles.
+      ci::gl::color(ci::Color("Green"));
+      for (size_t i = 0; i < snapshot.food.size(); i++) {
+          const FoodRenderState &curr_particle = snapshot.food[i];
+          if (view_zoom_ > 1 && !IsInView(curr_particle.position, view)) {
+              continue;
+          }
+          ci::gl::drawSolidCircle(arena_origin + (curr_particle.position - view_origin) * view_zoom_,
+                                  curr_particle.radius * view_zoom_);
+      }
   }
 
   // Displays borders
@@ -81,61 +159,144 @@ void Environment::Display() const {
   ci::gl::drawStrokedRect(ci::Rectf(vec2(x_coor_, y_coor_),
                                     vec2(x_coor_ + width_, y_coor_ + height_)));
 
-  // Displays histograms.
-  for (size_t i = 0; i < speed_histograms_.size(); i++) {
-      speed_histograms_.at(i).PrintGraph();
-  }
+  // Displays histograms, as published with the snapshot.
+  if (snapshot.graphs != nullptr) {
+      const WorldGraphs &graphs = *snapshot.graphs;
+      for (size_t i = 0; i < graphs.speed_histograms.size(); i++) {
+          graphs.speed_histograms.at(i).PrintGraph();
+      }
 
-  for (size_t i = 0; i < intelligence_histograms_.size(); i++) {
-      intelligence_histograms_.at(i).PrintGraph();
-  }
+      for (size_t i = 0; i < graphs.intelligence_histograms.size(); i++) {
+          graphs.intelligence_histograms.at(i).PrintGraph();
+      }
 
-  for (size_t i = 0; i < scatter_plots_.size(); i++) {
-      scatter_plots_.at(i).PrintGraph();
+      for (size_t i = 0; i < graphs.scatter_plots.size(); i++) {
+          graphs.scatter_plots.at(i).PrintGraph();
+      }
+
+      for (size_t i = 0; i < graphs.population_graphs.size(); i++) {
+          graphs.population_graphs.at(i).PrintGraph();
+      }
   }
 
-  for (size_t i = 0; i < population_graphs_.size(); i++) {
-      population_graphs_.at(i).PrintGraph();
+  // Displays memory use per subsystem over the top left of the arena.
+  if (show_memory_overlay_) {
+      std::vector<std::string> lines = snapshot.memory.FormatLines();
+      for (size_t i = 0; i < lines.size(); i++) {
+          ci::gl::drawString(lines[i], vec2(x_coor_ + 10, y_coor_ + 10 + i * DEFAULT_SMALL_FONT_SIZE),
+                             ci::Color("white"), ci::Font("Arial", DEFAULT_SMALL_FONT_SIZE));
+      }
   }
 }
 
-void Environment::AdvanceOneFrame() {
-  if (needs_reset) {
-      // Function to spawn more creatures based on replicating creatures.
-      KillAndReproduceSpeedCreatures();
+bool Environment::ShouldDrawDensity(const WorldSnapshot &snapshot, const WorldBounds &view) const {
+    if (lod_entity_threshold_ == 0 || snapshot.creatures.size() + snapshot.food.size() <= lod_entity_threshold_) {
+        return false;
+    }
 
-      if (!ContainsSpeedCreatures()) {
-          RemoveSpeedCreatures();
-      }
+    // Zoomed in, only what is in view gets drawn, which may be few enough for circles again.
+    return view_zoom_ <= 1 || DensityGrid::CountInside(snapshot, view) > lod_entity_threshold_;
+}
 
-      if (!ContainsIntelligenceCreatures()) {
-          RemoveIntelligenceCreatures();
-      }
+void Environment::DrawDensity(const WorldSnapshot &snapshot, const WorldBounds &view) const {
+    density_grid_.Rasterize(snapshot, view, width_ / DENSITY_CELL_PIXELS, height_ / DENSITY_CELL_PIXELS);
+    density_grid_.FillPixels(density_pixels_);
 
-      if (!ContainsBothTypeCreatures()) {
-          RemoveBothTypeCreatures();
-      }
+    int columns = (int) density_grid_.GetColumns();
+    int rows = (int) density_grid_.GetRows();
+    if (!density_texture_ || density_texture_->getWidth() != columns || density_texture_->getHeight() != rows) {
+        density_texture_ = ci::gl::Texture2d::create(density_pixels_.data(), GL_RGBA, columns, rows,
+                                                     ci::gl::Texture2d::Format().magFilter(GL_NEAREST));
+        density_texture_->setTopDown(true); // Rows are filled from the top of the arena down
+    } else {
+        density_texture_->update(density_pixels_.data(), GL_RGBA, GL_UNSIGNED_BYTE, 0, columns, rows);
+    }
 
-      // Reset Food and Creature Energies, Velocities, and Food
-      Creature::ResetAllCreatures(creatures_);
-      RefreshFood();
+    ci::gl::color(ci::Color("white"));
+    ci::gl::draw(density_texture_, ci::Rectf(vec2(x_coor_, y_coor_), vec2(x_coor_ + width_, y_coor_ + height_)));
+}
 
-      needs_reset = false;
-      for (size_t i = 0; i < speed_histograms_.size(); i++) {
-          speed_histograms_.at(i).SetParticles(creatures_);
-      }
+bool Environment::IsInView(const vec2 &position, const WorldBounds &view) {
+    return position.x >= view.x_coor && position.x <= view.x_coor + view.width &&
+           position.y >= view.y_coor && position.y <= view.y_coor + view.height;
+}
 
-      for (size_t i = 0; i < intelligence_histograms_.size(); i++) {
-          intelligence_histograms_.at(i).SetParticles(creatures_);
-      }
+WorldBounds Environment::GetViewBounds() const {
+    // Zooms in on the middle of the arena.
+    float view_width = (float) width_ / view_zoom_;
+    float view_height = (float) height_ / view_zoom_;
+    return WorldBounds{x_coor_ + ((float) width_ - view_width) / 2, y_coor_ + ((float) height_ - view_height) / 2,
+                       view_width, view_height};
+}
 
-      for (size_t i = 0; i < scatter_plots_.size(); i++) {
-          scatter_plots_.at(i).SetParticles(creatures_);
-      }
+bool Environment::IsDrawingDensity() const {
+    return ShouldDrawDensity(snapshots_.Acquire(), GetViewBounds());
+}
+
+size_t Environment::GetLodEntityThreshold() const {
+    return lod_entity_threshold_;
+}
 
-      population_records_.push_back(creatures_);
-      for (size_t i = 0; i < population_graphs_.size(); i++) {
-          population_graphs_.at(i).SetParticles(population_records_);
+void Environment::SetLodEntityThreshold(size_t threshold) {
+    lod_entity_threshold_ = threshold;
+}
+
+float Environment::GetViewZoom() const {
+    return view_zoom_;
+}
+
+void Environment::SetViewZoom(float zoom) {
+    view_zoom_ = std::min(std::max(zoom, 1.0f), MAX_VIEW_ZOOM);
+}
+
+void Environment::AdvanceOneFrame() {
+    if (tick_in_progress_) { // AdvanceWithinBudget ran out of time part way through it
+        RunTickSlices(std::chrono::steady_clock::time_point::max());
+    } else if (StartTick()) {
+        tick_tasks_.Clear();
+        tick_graph_.BuildGraph(tick_tasks_);
+        if (creatures_.size() >= PARALLEL_TICK_MIN_CREATURES) {
+            TaskScheduler::Shared().Run(tick_tasks_);
+        } else { // Not worth waking other threads for
+            tick_tasks_.RunInline();
+        }
+        FinishTick();
+    }
+
+    PublishSnapshot();
+}
+
+bool Environment::AdvanceWithinBudget(std::chrono::steady_clock::duration budget) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
+    if (!tick_in_progress_ && !StartTick()) {
+        PublishSnapshot();
+        return true;
+    }
+
+    // Until the tick is done, the snapshot keeps showing the last finished one.
+    if (!RunTickSlices(deadline)) {
+        return false;
+    }
+    PublishSnapshot();
+    return true;
+}
+
+bool Environment::GetTickInProgress() const {
+    return tick_in_progress_;
+}
+
+bool Environment::StartTick() {
+  // Everything before the creatures move. The reference engine's tick runs whole from here; the
+  // optimized one is only prepared, and true means it is waiting to be run and finished.
+  if (needs_reset) {
+      bool fast_forwarding = false;
+      if (fast_forward_generations_ > 0) {
+          ObserveGeneration();
+          fast_forwarding = IsFastForwardDue();
+      }
+      TurnOverGeneration(!fast_forwarding); // A fast-forward spawns the food once it is done
+      if (fast_forwarding) {
+          FastForward();
       }
   }
 
@@ -144,126 +305,545 @@ void Environment::AdvanceOneFrame() {
       needs_reset = true;
   }
 
-  if (is_running_) {
-      // LOOP THROUGH ALL SPEED CREATURES
-      for (size_t i = 0; i < creatures_.size(); i++) {
-          Creature &curr_creature = creatures_.at(i);
-          if (curr_creature.GetNeedsMovement()) {
-              curr_creature.ChangeVelocityTowardsFurthestCorner();
-              curr_creature.SetNeedsMovement(false);
-          }
+  if (is_running_ && food_regrowth_rate_ > 0 && food_mode_ == FOOD_MODE_PARTICLES) {
+      RegrowFood();
+  }
 
-          if (!food_.empty()) {
-              for (size_t i = 0; i < food_.size(); i++) {
-                  if (curr_creature.IsTouchingSpecificFood(food_.at(i))) {
-                      if (curr_creature.GetFood() < 2) {
-                          curr_creature.AddFood();
-                          food_.erase(food_.begin() + i);
-                          curr_creature.SetNeedsMovement(true);
-                      }
-                  }
-              }
+  // Creatures drift apart from their neighbours in memory as they move, so they are re-sorted now and
+  // then. So is food that has grown back since, as it lands wherever it lands at the end of the list.
+  if (is_running_ && spatial_sort_interval_ > 0 && tick_count_ > 0 && tick_count_ % spatial_sort_interval_ == 0) {
+      SortCreaturesSpatially();
+      if (food_added_since_sort_) {
+          SortFoodSpatially();
+      }
+  }
+
+  if (is_running_ && food_mode_ == FOOD_MODE_FIELD) {
+      RunFieldTick();
+      tick_count_++;
+  } else if (is_running_ && tick_engine_ == TICK_ENGINE_REFERENCE) {
+      RunReferenceTick();
+      tick_count_++;
+  } else if (is_running_) {
+      // Every phase of the tick runs on the steering batch, chunk by chunk, as a task graph.
+      steering_batch_.Gather(creatures_);
+      tick_graph_.Prepare(&steering_batch_, &food_, &food_grid_, GetWorldBounds(),
+                          collisions_enabled_ ? &broad_phase_ : nullptr, TICK_CHUNK_SIZE, time_step_);
+      tick_in_progress_ = true;
+      return true;
+  }
+
+  return false;
+}
+
+void Environment::TurnOverGeneration(bool spawn_food) {
+    // Function to spawn more creatures based on replicating creatures.
+    KillAndReproduceSpeedCreatures();
+
+    if (!ContainsSpeedCreatures()) {
+        RemoveSpeedCreatures();
+    }
+
+    if (!ContainsIntelligenceCreatures()) {
+        RemoveIntelligenceCreatures();
+    }
+
+    if (!ContainsBothTypeCreatures()) {
+        RemoveBothTypeCreatures();
+    }
+
+    // Reset Food and Creature Energies, Velocities, and Food
+    Creature::ResetAllCreatures(creatures_);
+    field_meal_progress_.assign(creatures_.size(), 0);
+    AssignCreatureIds();
+    SortCreaturesSpatially();
+    if (event_stream_ != nullptr) {
+        event_stream_->RecordGeneration(tick_count_, population_records_.size(), creatures_.size());
+    }
+    phylogeny_.Compact(); // Once a generation keeps the tree to fewer than twice the living
+    phylogeny_.TakeCensus(population_records_.size());
+
+    // Next generation's food and its grid don't depend on the statistics below, so they are
+    // built on another thread meanwhile. Nothing below calls rand(), so spawns stay seeded.
+    std::future<void> next_food;
+    if (spawn_food) {
+        next_food = std::async(std::launch::async, [this]() { SpawnFood(); });
+    }
+
+    needs_reset = false;
+    WorldGraphs &graphs = EditGraphs();
+    for (size_t i = 0; i < graphs.speed_histograms.size(); i++) {
+        graphs.speed_histograms.at(i).SetParticles(creatures_);
+    }
+
+    for (size_t i = 0; i < graphs.intelligence_histograms.size(); i++) {
+        graphs.intelligence_histograms.at(i).SetParticles(creatures_);
+    }
+
+    for (size_t i = 0; i < graphs.scatter_plots.size(); i++) {
+        graphs.scatter_plots.at(i).SetParticles(creatures_);
+    }
+
+    // Every generation stays in the record, so it is kept in compact form and shared with the graphs.
+    std::shared_ptr<std::vector<CompactCreature>> record = std::make_shared<std::vector<CompactCreature>>();
+    CompactCreature::PackAll(creatures_, *record);
+    population_records_.push_back(record);
+    population_history_.push_back(PopulationCount{GetSpeedCount(), GetIntelligenceCount(), GetBothTypeCount()});
+    for (size_t i = 0; i < graphs.population_graphs.size(); i++) {
+        graphs.population_graphs.at(i).AddGeneration(record);
+    }
+
+    if (next_food.valid()) {
+        next_food.get();
+    }
+}
+
+void Environment::ObserveGeneration() {
+    // Every generation simulated in full calibrates the model, and the first after a fast-forward checks it.
+    if (score_next_generation_) {
+        FastForwardReport report = generation_model_.Score(creatures_, food_count_);
+        report.generation = population_records_.size() - 1;
+        report.generations_skipped = fast_forward_generations_;
+        fast_forward_reports_.push_back(report);
+        score_next_generation_ = false;
+    }
+    generation_model_.Observe(creatures_, food_count_);
+    full_generations_since_fast_forward_++;
+}
+
+bool Environment::IsFastForwardDue() {
+    // Once enough generations have run in full, and the model fits them, it stands in for the next few.
+    return full_generations_since_fast_forward_ >= generation_model_.GetWindow() && generation_model_.Fit();
+}
+
+void Environment::FastForward() {
+    // Each creature's food is drawn from how creatures like it fared lately, and the usual turnover runs on that.
+    for (size_t generation = 0; generation < fast_forward_generations_ && !creatures_.empty(); generation++) {
+        // Regrown food has no fixed total, so only a world that spawns all its food at once caps the meals.
+        uint64_t seed = ((uint64_t) rand() << 32) ^ (uint64_t) rand();
+        size_t meal_budget = food_regrowth_rate_ > 0 ? SIZE_MAX : food_count_;
+        generation_model_.DrawOutcomes(creatures_, food_count_, meal_budget, seed, drawn_food_);
+        for (size_t i = 0; i < creatures_.size(); i++) {
+            creatures_[i].SetFood(drawn_food_[i]);
+        }
+        TurnOverGeneration(false); // Skipped generations never see their food
+    }
+    SpawnFood(); // Only the generation run in full next does
+    full_generations_since_fast_forward_ = 0;
+    score_next_generation_ = true;
+}
+
+bool Environment::RunTickSlices(std::chrono::steady_clock::time_point deadline) {
+    TaskScheduler *scheduler = creatures_.size() >= PARALLEL_TICK_MIN_CREATURES ? &TaskScheduler::Shared() : nullptr;
+    if (!tick_graph_.RunSliced(scheduler, deadline)) {
+        return false;
+    }
+    FinishTick();
+    return true;
+}
+
+void Environment::FinishTick() {
+    if (event_stream_ != nullptr) { // Before the eaten food is dropped, while the indices still match
+        const std::vector<std::pair<uint32_t, uint32_t>> &meals = tick_graph_.GetMeals();
+        for (size_t i = 0; i < meals.size(); i++) {
+            event_stream_->RecordMeal(tick_count_, creatures_[meals[i].first].GetId(), food_[meals[i].second].GetId());
+        }
+    }
+
+    // Meals index the food as the tick found it, which is how it still is.
+    const std::vector<std::pair<uint32_t, uint32_t>> &meals = tick_graph_.GetMeals();
+    eaten_food_.resize(meals.size());
+    for (size_t i = 0; i < meals.size(); i++) {
+        eaten_food_[i] = meals[i].second;
+    }
+    TakeOutFood(eaten_food_);
+    steering_batch_.Scatter(creatures_);
+
+    tick_count_++;
+    tick_in_progress_ = false;
+}
+
+void Environment::FinishPendingTick() {
+    // Anything that changes the creatures or food waits for the tick that is reading them.
+    if (tick_in_progress_) {
+        RunTickSlices(std::chrono::steady_clock::time_point::max());
+        PublishSnapshot();
+    }
+}
+
+void Environment::RunFieldTick() {
+    // Either engine runs the same field tick: the reference one is there to check food particles against.
+    steering_batch_.Gather(creatures_);
+    if (field_meal_progress_.size() != creatures_.size()) { // Creatures were added or removed by hand
+        field_meal_progress_.assign(creatures_.size(), 0);
+    }
 
-              if (!food_.empty()) {
-                  for (size_t i = 0; i < creatures_.size(); i++) {
-                      if (curr_creature.ChangeVelocityTowardsNearestFood(food_)) {
-                          curr_creature.SetNeedsMovement(true);
+    // An emptied field grows back at about the regrowth rate's food per tick at first, as particles would.
+    float regrowth = food_count_ > 0 ? food_regrowth_rate_ / (float) food_count_ : 0;
+    food_field_tick_.Prepare(&steering_batch_, &food_field_, &field_meal_progress_, GetWorldBounds(),
+                             collisions_enabled_ ? &broad_phase_ : nullptr, TICK_CHUNK_SIZE, time_step_,
+                             FOOD_FIELD_DIFFUSION, std::min(regrowth, 1.0f));
+    tick_tasks_.Clear();
+    food_field_tick_.BuildGraph(tick_tasks_);
+    if (creatures_.size() >= PARALLEL_TICK_MIN_CREATURES) {
+        TaskScheduler::Shared().Run(tick_tasks_);
+    } else {
+        tick_tasks_.RunInline();
+    }
+    food_field_tick_.Finish();
+
+    if (event_stream_ != nullptr) {
+        const std::vector<uint32_t> &meals = food_field_tick_.GetMeals();
+        for (size_t i = 0; i < meals.size(); i++) {
+            event_stream_->RecordMeal(tick_count_, creatures_[meals[i]].GetId(), 0);
+        }
+    }
+    steering_batch_.Scatter(creatures_);
+}
+
+void Environment::RunReferenceTick() {
+  // The tick as AdvanceOneFrame first ran it, one creature at a time through the Creature
+  // methods. It is only here to check the optimized engine against, so it stays plain.
+  reference_food_gone_.assign(creatures_.size(), 0);
+  reference_food_before_ = food_;
+  for (size_t i = 0; i < creatures_.size(); i++) {
+      Creature &curr_creature = creatures_.at(i);
+      if (curr_creature.GetNeedsMovement()) {
+          curr_creature.ChangeVelocityTowardsFurthestCorner();
+          curr_creature.SetNeedsMovement(false);
+      }
+
+      if (!food_.empty()) {
+          for (size_t j = 0; j < food_.size(); j++) {
+              if (curr_creature.IsTouchingSpecificFood(food_.at(j))) {
+                  if (curr_creature.GetFood() < 2) {
+                      if (event_stream_ != nullptr) {
+                          event_stream_->RecordMeal(tick_count_, curr_creature.GetId(), food_.at(j).GetId());
                       }
+                      curr_creature.AddFood();
+                      food_.erase(food_.begin() + j);
+                      curr_creature.SetNeedsMovement(true);
                   }
               }
-
-              curr_creature.ChangeVelocityIfNotEnoughEnergy();
-          } else { // If no food, then creatures should all return home
-              curr_creature.SetNeedsMovement(false);
-              curr_creature.ChangeVelocityTowardsNearestWall();
-              DetectSpeedCreatureWallHits(curr_creature);
           }
 
-          if (curr_creature.GetFood() == 2) {
-              curr_creature.SetNeedsMovement(false);
+          // The original ran this once per creature in the world; it gives the same answer every time.
+          if (!food_.empty() && curr_creature.ChangeVelocityTowardsNearestFood(food_)) {
+              curr_creature.SetNeedsMovement(true);
           }
-          curr_creature.ChangeVelocityIfEnoughFood(); // Should go home if has two food.
+
+          curr_creature.ChangeVelocityIfNotEnoughEnergy();
+      } else { // If no food, then creatures should all return home
+          curr_creature.SetNeedsMovement(false);
+          curr_creature.ChangeVelocityTowardsNearestWall();
+          DetectSpeedCreatureWallHits(curr_creature);
+      }
+
+      if (curr_creature.GetFood() == 2) {
+          curr_creature.SetNeedsMovement(false);
+      }
+      curr_creature.ChangeVelocityIfEnoughFood(); // Should go home if has two food.
+
+      if (collisions_enabled_) {
+          reference_food_gone_[i] = food_.empty() ? 1 : 0;
+      } else {
           DetectSpeedCreatureWallHits(curr_creature);
-          // Update all particle positions.
-          creatures_.at(i).Move();
+          curr_creature.Move(time_step_); // Update all particle positions.
+          StopAtWalls(curr_creature);
       }
   }
+
+  if (collisions_enabled_) {
+      // Collisions never had a one-at-a-time version, so with them on every creature steers
+      // first, then bounces, walls and moves go through the same code as the optimized tick.
+      steering_batch_.Gather(creatures_);
+      broad_phase_.FindCandidatePairs(steering_batch_, reference_collision_pairs_);
+      SweepAndPrune::ResolveCollisions(steering_batch_, reference_collision_pairs_);
+      SteeringKernel::ResolveWallHits(steering_batch_, GetWorldBounds(), reference_food_gone_);
+      SteeringKernel::Move(steering_batch_, GetWorldBounds(), time_step_);
+      steering_batch_.Scatter(creatures_);
+  }
+
+  // What's left is what the tick started with minus what was eaten, in the same order. The eaten food
+  // is then taken out of the starting food just as the optimized engine does, so both leave the same order.
+  if (food_.size() != reference_food_before_.size()) {
+      eaten_food_.clear();
+      for (size_t i = 0, kept = 0; i < reference_food_before_.size(); i++) {
+          if (kept < food_.size() && food_[kept].GetId() == reference_food_before_[i].GetId()) {
+              kept++;
+          } else {
+              eaten_food_.push_back((uint32_t) i);
+          }
+      }
+      food_.swap(reference_food_before_);
+      TakeOutFood(eaten_food_);
+  }
+}
+
+void Environment::PublishSnapshot() {
+    UpdateMemoryUsage();
+    WorldSnapshot &snapshot = snapshots_.BeginWrite();
+    snapshot.Capture(creatures_, food_, tick_count_, GetTrialsRun());
+    snapshot.memory = memory_ledger_;
+    snapshot.population_history = population_history_;
+    snapshot.graphs = graphs_;
+    snapshots_.Publish();
+
+    // Readers poll the ring, so a frame that repeats the last one would only push older ticks out of it.
+    if (shared_world_ != nullptr && (!shared_world_current_ || tick_count_ != shared_tick_ ||
+                                     GetTrialsRun() != shared_generation_)) {
+        shared_world_->Publish(creatures_, food_, tick_count_, GetTrialsRun());
+        shared_world_current_ = true;
+        shared_tick_ = tick_count_;
+        shared_generation_ = GetTrialsRun();
+    }
+}
+
+void Environment::UpdateMemoryUsage() {
+    std::array<MemoryFootprint, MEMORY_SUBSYSTEM_COUNT> footprints;
+    footprints[MEMORY_CREATURES].Add(creatures_);
+    footprints[MEMORY_FOOD].Add(food_);
+    footprints[MEMORY_FOOD].Add(food_field_.GetMemoryFootprint());
+    footprints[MEMORY_POPULATION_RECORDS].Add(population_records_);
+    for (size_t i = 0; i < population_records_.size(); i++) {
+        footprints[MEMORY_POPULATION_RECORDS].Add(*population_records_[i]);
+    }
+    footprints[MEMORY_POPULATION_RECORDS].Add(population_history_);
+    footprints[MEMORY_PHYLOGENY].Add(phylogeny_.GetMemoryFootprint());
+
+    // Each graph keeps its own copy of the creatures it draws. Older copies still held by a
+    // snapshot are let go of once every snapshot has moved on, so only the current ones count.
+    const WorldGraphs &graphs = *graphs_;
+    footprints[MEMORY_SPEED_HISTOGRAMS].Add(graphs.speed_histograms);
+    for (size_t i = 0; i < graphs.speed_histograms.size(); i++) {
+        footprints[MEMORY_SPEED_HISTOGRAMS].Add(graphs.speed_histograms[i].GetMemoryFootprint());
+    }
+    footprints[MEMORY_INTELLIGENCE_HISTOGRAMS].Add(graphs.intelligence_histograms);
+    for (size_t i = 0; i < graphs.intelligence_histograms.size(); i++) {
+        footprints[MEMORY_INTELLIGENCE_HISTOGRAMS].Add(graphs.intelligence_histograms[i].GetMemoryFootprint());
+    }
+    footprints[MEMORY_SCATTER_PLOTS].Add(graphs.scatter_plots);
+    for (size_t i = 0; i < graphs.scatter_plots.size(); i++) {
+        footprints[MEMORY_SCATTER_PLOTS].Add(graphs.scatter_plots[i].GetMemoryFootprint());
+    }
+    footprints[MEMORY_POPULATION_GRAPHS].Add(graphs.population_graphs);
+    for (size_t i = 0; i < graphs.population_graphs.size(); i++) {
+        footprints[MEMORY_POPULATION_GRAPHS].Add(graphs.population_graphs[i].GetMemoryFootprint());
+    }
+
+    memory_ledger_.Record(footprints);
+}
+
+const MemoryLedger &Environment::GetMemoryLedger() const {
+    return memory_ledger_;
+}
+
+int Environment::GetTickEngine() const {
+    return tick_engine_;
+}
+
+void Environment::SetTickEngine(int engine) {
+    tick_engine_ = engine;
+}
+
+int Environment::GetFoodMode() const {
+    return food_mode_;
+}
+
+void Environment::SetFoodMode(int mode) {
+    FinishPendingTick();
+    if (mode == food_mode_) {
+        return;
+    }
+    food_mode_ = mode;
+    field_meal_progress_.clear();
+    SpawnFood(); // The food starts over in its new form
+    PublishSnapshot();
+}
+
+const FoodField &Environment::GetFoodField() const {
+    return food_field_;
+}
+
+void Environment::SetFastForward(size_t calibration_generations, size_t skipped_generations) {
+    FinishPendingTick();
+    fast_forward_generations_ = skipped_generations;
+    generation_model_.Clear();
+    generation_model_.SetWindow(calibration_generations);
+    full_generations_since_fast_forward_ = 0;
+    score_next_generation_ = false;
+}
+
+const std::vector<FastForwardReport> &Environment::GetFastForwardReports() const {
+    return fast_forward_reports_;
+}
+
+const CarryingCapacity &Environment::GetCarryingCapacity() const {
+    return carrying_capacity_;
+}
+
+void Environment::SetCarryingCapacity(const CarryingCapacity &capacity) {
+    carrying_capacity_ = capacity;
+}
+
+size_t Environment::GetCapacityRemovedCount() const {
+    return capacity_removed_count_;
+}
+
+void Environment::SetSharedWorld(SharedWorldPublisher *publisher) {
+    shared_world_ = publisher;
+    shared_world_current_ = false;
+}
+
+void Environment::SetEventStream(EventStreamWriter *writer) {
+    event_stream_ = writer;
+}
+
+const Phylogeny &Environment::GetPhylogeny() const {
+    return phylogeny_;
+}
+
+bool Environment::GetShowMemoryOverlay() const {
+    return show_memory_overlay_;
+}
+
+void Environment::SetShowMemoryOverlay(bool setter) {
+    show_memory_overlay_ = setter;
+}
+
+const WorldSnapshot &Environment::GetSnapshot() const {
+    return snapshots_.Acquire();
+}
+
+uint64_t Environment::GetTick() const {
+    return tick_count_;
+}
+
+size_t Environment::GetTrialsRun() const {
+    return population_records_.size() - 1;
+}
+
+const std::vector<PopulationCount> &Environment::GetPopulationHistory() const {
+    return population_history_;
+}
+
+WorldGraphs &Environment::EditGraphs() {
+    // Only this thread copies graphs_ into snapshots, so a count of 1 means no snapshot holds it.
+    if (graphs_.use_count() > 1) {
+        graphs_ = std::make_shared<WorldGraphs>(*graphs_);
+    }
+    return *graphs_;
 }
 
 void Environment::AddSpeedCreatures() {
+    AddSpeedCreatures(DEFAULT_COUNT);
+}
+
+void Environment::AddSpeedCreatures(size_t count) {
+    FinishPendingTick();
     // Spawn speed creatures //
     std::vector<Creature> speed_creatures = Creature::SpawnCreatures(SPEED,
-                                                                     DEFAULT_COUNT, ci::Color("Red"), DEFAULT_CREATURE_RADIUS, DEFAULT_CREATURE_MASS,
+                                                                     count, DEFAULT_CREATURE_RADIUS, DEFAULT_CREATURE_MASS,
                                                                      DEFAULT_ENERGY_CAPACITY, 0);
     creatures_.insert(creatures_.end(), speed_creatures.begin(), speed_creatures.end());
+    AssignCreatureIds();
+    RecordAddedCreatures(creatures_.size() - count);
 
     // Histogram Data
-    speed_histograms_.push_back(SpeedHistogram("Red", DEFAULT_HISTOGRAM_WIDTH,
+    EditGraphs().speed_histograms.push_back(SpeedHistogram("Red", DEFAULT_HISTOGRAM_WIDTH,
                                                DEFAULT_HISTOGRAM_HEIGHT, DEFAULT_X_COOR,
                                          DEFAULT_HEIGHT + DEFAULT_Y_COOR + DEFAULT_HISTOGRAM_MARGINS, creatures_));
+    PublishSnapshot();
 }
 
 void Environment::RemoveSpeedCreatures() {
+    FinishPendingTick();
     std::vector<Creature> new_creature_vector;
     for (size_t i = 0; i < creatures_.size(); i++) {
         if (creatures_.at(i).GetCreatureType() != SPEED) {
             new_creature_vector.push_back(creatures_.at(i));
+        } else {
+            RecordRemovedCreature(creatures_.at(i));
         }
     }
 
     creatures_ = new_creature_vector;
-    speed_histograms_.clear();
+    EditGraphs().speed_histograms.clear();
+    PublishSnapshot();
 }
 
 void Environment::AddIntelligenceCreatures() {
+    AddIntelligenceCreatures(DEFAULT_COUNT);
+}
+
+void Environment::AddIntelligenceCreatures(size_t count) {
+    FinishPendingTick();
     // Spawn intelligence creatures //
     std::vector<Creature> intelligence_creatures = Creature::SpawnCreatures(INTELLIGENCE,
-                                                                            DEFAULT_COUNT, ci::Color("Blue"), DEFAULT_CREATURE_RADIUS, DEFAULT_CREATURE_MASS,
+                                                                            count, DEFAULT_CREATURE_RADIUS, DEFAULT_CREATURE_MASS,
                                                                             DEFAULT_ENERGY_CAPACITY, 0);
     creatures_.insert(creatures_.end(), intelligence_creatures.begin(), intelligence_creatures.end());
+    AssignCreatureIds();
+    RecordAddedCreatures(creatures_.size() - count);
 
     // Histogram Data
-    intelligence_histograms_.push_back(IntelligenceHistogram("Blue", DEFAULT_HISTOGRAM_WIDTH,
+    EditGraphs().intelligence_histograms.push_back(IntelligenceHistogram("Blue", DEFAULT_HISTOGRAM_WIDTH,
                                                              DEFAULT_HISTOGRAM_HEIGHT, DEFAULT_X_COOR * 3 + DEFAULT_HISTOGRAM_WIDTH + DEFAULT_HISTOGRAM_MARGINS,
                                                              DEFAULT_HEIGHT + DEFAULT_Y_COOR + DEFAULT_HISTOGRAM_MARGINS, creatures_));
+    PublishSnapshot();
 }
 
 void Environment::RemoveIntelligenceCreatures() {
+    FinishPendingTick();
     std::vector<Creature> new_creature_vector;
     for (size_t i = 0; i < creatures_.size(); i++) {
         if (creatures_.at(i).GetCreatureType() != INTELLIGENCE) {
             new_creature_vector.push_back(creatures_.at(i));
+        } else {
+            RecordRemovedCreature(creatures_.at(i));
         }
     }
 
     creatures_ = new_creature_vector;
-    intelligence_histograms_.clear();
+    EditGraphs().intelligence_histograms.clear();
+    PublishSnapshot();
 }
 
 void Environment::AddBothTypeCreatures() {
+    AddBothTypeCreatures(DEFAULT_COUNT);
+}
+
+void Environment::AddBothTypeCreatures(size_t count) {
+    FinishPendingTick();
     // Spawn intelligence creatures //
     std::vector<Creature> both_type_creatures = Creature::SpawnCreatures(BOTH,
-                                                                         DEFAULT_COUNT, ci::Color(ci::Color(0.8f, 0.0f, 0.8f)),
-                                                                         DEFAULT_CREATURE_RADIUS, DEFAULT_CREATURE_MASS,
+                                                                         count, DEFAULT_CREATURE_RADIUS, DEFAULT_CREATURE_MASS,
                                                                          DEFAULT_ENERGY_CAPACITY, 0);
     creatures_.insert(creatures_.end(), both_type_creatures.begin(), both_type_creatures.end());
+    AssignCreatureIds();
+    RecordAddedCreatures(creatures_.size() - count);
 
     // Histogram Data
-    scatter_plots_.push_back(BothScatterPlot("Purple", DEFAULT_HISTOGRAM_WIDTH * 2,
+    EditGraphs().scatter_plots.push_back(BothScatterPlot("Purple", DEFAULT_HISTOGRAM_WIDTH * 2,
                                                DEFAULT_HISTOGRAM_HEIGHT * 2, 1000 + DEFAULT_HISTOGRAM_WIDTH * 2 + DEFAULT_HISTOGRAM_MARGINS,
                                              DEFAULT_Y_COOR * 2 + DEFAULT_HISTOGRAM_MARGINS, creatures_));
+    PublishSnapshot();
 }
 
 void Environment::RemoveBothTypeCreatures() {
+    FinishPendingTick();
     std::vector<Creature> new_creature_vector;
     for (size_t i = 0; i < creatures_.size(); i++) {
         if (creatures_.at(i).GetCreatureType() != BOTH) {
             new_creature_vector.push_back(creatures_.at(i));
+        } else {
+            RecordRemovedCreature(creatures_.at(i));
         }
     }
 
     creatures_ = new_creature_vector;
-    scatter_plots_.clear();
+    EditGraphs().scatter_plots.clear();
+    PublishSnapshot();
 }
 
 bool Environment::ContainsSpeedCreatures() {
@@ -296,10 +876,14 @@ bool Environment::ContainsBothTypeCreatures() {
     return false;
 }
 
-std::vector<Food> Environment::GetFood() {
+const std::vector<Food> &Environment::GetFood() const {
     return food_;
 }
 
+const std::vector<Creature> &Environment::GetCreatures() const {
+    return creatures_;
+}
+
 void Environment::DetectSpeedCreatureWallHits(Creature& curr_creature) const {
     float x_pos = curr_creature.GetPosition().x;
     float y_pos = curr_creature.GetPosition().y;
@@ -343,8 +927,19 @@ void Environment::DetectSpeedCreatureWallHits(Creature& curr_creature) const {
     }
 }
 
+void Environment::StopAtWalls(Creature &curr_creature) const {
+    // However far a move would have overshot, the creature stops at the wall and the hit is
+    // handled next tick, so a large time step can't carry it out of the arena.
+    WorldBounds bounds = GetWorldBounds();
+    vec2 from = curr_creature.GetPreviousPosition();
+    vec2 to = curr_creature.GetPosition();
+    curr_creature.SetPosition(vec2(SteeringKernel::StopAtWalls(from.x, to.x, bounds.x_coor, bounds.x_coor + bounds.width),
+                                   SteeringKernel::StopAtWalls(from.y, to.y, bounds.y_coor, bounds.y_coor + bounds.height)));
+}
+
 bool Environment::AreAllParticlesReturned() {
-    if (food_.empty()) {
+    bool food_gone = food_mode_ == FOOD_MODE_FIELD ? food_field_.GetTotal() < 1 : food_.empty();
+    if (food_gone) {
         return true;
     } else {
         bool all_touching_side = true;
@@ -376,6 +971,14 @@ std::vector<Creature> Environment::GetSpeedCreatures() {
     return creatures_;
 }
 
+bool Environment::GetCollisionsEnabled() const {
+    return collisions_enabled_;
+}
+
+void Environment::SetCollisionsEnabled(bool setter) {
+    collisions_enabled_ = setter;
+}
+
 bool Environment::GetIsRunning() const {
     return is_running_;
 }
@@ -385,25 +988,69 @@ void Environment::SetIsRunning(bool setter) {
 }
 
 void Environment::KillAndReproduceSpeedCreatures() {
-    std::vector<Creature> creatures_to_keep;
+    // Mutations come from per-creature streams under one seed per generation,
+    // so runs stay reproducible under srand() no matter how many threads are used.
+    uint64_t seed = ((uint64_t) rand() << 32) ^ (uint64_t) rand();
+    // The capacity is applied as the generation is built, so children it culls are never born.
+    capacity_removed_count_ += GenerationTurnover::Run(creatures_, next_generation_, seed, carrying_capacity_);
+
+    uint32_t first_child_id = next_creature_id_;
+    for (size_t i = 0; i < next_generation_.size(); i++) {
+        if (next_generation_[i].GetId() == 0) {
+            next_generation_[i].SetId(next_creature_id_++);
+        }
+    }
+    RecordBirths(first_child_id);
+    RecordDeaths();
+    creatures_.swap(next_generation_);
+}
+
+void Environment::RecordBirths(uint32_t first_child_id) {
+    for (size_t i = 0; i < next_generation_.size(); i++) {
+        const Creature &child = next_generation_[i];
+        if (child.GetId() < first_child_id) { // A survivor
+            continue;
+        }
+        phylogeny_.AddBirth(child.GetId(), child.GetParentId());
+        if (event_stream_ != nullptr) {
+            event_stream_->RecordBirth(tick_count_, child);
+        }
+    }
+}
+
+void Environment::RecordDeaths() {
+    // Whoever is not in the next generation died, either starved or culled.
+    std::vector<uint32_t> kept(next_generation_.size());
+    for (size_t i = 0; i < next_generation_.size(); i++) {
+        kept[i] = next_generation_[i].GetId();
+    }
+    std::sort(kept.begin(), kept.end());
+
     for (size_t i = 0; i < creatures_.size(); i++) {
-        if (creatures_.at(i).GetFood() > 0) { // Remove dead creatures
-            creatures_to_keep.push_back(creatures_.at(i));
+        if (!std::binary_search(kept.begin(), kept.end(), creatures_[i].GetId())) {
+            phylogeny_.RemoveCreature(creatures_[i].GetId());
+            if (event_stream_ != nullptr) {
+                int cause = GenerationTurnover::Survives(creatures_[i]) ? DEATH_CULLED : DEATH_STARVED;
+                event_stream_->RecordDeath(tick_count_, creatures_[i].GetId(), cause);
+            }
         }
     }
+}
 
-    std::vector<Creature> creatures_to_add;
-    for (size_t i = 0; i < creatures_to_keep.size(); i++) { // Spawn new creatures based on surviving ones
-        // new speeds
-        if (creatures_to_keep.at(i).GetFood() > 1) {
-            int type = creatures_to_keep.at(i).GetCreatureType();
-            Creature child = creatures_to_keep.at(i).CreateChild(type);
-            creatures_to_add.push_back(child);
+void Environment::RecordAddedCreatures(size_t first_index) {
+    for (size_t i = first_index; i < creatures_.size(); i++) {
+        phylogeny_.AddFounder(creatures_[i].GetId());
+        if (event_stream_ != nullptr) {
+            event_stream_->RecordBirth(tick_count_, creatures_[i]);
         }
     }
+}
 
-    creatures_to_keep.insert(creatures_to_keep.end(), creatures_to_add.begin(), creatures_to_add.end());
-    creatures_ = creatures_to_keep;
+void Environment::RecordRemovedCreature(const Creature &creature) {
+    phylogeny_.RemoveCreature(creature.GetId());
+    if (event_stream_ != nullptr) {
+        event_stream_->RecordDeath(tick_count_, creature.GetId(), DEATH_REMOVED);
+    }
 }
 
 void Environment::IncreaseFoodCount() {
@@ -417,7 +1064,173 @@ void Environment::DecreaseFoodCount() {
 }
 
 void Environment::RefreshFood() {
-    food_ = Food::SpawnParticles(food_count_, ci::Color("Green"), 2.0f, 20);
+    FinishPendingTick();
+    SpawnFood();
+    PublishSnapshot();
+}
+
+void Environment::AddFood(size_t count) {
+    FinishPendingTick();
+    AppendFood(count);
+    PublishSnapshot();
+}
+
+void Environment::AppendFood(size_t count) {
+    // The field stays as it is: the new food goes on the end, and into the grid and remembered targets in place.
+    size_t first_added = food_.size();
+    std::vector<Food> added = Food::SpawnParticles(count, ci::Color("Green"), FOOD_RADIUS, FOOD_EDGE_BUFFER);
+    if (food_mode_ == FOOD_MODE_FIELD) { // A meal's worth where each would have landed
+        for (size_t i = 0; i < added.size(); i++) {
+            food_field_.Deposit(added[i].GetPosition().x, added[i].GetPosition().y, 1);
+        }
+        return;
+    }
+    for (size_t i = 0; i < added.size(); i++) {
+        added[i].SetId(next_food_id_++);
+        food_.push_back(added[i]);
+        food_grid_.Add(added[i]);
+    }
+    tick_graph_.AddFood(food_, first_added);
+    food_added_since_sort_ = food_added_since_sort_ || count > 0;
+}
+
+void Environment::RemoveFood(size_t count) {
+    // Like the food count, the food never goes below one item.
+    FinishPendingTick();
+    if (food_mode_ == FOOD_MODE_FIELD) {
+        food_field_.RemoveEvenly((float) std::min((double) count, std::max(food_field_.GetTotal() - 1, 0.0)));
+        PublishSnapshot();
+        return;
+    }
+    // Random picks, so the food thins out evenly. The food is kept in Morton order, so taking it
+    // off the end would empty one corner of the arena first.
+    count = std::min(count, food_.empty() ? 0 : food_.size() - 1);
+    std::vector<uint32_t> picks(food_.size());
+    for (size_t i = 0; i < picks.size(); i++) {
+        picks[i] = (uint32_t) i;
+    }
+    for (size_t i = 0; i < count; i++) {
+        std::swap(picks[i], picks[i + (size_t) rand() % (picks.size() - i)]);
+    }
+    picks.resize(count);
+    TakeOutFood(picks);
+    PublishSnapshot();
+}
+
+void Environment::TakeOutFood(std::vector<uint32_t> &indices) {
+    if (indices.empty()) {
+        return;
+    }
+
+    // Highest first, so the food swapped into each gap is never one still to be taken out. The grid
+    // and remembered targets follow each swap instead of being rebuilt.
+    std::sort(indices.begin(), indices.end(), std::greater<uint32_t>());
+    std::vector<uint32_t> food_order(food_.size());
+    for (size_t i = 0; i < food_order.size(); i++) {
+        food_order[i] = (uint32_t) i;
+    }
+    for (uint32_t index : indices) {
+        food_grid_.Remove(index);
+        food_[index] = food_.back();
+        food_.pop_back();
+        food_order[index] = food_order.back();
+        food_order.pop_back();
+    }
+    tick_graph_.RemoveFood(food_order);
+    food_added_since_sort_ = true; // The swapped food is out of order too
+}
+
+float Environment::GetFoodRegrowthRate() const {
+    return food_regrowth_rate_;
+}
+
+void Environment::SetFoodRegrowthRate(float food_per_tick) {
+    food_regrowth_rate_ = std::max(food_per_tick, 0.0f);
+}
+
+void Environment::RegrowFood() {
+    // Food grows back towards the food count, a fraction of an item per tick adding up over several ticks.
+    if (food_.size() >= food_count_) {
+        food_regrowth_due_ = 0;
+        return;
+    }
+    food_regrowth_due_ += food_regrowth_rate_;
+    size_t due = std::min((size_t) food_regrowth_due_, food_count_ - food_.size());
+    food_regrowth_due_ -= (float) due;
+    if (due > 0) {
+        AppendFood(due);
+    }
+}
+
+void Environment::SpawnFood() {
+    food_ = Food::SpawnParticles(food_count_, ci::Color("Green"), FOOD_RADIUS, FOOD_EDGE_BUFFER);
+    if (food_mode_ == FOOD_MODE_FIELD) {
+        // The particles only say where the field starts out, and what it grows back towards.
+        food_field_.Build(GetWorldBounds(), FOOD_FIELD_CELL_SIZE);
+        food_field_.Seed(food_);
+        food_.clear();
+    }
+    for (size_t i = 0; i < food_.size(); i++) {
+        food_[i].SetId(next_food_id_++);
+    }
+    food_sorter_.Sort(food_, GetWorldBounds()); // Food never moves, so once is enough unless more grows
+    food_grid_.Build(food_, GetWorldBounds(), FOOD_GRID_CELL_SIZE);
+    tick_graph_.InvalidateSensing(); // Remembered targets point into the old food
+    food_regrowth_due_ = 0;
+    food_added_since_sort_ = false;
+}
+
+void Environment::SortFoodSpatially() {
+    if (food_sorter_.Sort(food_, GetWorldBounds())) {
+        tick_graph_.Reorder(nullptr, &food_sorter_.GetOrder());
+        food_grid_.Build(food_, GetWorldBounds(), FOOD_GRID_CELL_SIZE);
+    }
+    food_added_since_sort_ = false;
+}
+
+void Environment::SortCreaturesSpatially() {
+    if (creature_sorter_.Sort(creatures_, GetWorldBounds())) {
+        tick_graph_.Reorder(&creature_sorter_.GetOrder(), nullptr);
+        broad_phase_.Renumber(creature_sorter_.GetOrder());
+        const std::vector<uint32_t> &order = creature_sorter_.GetOrder();
+        if (field_meal_progress_.size() == order.size()) { // Bites towards a meal stay with their creature
+            std::vector<float> sorted_progress(order.size());
+            for (size_t i = 0; i < order.size(); i++) {
+                sorted_progress[i] = field_meal_progress_[order[i]];
+            }
+            field_meal_progress_.swap(sorted_progress);
+        }
+    }
+}
+
+void Environment::AssignCreatureIds() {
+    for (size_t i = 0; i < creatures_.size(); i++) {
+        if (creatures_[i].GetId() == 0) {
+            creatures_[i].SetId(next_creature_id_++);
+        }
+    }
+}
+
+float Environment::GetTimeStep() const {
+    return time_step_;
+}
+
+void Environment::SetTimeStep(float time_step) {
+    if (time_step > 0) { // Nothing would move at 0, so the generation would never end
+        time_step_ = time_step;
+    }
+}
+
+size_t Environment::GetSpatialSortInterval() const {
+    return spatial_sort_interval_;
+}
+
+void Environment::SetSpatialSortInterval(size_t ticks) {
+    spatial_sort_interval_ = ticks;
+}
+
+WorldBounds Environment::GetWorldBounds() const {
+    return WorldBounds{(float) x_coor_, (float) y_coor_, (float) width_, (float) height_};
 }
 
 bool Environment::AreThereCreaturesAlive() {
@@ -0,0 +1,274 @@
+#include "equivalence_checker.h"
+#include "creature.h"
+#include "environment.h"
+#include "food.h"
+#include "tick_graph.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace naturalselection {
+
+static const uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+static const uint64_t HASH_PRIME = 0x100000001b3ull;
+
+// FNV-1a over whole words rather than bytes; it only has to notice differences, not resist attacks.
+static void MixWord(uint64_t &hash, uint64_t word) {
+    hash = (hash ^ word) * HASH_PRIME;
+}
+
+static void MixFloat(uint64_t &hash, float value) {
+    value += 0.0f; // -0 becomes +0; the tick only ever compares against zero, so the sign never matters.
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    MixWord(hash, bits);
+}
+
+static void MixDouble(uint64_t &hash, double value) {
+    value += 0.0;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    MixWord(hash, bits);
+}
+
+template <typename T>
+static std::string FormatValue(T value) {
+    std::ostringstream text;
+    text << std::setprecision(17) << value;
+    return text.str();
+}
+
+// Records the difference in report if the two values differ. Returns whether they did.
+template <typename T>
+static bool CheckField(const std::string &subject, const std::string &field, T reference, T optimized,
+                       EquivalenceReport &report) {
+    if (reference == optimized) {
+        return false;
+    }
+
+    report.subject = subject;
+    report.field = field;
+    report.reference_value = FormatValue(reference);
+    report.optimized_value = FormatValue(optimized);
+    return true;
+}
+
+std::string EquivalenceReport::Describe() const {
+    std::ostringstream text;
+    if (equivalent) {
+        text << "equivalent over " << frames_compared << " frames (" << checkpoints_compared << " checkpoints)";
+    } else {
+        text << "diverged after frame " << frame << ": " << subject << " " << field << " is "
+             << reference_value << " in the reference engine but " << optimized_value << " in the optimized one";
+    }
+    return text.str();
+}
+
+uint64_t EquivalenceChecker::HashState(const std::vector<Creature> &creatures, const std::vector<Food> &food) {
+    uint64_t hash = HASH_SEED;
+    MixWord(hash, creatures.size());
+    for (size_t i = 0; i < creatures.size(); i++) {
+        const Creature &creature = creatures[i];
+        MixWord(hash, (uint64_t) creature.GetCreatureType());
+        MixFloat(hash, creature.GetPosition().x);
+        MixFloat(hash, creature.GetPosition().y);
+        MixFloat(hash, creature.GetVelocity().x);
+        MixFloat(hash, creature.GetVelocity().y);
+        MixDouble(hash, creature.GetEnergy());
+        MixWord(hash, (uint64_t) creature.GetFood());
+        MixWord(hash, creature.GetNeedsMovement() ? 1 : 0);
+        MixFloat(hash, creature.GetMaxVelocity());
+        MixDouble(hash, creature.GetVisionRadius());
+        MixDouble(hash, creature.GetEnergySpend());
+    }
+
+    MixWord(hash, food.size());
+    for (size_t i = 0; i < food.size(); i++) {
+        MixFloat(hash, food[i].GetPosition().x);
+        MixFloat(hash, food[i].GetPosition().y);
+    }
+    return hash;
+}
+
+bool EquivalenceChecker::FindFirstDifference(const std::vector<Creature> &reference_creatures,
+                                             const std::vector<Food> &reference_food,
+                                             const std::vector<Creature> &optimized_creatures,
+                                             const std::vector<Food> &optimized_food, EquivalenceReport &report) {
+    size_t creature_count = std::min(reference_creatures.size(), optimized_creatures.size());
+    for (size_t i = 0; i < creature_count; i++) {
+        const Creature &reference = reference_creatures[i];
+        const Creature &optimized = optimized_creatures[i];
+        std::string subject = "creature " + std::to_string(i);
+        if (CheckField(subject, "type", reference.GetCreatureType(), optimized.GetCreatureType(), report) ||
+            CheckField(subject, "x", reference.GetPosition().x, optimized.GetPosition().x, report) ||
+            CheckField(subject, "y", reference.GetPosition().y, optimized.GetPosition().y, report) ||
+            CheckField(subject, "x_velocity", reference.GetVelocity().x, optimized.GetVelocity().x, report) ||
+            CheckField(subject, "y_velocity", reference.GetVelocity().y, optimized.GetVelocity().y, report) ||
+            CheckField(subject, "energy", reference.GetEnergy(), optimized.GetEnergy(), report) ||
+            CheckField(subject, "food", reference.GetFood(), optimized.GetFood(), report) ||
+            CheckField(subject, "needs_movement", reference.GetNeedsMovement(), optimized.GetNeedsMovement(), report) ||
+            CheckField(subject, "max_velocity", reference.GetMaxVelocity(), optimized.GetMaxVelocity(), report) ||
+            CheckField(subject, "vision_radius", reference.GetVisionRadius(), optimized.GetVisionRadius(), report) ||
+            CheckField(subject, "energy_spend", reference.GetEnergySpend(), optimized.GetEnergySpend(), report)) {
+            return true;
+        }
+    }
+    if (CheckField("world", "creature count", reference_creatures.size(), optimized_creatures.size(), report)) {
+        return true;
+    }
+
+    size_t food_count = std::min(reference_food.size(), optimized_food.size());
+    for (size_t i = 0; i < food_count; i++) {
+        std::string subject = "food " + std::to_string(i);
+        if (CheckField(subject, "x", reference_food[i].GetPosition().x, optimized_food[i].GetPosition().x, report) ||
+            CheckField(subject, "y", reference_food[i].GetPosition().y, optimized_food[i].GetPosition().y, report)) {
+            return true;
+        }
+    }
+    return CheckField("world", "food count", reference_food.size(), optimized_food.size(), report);
+}
+
+uint64_t EquivalenceChecker::Replay(const SweepJob &job, int engine, const FrameVisitor &visit) {
+    srand(job.seed);
+    Environment environment = Environment();
+    HeadlessRunner::SetUp(job, environment);
+    environment.SetTickEngine(engine);
+    if (!visit(0, environment)) {
+        return 0;
+    }
+
+    uint64_t frames = 0;
+    while (!HeadlessRunner::IsFinished(job, environment) && frames < job.max_ticks) {
+        HeadlessRunner::StepFrame(environment);
+        frames++;
+        if (!visit(frames, environment)) {
+            break;
+        }
+    }
+    return frames;
+}
+
+EquivalenceReport EquivalenceChecker::Run(const SweepJob &job, int granularity) {
+    // A frame is a checkpoint every tick, or whenever a generation has just been turned over.
+    auto is_checkpoint = [granularity](uint64_t frame, Environment &environment, size_t &trials_seen) {
+        size_t trials_run = environment.GetTrialsRun();
+        bool new_generation = trials_run != trials_seen;
+        trials_seen = trials_run;
+        return granularity == COMPARE_EVERY_TICK || frame == 0 || new_generation;
+    };
+
+    std::vector<uint64_t> reference_frames;
+    std::vector<uint64_t> reference_hashes;
+    size_t trials_seen = 0;
+    uint64_t reference_length = Replay(job, TICK_ENGINE_REFERENCE, [&](uint64_t frame, Environment &environment) {
+        if (is_checkpoint(frame, environment, trials_seen)) {
+            reference_frames.push_back(frame);
+            reference_hashes.push_back(HashState(environment.GetCreatures(), environment.GetFood()));
+        }
+        return true;
+    });
+
+    EquivalenceReport report;
+    uint64_t last_match = 0;
+    bool diverged = false;
+    std::vector<Creature> optimized_creatures;
+    std::vector<Food> optimized_food;
+    trials_seen = 0;
+    uint64_t optimized_length = Replay(job, TICK_ENGINE_OPTIMIZED, [&](uint64_t frame, Environment &environment) {
+        if (!is_checkpoint(frame, environment, trials_seen)) {
+            return true;
+        }
+
+        size_t checkpoint = report.checkpoints_compared;
+        if (checkpoint < reference_frames.size() && reference_frames[checkpoint] == frame &&
+            reference_hashes[checkpoint] == HashState(environment.GetCreatures(), environment.GetFood())) {
+            report.checkpoints_compared++;
+            last_match = frame;
+            return true;
+        }
+
+        diverged = true;
+        report.frame = frame;
+        optimized_creatures = environment.GetCreatures();
+        optimized_food = environment.GetFood();
+        return false;
+    });
+
+    report.frames_compared = diverged ? last_match : std::min(reference_length, optimized_length);
+    if (!diverged && report.checkpoints_compared == reference_frames.size()) {
+        return report;
+    }
+
+    report.equivalent = false;
+    if (!diverged) { // Every state matched, but the reference run went on for longer.
+        report.frame = optimized_length;
+        report.subject = "world";
+        report.field = "frames run";
+        report.reference_value = std::to_string(reference_length);
+        report.optimized_value = std::to_string(optimized_length);
+        return report;
+    }
+
+    // Between generation checkpoints, replay both tick by tick to find the first frame that differs.
+    if (report.frame > last_match + 1) {
+        uint64_t window_end = report.frame;
+        std::vector<uint64_t> window_hashes;
+        Replay(job, TICK_ENGINE_REFERENCE, [&](uint64_t frame, Environment &environment) {
+            if (frame > last_match) {
+                window_hashes.push_back(HashState(environment.GetCreatures(), environment.GetFood()));
+            }
+            return frame < window_end;
+        });
+
+        Replay(job, TICK_ENGINE_OPTIMIZED, [&](uint64_t frame, Environment &environment) {
+            if (frame <= last_match) {
+                return true;
+            }
+
+            size_t offset = (size_t) (frame - last_match - 1);
+            if (offset < window_hashes.size() &&
+                window_hashes[offset] == HashState(environment.GetCreatures(), environment.GetFood())) {
+                return frame < window_end;
+            }
+
+            report.frame = frame;
+            optimized_creatures = environment.GetCreatures();
+            optimized_food = environment.GetFood();
+            return false;
+        });
+        report.frames_compared = report.frame - 1;
+    }
+
+    if (report.frame > reference_length) { // The reference run had already finished
+        report.subject = "world";
+        report.field = "frames run";
+        report.reference_value = std::to_string(reference_length);
+        report.optimized_value = std::to_string(optimized_length);
+        return report;
+    }
+
+    std::vector<Creature> reference_creatures;
+    std::vector<Food> reference_food;
+    uint64_t reference_end = report.frame;
+    Replay(job, TICK_ENGINE_REFERENCE, [&](uint64_t frame, Environment &environment) {
+        if (frame < reference_end) {
+            return true;
+        }
+        reference_creatures = environment.GetCreatures();
+        reference_food = environment.GetFood();
+        return false;
+    });
+
+    if (!FindFirstDifference(reference_creatures, reference_food, optimized_creatures, optimized_food, report)) {
+        // Same state, but only one engine reached this frame at all.
+        report.subject = "world";
+        report.field = "frames run";
+        report.reference_value = std::to_string(reference_length);
+        report.optimized_value = std::to_string(optimized_length);
+    }
+    return report;
+}
+
+}
@@ -0,0 +1,247 @@
+#include "event_stream.h"
+#include "creature.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace naturalselection {
+
+static_assert(sizeof(LifeEvent) == 32, "events are a fixed 32 bytes in the file");
+static_assert(sizeof(EventStreamHeader) % alignof(LifeEvent) == 0, "events must start aligned");
+
+EventStreamWriter::~EventStreamWriter() {
+    Close();
+}
+
+bool EventStreamWriter::Open(const std::string &path, size_t buffer_events) {
+    Close();
+    file_ = fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+
+    EventStreamHeader header = {};
+    header.magic = EVENT_STREAM_MAGIC;
+    header.version = EVENT_STREAM_VERSION;
+    header.event_bytes = sizeof(LifeEvent);
+    if (fwrite(&header, sizeof(header), 1, file_) != 1 || fflush(file_) != 0) {
+        fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+
+    buffer_events_ = std::max(buffer_events, (size_t) 1);
+    filling_.clear();
+    filling_.reserve(buffer_events_);
+    events_recorded_ = 0;
+    write_failed_ = false;
+    stopping_ = false;
+    thread_ = std::thread(&EventStreamWriter::Write, this);
+    return true;
+}
+
+void EventStreamWriter::RecordMeal(uint64_t tick, uint32_t creature_id, uint32_t food_id) {
+    LifeEvent event = {};
+    event.tick = tick;
+    event.type = EVENT_MEAL;
+    event.creature_id = creature_id;
+    event.other_id = food_id;
+    Record(event);
+}
+
+void EventStreamWriter::RecordBirth(uint64_t tick, const Creature &child) {
+    LifeEvent event = {};
+    event.tick = tick;
+    event.type = EVENT_BIRTH;
+    event.creature_id = child.GetId();
+    event.other_id = child.GetParentId();
+    event.max_velocity = child.GetMaxVelocity();
+    event.vision_radius = (float) child.GetVisionRadius();
+    event.detail = (uint8_t) child.GetCreatureType();
+    Record(event);
+}
+
+void EventStreamWriter::RecordDeath(uint64_t tick, uint32_t creature_id, int cause) {
+    LifeEvent event = {};
+    event.tick = tick;
+    event.type = EVENT_DEATH;
+    event.creature_id = creature_id;
+    event.detail = (uint8_t) cause;
+    Record(event);
+}
+
+void EventStreamWriter::RecordGeneration(uint64_t tick, size_t generation, size_t population) {
+    LifeEvent event = {};
+    event.tick = tick;
+    event.type = EVENT_GENERATION;
+    event.creature_id = (uint32_t) generation;
+    event.other_id = (uint32_t) population;
+    Record(event);
+}
+
+void EventStreamWriter::Record(const LifeEvent &event) {
+    if (file_ == nullptr) {
+        return;
+    }
+
+    filling_.push_back(event);
+    events_recorded_++;
+    if (filling_.size() >= buffer_events_) {
+        HandOff();
+    }
+}
+
+void EventStreamWriter::HandOff() {
+    if (filling_.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    written_.wait(lock, [this]() { return queued_.size() < MAX_QUEUED_BUFFERS; });
+    queued_.push_back(std::move(filling_));
+    if (spare_.empty()) {
+        filling_ = std::vector<LifeEvent>();
+        filling_.reserve(buffer_events_);
+    } else { // Already as big as a full buffer, so recording into it never reallocates
+        filling_ = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    wake_.notify_one();
+}
+
+void EventStreamWriter::Flush() {
+    if (file_ == nullptr) {
+        return;
+    }
+
+    HandOff();
+    std::unique_lock<std::mutex> lock(mutex_);
+    written_.wait(lock, [this]() { return queued_.empty() && !writing_; });
+}
+
+void EventStreamWriter::Close() {
+    if (file_ == nullptr) {
+        return;
+    }
+
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+
+    fclose(file_);
+    file_ = nullptr;
+    filling_.clear();
+    spare_.clear();
+}
+
+bool EventStreamWriter::IsOpen() const {
+    return file_ != nullptr;
+}
+
+uint64_t EventStreamWriter::GetEventsRecorded() const {
+    return events_recorded_;
+}
+
+bool EventStreamWriter::GetWriteFailed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_failed_;
+}
+
+void EventStreamWriter::Write() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return !queued_.empty() || stopping_; });
+        if (queued_.empty()) { // Stopping, and everything queued is written
+            return;
+        }
+
+        std::vector<LifeEvent> buffer = std::move(queued_.front());
+        queued_.erase(queued_.begin());
+        writing_ = true;
+        lock.unlock();
+
+        // Flushed every time, so whatever a reader maps is complete up to the last buffer.
+        bool failed = fwrite(buffer.data(), sizeof(LifeEvent), buffer.size(), file_) != buffer.size() ||
+                      fflush(file_) != 0;
+        buffer.clear();
+
+        lock.lock();
+        write_failed_ = write_failed_ || failed;
+        spare_.push_back(std::move(buffer));
+        writing_ = false;
+        written_.notify_all();
+    }
+}
+
+EventStreamReader::~EventStreamReader() {
+    Close();
+}
+
+bool EventStreamReader::Open(const std::string &path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) < 0 || (size_t) status.st_size < sizeof(EventStreamHeader)) {
+        close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    mapping_ = (const uint8_t *) mapping;
+    mapping_bytes_ = (size_t) status.st_size;
+    const EventStreamHeader *header = (const EventStreamHeader *) mapping_;
+    if (header->magic != EVENT_STREAM_MAGIC || header->version != EVENT_STREAM_VERSION ||
+        header->event_bytes != sizeof(LifeEvent)) {
+        Close();
+        return false;
+    }
+    event_count_ = (mapping_bytes_ - sizeof(EventStreamHeader)) / sizeof(LifeEvent);
+    return true;
+}
+
+void EventStreamReader::Close() {
+    if (mapping_ != nullptr) {
+        munmap((void *) mapping_, mapping_bytes_);
+        mapping_ = nullptr;
+        mapping_bytes_ = 0;
+        event_count_ = 0;
+    }
+}
+
+size_t EventStreamReader::Size() const {
+    return event_count_;
+}
+
+const LifeEvent &EventStreamReader::operator[](size_t index) const {
+    return begin()[index];
+}
+
+const LifeEvent *EventStreamReader::begin() const {
+    if (mapping_ == nullptr) {
+        return nullptr;
+    }
+    return (const LifeEvent *) (mapping_ + sizeof(EventStreamHeader));
+}
+
+const LifeEvent *EventStreamReader::end() const {
+    if (mapping_ == nullptr) {
+        return nullptr;
+    }
+    return begin() + event_count_;
+}
+
+}
@@ -14,7 +14,6 @@ Food::Food(vec2 new_position, float new_radius, ci::Color new_color) {
 }
 
 std::vector<Food> Food::SpawnParticles(size_t count, ci::Color color, float radius, int edge_buffer) {
-    srand((unsigned int) time(NULL));
     std::vector<Food> food_particles;
     for (size_t i = 0; i < count; i++) {
         // Creates two random x and y coordinates within the gas container box.
@@ -45,4 +44,12 @@ ci::Color Food::GetColor() const {
     return color_;
 }
 
+uint32_t Food::GetId() const {
+    return id_;
+}
+
+void Food::SetId(uint32_t id) {
+    id_ = id;
+}
+
 }
\ No newline at end of file
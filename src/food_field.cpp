@@ -0,0 +1,229 @@
+#include "food_field.h"
+#include "food.h"
+#include <algorithm>
+#include <cmath>
+
+namespace naturalselection {
+
+// Most of a meal a creature can take from its cell in one tick.
+static const float BITE = 0.25f;
+// Less of a difference than this, in meals, and a creature doesn't notice which way the field rises.
+static const double MIN_GRADIENT = 1e-3;
+
+void FoodField::Build(const WorldBounds &bounds, float cell_size) {
+    bounds_ = bounds;
+    inverse_cell_size_ = 1.0f / cell_size;
+    columns_ = std::max((size_t) std::ceil(bounds.width * inverse_cell_size_), (size_t) 1);
+    rows_ = std::max((size_t) std::ceil(bounds.height * inverse_cell_size_), (size_t) 1);
+
+    size_t cell_count = columns_ * rows_;
+    density_.assign(cell_count, 0);
+    capacity_.assign(cell_count, 0);
+    next_density_.assign(cell_count, 0);
+    row_totals_.assign(rows_, 0);
+    sums_.assign((columns_ + 1) * (rows_ + 1), 0);
+    total_ = 0;
+}
+
+void FoodField::Seed(const std::vector<Food> &food) {
+    std::fill(density_.begin(), density_.end(), 0.0f);
+    total_ = 0;
+    for (size_t i = 0; i < food.size(); i++) {
+        Deposit(food[i].GetPosition().x, food[i].GetPosition().y, 1);
+    }
+    capacity_ = density_;
+}
+
+void FoodField::Deposit(float x, float y, float amount) {
+    if (density_.empty()) {
+        return;
+    }
+    density_[RowOf(y) * columns_ + ColumnOf(x)] += amount;
+    total_ += amount;
+}
+
+void FoodField::RemoveEvenly(float amount) {
+    if (total_ <= 0) {
+        return;
+    }
+
+    float kept = (float) std::max(1.0 - amount / total_, 0.0);
+    total_ = 0;
+    for (size_t cell = 0; cell < density_.size(); cell++) {
+        density_[cell] *= kept;
+        total_ += density_[cell];
+    }
+}
+
+void FoodField::Feed(SteeringBatch &batch, std::vector<float> &meal_progress, std::vector<uint32_t> &fed) {
+    // In creature order, so that whoever comes later finds the cell emptier, as with food particles.
+    fed.clear();
+    if (density_.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < batch.Size(); i++) {
+        if (batch.food[i] >= 2) {
+            continue;
+        }
+
+        float &cell = density_[RowOf(batch.y[i]) * columns_ + ColumnOf(batch.x[i])];
+        float bite = std::min(cell, BITE);
+        cell -= bite;
+        total_ -= bite;
+        meal_progress[i] += bite;
+        if (meal_progress[i] >= 1) {
+            meal_progress[i] -= 1;
+            batch.food[i]++;
+            batch.needs_movement[i] = 1;
+            fed.push_back((uint32_t) i);
+        }
+    }
+}
+
+void FoodField::BuildSums() {
+    size_t stride = columns_ + 1;
+    for (size_t row = 0; row < rows_; row++) {
+        double row_sum = 0;
+        for (size_t column = 0; column < columns_; column++) {
+            row_sum += density_[row * columns_ + column];
+            sums_[(row + 1) * stride + column + 1] = sums_[row * stride + column + 1] + row_sum;
+        }
+    }
+}
+
+void FoodField::SteerUpGradient(SteeringBatch &batch, const std::vector<uint8_t> &mask, size_t begin,
+                                size_t end) const {
+    if (density_.empty()) {
+        return;
+    }
+
+    for (size_t i = begin; i < end; i++) {
+        // A full creature's velocity is overwritten on its way home anyway.
+        if (!mask[i] || batch.food[i] >= 2) {
+            continue;
+        }
+
+        // Everything in vision to one side of the creature's cell against everything to the other.
+        float reach = (float) batch.vision_radius[i];
+        size_t column = ColumnOf(batch.x[i]);
+        size_t row = RowOf(batch.y[i]);
+        size_t column_begin = ColumnOf(batch.x[i] - reach);
+        size_t column_end = ColumnOf(batch.x[i] + reach) + 1;
+        size_t row_begin = RowOf(batch.y[i] - reach);
+        size_t row_end = RowOf(batch.y[i] + reach) + 1;
+        double x_gradient = SumBox(column + 1, column_end, row_begin, row_end) -
+                            SumBox(column_begin, column, row_begin, row_end);
+        double y_gradient = SumBox(column_begin, column_end, row + 1, row_end) -
+                            SumBox(column_begin, column_end, row_begin, row);
+
+        double length = std::sqrt(x_gradient * x_gradient + y_gradient * y_gradient);
+        if (length < MIN_GRADIENT) {
+            continue;
+        }
+        batch.x_velocity[i] = (float) (x_gradient / length) * batch.max_velocity[i];
+        batch.y_velocity[i] = (float) (y_gradient / length) * batch.max_velocity[i];
+        batch.needs_movement[i] = 1;
+    }
+}
+
+void FoodField::Step(float diffusion, float regrowth) {
+    StepRows(diffusion, regrowth, 0, rows_);
+    FinishStep();
+}
+
+// One cell's next density, given the sum of its four neighbours.
+static inline float Spread(float here, float neighbours, float capacity, float diffusion, float regrowth) {
+    return std::max(here + diffusion * (neighbours - 4 * here) + regrowth * (capacity - here), 0.0f);
+}
+
+void FoodField::StepRows(float diffusion, float regrowth, size_t row_begin, size_t row_end) {
+    size_t last = columns_ - 1;
+    for (size_t row = row_begin; row < row_end; row++) {
+        // A cell on a wall stands in for its missing neighbour, so nothing flows out through it.
+        const float *above = &density_[(row > 0 ? row - 1 : row) * columns_];
+        const float *here = &density_[row * columns_];
+        const float *below = &density_[(row + 1 < rows_ ? row + 1 : row) * columns_];
+        const float *capacity = &capacity_[row * columns_];
+        float *next = &next_density_[row * columns_];
+
+        if (columns_ == 1) {
+            next[0] = Spread(here[0], above[0] + below[0] + 2 * here[0], capacity[0], diffusion, regrowth);
+        } else {
+            next[0] = Spread(here[0], above[0] + below[0] + here[0] + here[1], capacity[0], diffusion, regrowth);
+            // Straight-line code over the middle of the row, which the compiler vectorizes.
+            for (size_t column = 1; column < last; column++) {
+                next[column] = Spread(here[column], above[column] + below[column] + here[column - 1] + here[column + 1],
+                                      capacity[column], diffusion, regrowth);
+            }
+            next[last] = Spread(here[last], above[last] + below[last] + here[last - 1] + here[last], capacity[last],
+                                diffusion, regrowth);
+        }
+
+        double row_total = 0;
+        for (size_t column = 0; column < columns_; column++) {
+            row_total += next[column];
+        }
+        row_totals_[row] = row_total;
+    }
+}
+
+void FoodField::FinishStep() {
+    density_.swap(next_density_);
+    total_ = 0;
+    for (size_t row = 0; row < rows_; row++) {
+        total_ += row_totals_[row];
+    }
+}
+
+size_t FoodField::GetColumns() const {
+    return columns_;
+}
+
+size_t FoodField::GetRows() const {
+    return rows_;
+}
+
+float FoodField::GetDensity(size_t column, size_t row) const {
+    return density_[row * columns_ + column];
+}
+
+float FoodField::GetDensityAt(float x, float y) const {
+    return density_.empty() ? 0 : density_[RowOf(y) * columns_ + ColumnOf(x)];
+}
+
+double FoodField::GetTotal() const {
+    return total_;
+}
+
+MemoryFootprint FoodField::GetMemoryFootprint() const {
+    MemoryFootprint footprint;
+    footprint.Add(density_);
+    footprint.Add(capacity_);
+    footprint.Add(next_density_);
+    footprint.Add(row_totals_);
+    footprint.Add(sums_);
+    return footprint;
+}
+
+size_t FoodField::ColumnOf(float x) const {
+    float column = (x - bounds_.x_coor) * inverse_cell_size_;
+    return (size_t) std::min(std::max(column, 0.0f), (float) (columns_ - 1));
+}
+
+size_t FoodField::RowOf(float y) const {
+    float row = (y - bounds_.y_coor) * inverse_cell_size_;
+    return (size_t) std::min(std::max(row, 0.0f), (float) (rows_ - 1));
+}
+
+double FoodField::SumBox(size_t column_begin, size_t column_end, size_t row_begin, size_t row_end) const {
+    if (column_begin >= column_end || row_begin >= row_end) {
+        return 0;
+    }
+
+    size_t stride = columns_ + 1;
+    return sums_[row_end * stride + column_end] - sums_[row_begin * stride + column_end] -
+           sums_[row_end * stride + column_begin] + sums_[row_begin * stride + column_begin];
+}
+
+}
@@ -0,0 +1,126 @@
+#include "food_field_tick.h"
+#include <algorithm>
+
+namespace naturalselection {
+
+// Rows of the field stepped per task. A band is about as much work as a chunk of creatures.
+static const size_t FIELD_ROWS_PER_TASK = 32;
+
+void FoodFieldTick::Prepare(SteeringBatch *batch, FoodField *field, std::vector<float> *meal_progress,
+                            const WorldBounds &bounds, SweepAndPrune *broad_phase, size_t chunk_size,
+                            float time_step, float diffusion, float regrowth) {
+    batch_ = batch;
+    field_ = field;
+    meal_progress_ = meal_progress;
+    bounds_ = bounds;
+    broad_phase_ = broad_phase;
+    chunk_size_ = std::max(chunk_size, (size_t) 1);
+    chunk_count_ = (batch->Size() + chunk_size_ - 1) / chunk_size_;
+    time_step_ = time_step;
+    diffusion_ = diffusion;
+    regrowth_ = regrowth;
+
+    // Less than a meal left anywhere is as good as none.
+    uint8_t food_empty = field->GetTotal() < 1 ? 1 : 0;
+    food_empty_.assign(batch->Size(), food_empty);
+    food_left_.assign(batch->Size(), 1 - food_empty);
+    meals_.clear();
+}
+
+size_t FoodFieldTick::GetChunkCount() const {
+    return chunk_count_;
+}
+
+void FoodFieldTick::BuildGraph(TaskGraph &graph) {
+    std::vector<TaskGraph::TaskId> corner(chunk_count_);
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        size_t begin = chunk * chunk_size_;
+        size_t end = std::min(begin + chunk_size_, batch_->Size());
+        corner[chunk] = graph.AddTask([this, begin, end]() { SteerToCorner(begin, end); });
+    }
+
+    // Eating sets movement flags the corner phase clears, so it waits on every chunk.
+    TaskGraph::TaskId eating = graph.AddTask([this]() {
+        if (!food_empty_.empty() && food_left_[0]) {
+            field_->Feed(*batch_, *meal_progress_, meals_);
+        }
+        field_->BuildSums();
+    });
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        graph.AddDependency(corner[chunk], eating);
+    }
+
+    // Steering only reads the sums, so the field steps alongside it.
+    for (size_t row = 0; row < field_->GetRows(); row += FIELD_ROWS_PER_TASK) {
+        size_t row_end = std::min(row + FIELD_ROWS_PER_TASK, field_->GetRows());
+        TaskGraph::TaskId step = graph.AddTask([this, row, row_end]() {
+            field_->StepRows(diffusion_, regrowth_, row, row_end);
+        });
+        graph.AddDependency(eating, step);
+    }
+
+    std::vector<TaskGraph::TaskId> home(chunk_count_);
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        size_t begin = chunk * chunk_size_;
+        size_t end = std::min(begin + chunk_size_, batch_->Size());
+        home[chunk] = graph.AddTask([this, begin, end]() { SteerHome(begin, end); });
+        graph.AddDependency(eating, home[chunk]);
+    }
+
+    // Collisions look at every creature at once, so they are a barrier when enabled.
+    bool has_collisions = broad_phase_ != nullptr;
+    TaskGraph::TaskId collisions = 0;
+    if (has_collisions) {
+        collisions = graph.AddTask([this]() { ResolveCollisions(); });
+        for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+            graph.AddDependency(home[chunk], collisions);
+        }
+    }
+
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        size_t begin = chunk * chunk_size_;
+        size_t end = std::min(begin + chunk_size_, batch_->Size());
+        TaskGraph::TaskId move = graph.AddTask([this, begin, end]() { Move(begin, end); });
+        graph.AddDependency(has_collisions ? collisions : home[chunk], move);
+    }
+}
+
+void FoodFieldTick::Finish() {
+    field_->FinishStep();
+}
+
+const std::vector<uint32_t> &FoodFieldTick::GetMeals() const {
+    return meals_;
+}
+
+void FoodFieldTick::SteerToCorner(size_t begin, size_t end) {
+    // Creatures that changed course last tick head for the furthest corner.
+    SteeringKernel::TowardsFurthestCorner(*batch_, batch_->needs_movement, begin, end);
+    std::fill(batch_->needs_movement.begin() + begin, batch_->needs_movement.begin() + end, 0);
+}
+
+void FoodFieldTick::SteerHome(size_t begin, size_t end) {
+    // As TickGraph's sensing and steering home, with the field in place of the nearest food.
+    field_->SteerUpGradient(*batch_, food_left_, begin, end);
+    SteeringKernel::IfNotEnoughEnergy(*batch_, food_left_, begin, end);
+    SteeringKernel::TowardsNearestWall(*batch_, food_empty_, begin, end);
+
+    for (size_t i = begin; i < end; i++) {
+        if (food_empty_[i] || batch_->food[i] == 2) {
+            batch_->needs_movement[i] = 0;
+        }
+    }
+    SteeringKernel::IfEnoughFood(*batch_, begin, end);
+}
+
+void FoodFieldTick::ResolveCollisions() {
+    broad_phase_->FindCandidatePairs(*batch_, collision_pairs_);
+    SweepAndPrune::ResolveCollisions(*batch_, collision_pairs_);
+}
+
+void FoodFieldTick::Move(size_t begin, size_t end) {
+    SteeringKernel::ResolveWallHits(*batch_, bounds_, food_empty_, begin, end);
+    SteeringKernel::Move(*batch_, bounds_, time_step_, begin, end);
+}
+
+}
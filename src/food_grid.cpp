@@ -0,0 +1,113 @@
+#include "food_grid.h"
+#include "food.h"
+#include <algorithm>
+#include <cmath>
+
+namespace naturalselection {
+
+// Room left in every cell beyond the food already in it: a fraction of them, plus a few.
+static const uint32_t CELL_ROOM_DIVISOR = 4;
+static const uint32_t MIN_CELL_ROOM = 2;
+
+void FoodGrid::Build(const std::vector<Food> &food, const WorldBounds &bounds, float cell_size) {
+    min_x_ = bounds.x_coor;
+    min_y_ = bounds.y_coor;
+    inverse_cell_size_ = 1.0f / cell_size;
+    columns_ = std::max((size_t) std::ceil(bounds.width / cell_size), (size_t) 1);
+    rows_ = std::max((size_t) std::ceil(bounds.height / cell_size), (size_t) 1);
+    food_count_ = food.size();
+
+    food_cells_.resize(food_count_);
+    for (size_t i = 0; i < food_count_; i++) {
+        food_cells_[i] = (uint32_t) (CellRow(food[i].GetPosition().y) * columns_ + CellColumn(food[i].GetPosition().x));
+    }
+    Layout();
+}
+
+void FoodGrid::Add(const Food &food) {
+    uint32_t cell = (uint32_t) (CellRow(food.GetPosition().y) * columns_ + CellColumn(food.GetPosition().x));
+    uint32_t index = (uint32_t) food_count_;
+    food_cells_.push_back(cell);
+    food_count_++;
+
+    if (cell_starts_[cell] + cell_counts_[cell] == cell_starts_[cell + 1]) { // No room left, so it goes in with the rest
+        Layout();
+        return;
+    }
+    uint32_t slot = cell_starts_[cell] + cell_counts_[cell]++;
+    food_indices_[slot] = index;
+    food_slots_.push_back(slot);
+}
+
+void FoodGrid::Remove(size_t index) {
+    if (index >= food_count_) {
+        return;
+    }
+
+    // The last index in the same cell fills the gap, so the cell stays contiguous.
+    uint32_t cell = food_cells_[index];
+    uint32_t slot = food_slots_[index];
+    uint32_t last_slot = cell_starts_[cell] + --cell_counts_[cell];
+    uint32_t moved = food_indices_[last_slot];
+    food_indices_[slot] = moved;
+    food_slots_[moved] = slot;
+
+    // Then the last food takes over index, staying in its own cell and slot.
+    food_count_--;
+    if (index != food_count_) {
+        food_indices_[food_slots_[food_count_]] = (uint32_t) index;
+        food_cells_[index] = food_cells_[food_count_];
+        food_slots_[index] = food_slots_[food_count_];
+    }
+    food_cells_.pop_back();
+    food_slots_.pop_back();
+}
+
+void FoodGrid::RemoveLast() {
+    if (food_count_ > 0) {
+        Remove(food_count_ - 1);
+    }
+}
+
+void FoodGrid::Layout() {
+    // Count per cell, scan into starts with room to spare, then place every food index.
+    size_t cell_count = columns_ * rows_;
+    cell_counts_.assign(cell_count, 0);
+    for (size_t i = 0; i < food_count_; i++) {
+        cell_counts_[food_cells_[i]]++;
+    }
+
+    cell_starts_.resize(cell_count + 1);
+    cell_starts_[0] = 0;
+    for (size_t cell = 0; cell < cell_count; cell++) {
+        uint32_t room = cell_counts_[cell] + cell_counts_[cell] / CELL_ROOM_DIVISOR + MIN_CELL_ROOM;
+        cell_starts_[cell + 1] = cell_starts_[cell] + room;
+    }
+
+    food_indices_.resize(cell_starts_[cell_count]);
+    food_slots_.resize(food_count_);
+    std::fill(cell_counts_.begin(), cell_counts_.end(), 0);
+    for (size_t i = 0; i < food_count_; i++) {
+        uint32_t cell = food_cells_[i];
+        uint32_t slot = cell_starts_[cell] + cell_counts_[cell]++;
+        food_indices_[slot] = (uint32_t) i;
+        food_slots_[i] = slot;
+    }
+}
+
+size_t FoodGrid::Size() const {
+    return food_count_;
+}
+
+// Positions outside the bounds fall into the edge cells, so every food is somewhere in the grid.
+size_t FoodGrid::CellColumn(float x) const {
+    float column = std::floor((x - min_x_) * inverse_cell_size_);
+    return (size_t) std::min(std::max(column, 0.0f), (float) (columns_ - 1));
+}
+
+size_t FoodGrid::CellRow(float y) const {
+    float row = std::floor((y - min_y_) * inverse_cell_size_);
+    return (size_t) std::min(std::max(row, 0.0f), (float) (rows_ - 1));
+}
+
+}
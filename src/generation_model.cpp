@@ -0,0 +1,322 @@
+#include "generation_model.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace naturalselection {
+
+// Pulls the weights of the standardized features towards 0, so a window in which a trait
+// hardly varies can't give it a wild slope that only shows once the traits drift.
+static const double RIDGE = 1.0;
+// Just enough to keep the intercept finite when every creature in the window fared the same.
+static const double INTERCEPT_RIDGE = 1e-6;
+static const size_t MAX_NEWTON_STEPS = 50;
+static const double NEWTON_TOLERANCE = 1e-8;
+
+static double Sigmoid(double z) {
+    return 1.0 / (1.0 + std::exp(-std::min(std::max(z, -40.0), 40.0)));
+}
+
+// Solves matrix * x = vector in place by Gaussian elimination with partial pivoting, leaving x
+// in vector. A pivot of 0 leaves that unknown at 0.
+static void Solve(std::array<std::array<double, GenerationModel::FEATURE_COUNT>, GenerationModel::FEATURE_COUNT> &matrix,
+                  std::array<double, GenerationModel::FEATURE_COUNT> &vector) {
+    const size_t size = GenerationModel::FEATURE_COUNT;
+    for (size_t column = 0; column < size; column++) {
+        size_t pivot = column;
+        for (size_t row = column + 1; row < size; row++) {
+            if (std::abs(matrix[row][column]) > std::abs(matrix[pivot][column])) {
+                pivot = row;
+            }
+        }
+        std::swap(matrix[column], matrix[pivot]);
+        std::swap(vector[column], vector[pivot]);
+        if (matrix[column][column] == 0) {
+            continue;
+        }
+
+        for (size_t row = column + 1; row < size; row++) {
+            double factor = matrix[row][column] / matrix[column][column];
+            for (size_t k = column; k < size; k++) {
+                matrix[row][k] -= factor * matrix[column][k];
+            }
+            vector[row] -= factor * vector[column];
+        }
+    }
+
+    for (size_t column = size; column-- > 0;) {
+        double sum = vector[column];
+        for (size_t k = column + 1; k < size; k++) {
+            sum -= matrix[column][k] * vector[k];
+        }
+        vector[column] = matrix[column][column] == 0 ? 0 : sum / matrix[column][column];
+    }
+}
+
+void GenerationModel::SetWindow(size_t generations) {
+    window_ = std::max(generations, (size_t) 1);
+    while (generations_.size() > window_) {
+        generations_.erase(generations_.begin());
+    }
+}
+
+size_t GenerationModel::GetWindow() const {
+    return window_;
+}
+
+void GenerationModel::Observe(const std::vector<Creature> &creatures, size_t food_count) {
+    float crowding = GetCrowding(creatures.size(), food_count);
+    std::vector<Sample> generation(creatures.size());
+    for (size_t i = 0; i < creatures.size(); i++) {
+        generation[i].speed = creatures[i].GetMaxVelocity();
+        generation[i].vision = (float) creatures[i].GetVisionRadius();
+        generation[i].crowding = crowding;
+        generation[i].type = (uint8_t) creatures[i].GetCreatureType();
+        generation[i].food = (uint8_t) std::min(std::max(creatures[i].GetFood(), 0), 2);
+    }
+
+    generations_.push_back(generation);
+    if (generations_.size() > window_) {
+        generations_.erase(generations_.begin());
+    }
+}
+
+bool GenerationModel::Fit() {
+    size_t sample_count = 0;
+    for (size_t g = 0; g < generations_.size(); g++) {
+        sample_count += generations_[g].size();
+    }
+    if (sample_count < MIN_FIT_SAMPLES) {
+        return false;
+    }
+
+    // Each generation is held out in turn and scored against the overall rates of the rest. Every
+    // generation has its own crowding, so this is also how well the fit carries over to new crowding.
+    double brier_score = 0;
+    double baseline_brier_score = 0;
+    for (size_t held_out = 0; generations_.size() > 1 && held_out < generations_.size(); held_out++) {
+        if (sample_count - generations_[held_out].size() < MIN_FIT_SAMPLES) {
+            continue;
+        }
+
+        FitTo(held_out);
+        for (const Sample &sample : generations_[held_out]) {
+            std::array<double, 3> chances = PredictFeatures(GetFeatures(sample.speed, sample.vision,
+                                                                        sample.crowding, sample.type));
+            for (size_t k = 0; k < 3; k++) {
+                double happened = k == sample.food ? 1 : 0;
+                brier_score += (chances[k] - happened) * (chances[k] - happened);
+                baseline_brier_score += (base_rates_[k] - happened) * (base_rates_[k] - happened);
+            }
+        }
+    }
+    using_base_rates_ = brier_score > baseline_brier_score;
+
+    FitTo(SIZE_MAX);
+    fitted_ = true;
+    return true;
+}
+
+void GenerationModel::FitTo(size_t held_out) {
+    size_t sample_count = 0;
+    for (size_t g = 0; g < generations_.size(); g++) {
+        sample_count += g != held_out ? generations_[g].size() : 0;
+    }
+
+    // Traits are standardized over the window, so the ridge treats them alike whatever their units.
+    std::array<double, 3> sums = {};
+    std::array<double, 3> squares = {};
+    for (size_t g = 0; g < generations_.size(); g++) {
+        if (g == held_out) {
+            continue;
+        }
+        for (const Sample &sample : generations_[g]) {
+            double values[3] = {sample.speed, sample.vision, sample.crowding};
+            for (size_t k = 0; k < 3; k++) {
+                sums[k] += values[k];
+                squares[k] += values[k] * values[k];
+            }
+        }
+    }
+    for (size_t k = 0; k < 3; k++) {
+        double mean = sums[k] / sample_count;
+        double deviation = std::sqrt(std::max(squares[k] / sample_count - mean * mean, 0.0));
+        means_[k] = (float) mean;
+        scales_[k] = deviation > 1e-6 ? (float) deviation : 1.0f;
+    }
+
+    std::vector<Features> rows;
+    std::vector<uint8_t> ate;
+    std::vector<Features> fed_rows;
+    std::vector<uint8_t> ate_twice;
+    std::array<size_t, 3> outcome_counts = {};
+    for (size_t g = 0; g < generations_.size(); g++) {
+        if (g == held_out) {
+            continue;
+        }
+        for (const Sample &sample : generations_[g]) {
+            Features features = GetFeatures(sample.speed, sample.vision, sample.crowding, sample.type);
+            rows.push_back(features);
+            ate.push_back(sample.food > 0 ? 1 : 0);
+            if (sample.food > 0) {
+                fed_rows.push_back(features);
+                ate_twice.push_back(sample.food > 1 ? 1 : 0);
+            }
+            outcome_counts[sample.food]++;
+        }
+    }
+
+    survival_weights_ = FitLogistic(rows, ate);
+    reproduction_weights_ = FitLogistic(fed_rows, ate_twice);
+    if (fed_rows.empty()) { // Nothing to go on, and nothing ate, so nothing eats twice either
+        reproduction_weights_[0] = -40;
+    }
+    for (size_t k = 0; k < 3; k++) {
+        base_rates_[k] = (double) outcome_counts[k] / sample_count;
+    }
+}
+
+bool GenerationModel::IsFitted() const {
+    return fitted_;
+}
+
+bool GenerationModel::IsUsingBaseRates() const {
+    return using_base_rates_;
+}
+
+std::array<double, 3> GenerationModel::Predict(const Creature &creature, size_t population, size_t food_count) const {
+    if (using_base_rates_) {
+        return base_rates_;
+    }
+    return PredictFeatures(GetFeatures(creature.GetMaxVelocity(), (float) creature.GetVisionRadius(),
+                                       GetCrowding(population, food_count), creature.GetCreatureType()));
+}
+
+std::array<double, 3> GenerationModel::PredictFeatures(const Features &features) const {
+    double survival = 0;
+    double reproduction = 0;
+    for (size_t k = 0; k < FEATURE_COUNT; k++) {
+        survival += survival_weights_[k] * features[k];
+        reproduction += reproduction_weights_[k] * features[k];
+    }
+    survival = Sigmoid(survival);
+    reproduction = Sigmoid(reproduction);
+    return std::array<double, 3>{1 - survival, survival * (1 - reproduction), survival * reproduction};
+}
+
+void GenerationModel::DrawOutcomes(const std::vector<Creature> &creatures, size_t food_count, size_t meal_budget,
+                                   uint64_t seed, std::vector<int> &food) const {
+    food.assign(creatures.size(), 0);
+    std::vector<std::pair<double, size_t>> order(creatures.size()); // Priority to keep its meals, and creature
+    size_t meals = 0;
+    for (size_t i = 0; i < creatures.size(); i++) {
+        std::array<double, 3> chances = Predict(creatures[i], creatures.size(), food_count);
+        RandomStream random = RandomStream::ForCreature(seed, i);
+        double draw = random.NextUnitFloat();
+        food[i] = draw < chances[0] ? 0 : draw < chances[0] + chances[1] ? 1 : 2;
+        meals += food[i];
+
+        // A random order weighted by expected meals, as if creatures reached the food in turn.
+        double expected_meals = std::max(chances[1] + 2 * chances[2], 1e-9);
+        order[i] = std::make_pair(std::pow(std::max((double) random.NextUnitFloat(), 1e-12), 1 / expected_meals), i);
+    }
+    if (meals <= meal_budget) {
+        return;
+    }
+
+    std::sort(order.begin(), order.end(), std::greater<std::pair<double, size_t>>());
+    size_t left = meal_budget;
+    for (const std::pair<double, size_t> &entry : order) {
+        int kept = (int) std::min((size_t) food[entry.second], left);
+        food[entry.second] = kept;
+        left -= kept;
+    }
+}
+
+FastForwardReport GenerationModel::Score(const std::vector<Creature> &creatures, size_t food_count) const {
+    FastForwardReport report;
+    report.population = creatures.size();
+    for (size_t i = 0; i < creatures.size(); i++) {
+        std::array<double, 3> chances = Predict(creatures[i], creatures.size(), food_count);
+        int food = std::min(std::max(creatures[i].GetFood(), 0), 2);
+        for (int k = 0; k < 3; k++) {
+            double happened = k == food ? 1 : 0;
+            report.brier_score += (chances[k] - happened) * (chances[k] - happened);
+            report.baseline_brier_score += (base_rates_[k] - happened) * (base_rates_[k] - happened);
+        }
+        report.expected_survivors += chances[1] + chances[2];
+        report.expected_births += chances[2];
+        report.survivors += food > 0 ? 1 : 0;
+        report.births += food > 1 ? 1 : 0;
+    }
+
+    if (!creatures.empty()) {
+        report.brier_score /= creatures.size();
+        report.baseline_brier_score /= creatures.size();
+    }
+    return report;
+}
+
+size_t GenerationModel::GetObservedCount() const {
+    return generations_.size();
+}
+
+void GenerationModel::Clear() {
+    generations_.clear();
+    fitted_ = false;
+    using_base_rates_ = false;
+}
+
+GenerationModel::Features GenerationModel::GetFeatures(float speed, float vision, float crowding, int type) const {
+    double s = (speed - means_[0]) / scales_[0];
+    double v = (vision - means_[1]) / scales_[1];
+    double c = (crowding - means_[2]) / scales_[2];
+    // Speed creatures are the baseline the other two types are measured against.
+    return Features{1, s, v, s * s, v * v, s * v, c, type == INTELLIGENCE ? 1.0 : 0.0, type == BOTH ? 1.0 : 0.0};
+}
+
+GenerationModel::Features GenerationModel::FitLogistic(const std::vector<Features> &rows,
+                                                       const std::vector<uint8_t> &labels) {
+    Features weights = {};
+    for (size_t step = 0; step < MAX_NEWTON_STEPS; step++) {
+        std::array<std::array<double, FEATURE_COUNT>, FEATURE_COUNT> hessian = {};
+        Features gradient = {};
+        for (size_t i = 0; i < rows.size(); i++) {
+            double z = 0;
+            for (size_t a = 0; a < FEATURE_COUNT; a++) {
+                z += weights[a] * rows[i][a];
+            }
+            double p = Sigmoid(z);
+            double curvature = p * (1 - p);
+            for (size_t a = 0; a < FEATURE_COUNT; a++) {
+                gradient[a] += (labels[i] - p) * rows[i][a];
+                for (size_t b = 0; b < FEATURE_COUNT; b++) {
+                    hessian[a][b] += curvature * rows[i][a] * rows[i][b];
+                }
+            }
+        }
+        for (size_t a = 0; a < FEATURE_COUNT; a++) {
+            double ridge = a == 0 ? INTERCEPT_RIDGE : RIDGE;
+            gradient[a] -= ridge * weights[a];
+            hessian[a][a] += ridge;
+        }
+
+        Solve(hessian, gradient); // Leaves the Newton step in gradient
+        double largest_step = 0;
+        for (size_t a = 0; a < FEATURE_COUNT; a++) {
+            weights[a] += gradient[a];
+            largest_step = std::max(largest_step, std::abs(gradient[a]));
+        }
+        if (largest_step < NEWTON_TOLERANCE) {
+            break;
+        }
+    }
+    return weights;
+}
+
+float GenerationModel::GetCrowding(size_t population, size_t food_count) {
+    return std::log((float) std::max(population, (size_t) 1) / (float) std::max(food_count, (size_t) 1));
+}
+
+}
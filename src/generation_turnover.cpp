@@ -0,0 +1,146 @@
+#include "generation_turnover.h"
+#include "genome.h"
+#include "parallel_for.h"
+#include "random_stream.h"
+#include <algorithm>
+
+namespace naturalselection {
+
+// Below this many creatures per chunk, starting a thread costs more than it saves.
+static const size_t MIN_TURNOVER_CHUNK_SIZE = 16384;
+
+bool GenerationTurnover::Survives(const Creature &creature) {
+    return creature.GetFood() > 0;
+}
+
+bool GenerationTurnover::Reproduces(const Creature &creature) {
+    return creature.GetFood() > 1;
+}
+
+// Follows a run of consecutive indices into the full generation and says where each one lands
+// once the capacity has picked who stays: at its rank among the chosen, or nowhere.
+class OutputCursor {
+public:
+    OutputCursor(const std::vector<size_t> *chosen, size_t first_index) {
+        chosen_ = chosen;
+        next_index_ = first_index;
+        rank_ = 0;
+        if (chosen != nullptr) {
+            rank_ = std::lower_bound(chosen->begin(), chosen->end(), first_index) - chosen->begin();
+        }
+    }
+
+    bool Next(size_t &slot) {
+        size_t index = next_index_++;
+        if (chosen_ == nullptr) { // Everyone stays
+            slot = index;
+            return true;
+        }
+        if (rank_ < chosen_->size() && (*chosen_)[rank_] == index) {
+            slot = rank_++;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const std::vector<size_t> *chosen_;
+    size_t next_index_;
+    size_t rank_;
+};
+
+void GenerationTurnover::Run(const std::vector<Creature> &parents, std::vector<Creature> &next_generation,
+                             uint64_t seed, size_t thread_count) {
+    Run(parents, next_generation, seed, CarryingCapacity(), thread_count);
+}
+
+size_t GenerationTurnover::Run(const std::vector<Creature> &parents, std::vector<Creature> &next_generation,
+                               uint64_t seed, const CarryingCapacity &capacity, size_t thread_count) {
+    size_t count = parents.size();
+    size_t chunk_count = ChunkCountFor(count, thread_count, MIN_TURNOVER_CHUNK_SIZE);
+
+    // Pass 1: count survivors and births per chunk.
+    std::vector<size_t> survivor_counts(chunk_count, 0);
+    std::vector<size_t> birth_counts(chunk_count, 0);
+    ParallelForChunks(count, chunk_count, [&](size_t chunk, size_t begin, size_t end) {
+        size_t survivors = 0;
+        size_t births = 0;
+        for (size_t i = begin; i < end; i++) {
+            survivors += Survives(parents[i]) ? 1 : 0;
+            births += Reproduces(parents[i]) ? 1 : 0;
+        }
+        survivor_counts[chunk] = survivors;
+        birth_counts[chunk] = births;
+    });
+
+    // Exclusive scan. Children go after every survivor, so their offsets start at the survivor total.
+    std::vector<size_t> survivor_offsets(chunk_count, 0);
+    std::vector<size_t> birth_offsets(chunk_count, 0);
+    size_t total_survivors = 0;
+    for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+        survivor_offsets[chunk] = total_survivors;
+        total_survivors += survivor_counts[chunk];
+    }
+
+    size_t total_births = 0;
+    for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+        birth_offsets[chunk] = total_survivors + total_births;
+        total_births += birth_counts[chunk];
+    }
+
+    // The counts are all the capacity needs, so the creatures it would cull are never built.
+    size_t total = total_survivors + total_births;
+    std::vector<size_t> chosen;
+    const std::vector<size_t> *kept = capacity.Choose(parents, total, seed, chosen) ? &chosen : nullptr;
+
+    // Pass 2: every chunk writes into its own disjoint slice of the output. Children are
+    // mutated together as a GenomeBatch, with each parent's samples drawn in trait order
+    // exactly as Creature::CreateChild would draw them.
+    next_generation.resize(kept != nullptr ? kept->size() : total);
+    ParallelForChunks(count, chunk_count, [&](size_t chunk, size_t begin, size_t end) {
+        OutputCursor survivor_cursor(kept, survivor_offsets[chunk]);
+        OutputCursor birth_cursor(kept, birth_offsets[chunk]);
+        std::vector<size_t> breeders;
+        std::vector<size_t> birth_slots;
+        breeders.reserve(birth_counts[chunk]);
+        birth_slots.reserve(birth_counts[chunk]);
+        for (size_t i = begin; i < end; i++) {
+            const Creature &parent = parents[i];
+            if (!Survives(parent)) { // Remove dead creatures
+                continue;
+            }
+
+            size_t slot;
+            if (survivor_cursor.Next(slot)) {
+                next_generation[slot] = parent;
+            }
+            if (Reproduces(parent) && birth_cursor.Next(slot)) {
+                breeders.push_back(i);
+                birth_slots.push_back(slot);
+            }
+        }
+
+        GenomeBatch batch;
+        batch.Resize(breeders.size());
+        for (size_t j = 0; j < breeders.size(); j++) {
+            const Creature &parent = parents[breeders[j]];
+            Genome genome = Genome::Inherit(parent);
+            RandomStream stream = RandomStream::ForCreature(seed, breeders[j]);
+            for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+                batch.traits[trait][j] = genome.GetTrait((int) trait);
+                batch.unit_samples[trait][j] = stream.NextUnitFloat();
+            }
+            batch.creature_type[j] = parent.GetCreatureType();
+        }
+        batch.Mutate();
+
+        // Spawn new creatures based on surviving ones
+        for (size_t j = 0; j < breeders.size(); j++) {
+            next_generation[birth_slots[j]] = batch.CreateCreature(j, parents[breeders[j]]);
+        }
+    });
+
+    return total - next_generation.size();
+}
+
+}
@@ -0,0 +1,266 @@
+#include "genome.h"
+#include "creature.h"
+#include <cmath>
+
+namespace naturalselection {
+
+using glm::vec2;
+
+// Increase in speed: exponentially increased cost. Decrease: logarithmically decreasing cost.
+static double SpeedCostCurve(double ratio) {
+    if (ratio > 1) {
+        return pow(ratio, 2);
+    } else if (ratio < 1) {
+        return 1 - log(1 + (1 - ratio));
+    }
+    return 1;
+}
+
+// Increase or decrease in vision: logarithmically changing cost.
+static double VisionCostCurve(double ratio) {
+    if (ratio > 1) {
+        return 1 + log(ratio);
+    } else if (ratio < 1) {
+        return 1 - log(1 + (1 - ratio));
+    }
+    return 1;
+}
+
+// Indexed by GenomeTrait.
+static const TraitSpec TRAIT_SPECS[TRAIT_COUNT] = {
+        {"max_velocity", DEFAULT_MAX_VELOCITY, 0.1f, SpeedCostCurve},          // 10% faster or slower
+        {"vision_radius", (float) DEFAULT_VISION_RADIUS, 0.5f, VisionCostCurve} // 50% larger or smaller
+};
+
+// Tables cover traits up to this many times their default, which generations of mutation rarely exceed.
+static const double COST_TABLE_MAX_RATIO = 4.0;
+static const size_t COST_TABLE_RESOLUTION = 4096;
+
+static const std::vector<CostTable> &GetCostTables() {
+    static const std::vector<CostTable> tables = []() {
+        std::vector<CostTable> built;
+        for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+            built.push_back(CostTable(TRAIT_SPECS[trait].cost_curve, COST_TABLE_MAX_RATIO, COST_TABLE_RESOLUTION));
+        }
+        return built;
+    }();
+    return tables;
+}
+
+CostTable::CostTable(CostCurve curve, double max_ratio, size_t resolution) {
+    curve_ = curve;
+    max_ratio_ = (float) max_ratio;
+    samples_per_unit_ = (float) (resolution / max_ratio);
+
+    // Resolution is a multiple of max_ratio, so a ratio of exactly 1 lands on a sample.
+    samples_.resize(resolution + 1);
+    for (size_t i = 0; i <= resolution; i++) {
+        samples_[i] = (float) curve(max_ratio * i / resolution);
+    }
+}
+
+float CostTable::Lookup(float ratio) const {
+    if (!(ratio >= 0.0f) || ratio >= max_ratio_) {
+        return (float) curve_(ratio);
+    }
+
+    float position = ratio * samples_per_unit_;
+    size_t index = (size_t) position;
+    float fraction = position - (float) index;
+    return samples_[index] + (samples_[index + 1] - samples_[index]) * fraction;
+}
+
+Genome::Genome() {
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        traits_[trait] = TRAIT_SPECS[trait].default_value;
+    }
+}
+
+Genome Genome::FromCreature(const Creature &creature) {
+    Genome genome;
+    genome.traits_[TRAIT_MAX_VELOCITY] = creature.GetMaxVelocity();
+    genome.traits_[TRAIT_VISION_RADIUS] = (float) creature.GetVisionRadius();
+    return genome;
+}
+
+Genome Genome::Inherit(const Creature &parent) {
+    Genome genome = FromCreature(parent);
+    uint32_t inherited_traits = GetInheritedTraits(parent.GetCreatureType());
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        if (!(inherited_traits & (1u << trait))) {
+            genome.traits_[trait] = TRAIT_SPECS[trait].default_value;
+        }
+    }
+    return genome;
+}
+
+uint32_t Genome::GetInheritedTraits(int creature_type) {
+    if (creature_type == BOTH) {
+        return 1u << TRAIT_MAX_VELOCITY;
+    }
+    return (1u << TRAIT_COUNT) - 1;
+}
+
+const TraitSpec &Genome::GetTraitSpec(int trait) {
+    return TRAIT_SPECS[trait];
+}
+
+uint32_t Genome::GetActiveTraits(int creature_type) {
+    if (creature_type == SPEED) {
+        return 1u << TRAIT_MAX_VELOCITY;
+    } else if (creature_type == INTELLIGENCE) {
+        return 1u << TRAIT_VISION_RADIUS;
+    } else if (creature_type == BOTH) {
+        return (1u << TRAIT_MAX_VELOCITY) | (1u << TRAIT_VISION_RADIUS);
+    }
+    return 0;
+}
+
+uint32_t Genome::GetCostedTraits(int creature_type) {
+    if (creature_type == BOTH) {
+        return 0;
+    }
+    return GetActiveTraits(creature_type);
+}
+
+uint32_t Genome::GetInheritedCostTraits(int creature_type) {
+    if (creature_type == INTELLIGENCE) {
+        return 1u << TRAIT_VISION_RADIUS;
+    }
+    return 0;
+}
+
+float Genome::GetCostMultiplier(int trait, float value) {
+    return GetCostTables()[trait].Lookup(value / TRAIT_SPECS[trait].default_value);
+}
+
+float Genome::GetTrait(int trait) const {
+    return traits_[trait];
+}
+
+void Genome::SetTrait(int trait, float value) {
+    traits_[trait] = value;
+}
+
+void Genome::Mutate(int creature_type, const float *unit_samples) {
+    uint32_t active_traits = GetActiveTraits(creature_type);
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        if (active_traits & (1u << trait)) {
+            float value = traits_[trait];
+            float margins = value * TRAIT_SPECS[trait].mutation_margin;
+            traits_[trait] = ((2 * margins) * unit_samples[trait]) + (value - margins); // Random mutation
+        }
+    }
+}
+
+double Genome::CalculateEnergySpend(int creature_type, const Genome &inherited) const {
+    // Each costed trait adds its own change in cost on top of the default spend.
+    uint32_t costed_traits = GetCostedTraits(creature_type);
+    uint32_t inherited_cost_traits = GetInheritedCostTraits(creature_type);
+    double multiplier = 1;
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        if (costed_traits & (1u << trait)) {
+            float value = (inherited_cost_traits & (1u << trait)) ? inherited.traits_[trait] : traits_[trait];
+            multiplier += GetCostMultiplier((int) trait, value) - 1;
+        }
+    }
+
+    return DEFAULT_ENERGY_SPEND * multiplier;
+}
+
+double Genome::CalculateEnergySpend(int creature_type) const {
+    return CalculateEnergySpend(creature_type, *this);
+}
+
+Creature Genome::CreateCreature(const Creature &parent, int creature_type, const Genome &inherited) const {
+    Creature child = Creature(creature_type, vec2(0, 0), vec2(0, 0), parent.GetRadius(),
+                              parent.GetMass(), 0.0, 0,
+                              (double) traits_[TRAIT_VISION_RADIUS], CalculateEnergySpend(creature_type, inherited),
+                              traits_[TRAIT_MAX_VELOCITY]);
+    child.SetParentId(parent.GetId());
+    return child;
+}
+
+void GenomeBatch::Resize(size_t count) {
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        traits[trait].resize(count);
+        unit_samples[trait].resize(count);
+    }
+    creature_type.resize(count);
+    energy_spend.resize(count);
+}
+
+size_t GenomeBatch::Size() const {
+    return creature_type.size();
+}
+
+void GenomeBatch::Mutate() {
+    size_t count = Size();
+    std::vector<uint32_t> active_traits(count);
+    std::vector<uint32_t> costed_traits(count);
+    std::vector<uint32_t> inherited_cost_traits(count);
+    for (size_t i = 0; i < count; i++) {
+        active_traits[i] = Genome::GetActiveTraits(creature_type[i]);
+        costed_traits[i] = Genome::GetCostedTraits(creature_type[i]);
+        inherited_cost_traits[i] = Genome::GetInheritedCostTraits(creature_type[i]);
+    }
+
+    std::vector<double> multipliers(count, 1.0);
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        uint32_t trait_bit = 1u << trait;
+        float margin = TRAIT_SPECS[trait].mutation_margin;
+        float *values = traits[trait].data();
+        const float *samples = unit_samples[trait].data();
+        const uint32_t *active = active_traits.data();
+        const CostTable &table = GetCostTables()[trait];
+        float default_value = TRAIT_SPECS[trait].default_value;
+
+        // Traits paid for at their inherited value are costed before they mutate, the rest after.
+        for (size_t i = 0; i < count; i++) {
+            if ((costed_traits[i] & inherited_cost_traits[i]) & trait_bit) {
+                multipliers[i] += table.Lookup(values[i] / default_value) - 1;
+            }
+        }
+
+        // Same arithmetic as Genome::Mutate, as a select instead of a branch.
+        for (size_t i = 0; i < count; i++) {
+            float margins = values[i] * margin;
+            float mutated = ((2 * margins) * samples[i]) + (values[i] - margins);
+            values[i] = (active[i] & trait_bit) ? mutated : values[i];
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if ((costed_traits[i] & ~inherited_cost_traits[i]) & trait_bit) {
+                multipliers[i] += table.Lookup(values[i] / default_value) - 1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        energy_spend[i] = DEFAULT_ENERGY_SPEND * multipliers[i];
+    }
+}
+
+Genome GenomeBatch::GetGenome(size_t index) const {
+    Genome genome;
+    for (size_t trait = 0; trait < TRAIT_COUNT; trait++) {
+        genome.SetTrait((int) trait, traits[trait][index]);
+    }
+    return genome;
+}
+
+Creature GenomeBatch::CreateCreature(size_t index, const Creature &parent) const {
+    int type = creature_type[index];
+    if (Genome::GetActiveTraits(type) == 0) { // Same as Creature::CreateChild for unknown types
+        return Creature();
+    }
+
+    Creature child = Creature(type, vec2(0, 0), vec2(0, 0), parent.GetRadius(),
+                              parent.GetMass(), 0.0, 0,
+                              (double) traits[TRAIT_VISION_RADIUS][index], energy_spend[index],
+                              traits[TRAIT_MAX_VELOCITY][index]);
+    child.SetParentId(parent.GetId());
+    return child;
+}
+
+}
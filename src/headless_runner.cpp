@@ -0,0 +1,182 @@
+#include "headless_runner.h"
+#include "environment.h"
+#include "metrics_server.h"
+#include <cstdlib>
+#include <sstream>
+
+namespace naturalselection {
+
+std::string SweepJob::Serialize() const {
+    std::ostringstream line;
+    line << "job " << id << " " << attempt << " " << seed << " " << food_count << " "
+         << speed_creatures << " " << intelligence_creatures << " " << both_type_creatures << " "
+         << creatures_per_type << " " << collisions_enabled << " " << generations << " " << max_ticks << " "
+         << carrying_capacity << " " << capacity_policy << " " << food_mode << " " << metrics_port << " ";
+    line.precision(9); // Enough that the rates read back exactly
+    line << time_step << " " << food_regrowth_rate << " " << fast_forward_calibration << " " << fast_forward_skipped;
+    return line.str();
+}
+
+bool SweepJob::Parse(const std::string &line, SweepJob &job) {
+    std::istringstream fields(line);
+    std::string tag;
+    SweepJob parsed;
+    fields >> tag >> parsed.id >> parsed.attempt >> parsed.seed >> parsed.food_count
+           >> parsed.speed_creatures >> parsed.intelligence_creatures >> parsed.both_type_creatures
+           >> parsed.creatures_per_type >> parsed.collisions_enabled >> parsed.generations >> parsed.max_ticks
+           >> parsed.carrying_capacity >> parsed.capacity_policy >> parsed.food_mode >> parsed.metrics_port
+           >> parsed.time_step >> parsed.food_regrowth_rate >> parsed.fast_forward_calibration
+           >> parsed.fast_forward_skipped;
+    if (fields.fail() || tag != "job" || !(parsed.time_step > 0)) { // A step of 0 never ends a generation
+        return false;
+    }
+
+    job = parsed;
+    return true;
+}
+
+std::string SweepResult::Serialize() const {
+    std::ostringstream line;
+    line << "result " << job_id << " " << seed << " " << generations_run << " " << ticks << " "
+         << speed_count << " " << intelligence_count << " " << both_type_count << " " << hit_tick_limit << " "
+         << carrying_capacity << " " << capacity_policy << " " << capacity_removed << " " << peak_memory_bytes;
+    for (size_t subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        line << " " << peak_subsystem_bytes[subsystem];
+    }
+    return line.str();
+}
+
+bool SweepResult::Parse(const std::string &line, SweepResult &result) {
+    std::istringstream fields(line);
+    std::string tag;
+    SweepResult parsed;
+    fields >> tag >> parsed.job_id >> parsed.seed >> parsed.generations_run >> parsed.ticks
+           >> parsed.speed_count >> parsed.intelligence_count >> parsed.both_type_count >> parsed.hit_tick_limit
+           >> parsed.carrying_capacity >> parsed.capacity_policy >> parsed.capacity_removed >> parsed.peak_memory_bytes;
+    for (size_t subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        fields >> parsed.peak_subsystem_bytes[subsystem];
+    }
+    if (fields.fail() || tag != "result") {
+        return false;
+    }
+
+    result = parsed;
+    return true;
+}
+
+const char *SweepResult::CsvHeader() {
+    static const std::string header = []() {
+        std::string columns = "job_id,seed,generations_run,ticks,speed_count,intelligence_count,both_type_count,"
+                              "hit_tick_limit,carrying_capacity,capacity_policy,capacity_removed,peak_memory_bytes";
+        for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+            columns += std::string(",peak_") + MemoryLedger::GetSubsystemName(subsystem) + "_bytes";
+        }
+        return columns;
+    }();
+    return header.c_str();
+}
+
+std::string SweepResult::ToCsvRow() const {
+    std::ostringstream row;
+    row << job_id << "," << seed << "," << generations_run << "," << ticks << ","
+        << speed_count << "," << intelligence_count << "," << both_type_count << "," << hit_tick_limit << ","
+        << carrying_capacity << "," << CarryingCapacity::GetPolicyName(capacity_policy) << "," << capacity_removed << ","
+        << peak_memory_bytes;
+    for (size_t subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        row << "," << peak_subsystem_bytes[subsystem];
+    }
+    return row.str();
+}
+
+SweepResult HeadlessRunner::Run(const SweepJob &job) {
+    srand(job.seed); // Food spawns and mutation seeds all come from rand()
+
+    Environment environment = Environment();
+    SetUp(job, environment);
+
+    SimulationMetrics metrics;
+    MetricsServer metrics_server(metrics);
+    bool serving_metrics = job.metrics_port != 0 && metrics_server.Start(job.metrics_port);
+
+    SweepResult result;
+    result.job_id = job.id;
+    result.seed = job.seed;
+
+    uint64_t frames = 0;
+    while (!IsFinished(job, environment)) {
+        if (frames >= job.max_ticks) {
+            result.hit_tick_limit = true;
+            break;
+        }
+
+        StepFrame(environment);
+        frames++;
+        if (serving_metrics) {
+            metrics.Record(environment);
+        }
+    }
+
+    result.generations_run = environment.GetTrialsRun();
+    result.ticks = environment.GetTick();
+    result.speed_count = environment.GetSpeedCount();
+    result.intelligence_count = environment.GetIntelligenceCount();
+    result.both_type_count = environment.GetBothTypeCount();
+    result.carrying_capacity = job.carrying_capacity;
+    result.capacity_policy = job.capacity_policy;
+    result.capacity_removed = environment.GetCapacityRemovedCount();
+
+    const MemoryLedger &memory = environment.GetMemoryLedger();
+    result.peak_memory_bytes = memory.GetTotal().peak_bytes;
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        result.peak_subsystem_bytes[subsystem] = memory.GetUsage(subsystem).peak_bytes;
+    }
+    return result;
+}
+
+void HeadlessRunner::SetUp(const SweepJob &job, Environment &environment) {
+    for (size_t count = DEFAULT_FOOD_COUNT; count < job.food_count; count++) {
+        environment.IncreaseFoodCount();
+    }
+    for (size_t count = DEFAULT_FOOD_COUNT; count > job.food_count; count--) {
+        environment.DecreaseFoodCount();
+    }
+    environment.SetFoodMode(job.food_mode);
+    environment.RefreshFood();
+
+    size_t creature_count = job.creatures_per_type == 0 ? DEFAULT_COUNT : job.creatures_per_type;
+    if (job.speed_creatures) {
+        environment.AddSpeedCreatures(creature_count);
+    }
+    if (job.intelligence_creatures) {
+        environment.AddIntelligenceCreatures(creature_count);
+    }
+    if (job.both_type_creatures) {
+        environment.AddBothTypeCreatures(creature_count);
+    }
+    environment.SetCollisionsEnabled(job.collisions_enabled);
+
+    CarryingCapacity capacity;
+    capacity.limit = job.carrying_capacity;
+    capacity.policy = job.capacity_policy;
+    environment.SetCarryingCapacity(capacity);
+
+    environment.SetTimeStep(job.time_step);
+    environment.SetFoodRegrowthRate(job.food_regrowth_rate);
+    if (job.fast_forward_skipped > 0) {
+        environment.SetFastForward(job.fast_forward_calibration, job.fast_forward_skipped);
+    }
+}
+
+bool HeadlessRunner::IsFinished(const SweepJob &job, Environment &environment) {
+    return !environment.AreThereCreaturesAlive() || environment.GetTrialsRun() >= job.generations;
+}
+
+void HeadlessRunner::StepFrame(Environment &environment) {
+    // Same as pressing return in the app once the previous generation is home.
+    if (!environment.GetIsRunning()) {
+        environment.SetIsRunning(true);
+    }
+    environment.AdvanceOneFrame();
+}
+
+}
@@ -187,6 +187,12 @@ void IntelligenceHistogram::SetParticles(std::vector<Creature> new_particles) {
     creatures_ = intelligence_creatures;
 }
 
+MemoryFootprint IntelligenceHistogram::GetMemoryFootprint() const {
+    MemoryFootprint footprint;
+    footprint.Add(creatures_);
+    return footprint;
+}
+
 // Source: https://www.codegrepper.com/code-examples/cpp/c%2B%2B+round+float+to+2+decimal+places
 std::string IntelligenceHistogram::FloatToStringPrecision(float value, unsigned char prec) const {
     std::stringstream ss;
@@ -0,0 +1,71 @@
+#include "memory_ledger.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace naturalselection {
+
+static const char *SUBSYSTEM_NAMES[MEMORY_SUBSYSTEM_COUNT] = {
+        "creatures",
+        "food",
+        "population_records",
+        "speed_histograms",
+        "intelligence_histograms",
+        "scatter_plots",
+        "population_graphs",
+        "phylogeny",
+};
+
+void MemoryFootprint::Add(const MemoryFootprint &other) {
+    bytes += other.bytes;
+    allocations += other.allocations;
+}
+
+static void UpdateUsage(MemoryUsage &usage, const MemoryFootprint &footprint) {
+    usage.bytes = footprint.bytes;
+    usage.allocations = footprint.allocations;
+    usage.peak_bytes = std::max(usage.peak_bytes, footprint.bytes);
+    usage.peak_allocations = std::max(usage.peak_allocations, footprint.allocations);
+}
+
+static std::string FormatKilobytes(size_t bytes) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << (double) bytes / 1024.0 << " KB";
+    return ss.str();
+}
+
+const char *MemoryLedger::GetSubsystemName(int subsystem) {
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+void MemoryLedger::Record(const std::array<MemoryFootprint, MEMORY_SUBSYSTEM_COUNT> &footprints) {
+    MemoryFootprint total;
+    for (size_t subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        UpdateUsage(usage_[subsystem], footprints[subsystem]);
+        total.Add(footprints[subsystem]);
+    }
+    UpdateUsage(total_, total);
+}
+
+const MemoryUsage &MemoryLedger::GetUsage(int subsystem) const {
+    return usage_.at(subsystem);
+}
+
+const MemoryUsage &MemoryLedger::GetTotal() const {
+    return total_;
+}
+
+std::vector<std::string> MemoryLedger::FormatLines() const {
+    std::vector<std::string> lines;
+    for (int subsystem = 0; subsystem <= MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        bool is_total = subsystem == MEMORY_SUBSYSTEM_COUNT;
+        const MemoryUsage &usage = is_total ? total_ : usage_[subsystem];
+        lines.push_back(std::string(is_total ? "total" : SUBSYSTEM_NAMES[subsystem]) + ": " +
+                        FormatKilobytes(usage.bytes) + " (peak " + FormatKilobytes(usage.peak_bytes) + "), " +
+                        std::to_string(usage.allocations) + " allocations (peak " +
+                        std::to_string(usage.peak_allocations) + ")");
+    }
+    return lines;
+}
+
+}
@@ -0,0 +1,263 @@
+#include "metrics_server.h"
+#include "environment.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace naturalselection {
+
+// Ticks per second is measured over windows of about this long, so it follows changes in speed
+// without jumping around from one tick to the next.
+static const double RATE_WINDOW_SECONDS = 1.0;
+// A scraper that connects and then says nothing is dropped after this long.
+static const int REQUEST_TIMEOUT_SECONDS = 1;
+// Longest request read. Prometheus sends a few hundred bytes of headers.
+static const size_t MAX_REQUEST_BYTES = 8192;
+static const int LISTEN_BACKLOG = 8;
+
+static const char *METRIC_PREFIX = "naturalselection_";
+
+SimulationMetrics::SimulationMetrics()
+        : tick_(0), generation_(0), ticks_per_second_(0), speed_count_(0), intelligence_count_(0),
+          both_type_count_(0), food_remaining_(0) {
+    for (size_t subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        memory_bytes_[subsystem].store(0);
+        peak_memory_bytes_[subsystem].store(0);
+    }
+}
+
+void SimulationMetrics::Record(const WorldSnapshot &snapshot, Clock::time_point now) {
+    Store(snapshot.tick, snapshot.trials_run, snapshot.speed_count, snapshot.intelligence_count,
+          snapshot.both_type_count, snapshot.food.size(), snapshot.memory, now);
+}
+
+void SimulationMetrics::Record(const Environment &environment, Clock::time_point now) {
+    Store(environment.GetTick(), environment.GetTrialsRun(), environment.GetSpeedCount(),
+          environment.GetIntelligenceCount(), environment.GetBothTypeCount(), environment.GetFood().size(),
+          environment.GetMemoryLedger(), now);
+}
+
+void SimulationMetrics::Store(uint64_t tick, uint64_t generation, int speed_count, int intelligence_count,
+                              int both_type_count, size_t food_remaining, const MemoryLedger &memory,
+                              Clock::time_point now) {
+    // Relaxed throughout: every value is independent, and readers only need each one to be whole.
+    tick_.store(tick, std::memory_order_relaxed);
+    generation_.store(generation, std::memory_order_relaxed);
+    speed_count_.store(speed_count, std::memory_order_relaxed);
+    intelligence_count_.store(intelligence_count, std::memory_order_relaxed);
+    both_type_count_.store(both_type_count, std::memory_order_relaxed);
+    food_remaining_.store(food_remaining, std::memory_order_relaxed);
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        memory_bytes_[subsystem].store(memory.GetUsage(subsystem).bytes, std::memory_order_relaxed);
+        peak_memory_bytes_[subsystem].store(memory.GetUsage(subsystem).peak_bytes, std::memory_order_relaxed);
+    }
+
+    if (!has_window_ || tick < window_start_tick_) {
+        has_window_ = true;
+        window_start_ = now;
+        window_start_tick_ = tick;
+        return;
+    }
+
+    double elapsed = std::chrono::duration<double>(now - window_start_).count();
+    if (elapsed >= RATE_WINDOW_SECONDS) {
+        ticks_per_second_.store((double) (tick - window_start_tick_) / elapsed, std::memory_order_relaxed);
+        window_start_ = now;
+        window_start_tick_ = tick;
+    }
+}
+
+// Writes the HELP and TYPE lines that come before a metric's samples.
+static void WriteHeader(std::ostream &output, const char *name, const char *type, const char *help) {
+    output << "# HELP " << METRIC_PREFIX << name << " " << help << "\n";
+    output << "# TYPE " << METRIC_PREFIX << name << " " << type << "\n";
+}
+
+std::string SimulationMetrics::Format() const {
+    std::stringstream output;
+    WriteHeader(output, "ticks_total", "counter", "Ticks simulated since the run started.");
+    output << METRIC_PREFIX << "ticks_total " << tick_.load(std::memory_order_relaxed) << "\n";
+
+    WriteHeader(output, "ticks_per_second", "gauge", "Ticks simulated per second over the last second.");
+    output << METRIC_PREFIX << "ticks_per_second " << ticks_per_second_.load(std::memory_order_relaxed) << "\n";
+
+    WriteHeader(output, "generation", "gauge", "Generations finished so far.");
+    output << METRIC_PREFIX << "generation " << generation_.load(std::memory_order_relaxed) << "\n";
+
+    WriteHeader(output, "creatures", "gauge", "Creatures alive, by type.");
+    output << METRIC_PREFIX << "creatures{type=\"speed\"} " << speed_count_.load(std::memory_order_relaxed) << "\n";
+    output << METRIC_PREFIX << "creatures{type=\"intelligence\"} "
+           << intelligence_count_.load(std::memory_order_relaxed) << "\n";
+    output << METRIC_PREFIX << "creatures{type=\"both\"} " << both_type_count_.load(std::memory_order_relaxed)
+           << "\n";
+
+    WriteHeader(output, "food_remaining", "gauge", "Food left in the arena.");
+    output << METRIC_PREFIX << "food_remaining " << food_remaining_.load(std::memory_order_relaxed) << "\n";
+
+    WriteHeader(output, "memory_bytes", "gauge", "Heap memory held, by subsystem.");
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        output << METRIC_PREFIX << "memory_bytes{subsystem=\"" << MemoryLedger::GetSubsystemName(subsystem)
+               << "\"} " << memory_bytes_[subsystem].load(std::memory_order_relaxed) << "\n";
+    }
+
+    WriteHeader(output, "memory_peak_bytes", "gauge", "Most heap memory held so far, by subsystem.");
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        output << METRIC_PREFIX << "memory_peak_bytes{subsystem=\"" << MemoryLedger::GetSubsystemName(subsystem)
+               << "\"} " << peak_memory_bytes_[subsystem].load(std::memory_order_relaxed) << "\n";
+    }
+    return output.str();
+}
+
+MetricsServer::MetricsServer(const SimulationMetrics &metrics) : metrics_(metrics) {}
+
+MetricsServer::~MetricsServer() {
+    Stop();
+}
+
+bool MetricsServer::Start(uint16_t port) {
+    if (thread_.joinable()) {
+        return false;
+    }
+
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_socket_ < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Never reachable from other machines
+    address.sin_port = htons(port);
+    socklen_t address_size = sizeof(address);
+    if (bind(listen_socket_, (sockaddr *) &address, sizeof(address)) < 0 ||
+        listen(listen_socket_, LISTEN_BACKLOG) < 0 ||
+        getsockname(listen_socket_, (sockaddr *) &address, &address_size) < 0 || pipe(wake_pipe_) < 0) {
+        Stop();
+        return false;
+    }
+
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread(&MetricsServer::Serve, this);
+    return true;
+}
+
+void MetricsServer::Stop() {
+    if (thread_.joinable()) {
+        char wake = 0;
+        ssize_t written;
+        do {
+            written = write(wake_pipe_[1], &wake, 1);
+        } while (written < 0 && errno == EINTR);
+        thread_.join();
+    }
+
+    for (int *fd : {&listen_socket_, &wake_pipe_[0], &wake_pipe_[1]}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+uint16_t MetricsServer::GetPort() const {
+    return port_;
+}
+
+void MetricsServer::Serve() {
+    while (true) {
+        pollfd poll_fds[2];
+        poll_fds[0].fd = listen_socket_;
+        poll_fds[0].events = POLLIN;
+        poll_fds[1].fd = wake_pipe_[0];
+        poll_fds[1].events = POLLIN;
+        if (poll(poll_fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        if (poll_fds[1].revents != 0) { // Stop() was called
+            return;
+        }
+        if (poll_fds[0].revents & POLLIN) {
+            int connection = accept(listen_socket_, nullptr, nullptr);
+            if (connection >= 0) {
+                Respond(connection);
+                close(connection);
+            }
+        }
+    }
+}
+
+void MetricsServer::Respond(int connection) {
+    timeval timeout = {};
+    timeout.tv_sec = REQUEST_TIMEOUT_SECONDS;
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters, but the headers are read too so closing doesn't reset the connection.
+    std::string request;
+    char chunk[1024];
+    while (request.size() < MAX_REQUEST_BYTES && request.find("\r\n\r\n") == std::string::npos &&
+           request.find("\n\n") == std::string::npos) {
+        ssize_t received = recv(connection, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+        request.append(chunk, (size_t) received);
+    }
+
+    std::string method;
+    std::string target;
+    std::stringstream request_line(request.substr(0, request.find('\n')));
+    request_line >> method >> target;
+    target = target.substr(0, target.find('?'));
+
+    std::string status = "200 OK";
+    std::string body;
+    if (method.empty()) { // Closed or timed out before asking for anything
+        return;
+    } else if (method != "GET") {
+        status = "405 Method Not Allowed";
+        body = "Only GET is supported\n";
+    } else if (target != "/metrics") {
+        status = "404 Not Found";
+        body = "Metrics are at /metrics\n";
+    } else {
+        body = metrics_.Format();
+    }
+
+    std::stringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string message = response.str();
+
+    // MSG_NOSIGNAL so a scraper that hangs up early is an error here rather than SIGPIPE.
+    size_t sent = 0;
+    while (sent < message.size()) {
+        ssize_t written = send(connection, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+        sent += (size_t) written;
+    }
+}
+
+}
@@ -0,0 +1,79 @@
+#include "morton_order.h"
+#include <algorithm>
+
+namespace naturalselection {
+
+static const float MAX_COORDINATE = 65535.0f;
+static const int RADIX_BITS = 8;
+static const size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+
+// Spreads the low 16 bits of value out to the even bits. Source: "Bit Twiddling Hacks", interleave bits.
+static uint32_t SpreadBits(uint32_t value) {
+    value &= 0xFFFF;
+    value = (value | (value << 8)) & 0x00FF00FF;
+    value = (value | (value << 4)) & 0x0F0F0F0F;
+    value = (value | (value << 2)) & 0x33333333;
+    value = (value | (value << 1)) & 0x55555555;
+    return value;
+}
+
+static uint32_t Quantize(float value, float start, float length) {
+    float scaled = length > 0 ? (value - start) / length * MAX_COORDINATE : 0;
+    return (uint32_t) std::min(std::max(scaled, 0.0f), MAX_COORDINATE);
+}
+
+void SortByKeyHalf(std::vector<uint64_t> &keyed, std::vector<uint64_t> &scratch) {
+    // Least significant digit radix sort over the key half. Each pass is stable, so ties keep
+    // the order they came in.
+    scratch.resize(keyed.size());
+    for (int shift = 32; shift < 64; shift += RADIX_BITS) {
+        size_t counts[RADIX_BUCKETS] = {};
+        for (size_t i = 0; i < keyed.size(); i++) {
+            counts[(keyed[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+        if (std::count(counts, counts + RADIX_BUCKETS, keyed.size()) == 1) {
+            continue; // Every key has the same digit here
+        }
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            size_t count = counts[bucket];
+            counts[bucket] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < keyed.size(); i++) {
+            scratch[counts[(keyed[i] >> shift) & (RADIX_BUCKETS - 1)]++] = keyed[i];
+        }
+        keyed.swap(scratch);
+    }
+}
+
+uint32_t MortonSorter::GetKey(glm::vec2 position, const WorldBounds &bounds) {
+    uint32_t x = Quantize(position.x, bounds.x_coor, bounds.width);
+    uint32_t y = Quantize(position.y, bounds.y_coor, bounds.height);
+    return SpreadBits(x) | (SpreadBits(y) << 1);
+}
+
+const std::vector<uint32_t> &MortonSorter::GetOrder() const {
+    return order_;
+}
+
+bool MortonSorter::ComputeOrder() {
+    bool sorted = true;
+    for (size_t i = 1; i < keyed_.size() && sorted; i++) {
+        sorted = keyed_[i - 1] <= keyed_[i];
+    }
+    if (sorted) {
+        return false;
+    }
+
+    SortByKeyHalf(keyed_, scratch_);
+
+    order_.resize(keyed_.size());
+    for (size_t i = 0; i < keyed_.size(); i++) {
+        order_[i] = (uint32_t) keyed_[i];
+    }
+    return true;
+}
+
+}
@@ -1,9 +1,34 @@
 #include "natural_selection_simulation.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
 
 namespace naturalselection {
 
+// Time each frame gets for simulating, leaving the rest of a 60 Hz frame for input and drawing.
+// A tick that needs longer carries on over the next frames.
+static const std::chrono::milliseconds TICK_BUDGET = std::chrono::milliseconds(10);
+
 NaturalSelectionSimulation::NaturalSelectionSimulation() {
   ci::app::setWindowSize(kWindowSize + kWindowSize, kWindowSize); // 1000 x 2000
+  srand((unsigned int) time(NULL)); // Seeded once here so headless runs can choose their own seed
+
+  // Lets outside tools map the world as it runs. The app works the same without it.
+  if (shared_world_.Create(DEFAULT_SHARED_WORLD_NAME)) {
+    environment_.SetSharedWorld(&shared_world_);
+  } else if (errno == EEXIST) {
+    std::cerr << "Not sharing the world: " << DEFAULT_SHARED_WORLD_NAME << " is taken by another"
+              << " simulation, or left over from one that crashed (then remove /dev/shm"
+              << DEFAULT_SHARED_WORLD_NAME << ")" << std::endl;
+  }
+
+  // Life events are only recorded when asked for, as the file grows for as long as the app runs.
+  const char *event_stream_path = std::getenv("NATURALSELECTION_EVENT_STREAM");
+  if (event_stream_path != nullptr && event_stream_.Open(event_stream_path)) {
+    environment_.SetEventStream(&event_stream_);
+  }
 }
 
 void NaturalSelectionSimulation::draw() {
@@ -15,7 +40,7 @@ void NaturalSelectionSimulation::draw() {
 
 void NaturalSelectionSimulation::update() {
     if (environment_.AreThereCreaturesAlive()) {
-        environment_.AdvanceOneFrame();
+        environment_.AdvanceWithinBudget(TICK_BUDGET);
     }
 }
 
@@ -33,18 +58,42 @@ void NaturalSelectionSimulation::keyDown(ci::app::KeyEvent event) {
             cinder::app::AppMsw::quit();
             break;
 
+        // One item at a time, leaving the rest of the field where it is, so these work mid-generation too.
         case ci::app::KeyEvent::KEY_UP:
-            if (!environment_.GetIsRunning()) {
-                environment_.IncreaseFoodCount();
-                environment_.RefreshFood();
-            }
+            environment_.IncreaseFoodCount();
+            environment_.AddFood(1);
             break;
 
         case ci::app::KeyEvent::KEY_DOWN:
-            if (!environment_.GetIsRunning()) {
-                environment_.DecreaseFoodCount();
-                environment_.RefreshFood();
-            }
+            environment_.DecreaseFoodCount();
+            environment_.RemoveFood(1); // Keeps the same floor as the food count, in either food mode
+            break;
+
+        case ci::app::KeyEvent::KEY_g:
+            // Toggles food growing back during a generation.
+            environment_.SetFoodRegrowthRate(environment_.GetFoodRegrowthRate() > 0 ? 0 : DEFAULT_FOOD_REGROWTH_RATE);
+            break;
+
+        case ci::app::KeyEvent::KEY_c:
+            environment_.SetCollisionsEnabled(!environment_.GetCollisionsEnabled());
+            break;
+
+        case ci::app::KeyEvent::KEY_m:
+            environment_.SetShowMemoryOverlay(!environment_.GetShowMemoryOverlay());
+            break;
+
+        case ci::app::KeyEvent::KEY_l:
+            // Toggles between the default level of detail and always drawing every circle.
+            environment_.SetLodEntityThreshold(
+                    environment_.GetLodEntityThreshold() == 0 ? DEFAULT_LOD_ENTITY_THRESHOLD : 0);
+            break;
+
+        case ci::app::KeyEvent::KEY_EQUALS:
+            environment_.SetViewZoom(environment_.GetViewZoom() * 2);
+            break;
+
+        case ci::app::KeyEvent::KEY_MINUS:
+            environment_.SetViewZoom(environment_.GetViewZoom() / 2);
             break;
 
         case ci::app::KeyEvent::KEY_0:
@@ -0,0 +1,185 @@
+#include "phylogeny.h"
+#include <algorithm>
+
+namespace naturalselection {
+
+void Phylogeny::AddFounder(uint32_t id) {
+    if (FindNode(id) != NO_NODE) {
+        return;
+    }
+    AddNode(id, NO_NODE, id);
+}
+
+void Phylogeny::AddBirth(uint32_t id, uint32_t parent_id) {
+    if (FindNode(id) != NO_NODE) {
+        return;
+    }
+
+    uint32_t parent = FindNode(parent_id);
+    if (parent == NO_NODE) {
+        AddNode(id, NO_NODE, id);
+        return;
+    }
+    nodes_[parent].references++;
+    AddNode(id, parent, nodes_[parent].founder);
+}
+
+uint32_t Phylogeny::AddNode(uint32_t id, uint32_t parent, uint32_t founder) {
+    uint32_t node;
+    if (free_nodes_.empty()) {
+        node = (uint32_t) nodes_.size();
+        nodes_.push_back(Node());
+    } else {
+        node = free_nodes_.back();
+        free_nodes_.pop_back();
+    }
+
+    nodes_[node] = Node{id, parent, founder, 1, true};
+    node_by_id_[id] = node;
+    lineage_sizes_[founder]++;
+    living_count_++;
+    return node;
+}
+
+void Phylogeny::RemoveCreature(uint32_t id) {
+    uint32_t node = FindNode(id);
+    if (node == NO_NODE || !nodes_[node].alive) {
+        return;
+    }
+
+    nodes_[node].alive = false;
+    living_count_--;
+    auto lineage = lineage_sizes_.find(nodes_[node].founder);
+    if (--lineage->second == 0) {
+        lineage_sizes_.erase(lineage);
+    }
+    nodes_[node].references--;
+    Release(node);
+}
+
+void Phylogeny::Release(uint32_t node) {
+    while (node != NO_NODE && nodes_[node].references == 0) {
+        uint32_t parent = nodes_[node].parent;
+        node_by_id_.erase(nodes_[node].id);
+        free_nodes_.push_back(node);
+        if (parent != NO_NODE) {
+            nodes_[parent].references--;
+        }
+        node = parent;
+    }
+}
+
+void Phylogeny::Compact() {
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        if (nodes_[i].references == 0) { // A free slot
+            continue;
+        }
+
+        // The child takes over the spliced ancestor's reference to its own parent, so that count stays the same.
+        uint32_t parent = nodes_[i].parent;
+        while (parent != NO_NODE && !nodes_[parent].alive && nodes_[parent].references == 1) {
+            nodes_[i].parent = nodes_[parent].parent;
+            nodes_[parent].references = 0;
+            node_by_id_.erase(nodes_[parent].id);
+            free_nodes_.push_back(parent);
+            parent = nodes_[i].parent;
+        }
+    }
+}
+
+void Phylogeny::TakeCensus(size_t generation) {
+    LineageCensus census;
+    census.generation = generation;
+    census.lineage_count = lineage_sizes_.size();
+    census.largest.assign(lineage_sizes_.begin(), lineage_sizes_.end());
+
+    // Largest first, then oldest founder first, so ties come out the same every run.
+    auto larger = [](const std::pair<uint32_t, size_t> &first, const std::pair<uint32_t, size_t> &second) {
+        return first.second != second.second ? first.second > second.second : first.first < second.first;
+    };
+    size_t kept = std::min(census.largest.size(), CENSUS_LINEAGES);
+    std::partial_sort(census.largest.begin(), census.largest.begin() + kept, census.largest.end(), larger);
+    census.largest.resize(kept);
+    censuses_.push_back(census);
+}
+
+void Phylogeny::Clear() {
+    nodes_.clear();
+    free_nodes_.clear();
+    node_by_id_.clear();
+    lineage_sizes_.clear();
+    censuses_.clear();
+    living_count_ = 0;
+}
+
+bool Phylogeny::IsAlive(uint32_t id) const {
+    uint32_t node = FindNode(id);
+    return node != NO_NODE && nodes_[node].alive;
+}
+
+uint32_t Phylogeny::FindCommonAncestor(uint32_t first_id, uint32_t second_id) const {
+    uint32_t first = FindNode(first_id);
+    uint32_t second = FindNode(second_id);
+    while (first != second) {
+        if (first == NO_NODE || second == NO_NODE) {
+            return 0;
+        }
+        if (nodes_[first].id > nodes_[second].id) {
+            first = nodes_[first].parent;
+        } else {
+            second = nodes_[second].parent;
+        }
+    }
+    return first == NO_NODE ? 0 : nodes_[first].id;
+}
+
+uint32_t Phylogeny::GetFounder(uint32_t id) const {
+    uint32_t node = FindNode(id);
+    return node == NO_NODE ? 0 : nodes_[node].founder;
+}
+
+size_t Phylogeny::GetLineageSize(uint32_t founder_id) const {
+    auto lineage = lineage_sizes_.find(founder_id);
+    return lineage == lineage_sizes_.end() ? 0 : lineage->second;
+}
+
+size_t Phylogeny::GetLineageCount() const {
+    return lineage_sizes_.size();
+}
+
+const std::vector<LineageCensus> &Phylogeny::GetCensuses() const {
+    return censuses_;
+}
+
+size_t Phylogeny::GetLivingCount() const {
+    return living_count_;
+}
+
+size_t Phylogeny::GetNodeCount() const {
+    return node_by_id_.size();
+}
+
+MemoryFootprint Phylogeny::GetMemoryFootprint() const {
+    MemoryFootprint footprint;
+    footprint.Add(nodes_);
+    footprint.Add(free_nodes_);
+    footprint.Add(censuses_);
+    for (size_t i = 0; i < censuses_.size(); i++) {
+        footprint.Add(censuses_[i].largest);
+    }
+
+    // Roughly: a bucket array, and one allocation per entry holding it and a next pointer.
+    footprint.bytes += node_by_id_.bucket_count() * sizeof(void *) +
+                       node_by_id_.size() * (sizeof(std::pair<uint32_t, uint32_t>) + sizeof(void *));
+    footprint.bytes += lineage_sizes_.bucket_count() * sizeof(void *) +
+                       lineage_sizes_.size() * (sizeof(std::pair<uint32_t, size_t>) + sizeof(void *));
+    footprint.allocations += 2 + node_by_id_.size() + lineage_sizes_.size();
+    return footprint;
+}
+
+uint32_t Phylogeny::FindNode(uint32_t id) const {
+    auto found = node_by_id_.find(id);
+    return found == node_by_id_.end() ? NO_NODE : found->second;
+}
+
+}
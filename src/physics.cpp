@@ -38,26 +38,11 @@ vec2 Physics::GetFlippedYVelocity(Creature particle) {
 
 std::vector<vec2> Physics::CalculateParticleBounceVelocity(Creature particle_1, Creature particle_2) {
     std::vector<vec2> new_velocities;
-    vec2 position_1 = particle_1.GetPosition();
-    vec2 position_2 = particle_2.GetPosition();
-
-    vec2 velocity_1 = particle_1.GetVelocity();
-    vec2 velocity_2 = particle_2.GetVelocity();
-
-    float mass_1 = particle_1.GetMass();
-    float mass_2 = particle_2.GetMass();
-
-    // Calculates the new velocity of the first particle.
-    vec2 new_velocity_1 = velocity_1 - ((2 * mass_2) / (mass_1 + mass_2)) * (glm::dot((velocity_1 - velocity_2),
-                                      (position_1 - position_2))/
-                                      (float) pow(glm::length(position_1 - position_2), 2))
-                                                * (position_1 - position_2);
-
-    // Calculates the new velocity of the second particle.
-    vec2 new_velocity_2 = velocity_2 - ((2 * mass_1) / (mass_1 + mass_2)) * (glm::dot((velocity_2 - velocity_1),
-                                      (position_2 - position_1))/
-                                      (float) pow(glm::length(position_2 - position_1), 2))
-                                                * (position_2 - position_1);
+    vec2 new_velocity_1;
+    vec2 new_velocity_2;
+    CalculateParticleBounceVelocity(particle_1.GetPosition(), particle_1.GetVelocity(), particle_1.GetMass(),
+                                    particle_2.GetPosition(), particle_2.GetVelocity(), particle_2.GetMass(),
+                                    new_velocity_1, new_velocity_2);
 
     // Add to new velocity vector.
     new_velocities.push_back(new_velocity_1);
@@ -65,6 +50,22 @@ std::vector<vec2> Physics::CalculateParticleBounceVelocity(Creature particle_1,
     return new_velocities;
 }
 
+void Physics::CalculateParticleBounceVelocity(vec2 position_1, vec2 velocity_1, float mass_1,
+                                              vec2 position_2, vec2 velocity_2, float mass_2,
+                                              vec2 &new_velocity_1, vec2 &new_velocity_2) {
+    // Calculates the new velocity of the first particle.
+    new_velocity_1 = velocity_1 - ((2 * mass_2) / (mass_1 + mass_2)) * (glm::dot((velocity_1 - velocity_2),
+                                  (position_1 - position_2))/
+                                  (float) pow(glm::length(position_1 - position_2), 2))
+                                            * (position_1 - position_2);
+
+    // Calculates the new velocity of the second particle.
+    new_velocity_2 = velocity_2 - ((2 * mass_1) / (mass_1 + mass_2)) * (glm::dot((velocity_2 - velocity_1),
+                                  (position_2 - position_1))/
+                                  (float) pow(glm::length(position_2 - position_1), 2))
+                                            * (position_2 - position_1);
+}
+
 float Physics::FindHighestSpeed(std::vector<Creature> particles) {
     if (!particles.empty()) {
         float highest_velocity = glm::length(particles.at(0).GetVelocity());
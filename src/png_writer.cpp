@@ -0,0 +1,353 @@
+#include "png_writer.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace naturalselection {
+
+// Source: https://www.w3.org/TR/png/ and https://www.rfc-editor.org/rfc/rfc1951 (fixed Huffman codes)
+static const size_t MIN_MATCH = 3;
+static const size_t MAX_MATCH = 258;
+static const size_t PIXEL_BYTES = 4;
+static const uint32_t END_OF_BLOCK = 256;
+// Most bytes Adler-32 can add up before its sums might overflow 32 bits.
+static const size_t ADLER_BLOCK = 5552;
+static const uint32_t ADLER_MODULUS = 65521;
+// Rows deflated as one task. Enough for a frame to split across every thread.
+static const size_t DEFLATE_GROUP_ROWS = 64;
+
+static const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                         35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA_BITS[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                              3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+static uint32_t ReverseBits(uint32_t code, int bit_count) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < bit_count; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    return reversed;
+}
+
+/**
+ * The fixed literal/length code, bit-reversed since Huffman codes go out most significant bit first.
+ */
+struct FixedCodes {
+    std::array<uint16_t, 288> codes;
+    std::array<uint8_t, 288> lengths;
+    std::array<uint8_t, MAX_MATCH + 1> length_symbols; // Index into LENGTH_BASE for each match length
+
+    FixedCodes() {
+        for (uint32_t symbol = 0; symbol < 288; symbol++) {
+            uint32_t code;
+            int bits;
+            if (symbol < 144) {
+                code = 0x30 + symbol;
+                bits = 8;
+            } else if (symbol < 256) {
+                code = 0x190 + (symbol - 144);
+                bits = 9;
+            } else if (symbol < 280) {
+                code = symbol - 256;
+                bits = 7;
+            } else {
+                code = 0xC0 + (symbol - 280);
+                bits = 8;
+            }
+            codes[symbol] = (uint16_t) ReverseBits(code, bits);
+            lengths[symbol] = (uint8_t) bits;
+        }
+
+        size_t index = 0;
+        for (size_t length = MIN_MATCH; length <= MAX_MATCH; length++) {
+            while (index + 1 < 29 && LENGTH_BASE[index + 1] <= length) {
+                index++;
+            }
+            length_symbols[length] = (uint8_t) index;
+        }
+    }
+};
+
+static const FixedCodes FIXED_CODES;
+
+// Slicing-by-4: CRC_TABLES[k][n] is the CRC of byte n followed by k zero bytes, so four bytes
+// can be folded in with four independent lookups.
+static const std::array<std::array<uint32_t, 256>, 4> CRC_TABLES = []() {
+    std::array<std::array<uint32_t, 256>, 4> tables;
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        tables[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        for (int k = 1; k < 4; k++) {
+            tables[k][n] = tables[0][tables[k - 1][n] & 0xFF] ^ (tables[k - 1][n] >> 8);
+        }
+    }
+    return tables;
+}();
+
+/**
+ * Packs bit fields least significant bit first, as deflate wants them, into a buffer
+ * sized up front for the worst case so the hot loop never checks capacity.
+ */
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t *output) : output_(output) {}
+
+    void Write(uint32_t value, int bit_count) {
+        buffer_ |= (uint64_t) value << filled_;
+        filled_ += bit_count;
+        if (filled_ >= 32) {
+            for (int i = 0; i < 4; i++) {
+                *output_++ = (uint8_t) (buffer_ >> (8 * i));
+            }
+            buffer_ >>= 32;
+            filled_ -= 32;
+        }
+    }
+
+    void WriteSymbol(uint32_t symbol) {
+        Write(FIXED_CODES.codes[symbol], FIXED_CODES.lengths[symbol]);
+    }
+
+    /**
+     * Writes out the partial byte and returns the end of the output.
+     */
+    uint8_t *Flush() {
+        while (filled_ > 0) {
+            *output_++ = (uint8_t) buffer_;
+            buffer_ >>= 8;
+            filled_ -= 8;
+        }
+        filled_ = 0;
+        return output_;
+    }
+
+private:
+    uint8_t *output_;
+    uint64_t buffer_ = 0;
+    int filled_ = 0;
+};
+
+static inline uint32_t LoadPixel(const uint8_t *bytes) {
+    uint32_t pixel;
+    memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+static void AppendBigEndian(std::vector<uint8_t> &output, uint32_t value) {
+    output.push_back((uint8_t) (value >> 24));
+    output.push_back((uint8_t) (value >> 16));
+    output.push_back((uint8_t) (value >> 8));
+    output.push_back((uint8_t) value);
+}
+
+static void AppendChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data) {
+    AppendBigEndian(png, (uint32_t) data.size());
+    size_t type_start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    AppendBigEndian(png, PngWriter::Crc32(&png[type_start], png.size() - type_start));
+}
+
+// Adler-32 over more of the stream, with the modulo deferred as long as it cannot overflow.
+// Works on copies, since the compiler has to assume data might alias a and b, and adds up
+// 16 bytes at a time so the inner loop has no dependency from one byte to the next.
+static void UpdateAdler32(uint32_t &a, uint32_t &b, const uint8_t *data, size_t size) {
+    uint32_t sum = a;
+    uint32_t sum_of_sums = b;
+    for (size_t start = 0; start < size; start += ADLER_BLOCK) {
+        size_t end = std::min(size, start + ADLER_BLOCK);
+        size_t i = start;
+        for (; i + 16 <= end; i += 16) {
+            uint32_t block_sum = 0;
+            uint32_t weighted_sum = 0;
+            for (uint32_t j = 0; j < 16; j++) {
+                block_sum += data[i + j];
+                weighted_sum += (16 - j) * data[i + j];
+            }
+            sum_of_sums += 16 * sum + weighted_sum;
+            sum += block_sum;
+        }
+        for (; i < end; i++) {
+            sum += data[i];
+            sum_of_sums += sum;
+        }
+        sum %= ADLER_MODULUS;
+        sum_of_sums %= ADLER_MODULUS;
+    }
+    a = sum;
+    b = sum_of_sums;
+}
+
+// Adler-32 of two streams joined, from each one's checksum. Source: zlib's adler32_combine.
+static uint32_t CombineAdler32(uint32_t first, uint32_t second, size_t second_size) {
+    uint32_t remainder = (uint32_t) (second_size % ADLER_MODULUS);
+    uint32_t sum = first & 0xFFFF;
+    uint32_t sum_of_sums = (uint32_t) (((uint64_t) remainder * sum) % ADLER_MODULUS);
+    sum += (second & 0xFFFF) + ADLER_MODULUS - 1;
+    sum_of_sums += (first >> 16) + (second >> 16) + ADLER_MODULUS - remainder;
+    while (sum >= ADLER_MODULUS) {
+        sum -= ADLER_MODULUS;
+    }
+    while (sum_of_sums >= ADLER_MODULUS) {
+        sum_of_sums -= ADLER_MODULUS;
+    }
+    return (sum_of_sums << 16) | sum;
+}
+
+/**
+ * Some rows of the image, deflated on their own, and the Adler-32 of their filtered bytes.
+ */
+struct DeflatedRows {
+    std::vector<uint8_t> bytes;
+    uint32_t adler = 1;
+    size_t raw_size = 0;
+};
+
+// Fixed-Huffman deflate of [first_row, end_row). The only matches looked for are repeats of the
+// previous pixel, so the encoder walks whole pixels: one comparison each, and a run of background
+// costs a single match per 64 pixels. Rows before the last ones end with an empty stored block,
+// as zlib's sync flush does, so every group of rows ends on a byte and groups simply concatenate.
+static void DeflateRows(const uint8_t *rgba, size_t width, size_t first_row, size_t end_row, bool last,
+                        DeflatedRows &deflated) {
+    static const uint8_t FILTER_NONE = 0;
+    static const size_t MAX_RUN_PIXELS = MAX_MATCH / PIXEL_BYTES;
+
+    // Every symbol takes at most 9 bits per byte it covers.
+    size_t row_bytes = width * PIXEL_BYTES;
+    deflated.raw_size = (end_row - first_row) * (row_bytes + 1);
+    deflated.bytes.resize(deflated.raw_size + deflated.raw_size / 8 + 16);
+    BitWriter bits(deflated.bytes.data());
+    bits.Write(last ? 1 : 0, 1); // Final block
+    bits.Write(1, 2); // Fixed Huffman codes
+
+    const uint32_t distance_code = ReverseBits(PIXEL_BYTES - 1, 5); // Code 3 is exactly one pixel back
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t row = first_row; row < end_row; row++) {
+        // Each row starts with its filter type, and filter 0 leaves the pixels as they are.
+        const uint8_t *pixels = rgba + row * row_bytes;
+        bits.WriteSymbol(FILTER_NONE);
+        UpdateAdler32(a, b, &FILTER_NONE, 1);
+        UpdateAdler32(a, b, pixels, row_bytes);
+
+        size_t x = 0;
+        while (x < width) {
+            size_t run = 0;
+            if (x > 0) { // The first pixel of a row has the filter byte between it and the last one
+                uint32_t previous = LoadPixel(pixels + (x - 1) * PIXEL_BYTES);
+                while (run < MAX_RUN_PIXELS && x + run < width &&
+                       LoadPixel(pixels + (x + run) * PIXEL_BYTES) == previous) {
+                    run++;
+                }
+            }
+
+            if (run > 0) {
+                size_t length = run * PIXEL_BYTES;
+                size_t index = FIXED_CODES.length_symbols[length];
+                bits.WriteSymbol(257 + (uint32_t) index);
+                bits.Write((uint32_t) (length - LENGTH_BASE[index]), LENGTH_EXTRA_BITS[index]);
+                bits.Write(distance_code, 5);
+                x += run;
+            } else {
+                const uint8_t *pixel = pixels + x * PIXEL_BYTES;
+                for (size_t channel = 0; channel < PIXEL_BYTES; channel++) {
+                    bits.WriteSymbol(pixel[channel]);
+                }
+                x++;
+            }
+        }
+    }
+    bits.WriteSymbol(END_OF_BLOCK);
+
+    if (!last) {
+        bits.Write(0, 1); // Not final
+        bits.Write(0, 2); // Stored
+    }
+    uint8_t *end = bits.Flush();
+    if (!last) {
+        static const uint8_t EMPTY_STORED_LENGTHS[4] = {0x00, 0x00, 0xFF, 0xFF};
+        end = std::copy(EMPTY_STORED_LENGTHS, EMPTY_STORED_LENGTHS + 4, end);
+    }
+    deflated.bytes.resize(end - deflated.bytes.data());
+    deflated.adler = (b << 16) | a;
+}
+
+uint32_t PngWriter::Crc32(const uint8_t *data, size_t size, uint32_t crc) {
+    uint32_t c = crc ^ 0xFFFFFFFFu;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        c ^= (uint32_t) data[i] | ((uint32_t) data[i + 1] << 8) | ((uint32_t) data[i + 2] << 16) |
+             ((uint32_t) data[i + 3] << 24);
+        c = CRC_TABLES[3][c & 0xFF] ^ CRC_TABLES[2][(c >> 8) & 0xFF] ^ CRC_TABLES[1][(c >> 16) & 0xFF] ^
+            CRC_TABLES[0][c >> 24];
+    }
+    for (; i < size; i++) {
+        c = CRC_TABLES[0][(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+void PngWriter::Encode(const uint8_t *rgba, size_t width, size_t height, std::vector<uint8_t> &png,
+                       TaskScheduler *scheduler) {
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    png.assign(SIGNATURE, SIGNATURE + 8);
+
+    std::vector<uint8_t> header;
+    AppendBigEndian(header, (uint32_t) width);
+    AppendBigEndian(header, (uint32_t) height);
+    header.push_back(8); // Bits per channel
+    header.push_back(6); // RGBA
+    header.push_back(0); // Deflate
+    header.push_back(0); // Adaptive filtering, every row using filter 0
+    header.push_back(0); // Not interlaced
+    AppendChunk(png, "IHDR", header);
+
+    // Groups of rows are deflated independently. The groups never depend on the thread
+    // count, so neither do the bytes written.
+    size_t group_count = std::max((height + DEFLATE_GROUP_ROWS - 1) / DEFLATE_GROUP_ROWS, (size_t) 1);
+    std::vector<DeflatedRows> groups(group_count);
+    TaskGraph tasks;
+    for (size_t group = 0; group < group_count; group++) {
+        tasks.AddTask([rgba, width, height, group, group_count, &groups]() {
+            size_t first_row = group * DEFLATE_GROUP_ROWS;
+            size_t end_row = std::min(first_row + DEFLATE_GROUP_ROWS, height);
+            DeflateRows(rgba, width, first_row, end_row, group + 1 == group_count, groups[group]);
+        });
+    }
+    if (scheduler != nullptr) {
+        scheduler->Run(tasks);
+    } else {
+        tasks.RunInline();
+    }
+
+    std::vector<uint8_t> compressed;
+    compressed.push_back(0x78); // Deflate, 32K window
+    compressed.push_back(0x01); // No preset dictionary, fastest compression
+    uint32_t adler = 1;
+    for (size_t group = 0; group < group_count; group++) {
+        compressed.insert(compressed.end(), groups[group].bytes.begin(), groups[group].bytes.end());
+        adler = CombineAdler32(adler, groups[group].adler, groups[group].raw_size);
+    }
+    AppendBigEndian(compressed, adler);
+
+    AppendChunk(png, "IDAT", compressed);
+    AppendChunk(png, "IEND", std::vector<uint8_t>());
+}
+
+bool PngWriter::Write(const std::string &path, const uint8_t *rgba, size_t width, size_t height,
+                      TaskScheduler *scheduler) {
+    std::vector<uint8_t> png;
+    Encode(rgba, width, height, png, scheduler);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char *) png.data(), (std::streamsize) png.size());
+    return (bool) file;
+}
+
+}
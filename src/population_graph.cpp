@@ -7,7 +7,7 @@ using glm::vec2;
 
 PopulationGraph::PopulationGraph() {}
 
-PopulationGraph::PopulationGraph(std::string trait, size_t width, size_t height, int x_coor, int y_coor, std::vector<std::vector<Creature>> population_records) {
+PopulationGraph::PopulationGraph(std::string trait, size_t width, size_t height, int x_coor, int y_coor, const std::vector<GenerationRecord> &population_records) {
     trait_ = trait;
     width_ = width; //   200
     height_ = height; // 200
@@ -89,10 +89,21 @@ void PopulationGraph::PrintGraph() const {
     PrintNumericalLines();
 }
 
-void PopulationGraph::SetParticles(std::vector<std::vector<Creature>> new_particles) {
+void PopulationGraph::SetParticles(const std::vector<GenerationRecord> &new_particles) {
     population_records_ = new_particles;
 }
 
+void PopulationGraph::AddGeneration(const GenerationRecord &record) {
+    population_records_.push_back(record);
+}
+
+MemoryFootprint PopulationGraph::GetMemoryFootprint() const {
+    // The records themselves belong to the environment; only the list of them is ours.
+    MemoryFootprint footprint;
+    footprint.Add(population_records_);
+    return footprint;
+}
+
 // Source: https://www.codegrepper.com/code-examples/cpp/c%2B%2B+round+float+to+2+decimal+places
 std::string PopulationGraph::FloatToStringPrecision(float value, unsigned char prec) const {
     std::stringstream ss;
@@ -123,8 +134,8 @@ double PopulationGraph::GetAveragePopulation() const {
 
 int PopulationGraph::GetSpeedCountAtIndex(int index) const {
     int sum = 0;
-    for (size_t i = 0; i < population_records_.at(index).size(); i++) {
-        if (population_records_.at(index).at(i).GetCreatureType() == SPEED) {
+    for (size_t i = 0; i < population_records_.at(index)->size(); i++) {
+        if (population_records_.at(index)->at(i).GetCreatureType() == SPEED) {
             sum++;
         }
     }
@@ -134,8 +145,8 @@ int PopulationGraph::GetSpeedCountAtIndex(int index) const {
 
 int PopulationGraph::GetIntelligenceCountAtIndex(int index) const {
     int sum = 0;
-    for (size_t i = 0; i < population_records_.at(index).size(); i++) {
-        if (population_records_.at(index).at(i).GetCreatureType() == INTELLIGENCE) {
+    for (size_t i = 0; i < population_records_.at(index)->size(); i++) {
+        if (population_records_.at(index)->at(i).GetCreatureType() == INTELLIGENCE) {
             sum++;
         }
     }
@@ -145,8 +156,8 @@ int PopulationGraph::GetIntelligenceCountAtIndex(int index) const {
 
 int PopulationGraph::GetBothTypeCountAtIndex(int index) const {
     int sum = 0;
-    for (size_t i = 0; i < population_records_.at(index).size(); i++) {
-        if (population_records_.at(index).at(i).GetCreatureType() == BOTH) {
+    for (size_t i = 0; i < population_records_.at(index)->size(); i++) {
+        if (population_records_.at(index)->at(i).GetCreatureType() == BOTH) {
             sum++;
         }
     }
@@ -155,7 +166,7 @@ int PopulationGraph::GetBothTypeCountAtIndex(int index) const {
 }
 
 int PopulationGraph::GetTotalPopulationAtIndex(int index) const {
-    return population_records_.at(index).size();
+    return population_records_.at(index)->size();
 }
 
 }
\ No newline at end of file
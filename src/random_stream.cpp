@@ -0,0 +1,42 @@
+#include "random_stream.h"
+
+namespace naturalselection {
+
+// Source: https://www.pcg-random.org/download.html (pcg32_random_r)
+RandomStream::RandomStream() : RandomStream(0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL) {}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t stream_id) {
+    state_ = 0;
+    increment_ = (stream_id << 1u) | 1u; // Must be odd.
+    NextUInt();
+    state_ += seed;
+    NextUInt();
+}
+
+// Source: https://prng.di.unimi.it/splitmix64.c
+static uint64_t SplitMix64(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+RandomStream RandomStream::ForCreature(uint64_t seed, uint64_t creature_index) {
+    // Scramble both so neighbouring indices don't get correlated streams.
+    return RandomStream(SplitMix64(seed ^ SplitMix64(creature_index)), SplitMix64(creature_index));
+}
+
+uint32_t RandomStream::NextUInt() {
+    uint64_t old_state = state_;
+    state_ = old_state * 6364136223846793005ULL + increment_;
+    uint32_t xor_shifted = (uint32_t) (((old_state >> 18u) ^ old_state) >> 27u);
+    uint32_t rotation = (uint32_t) (old_state >> 59u);
+    return (xor_shifted >> rotation) | (xor_shifted << ((-rotation) & 31));
+}
+
+float RandomStream::NextUnitFloat() {
+    // Top 24 bits give every float in [0, 1] on an even grid.
+    return (float) (NextUInt() >> 8) / (float) (1u << 24);
+}
+
+}
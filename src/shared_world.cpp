@@ -0,0 +1,245 @@
+#include "shared_world.h"
+#include "creature.h"
+#include "food.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace naturalselection {
+
+// Source: https://www.kernel.org/doc/html/latest/locking/seqlock.html
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared sequence numbers must not need a lock");
+static_assert(sizeof(SharedWorldHeader) % alignof(SharedWorldSlot) == 0, "slots must start aligned");
+static_assert(sizeof(SharedWorldSlot) % alignof(SharedCreature) == 0, "creatures must start aligned");
+
+static const size_t SLOT_ALIGNMENT = 64; // Slots start on their own cache line
+
+static size_t GetSlotBytes(size_t max_creatures, size_t max_food) {
+    size_t bytes = sizeof(SharedWorldSlot) + max_creatures * sizeof(SharedCreature) + max_food * sizeof(SharedFood);
+    return (bytes + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+}
+
+static size_t GetHeaderBytes() {
+    return (sizeof(SharedWorldHeader) + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+}
+
+SharedWorldPublisher::~SharedWorldPublisher() {
+    Close();
+}
+
+bool SharedWorldPublisher::Create(const std::string &name, size_t max_creatures, size_t max_food,
+                                  size_t slot_count) {
+    Close();
+    slot_count = std::max(slot_count, (size_t) 2); // With one slot every write would tear the only frame
+    size_t slot_bytes = GetSlotBytes(max_creatures, max_food);
+    size_t total_bytes = GetHeaderBytes() + slot_count * slot_bytes;
+
+    // Readers map it read-only, so the segment itself only needs to be writable by this user.
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, (off_t) total_bytes) < 0) {
+        int error = errno;
+        close(fd);
+        shm_unlink(name.c_str()); // Ours, since O_EXCL created it
+        errno = error;
+        return false;
+    }
+    void *mapping = mmap(nullptr, total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    close(fd); // The mapping keeps the segment alive
+    if (mapping == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        errno = error;
+        return false;
+    }
+
+    name_ = name;
+    mapping_ = (uint8_t *) mapping;
+    mapping_bytes_ = total_bytes;
+    frames_published_ = 0;
+
+    // ftruncate zero-fills, so every sequence number already reads as an empty, even slot.
+    SharedWorldHeader *header = (SharedWorldHeader *) mapping_;
+    header->slot_count = (uint32_t) slot_count;
+    header->max_creatures = (uint32_t) max_creatures;
+    header->max_food = (uint32_t) max_food;
+    header->slot_bytes = slot_bytes;
+    header->version = SHARED_WORLD_VERSION;
+    header->latest_frame.store(0, std::memory_order_relaxed);
+    // Written last, so a reader that sees the magic number sees the rest of the header too.
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SHARED_WORLD_MAGIC;
+    return true;
+}
+
+void SharedWorldPublisher::Publish(const std::vector<Creature> &creatures, const std::vector<Food> &food,
+                                   uint64_t tick, size_t generation) {
+    if (mapping_ == nullptr) {
+        return;
+    }
+
+    SharedWorldHeader *header = (SharedWorldHeader *) mapping_;
+    uint64_t frame = frames_published_ + 1;
+    uint8_t *slot_start = mapping_ + GetHeaderBytes() + (size_t) ((frame - 1) % header->slot_count) * header->slot_bytes;
+    SharedWorldSlot *slot = (SharedWorldSlot *) slot_start;
+
+    // Odd while writing. The fence keeps the data writes below from moving above it.
+    slot->sequence.store(2 * frame - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t creature_count = std::min(creatures.size(), (size_t) header->max_creatures);
+    size_t food_count = std::min(food.size(), (size_t) header->max_food);
+    slot->tick = tick;
+    slot->generation = generation;
+    slot->creature_count = (uint32_t) creature_count;
+    slot->food_count = (uint32_t) food_count;
+    slot->dropped_creatures = (uint32_t) (creatures.size() - creature_count);
+    slot->dropped_food = (uint32_t) (food.size() - food_count);
+
+    SharedCreature *shared_creatures = (SharedCreature *) (slot_start + sizeof(SharedWorldSlot));
+    for (size_t i = 0; i < creature_count; i++) {
+        const Creature &creature = creatures[i];
+        SharedCreature &shared = shared_creatures[i];
+        shared.x = creature.GetPosition().x;
+        shared.y = creature.GetPosition().y;
+        shared.velocity_x = creature.GetVelocity().x;
+        shared.velocity_y = creature.GetVelocity().y;
+        shared.radius = creature.GetRadius();
+        shared.vision_radius = (float) creature.GetVisionRadius();
+        shared.creature_type = creature.GetCreatureType();
+        shared.food = creature.GetFood();
+        shared.id = creature.GetId();
+        shared.reserved = 0;
+    }
+
+    SharedFood *shared_food = (SharedFood *) (shared_creatures + header->max_creatures);
+    for (size_t i = 0; i < food_count; i++) {
+        shared_food[i].x = food[i].GetPosition().x;
+        shared_food[i].y = food[i].GetPosition().y;
+        shared_food[i].radius = food[i].GetRadius();
+    }
+
+    slot->sequence.store(2 * frame, std::memory_order_release);
+    header->latest_frame.store(frame, std::memory_order_release);
+    frames_published_ = frame;
+}
+
+void SharedWorldPublisher::Close() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_bytes_);
+        shm_unlink(name_.c_str());
+        mapping_ = nullptr;
+        mapping_bytes_ = 0;
+    }
+}
+
+bool SharedWorldPublisher::IsOpen() const {
+    return mapping_ != nullptr;
+}
+
+uint64_t SharedWorldPublisher::GetFramesPublished() const {
+    return frames_published_;
+}
+
+SharedWorldReader::~SharedWorldReader() {
+    Close();
+}
+
+bool SharedWorldReader::Open(const std::string &name) {
+    Close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) < 0 || (size_t) status.st_size < GetHeaderBytes()) {
+        close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    mapping_ = (const uint8_t *) mapping;
+    mapping_bytes_ = (size_t) status.st_size;
+    const SharedWorldHeader *header = (const SharedWorldHeader *) mapping_;
+    bool valid = header->magic == SHARED_WORLD_MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && header->version == SHARED_WORLD_VERSION &&
+            header->slot_bytes == GetSlotBytes(header->max_creatures, header->max_food) &&
+            GetHeaderBytes() + header->slot_count * header->slot_bytes <= mapping_bytes_;
+    if (!valid) {
+        Close();
+    }
+    return valid;
+}
+
+void SharedWorldReader::Close() {
+    if (mapping_ != nullptr) {
+        munmap((void *) mapping_, mapping_bytes_);
+        mapping_ = nullptr;
+        mapping_bytes_ = 0;
+    }
+}
+
+bool SharedWorldReader::ReadLatest(SharedWorldFrame &frame, size_t max_attempts) const {
+    if (mapping_ == nullptr) {
+        return false;
+    }
+
+    const SharedWorldHeader *header = (const SharedWorldHeader *) mapping_;
+    for (size_t attempt = 0; attempt < max_attempts; attempt++) {
+        uint64_t latest = header->latest_frame.load(std::memory_order_acquire);
+        if (latest == 0) {
+            return false;
+        }
+
+        const uint8_t *slot_start =
+                mapping_ + GetHeaderBytes() + (size_t) ((latest - 1) % header->slot_count) * header->slot_bytes;
+        const SharedWorldSlot *slot = (const SharedWorldSlot *) slot_start;
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * latest) { // Already being overwritten by a newer frame
+            continue;
+        }
+
+        // The writer can change these at any moment, so they are only trusted once the
+        // sequence number is found unchanged afterwards, and clamped before use either way.
+        size_t creature_count = std::min((size_t) slot->creature_count, (size_t) header->max_creatures);
+        size_t food_count = std::min((size_t) slot->food_count, (size_t) header->max_food);
+        frame.frame = latest;
+        frame.tick = slot->tick;
+        frame.generation = slot->generation;
+        frame.dropped_creatures = slot->dropped_creatures;
+        frame.dropped_food = slot->dropped_food;
+        frame.creatures.resize(creature_count);
+        frame.food.resize(food_count);
+        const SharedCreature *shared_creatures = (const SharedCreature *) (slot_start + sizeof(SharedWorldSlot));
+        const SharedFood *shared_food = (const SharedFood *) (shared_creatures + header->max_creatures);
+        memcpy(frame.creatures.data(), shared_creatures, creature_count * sizeof(SharedCreature));
+        memcpy(frame.food.data(), shared_food, food_count * sizeof(SharedFood));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) == sequence) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t SharedWorldReader::GetLatestFrame() const {
+    if (mapping_ == nullptr) {
+        return 0;
+    }
+    return ((const SharedWorldHeader *) mapping_)->latest_frame.load(std::memory_order_acquire);
+}
+
+}
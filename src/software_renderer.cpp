@@ -0,0 +1,240 @@
+#include "software_renderer.h"
+#include "png_writer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace naturalselection {
+
+using glm::vec2;
+
+// Rows per band. Small enough that a frame splits across every thread, large enough that
+// rejecting the shapes outside a band stays cheap next to drawing the ones inside it.
+static const size_t BAND_ROWS = 32;
+// Same graph that PopulationGraph::PrintVerticalBars draws, with separators for short runs.
+static const size_t MAX_SEPARATED_GENERATIONS = 25;
+
+static const uint32_t BLACK = 0x000000FF;
+static const uint32_t WHITE = 0xFFFFFFFF;
+static const uint32_t FOOD_GREEN = 0x008000FF; // ci::Color("Green")
+static const uint32_t GRAPH_TOTAL = 0xFF00FFFF;
+static const uint32_t GRAPH_BLUE = 0x0000FFFF;
+static const uint32_t GRAPH_RED = 0xFF0000FF;
+
+static uint32_t PackColor(const ci::Color &color) {
+    uint32_t r = (uint32_t) std::lround(std::min(std::max(color.r, 0.0f), 1.0f) * 255.0f);
+    uint32_t g = (uint32_t) std::lround(std::min(std::max(color.g, 0.0f), 1.0f) * 255.0f);
+    uint32_t b = (uint32_t) std::lround(std::min(std::max(color.b, 0.0f), 1.0f) * 255.0f);
+    return (r << 24) | (g << 16) | (b << 8) | 0xFF;
+}
+
+FrameLayout FrameLayout::AroundArena(const WorldBounds &arena) {
+    FrameLayout layout;
+    layout.arena = arena;
+    layout.population_graph = WorldBounds{arena.x_coor * 2 + arena.width, arena.y_coor, arena.height, arena.height};
+    layout.width = (size_t) std::ceil(layout.population_graph.x_coor + layout.population_graph.width + arena.x_coor);
+    layout.height = (size_t) std::ceil(arena.y_coor * 2 + arena.height);
+    return layout;
+}
+
+SoftwareRenderer::SoftwareRenderer(const FrameLayout &layout, TaskScheduler *scheduler) {
+    layout_ = layout;
+    scheduler_ = scheduler;
+    pixels_.assign(layout_.width * layout_.height * 4, 0);
+}
+
+void SoftwareRenderer::Render(const WorldSnapshot &snapshot) {
+    band_tasks_.Clear();
+    for (size_t first_row = 0; first_row < layout_.height; first_row += BAND_ROWS) {
+        size_t end_row = std::min(first_row + BAND_ROWS, layout_.height);
+        band_tasks_.AddTask([this, &snapshot, first_row, end_row]() { RenderBand(snapshot, first_row, end_row); });
+    }
+
+    if (scheduler_ != nullptr) {
+        scheduler_->Run(band_tasks_);
+    } else {
+        band_tasks_.RunInline();
+    }
+}
+
+size_t SoftwareRenderer::GetWidth() const {
+    return layout_.width;
+}
+
+size_t SoftwareRenderer::GetHeight() const {
+    return layout_.height;
+}
+
+const std::vector<uint8_t> &SoftwareRenderer::GetPixels() const {
+    return pixels_;
+}
+
+uint32_t SoftwareRenderer::GetPixel(size_t x, size_t y) const {
+    const uint8_t *pixel = &pixels_.at((y * layout_.width + x) * 4);
+    return ((uint32_t) pixel[0] << 24) | ((uint32_t) pixel[1] << 16) | ((uint32_t) pixel[2] << 8) | pixel[3];
+}
+
+void SoftwareRenderer::RenderBand(const WorldSnapshot &snapshot, size_t first_row, size_t end_row) {
+    FillRect(0, (float) first_row, (float) layout_.width, (float) end_row, BLACK, first_row, end_row);
+
+    // Same order as Environment::Display(): creatures, food on top, then the border and graph.
+    for (size_t i = 0; i < snapshot.creatures.size(); i++) {
+        const CreatureRenderState &creature = snapshot.creatures[i];
+        uint32_t color = PackColor(creature.GetColor());
+        FillCircle(creature.position, creature.radius, color, first_row, end_row);
+        StrokeCircle(creature.position, creature.vision_radius, color, first_row, end_row);
+    }
+
+    for (size_t i = 0; i < snapshot.food.size(); i++) {
+        FillCircle(snapshot.food[i].position, snapshot.food[i].radius, FOOD_GREEN, first_row, end_row);
+    }
+
+    const WorldBounds &arena = layout_.arena;
+    StrokeRect(arena.x_coor, arena.y_coor, arena.x_coor + arena.width, arena.y_coor + arena.height, WHITE,
+               first_row, end_row);
+    DrawPopulationGraph(snapshot.population_history, first_row, end_row);
+}
+
+void SoftwareRenderer::DrawPopulationGraph(const std::vector<PopulationCount> &history, size_t first_row,
+                                           size_t end_row) {
+    const WorldBounds &graph = layout_.population_graph;
+    int highest = 0;
+    for (size_t i = 0; i < history.size(); i++) {
+        highest = std::max(highest, history[i].GetTotal());
+    }
+
+    if (highest > 0) {
+        float bar_width = graph.width / (float) history.size();
+        float unit_height = graph.height / (float) highest;
+        float bottom = graph.y_coor + graph.height;
+        for (size_t i = 0; i < history.size(); i++) {
+            float left = graph.x_coor + bar_width * i;
+            float right = graph.x_coor + bar_width * (i + 1);
+            int speed_and_intelligence = history[i].speed_count + history[i].intelligence_count;
+            FillRect(left, bottom - unit_height * history[i].GetTotal(), right, bottom, GRAPH_TOTAL,
+                     first_row, end_row);
+            FillRect(left, bottom - unit_height * speed_and_intelligence, right, bottom, GRAPH_BLUE,
+                     first_row, end_row);
+            FillRect(left, bottom - unit_height * history[i].speed_count, right, bottom, GRAPH_RED,
+                     first_row, end_row);
+
+            if (history.size() < MAX_SEPARATED_GENERATIONS) {
+                FillRect(right, graph.y_coor, right + 1, bottom, WHITE, first_row, end_row);
+            }
+        }
+    }
+
+    StrokeRect(graph.x_coor, graph.y_coor, graph.x_coor + graph.width, graph.y_coor + graph.height, WHITE,
+               first_row, end_row);
+}
+
+// A pixel is covered when its centre is, so rows and columns are offset by half a pixel throughout.
+void SoftwareRenderer::FillRect(float left, float top, float right, float bottom, uint32_t color,
+                                size_t first_row, size_t end_row) {
+    long top_row = std::max((long) std::ceil(top - 0.5f), (long) first_row);
+    long bottom_row = std::min((long) std::ceil(bottom - 0.5f), (long) end_row);
+    long first_column = (long) std::ceil(left - 0.5f);
+    long last_column = (long) std::ceil(right - 0.5f) - 1;
+    for (long row = top_row; row < bottom_row; row++) {
+        FillSpan((size_t) row, first_column, last_column, color);
+    }
+}
+
+void SoftwareRenderer::StrokeRect(float left, float top, float right, float bottom, uint32_t color,
+                                  size_t first_row, size_t end_row) {
+    // One pixel lines on the pixels starting at each edge, as GL draws lines on whole coordinates.
+    FillRect(left, top, right + 1, top + 1, color, first_row, end_row);
+    FillRect(left, bottom, right + 1, bottom + 1, color, first_row, end_row);
+    FillRect(left, top, left + 1, bottom + 1, color, first_row, end_row);
+    FillRect(right, top, right + 1, bottom + 1, color, first_row, end_row);
+}
+
+void SoftwareRenderer::FillCircle(vec2 center, float radius, uint32_t color, size_t first_row, size_t end_row) {
+    long top_row = std::max((long) std::ceil(center.y - radius - 0.5f), (long) first_row);
+    long bottom_row = std::min((long) std::floor(center.y + radius - 0.5f), (long) end_row - 1);
+    for (long row = top_row; row <= bottom_row; row++) {
+        float dy = (float) row + 0.5f - center.y;
+        float dx = std::sqrt(std::max(radius * radius - dy * dy, 0.0f));
+        FillSpan((size_t) row, (long) std::ceil(center.x - dx - 0.5f), (long) std::floor(center.x + dx - 0.5f), color);
+    }
+}
+
+void SoftwareRenderer::StrokeCircle(vec2 center, float radius, uint32_t color, size_t first_row, size_t end_row) {
+    // A one pixel wide ring: the span of the outer circle minus the span of the inner one.
+    float outer = radius + 0.5f;
+    float inner = std::max(radius - 0.5f, 0.0f);
+    long top_row = std::max((long) std::ceil(center.y - outer - 0.5f), (long) first_row);
+    long bottom_row = std::min((long) std::floor(center.y + outer - 0.5f), (long) end_row - 1);
+    for (long row = top_row; row <= bottom_row; row++) {
+        float dy = (float) row + 0.5f - center.y;
+        float outer_dx = std::sqrt(std::max(outer * outer - dy * dy, 0.0f));
+        long first_column = (long) std::ceil(center.x - outer_dx - 0.5f);
+        long last_column = (long) std::floor(center.x + outer_dx - 0.5f);
+
+        long inner_first = last_column + 1;
+        long inner_last = last_column;
+        if (std::fabs(dy) < inner) {
+            float inner_dx = std::sqrt(inner * inner - dy * dy);
+            inner_first = (long) std::ceil(center.x - inner_dx - 0.5f);
+            inner_last = (long) std::floor(center.x + inner_dx - 0.5f);
+        }
+
+        if (inner_first > inner_last) { // Nothing of the inside on this row
+            FillSpan((size_t) row, first_column, last_column, color);
+        } else {
+            FillSpan((size_t) row, first_column, inner_first - 1, color);
+            FillSpan((size_t) row, inner_last + 1, last_column, color);
+        }
+    }
+}
+
+void SoftwareRenderer::FillSpan(size_t row, long first_column, long last_column, uint32_t color) {
+    first_column = std::max(first_column, 0L);
+    last_column = std::min(last_column, (long) layout_.width - 1);
+    if (row >= layout_.height || first_column > last_column) {
+        return;
+    }
+
+    uint8_t *pixel = &pixels_[(row * layout_.width + (size_t) first_column) * 4];
+    for (long column = first_column; column <= last_column; column++) {
+        pixel[0] = (uint8_t) (color >> 24);
+        pixel[1] = (uint8_t) (color >> 16);
+        pixel[2] = (uint8_t) (color >> 8);
+        pixel[3] = (uint8_t) color;
+        pixel += 4;
+    }
+}
+
+FrameRecorder::FrameRecorder(const std::string &directory, uint64_t interval, const FrameLayout &layout,
+                             TaskScheduler *scheduler)
+        : directory_(directory), interval_(std::max(interval, (uint64_t) 1)), scheduler_(scheduler),
+          renderer_(layout, scheduler) {}
+
+bool FrameRecorder::Capture(const WorldSnapshot &snapshot) {
+    if (snapshot.tick % interval_ != 0 || (wrote_any_ && snapshot.tick == last_tick_)) {
+        return true;
+    }
+
+    renderer_.Render(snapshot);
+    if (!PngWriter::Write(GetFramePath(directory_, frames_written_), renderer_.GetPixels().data(),
+                          renderer_.GetWidth(), renderer_.GetHeight(), scheduler_)) {
+        return false;
+    }
+
+    frames_written_++;
+    wrote_any_ = true;
+    last_tick_ = snapshot.tick;
+    return true;
+}
+
+size_t FrameRecorder::GetFramesWritten() const {
+    return frames_written_;
+}
+
+std::string FrameRecorder::GetFramePath(const std::string &directory, size_t frame) {
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%06zu.png", frame);
+    return directory + "/" + name;
+}
+
+}
@@ -187,6 +187,12 @@ void SpeedHistogram::SetParticles(std::vector<Creature> new_particles) {
     creatures_ = speed_creatures;
 }
 
+MemoryFootprint SpeedHistogram::GetMemoryFootprint() const {
+    MemoryFootprint footprint;
+    footprint.Add(creatures_);
+    return footprint;
+}
+
 // Source: https://www.codegrepper.com/code-examples/cpp/c%2B%2B+round+float+to+2+decimal+places
 std::string SpeedHistogram::FloatToStringPrecision(float value, unsigned char prec) const {
     std::stringstream ss;
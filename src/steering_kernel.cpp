@@ -0,0 +1,304 @@
+#include "steering_kernel.h"
+#include "creature.h"
+#include <algorithm>
+#include <cmath>
+
+namespace naturalselection {
+
+using glm::vec2;
+
+size_t SteeringBatch::Size() const {
+    return x.size();
+}
+
+void SteeringBatch::Gather(const std::vector<Creature> &creatures) {
+    size_t count = creatures.size();
+    x.resize(count);
+    y.resize(count);
+    previous_x.resize(count);
+    previous_y.resize(count);
+    x_velocity.resize(count);
+    y_velocity.resize(count);
+    max_velocity.resize(count);
+    radius.resize(count);
+    mass.resize(count);
+    energy.resize(count);
+    energy_spend.resize(count);
+    vision_radius.resize(count);
+    food.resize(count);
+    needs_movement.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        const Creature &curr_creature = creatures[i];
+        x[i] = curr_creature.GetPosition().x;
+        y[i] = curr_creature.GetPosition().y;
+        previous_x[i] = curr_creature.GetPreviousPosition().x;
+        previous_y[i] = curr_creature.GetPreviousPosition().y;
+        x_velocity[i] = curr_creature.GetVelocity().x;
+        y_velocity[i] = curr_creature.GetVelocity().y;
+        max_velocity[i] = curr_creature.GetMaxVelocity();
+        radius[i] = curr_creature.GetRadius();
+        mass[i] = curr_creature.GetMass();
+        energy[i] = curr_creature.GetEnergy();
+        energy_spend[i] = curr_creature.GetEnergySpend();
+        vision_radius[i] = curr_creature.GetVisionRadius();
+        food[i] = curr_creature.GetFood();
+        needs_movement[i] = curr_creature.GetNeedsMovement() ? 1 : 0;
+    }
+}
+
+void SteeringBatch::Scatter(std::vector<Creature> &creatures) const {
+    for (size_t i = 0; i < creatures.size(); i++) {
+        Creature &curr_creature = creatures[i];
+        curr_creature.SetPosition(vec2(x[i], y[i]));
+        curr_creature.SetPreviousPosition(vec2(previous_x[i], previous_y[i]));
+        curr_creature.SetVelocity(vec2(x_velocity[i], y_velocity[i]));
+        curr_creature.SetEnergy(energy[i]);
+        curr_creature.SetFood(food[i]);
+        curr_creature.SetNeedsMovement(needs_movement[i] != 0);
+    }
+}
+
+// Same arithmetic as Creature::CalculateDistance so that ties resolve identically.
+static inline float CornerDistance(float x_pos, float y_pos, float corner_x, float corner_y) {
+    double x_diff = corner_x - x_pos;
+    double y_diff = corner_y - y_pos;
+    return (float) std::sqrt(x_diff * x_diff + y_diff * y_diff * 1.0);
+}
+
+void SteeringKernel::TowardsFurthestCorner(SteeringBatch &batch, const std::vector<uint8_t> &mask) {
+    TowardsFurthestCorner(batch, mask, 0, batch.Size());
+}
+
+void SteeringKernel::TowardsFurthestCorner(SteeringBatch &batch, const std::vector<uint8_t> &mask,
+                                           size_t begin, size_t end) {
+    const float left = (float) DEFAULT_X_COOR;
+    const float right = (float) (DEFAULT_X_COOR + DEFAULT_WIDTH);
+    const float top = (float) DEFAULT_Y_COOR;
+    const float bottom = (float) (DEFAULT_Y_COOR + DEFAULT_HEIGHT);
+
+    const float *x = batch.x.data();
+    const float *y = batch.y.data();
+    const float *max_velocity = batch.max_velocity.data();
+    float *x_velocity = batch.x_velocity.data();
+    float *y_velocity = batch.y_velocity.data();
+    const uint8_t *active = mask.data();
+
+    for (size_t i = begin; i < end; i++) {
+        float top_left = CornerDistance(x[i], y[i], left, top);
+        float top_right = CornerDistance(x[i], y[i], right, top);
+        float bottom_left = CornerDistance(x[i], y[i], left, bottom);
+        float bottom_right = CornerDistance(x[i], y[i], right, bottom);
+
+        float furthest = std::max(top_left, std::max(top_right, std::max(bottom_left, bottom_right)));
+
+        // Ties go to the first corner in the order the scalar code checks them.
+        bool is_top_left = furthest == top_left;
+        bool is_top_right = !is_top_left && furthest == top_right;
+        bool is_bottom_left = !is_top_left && !is_top_right && furthest == bottom_left;
+        bool is_left = is_top_left || is_bottom_left;
+        bool is_top = is_top_left || is_top_right;
+
+        float x_diff = (is_left ? left : right) - x[i];
+        float y_diff = (is_top ? top : bottom) - y[i];
+        float inverse_length = 1.0f / std::sqrt(x_diff * x_diff + y_diff * y_diff);
+
+        x_velocity[i] = active[i] ? (x_diff * inverse_length) * max_velocity[i] : x_velocity[i];
+        y_velocity[i] = active[i] ? (y_diff * inverse_length) * max_velocity[i] : y_velocity[i];
+    }
+}
+
+// Distances to the four walls in the same order and precision as the scalar steering methods.
+struct WallDistances {
+    float bottom;
+    float top;
+    float right;
+    float left;
+    float closest;
+};
+
+static inline WallDistances CalculateWallDistances(float x_pos, float y_pos) {
+    WallDistances distances;
+    distances.bottom = DEFAULT_HEIGHT - (y_pos - DEFAULT_Y_COOR);
+    distances.top = DEFAULT_HEIGHT - distances.bottom;
+    distances.right = DEFAULT_WIDTH - (x_pos - DEFAULT_X_COOR);
+    distances.left = DEFAULT_WIDTH - distances.right;
+    distances.closest = std::min(distances.left, std::min(distances.right,
+                                 std::min(distances.bottom, distances.top)));
+    return distances;
+}
+
+// Full speed straight at the closest wall, checking walls in the same order as the scalar code.
+static inline void NearestWallVelocity(const WallDistances &distances, float max_velocity,
+                                       float &x_velocity, float &y_velocity) {
+    bool is_bottom = distances.closest == distances.bottom;
+    bool is_top = !is_bottom && distances.closest == distances.top;
+    bool is_right = !is_bottom && !is_top && distances.closest == distances.right;
+    bool is_vertical = is_bottom || is_top;
+
+    x_velocity = is_vertical ? 0.0f : (is_right ? max_velocity : -max_velocity);
+    y_velocity = is_bottom ? max_velocity : (is_top ? -max_velocity : 0.0f);
+}
+
+void SteeringKernel::TowardsNearestWall(SteeringBatch &batch, const std::vector<uint8_t> &mask) {
+    TowardsNearestWall(batch, mask, 0, batch.Size());
+}
+
+void SteeringKernel::TowardsNearestWall(SteeringBatch &batch, const std::vector<uint8_t> &mask,
+                                        size_t begin, size_t end) {
+    const float *x = batch.x.data();
+    const float *y = batch.y.data();
+    const float *max_velocity = batch.max_velocity.data();
+    float *x_velocity = batch.x_velocity.data();
+    float *y_velocity = batch.y_velocity.data();
+    const uint8_t *active = mask.data();
+
+    for (size_t i = begin; i < end; i++) {
+        WallDistances distances = CalculateWallDistances(x[i], y[i]);
+
+        float new_x_velocity;
+        float new_y_velocity;
+        NearestWallVelocity(distances, max_velocity[i], new_x_velocity, new_y_velocity);
+
+        x_velocity[i] = active[i] ? new_x_velocity : x_velocity[i];
+        y_velocity[i] = active[i] ? new_y_velocity : y_velocity[i];
+    }
+}
+
+void SteeringKernel::IfNotEnoughEnergy(SteeringBatch &batch, const std::vector<uint8_t> &mask) {
+    IfNotEnoughEnergy(batch, mask, 0, batch.Size());
+}
+
+void SteeringKernel::IfNotEnoughEnergy(SteeringBatch &batch, const std::vector<uint8_t> &mask,
+                                       size_t begin, size_t end) {
+    const float *x = batch.x.data();
+    const float *y = batch.y.data();
+    const float *max_velocity = batch.max_velocity.data();
+    const double *energy = batch.energy.data();
+    const double *energy_spend = batch.energy_spend.data();
+    float *x_velocity = batch.x_velocity.data();
+    float *y_velocity = batch.y_velocity.data();
+    const uint8_t *active = mask.data();
+
+    for (size_t i = begin; i < end; i++) {
+        WallDistances distances = CalculateWallDistances(x[i], y[i]);
+        double energy_needed = (distances.closest / max_velocity[i]) * energy_spend[i];
+
+        float new_x_velocity;
+        float new_y_velocity;
+        NearestWallVelocity(distances, max_velocity[i], new_x_velocity, new_y_velocity);
+
+        bool head_home = active[i] && energy_needed >= energy[i];
+        x_velocity[i] = head_home ? new_x_velocity : x_velocity[i];
+        y_velocity[i] = head_home ? new_y_velocity : y_velocity[i];
+    }
+}
+
+void SteeringKernel::IfEnoughFood(SteeringBatch &batch) {
+    IfEnoughFood(batch, 0, batch.Size());
+}
+
+void SteeringKernel::IfEnoughFood(SteeringBatch &batch, size_t begin, size_t end) {
+    const float *x = batch.x.data();
+    const float *y = batch.y.data();
+    const float *max_velocity = batch.max_velocity.data();
+    const int *food = batch.food.data();
+    float *x_velocity = batch.x_velocity.data();
+    float *y_velocity = batch.y_velocity.data();
+
+    for (size_t i = begin; i < end; i++) {
+        WallDistances distances = CalculateWallDistances(x[i], y[i]);
+
+        float new_x_velocity;
+        float new_y_velocity;
+        NearestWallVelocity(distances, max_velocity[i], new_x_velocity, new_y_velocity);
+
+        bool head_home = food[i] == 2;
+        x_velocity[i] = head_home ? new_x_velocity : x_velocity[i];
+        y_velocity[i] = head_home ? new_y_velocity : y_velocity[i];
+    }
+}
+
+void SteeringKernel::ResolveWallHits(SteeringBatch &batch, const WorldBounds &bounds,
+                                     const std::vector<uint8_t> &food_empty) {
+    ResolveWallHits(batch, bounds, food_empty, 0, batch.Size());
+}
+
+void SteeringKernel::ResolveWallHits(SteeringBatch &batch, const WorldBounds &bounds,
+                                     const std::vector<uint8_t> &food_empty, size_t begin, size_t end) {
+    const float *x = batch.x.data();
+    const float *y = batch.y.data();
+    const double *energy = batch.energy.data();
+    const int *food = batch.food.data();
+    const uint8_t *no_food_left = food_empty.data();
+    float *x_velocity = batch.x_velocity.data();
+    float *y_velocity = batch.y_velocity.data();
+
+    const float right_wall = bounds.x_coor + bounds.width;
+    const float bottom_wall = bounds.y_coor + bounds.height;
+
+    for (size_t i = begin; i < end; i++) {
+        bool hits_left = x[i] <= bounds.x_coor;
+        bool hits_right = x[i] >= right_wall;
+        bool hits_top = y[i] <= bounds.y_coor;
+        bool hits_bottom = y[i] >= bottom_wall;
+        bool hits_any = hits_left || hits_right || hits_top || hits_bottom;
+
+        // Creatures that are out of energy, full, or have nothing left to find stop at the wall.
+        bool stops = hits_any && (energy[i] <= 0 || food[i] == 2 || no_food_left[i]);
+
+        // Otherwise bounce, but only if still moving into the wall.
+        bool flips_x = (hits_left && x_velocity[i] < 0) || (hits_right && x_velocity[i] > 0);
+        bool flips_y = (hits_top && y_velocity[i] < 0) || (hits_bottom && y_velocity[i] > 0);
+
+        float bounced_x_velocity = flips_x ? x_velocity[i] * (-1) : x_velocity[i];
+        float bounced_y_velocity = flips_y ? y_velocity[i] * (-1) : y_velocity[i];
+
+        x_velocity[i] = stops ? 0.0f : bounced_x_velocity;
+        y_velocity[i] = stops ? 0.0f : bounced_y_velocity;
+    }
+}
+
+void SteeringKernel::Move(SteeringBatch &batch, const WorldBounds &bounds, float time_step) {
+    Move(batch, bounds, time_step, 0, batch.Size());
+}
+
+void SteeringKernel::Move(SteeringBatch &batch, const WorldBounds &bounds, float time_step, size_t begin,
+                          size_t end) {
+    float *x = batch.x.data();
+    float *y = batch.y.data();
+    float *previous_x = batch.previous_x.data();
+    float *previous_y = batch.previous_y.data();
+    const float *x_velocity = batch.x_velocity.data();
+    const float *y_velocity = batch.y_velocity.data();
+    double *energy = batch.energy.data();
+    const double *energy_spend = batch.energy_spend.data();
+
+    const float right_wall = bounds.x_coor + bounds.width;
+    const float bottom_wall = bounds.y_coor + bounds.height;
+
+    for (size_t i = begin; i < end; i++) {
+        energy[i] = energy[i] > 0 ? energy[i] - energy_spend[i] * time_step : energy[i];
+        previous_x[i] = x[i];
+        previous_y[i] = y[i];
+        x[i] = StopAtWalls(x[i], x[i] + x_velocity[i] * time_step, bounds.x_coor, right_wall);
+        y[i] = StopAtWalls(y[i], y[i] + y_velocity[i] * time_step, bounds.y_coor, bottom_wall);
+    }
+}
+
+float SteeringKernel::SweptDistance(float from_x, float from_y, float to_x, float to_y, float point_x,
+                                    float point_y) {
+    // How far back from the end of the move its nearest point is, as a fraction of the move.
+    // Measuring from the end means a move that didn't get anywhere gives exactly the end.
+    float move_x = to_x - from_x;
+    float move_y = to_y - from_y;
+    float length_squared = move_x * move_x + move_y * move_y;
+    float back = 0;
+    if (length_squared > 0) {
+        back = ((to_x - point_x) * move_x + (to_y - point_y) * move_y) / length_squared;
+        back = std::min(std::max(back, 0.0f), 1.0f);
+    }
+    return CornerDistance(to_x - back * move_x, to_y - back * move_y, point_x, point_y);
+}
+
+}
@@ -0,0 +1,197 @@
+#include "sweep_and_prune.h"
+#include "morton_order.h"
+#include "physics.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace naturalselection {
+
+using glm::vec2;
+
+// Bits of value that order as unsigned integers the way the floats do.
+static uint32_t GetOrderedBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+void SweepAndPrune::SortByMinX() {
+    // Key in the high half and index in the low half, so ties go by index and the result never
+    // depends on the previous order, and comparisons read one contiguous array.
+    size_t count = min_x_.size();
+    if (order_.size() != count) { // Population changed, so start over.
+        order_.resize(count);
+        std::iota(order_.begin(), order_.end(), 0);
+    }
+    keyed_.resize(count);
+    for (size_t a = 0; a < count; a++) {
+        keyed_[a] = ((uint64_t) GetOrderedBits(min_x_[order_[a]]) << 32) | order_[a];
+    }
+
+    // Insertion sort is linear on the nearly sorted order left from last tick. If the
+    // creatures were reshuffled (e.g. new generation), give up and sort from scratch.
+    size_t shift_budget = 8 * count + 64;
+    size_t shifts = 0;
+    for (size_t i = 1; i < count && shifts <= shift_budget; i++) {
+        uint64_t curr = keyed_[i];
+        size_t j = i;
+        while (j > 0 && curr < keyed_[j - 1]) {
+            keyed_[j] = keyed_[j - 1];
+            j--;
+            shifts++;
+        }
+        keyed_[j] = curr;
+    }
+    if (shifts > shift_budget) { // Radix sort from index order, so ties still go by index
+        for (size_t i = 0; i < count; i++) {
+            keyed_[i] = ((uint64_t) GetOrderedBits(min_x_[i]) << 32) | i;
+        }
+        SortByKeyHalf(keyed_, scratch_);
+    }
+
+    for (size_t a = 0; a < count; a++) {
+        order_[a] = (uint32_t) keyed_[a];
+    }
+}
+
+void SweepAndPrune::FindCandidatePairs(const SteeringBatch &batch, std::vector<CollisionPair> &pairs) {
+    pairs.clear();
+    size_t count = batch.Size();
+    if (count == 0) {
+        return;
+    }
+
+    min_x_.resize(count);
+    float max_radius = 0;
+    float min_y = batch.y[0];
+    float max_y = batch.y[0];
+    for (size_t i = 0; i < count; i++) {
+        min_x_[i] = batch.x[i] - batch.radius[i];
+        max_radius = std::max(max_radius, batch.radius[i]);
+        min_y = std::min(min_y, batch.y[i]);
+        max_y = std::max(max_y, batch.y[i]);
+    }
+
+    SortByMinX();
+
+    // Creatures go in bands along y at least two radii tall, so only creatures in the same or the
+    // next band up can touch. There are never more bands than creatures, however far apart they are.
+    float band_height = std::max(2 * max_radius, 1.0f);
+    band_height = std::max(band_height, (max_y - min_y) / (float) count);
+    size_t band_count = (size_t) ((max_y - min_y) / band_height) + 1;
+    band_start_.assign(band_count + 1, 0);
+    band_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        band_[i] = std::min((uint32_t) ((batch.y[i] - min_y) / band_height), (uint32_t) band_count - 1);
+        band_start_[band_[i] + 1]++;
+    }
+    for (size_t band = 0; band < band_count; band++) {
+        band_start_[band + 1] += band_start_[band];
+    }
+
+    // Copy the boxes out band by band, each in sweep order, so the sweeps below read memory sequentially.
+    sorted_.resize(count);
+    band_fill_.assign(band_start_.begin(), band_start_.end() - 1);
+    for (size_t a = 0; a < count; a++) {
+        uint32_t i = order_[a];
+        sorted_[band_fill_[band_[i]]++] = SweepEntry{min_x_[i], batch.x[i] + batch.radius[i], batch.y[i],
+                                                     batch.radius[i], i};
+    }
+
+    for (size_t band = 0; band < band_count; band++) {
+        size_t begin = band_start_[band];
+        size_t end = band_start_[band + 1];
+        for (size_t a = begin; a < end; a++) {
+            // Only creatures that start before this one ends along x can overlap it.
+            for (size_t b = a + 1; b < end && sorted_[b].min_x <= sorted_[a].max_x; b++) {
+                AddIfOverlapping(sorted_[a], sorted_[b], pairs);
+            }
+        }
+        if (band + 1 < band_count) {
+            SweepAcross(begin, end, end, band_start_[band + 2], pairs);
+        }
+    }
+}
+
+void SweepAndPrune::SweepAcross(size_t begin, size_t end, size_t next_begin, size_t next_end,
+                                std::vector<CollisionPair> &pairs) const {
+    // Each pair is found from whichever of the two starts first along x, the lower band on ties.
+    size_t first = next_begin;
+    for (size_t a = begin; a < end; a++) {
+        while (first < next_end && sorted_[first].min_x < sorted_[a].min_x) {
+            first++;
+        }
+        for (size_t b = first; b < next_end && sorted_[b].min_x <= sorted_[a].max_x; b++) {
+            AddIfOverlapping(sorted_[a], sorted_[b], pairs);
+        }
+    }
+
+    first = begin;
+    for (size_t b = next_begin; b < next_end; b++) {
+        while (first < end && sorted_[first].min_x <= sorted_[b].min_x) {
+            first++;
+        }
+        for (size_t a = first; a < end && sorted_[a].min_x <= sorted_[b].max_x; a++) {
+            AddIfOverlapping(sorted_[a], sorted_[b], pairs);
+        }
+    }
+}
+
+void SweepAndPrune::AddIfOverlapping(const SweepEntry &a, const SweepEntry &b, std::vector<CollisionPair> &pairs) {
+    if (std::abs(a.y - b.y) <= a.radius + b.radius) {
+        pairs.push_back(CollisionPair{std::min(a.index, b.index), std::max(a.index, b.index)});
+    }
+}
+
+void SweepAndPrune::Renumber(const std::vector<uint32_t> &order) {
+    if (order.size() != order_.size()) { // The next sort starts over anyway
+        return;
+    }
+
+    std::vector<uint32_t> new_index(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        new_index[order[i]] = (uint32_t) i;
+    }
+    for (size_t a = 0; a < order_.size(); a++) {
+        order_[a] = new_index[order_[a]];
+    }
+}
+
+size_t SweepAndPrune::ResolveCollisions(SteeringBatch &batch, const std::vector<CollisionPair> &pairs) {
+    size_t collisions = 0;
+    for (size_t p = 0; p < pairs.size(); p++) {
+        uint32_t i = pairs[p].first;
+        uint32_t j = pairs[p].second;
+
+        vec2 position_1 = vec2(batch.x[i], batch.y[i]);
+        vec2 position_2 = vec2(batch.x[j], batch.y[j]);
+        vec2 velocity_1 = vec2(batch.x_velocity[i], batch.y_velocity[i]);
+        vec2 velocity_2 = vec2(batch.x_velocity[j], batch.y_velocity[j]);
+
+        vec2 offset = position_1 - position_2;
+        float reach = batch.radius[i] + batch.radius[j];
+        float distance_squared = glm::dot(offset, offset);
+
+        // Touching, not on top of each other, and moving closer together.
+        if (distance_squared > reach * reach || distance_squared == 0.0f ||
+            glm::dot(velocity_1 - velocity_2, offset) >= 0) {
+            continue;
+        }
+
+        vec2 new_velocity_1;
+        vec2 new_velocity_2;
+        Physics::CalculateParticleBounceVelocity(position_1, velocity_1, batch.mass[i],
+                                                 position_2, velocity_2, batch.mass[j],
+                                                 new_velocity_1, new_velocity_2);
+        batch.x_velocity[i] = new_velocity_1.x;
+        batch.y_velocity[i] = new_velocity_1.y;
+        batch.x_velocity[j] = new_velocity_2.x;
+        batch.y_velocity[j] = new_velocity_2.y;
+        collisions++;
+    }
+
+    return collisions;
+}
+
+}
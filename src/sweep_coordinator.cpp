@@ -0,0 +1,302 @@
+#include "sweep_coordinator.h"
+#include "creature.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace naturalselection {
+
+// How often the coordinator wakes up to check job timeouts when nothing arrives.
+static const int POLL_INTERVAL_MS = 1000;
+
+// Sends the whole line plus a newline. MSG_NOSIGNAL turns a dead peer into an error instead of SIGPIPE.
+static bool SendLine(int socket, const std::string &line) {
+    std::string message = line + "\n";
+    size_t sent = 0;
+    while (sent < message.size()) {
+        ssize_t written = send(socket, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        sent += (size_t) written;
+    }
+
+    return true;
+}
+
+// Appends whatever is available to buffer. Returns false once the peer has closed or failed.
+static bool ReceiveInto(int socket, std::string &buffer) {
+    char chunk[4096];
+    ssize_t received;
+    do {
+        received = recv(socket, chunk, sizeof(chunk), 0);
+    } while (received < 0 && errno == EINTR);
+
+    if (received <= 0) {
+        return false;
+    }
+    buffer.append(chunk, (size_t) received);
+    return true;
+}
+
+// Pops the first complete line off buffer, if there is one.
+static bool TakeLine(std::string &buffer, std::string &line) {
+    size_t end = buffer.find('\n');
+    if (end == std::string::npos) {
+        return false;
+    }
+
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+std::vector<SweepJob> SweepGrid::Expand() const {
+    std::vector<SweepJob> jobs;
+    for (size_t food = 0; food < food_counts.size(); food++) {
+        for (size_t mask = 0; mask < creature_type_masks.size(); mask++) {
+            for (size_t collision = 0; collision < collisions.size(); collision++) {
+                for (size_t replica = 0; replica < replicas; replica++) {
+                    SweepJob job;
+                    job.id = jobs.size();
+                    job.seed = base_seed + (uint32_t) job.id;
+                    job.food_count = food_counts[food];
+                    job.speed_creatures = (creature_type_masks[mask] & (1 << SPEED)) != 0;
+                    job.intelligence_creatures = (creature_type_masks[mask] & (1 << INTELLIGENCE)) != 0;
+                    job.both_type_creatures = (creature_type_masks[mask] & (1 << BOTH)) != 0;
+                    job.collisions_enabled = collisions[collision];
+                    job.generations = generations;
+                    job.max_ticks = max_ticks;
+                    job.carrying_capacity = carrying_capacity;
+                    job.capacity_policy = capacity_policy;
+                    job.time_step = time_step;
+                    job.food_regrowth_rate = food_regrowth_rate;
+                    job.fast_forward_calibration = fast_forward_calibration;
+                    job.fast_forward_skipped = fast_forward_skipped;
+                    jobs.push_back(job);
+                }
+            }
+        }
+    }
+
+    return jobs;
+}
+
+SweepCoordinator::SweepCoordinator(const std::vector<SweepJob> &jobs, const SweepOptions &options,
+                                   JobRunner runner) {
+    jobs_ = jobs;
+    options_ = options;
+    runner_ = runner;
+    attempts_.assign(jobs_.size(), 0);
+}
+
+SweepCoordinator::~SweepCoordinator() {
+    for (size_t i = 0; i < workers_.size(); i++) {
+        StopWorker(workers_.at(i), true);
+    }
+}
+
+bool SweepCoordinator::Run(std::ostream &output) {
+    output << SweepResult::CsvHeader() << "\n";
+    output.flush(); // Nothing buffered may be inherited by the forked workers
+
+    for (size_t i = 0; i < jobs_.size(); i++) {
+        pending_jobs_.push_back(i);
+    }
+
+    size_t worker_count = options_.worker_count > 0 ? options_.worker_count : DefaultThreadCount();
+    workers_.resize(std::min(worker_count, jobs_.size()));
+    // Every worker would otherwise size its own thread pools for the whole machine.
+    worker_thread_budget_ = options_.threads_per_worker > 0 ? options_.threads_per_worker :
+                            std::max(DefaultThreadCount() / std::max(workers_.size(), (size_t) 1), (size_t) 1);
+    for (size_t i = 0; i < workers_.size(); i++) {
+        if (!SpawnWorker(workers_.at(i))) {
+            return false;
+        }
+    }
+
+    std::vector<pollfd> poll_fds(workers_.size());
+    while (finished_count_ + failed_jobs_.size() < jobs_.size()) {
+        // Keep every worker busy while there is anything left to hand out.
+        for (size_t i = 0; i < workers_.size(); i++) {
+            Worker &worker = workers_.at(i);
+            if (!worker.busy && !pending_jobs_.empty()) {
+                size_t job_index = pending_jobs_.front();
+                pending_jobs_.pop_front();
+                if (!DispatchJob(worker, job_index)) {
+                    HandleWorkerLoss(worker);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < workers_.size(); i++) {
+            poll_fds[i].fd = workers_.at(i).socket;
+            poll_fds[i].events = POLLIN;
+            poll_fds[i].revents = 0;
+        }
+        if (poll(poll_fds.data(), poll_fds.size(), POLL_INTERVAL_MS) < 0 && errno != EINTR) {
+            return false;
+        }
+
+        time_t now = time(NULL);
+        for (size_t i = 0; i < workers_.size(); i++) {
+            Worker &worker = workers_.at(i);
+            if (worker.socket < 0) { // Could not be restarted
+                return false;
+            }
+
+            if (poll_fds[i].revents != 0) {
+                if (!ReadResults(worker, output)) {
+                    HandleWorkerLoss(worker);
+                }
+            } else if (worker.busy && options_.job_timeout_seconds > 0 &&
+                       now - worker.started_at >= options_.job_timeout_seconds) {
+                HandleWorkerLoss(worker);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < workers_.size(); i++) {
+        StopWorker(workers_.at(i), false);
+    }
+    return failed_jobs_.empty();
+}
+
+const std::vector<size_t> &SweepCoordinator::GetFailedJobs() const {
+    return failed_jobs_;
+}
+
+size_t SweepCoordinator::GetRetryCount() const {
+    return retry_count_;
+}
+
+bool SweepCoordinator::SpawnWorker(Worker &worker) {
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) < 0) {
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(sockets[0]);
+        close(sockets[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        // Only keep our own end, otherwise other workers never see their socket close.
+        close(sockets[0]);
+        for (size_t i = 0; i < workers_.size(); i++) {
+            if (workers_.at(i).socket >= 0) {
+                close(workers_.at(i).socket);
+            }
+        }
+        SetThreadBudget(worker_thread_budget_);
+        WorkerLoop(sockets[1], runner_);
+        _exit(0);
+    }
+
+    close(sockets[1]);
+    worker.pid = pid;
+    worker.socket = sockets[0];
+    worker.busy = false;
+    worker.read_buffer.clear();
+    return true;
+}
+
+void SweepCoordinator::StopWorker(Worker &worker, bool kill_process) {
+    if (worker.socket >= 0) {
+        close(worker.socket); // An idle worker exits when it reads end of file
+        worker.socket = -1;
+    }
+
+    if (worker.pid > 0) {
+        if (kill_process) {
+            kill(worker.pid, SIGKILL);
+        }
+        waitpid(worker.pid, NULL, 0);
+        worker.pid = -1;
+    }
+}
+
+void SweepCoordinator::HandleWorkerLoss(Worker &worker) {
+    StopWorker(worker, true);
+    if (worker.busy) {
+        worker.busy = false;
+        RequeueOrFail(worker.job_index);
+    }
+
+    // Leaves socket at -1 on failure, which Run treats as fatal.
+    SpawnWorker(worker);
+}
+
+bool SweepCoordinator::DispatchJob(Worker &worker, size_t job_index) {
+    SweepJob job = jobs_.at(job_index);
+    job.attempt = attempts_.at(job_index);
+    if (options_.metrics_port != 0) { // One port per worker, so jobs running side by side never share one
+        job.metrics_port = (uint16_t) (options_.metrics_port + (&worker - &workers_.front()));
+    }
+
+    worker.busy = true;
+    worker.job_index = job_index;
+    worker.started_at = time(NULL);
+    return SendLine(worker.socket, job.Serialize());
+}
+
+bool SweepCoordinator::ReadResults(Worker &worker, std::ostream &output) {
+    if (!ReceiveInto(worker.socket, worker.read_buffer)) {
+        return false;
+    }
+
+    std::string line;
+    while (TakeLine(worker.read_buffer, line)) {
+        SweepResult result;
+        if (!SweepResult::Parse(line, result) || !worker.busy ||
+            result.job_id != jobs_.at(worker.job_index).id) {
+            return false;
+        }
+
+        output << result.ToCsvRow() << "\n";
+        output.flush(); // A crash of the coordinator itself should lose as little as possible
+        worker.busy = false;
+        finished_count_++;
+    }
+
+    return true;
+}
+
+void SweepCoordinator::RequeueOrFail(size_t job_index) {
+    attempts_.at(job_index)++;
+    if (attempts_.at(job_index) >= options_.max_attempts) {
+        failed_jobs_.push_back(job_index);
+    } else {
+        retry_count_++;
+        pending_jobs_.push_front(job_index); // Retry soon, while its neighbours are still running
+    }
+}
+
+void SweepCoordinator::WorkerLoop(int socket, const JobRunner &runner) {
+    std::string buffer;
+    std::string line;
+    while (ReceiveInto(socket, buffer)) {
+        while (TakeLine(buffer, line)) {
+            SweepJob job;
+            if (!SweepJob::Parse(line, job)) {
+                return;
+            }
+            if (!SendLine(socket, runner(job).Serialize())) {
+                return;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,200 @@
+#include "task_scheduler.h"
+#include "parallel_for.h"
+
+namespace naturalselection {
+
+// The scheduler whose tasks this thread is running, if any.
+static thread_local TaskScheduler *current_scheduler = nullptr;
+
+TaskGraph::TaskId TaskGraph::AddTask(std::function<void()> work) {
+    Task task;
+    task.work = work;
+    tasks_.push_back(task);
+    return tasks_.size() - 1;
+}
+
+void TaskGraph::AddDependency(TaskId before, TaskId after) {
+    tasks_.at(before).successors.push_back(after);
+    tasks_.at(after).dependency_count++;
+}
+
+size_t TaskGraph::Size() const {
+    return tasks_.size();
+}
+
+void TaskGraph::Clear() {
+    tasks_.clear();
+}
+
+void TaskGraph::RunInline() {
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        tasks_[i].work();
+    }
+}
+
+TaskScheduler::TaskScheduler(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+
+    remaining_tasks_ = 0;
+    for (size_t i = 0; i < thread_count; i++) {
+        queues_.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+
+    // Worker 0 is whichever thread calls Run.
+    for (size_t i = 1; i < thread_count; i++) {
+        threads_.emplace_back([this, i]() { WorkerMain(i); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (size_t i = 0; i < threads_.size(); i++) {
+        threads_[i].join();
+    }
+}
+
+size_t TaskScheduler::GetThreadCount() const {
+    return queues_.size();
+}
+
+TaskScheduler &TaskScheduler::Shared() {
+    static TaskScheduler scheduler(DefaultThreadCount());
+    return scheduler;
+}
+
+void TaskScheduler::Run(TaskGraph &graph) {
+    size_t task_count = graph.tasks_.size();
+    if (task_count == 0) {
+        return;
+    }
+    if (queues_.size() == 1 || current_scheduler == this) { // Nobody to share with, or already inside a task
+        graph.RunInline();
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    if (pending_capacity_ < task_count) {
+        pending_dependencies_.reset(new std::atomic<size_t>[task_count]);
+        pending_capacity_ = task_count;
+    }
+    for (size_t i = 0; i < task_count; i++) {
+        pending_dependencies_[i] = graph.tasks_[i].dependency_count;
+    }
+    remaining_tasks_ = task_count;
+    graph_ = &graph;
+
+    // Deal the tasks that can start right away round-robin, so every thread begins with some work.
+    size_t next_queue = 0;
+    for (size_t i = 0; i < task_count; i++) {
+        if (graph.tasks_[i].dependency_count == 0) {
+            Push(next_queue, i);
+            next_queue = (next_queue + 1) % queues_.size();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        run_count_++;
+    }
+    wake_.notify_all();
+
+    TaskScheduler *outer_scheduler = current_scheduler;
+    current_scheduler = this;
+    WorkUntilDone(0);
+    current_scheduler = outer_scheduler;
+
+    // Workers may still be on their way out of WorkUntilDone; the graph has to outlive them.
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    idle_.wait(lock, [this]() { return active_workers_ == 0; });
+    graph_ = nullptr;
+}
+
+void TaskScheduler::WorkerMain(size_t worker) {
+    current_scheduler = this;
+    uint64_t runs_seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait(lock, [this, runs_seen]() { return stopping_ || run_count_ != runs_seen; });
+            if (stopping_) {
+                return;
+            }
+            runs_seen = run_count_;
+            active_workers_++;
+        }
+
+        WorkUntilDone(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            active_workers_--;
+        }
+        idle_.notify_all();
+    }
+}
+
+void TaskScheduler::Push(size_t worker, TaskGraph::TaskId task) {
+    WorkerQueue &queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(task);
+}
+
+bool TaskScheduler::TryRunOne(size_t worker) {
+    bool found = false;
+    TaskGraph::TaskId task = 0;
+
+    // Own work first, newest first.
+    {
+        WorkerQueue &queue = *queues_[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    // Otherwise steal the oldest task from the next thread that has any.
+    for (size_t offset = 1; !found && offset < queues_.size(); offset++) {
+        WorkerQueue &victim = *queues_[(worker + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    TaskGraph::Task &current = graph_->tasks_[task];
+    current.work();
+
+    for (size_t i = 0; i < current.successors.size(); i++) {
+        TaskGraph::TaskId successor = current.successors[i];
+        if (pending_dependencies_[successor].fetch_sub(1) == 1) {
+            Push(worker, successor);
+        }
+    }
+    remaining_tasks_.fetch_sub(1);
+    return true;
+}
+
+void TaskScheduler::WorkUntilDone(size_t worker) {
+    while (remaining_tasks_.load() > 0) {
+        if (!TryRunOne(worker)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+}
@@ -0,0 +1,579 @@
+#include "tick_graph.h"
+#include "creature.h"
+#include "food.h"
+#include <algorithm>
+#include <cmath>
+
+namespace naturalselection {
+
+static const uint32_t NOT_EATEN = UINT32_MAX;
+static const uint32_t NO_TARGET = UINT32_MAX;
+
+// Grid queries are widened by this much so float rounding at a cell edge never loses food.
+static const float GRID_QUERY_MARGIN = 1.0f;
+// Used when the caller has no grid for this food.
+static const float DEFAULT_FOOD_GRID_CELL_SIZE = 16.0f;
+// Sensing looks this much further than a creature can see, so its answer lasts while it moves.
+static const float SENSE_REACH_SLACK = 16.0f;
+// Held back from a remembered target's room, more than float rounding in the distances can eat.
+static const float SENSE_ROUNDING_MARGIN = 0.01f;
+// Beyond this much food added between ticks, every creature searches again rather than checking each one.
+static const size_t MAX_FOOD_ADDED_WITHOUT_SEARCHING = 64;
+
+static const char *PHASE_NAMES[TickGraph::PHASE_COUNT] = {
+        "steer to corner", "find touching food", "resolve eating", "sense nearest food",
+        "steer home", "resolve collisions", "move"
+};
+
+// Same arithmetic as Creature::CalculateDistance, so nearest food ties and vision checks come out identical.
+static inline float FoodDistance(float x_pos, float y_pos, float food_x, float food_y) {
+    double x_diff = food_x - x_pos;
+    double y_diff = food_y - y_pos;
+    return (float) std::sqrt(x_diff * x_diff + y_diff * y_diff * 1.0);
+}
+
+const char *TickGraph::GetPhaseName(int phase) {
+    return PHASE_NAMES[phase];
+}
+
+bool TickGraph::IsSerialPhase(int phase) {
+    return phase == PHASE_RESOLVE_EATING || phase == PHASE_RESOLVE_COLLISIONS;
+}
+
+void TickGraph::Prepare(SteeringBatch *batch, const std::vector<Food> *food, const FoodGrid *food_grid,
+                        const WorldBounds &bounds, SweepAndPrune *broad_phase, size_t chunk_size,
+                        float time_step) {
+    batch_ = batch;
+    food_ = food;
+    food_grid_ = food_grid;
+    if (food_grid_ == nullptr || food_grid_->Size() != food->size()) {
+        own_food_grid_.Build(*food, bounds, DEFAULT_FOOD_GRID_CELL_SIZE);
+        food_grid_ = &own_food_grid_;
+    }
+    bounds_ = bounds;
+    broad_phase_ = broad_phase;
+    chunk_size_ = std::max(chunk_size, (size_t) 1);
+    time_step_ = time_step;
+    chunk_count_ = std::max((batch->Size() + chunk_size_ - 1) / chunk_size_, (size_t) 1);
+
+    size_t food_count = food->size();
+    food_x_.resize(food_count);
+    food_y_.resize(food_count);
+    food_radius_.resize(food_count);
+    max_food_radius_ = 0;
+    for (size_t i = 0; i < food_count; i++) {
+        food_x_[i] = food->at(i).GetPosition().x;
+        food_y_[i] = food->at(i).GetPosition().y;
+        food_radius_[i] = food->at(i).GetRadius();
+        max_food_radius_ = std::max(max_food_radius_, food_radius_[i]);
+    }
+
+    touching_.resize(chunk_count_);
+    size_t creature_count = batch->Size();
+    food_empty_before_eating_.assign(creature_count, 0);
+    food_left_before_eating_.assign(creature_count, 0);
+    food_empty_after_eating_.assign(creature_count, 0);
+
+    // Remembered targets only carry over from the tick that left exactly this food.
+    if (sense_current_.size() != creature_count || food_count != expected_food_count_) {
+        sense_target_.assign(creature_count, NO_TARGET);
+        sense_current_.assign(creature_count, 0);
+        sensed_x_.resize(creature_count);
+        sensed_y_.resize(creature_count);
+        sensed_nearest_.resize(creature_count);
+        sensed_runner_up_.resize(creature_count);
+    }
+    expected_food_count_ = food_count;
+    sense_counts_.assign(chunk_count_, 0);
+    slice_phase_ = 0;
+    slice_chunk_ = 0;
+}
+
+size_t TickGraph::GetChunkCount() const {
+    return chunk_count_;
+}
+
+void TickGraph::RunPhase(int phase, size_t chunk) {
+    size_t begin = std::min(chunk * chunk_size_, batch_->Size());
+    size_t end = std::min(begin + chunk_size_, batch_->Size());
+
+    switch (phase) {
+        case PHASE_STEER_TO_CORNER:
+            SteerToCorner(begin, end);
+            break;
+        case PHASE_FIND_TOUCHING_FOOD:
+            FindTouchingFood(chunk, begin, end);
+            break;
+        case PHASE_RESOLVE_EATING:
+            ResolveEating();
+            break;
+        case PHASE_SENSE_NEAREST_FOOD:
+            SenseNearestFood(begin, end);
+            break;
+        case PHASE_STEER_HOME:
+            SteerHome(begin, end);
+            break;
+        case PHASE_RESOLVE_COLLISIONS:
+            ResolveCollisions();
+            break;
+        case PHASE_MOVE:
+            Move(begin, end);
+            break;
+    }
+}
+
+void TickGraph::BuildGraph(TaskGraph &graph) {
+    std::vector<TaskGraph::TaskId> corner(chunk_count_);
+    std::vector<TaskGraph::TaskId> touching(chunk_count_);
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        corner[chunk] = graph.AddTask([this, chunk]() { RunPhase(PHASE_STEER_TO_CORNER, chunk); });
+    }
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        touching[chunk] = graph.AddTask([this, chunk]() { RunPhase(PHASE_FIND_TOUCHING_FOOD, chunk); });
+    }
+
+    // Eating sets movement flags the corner phase clears, so it waits on both.
+    TaskGraph::TaskId eating = graph.AddTask([this]() { RunPhase(PHASE_RESOLVE_EATING, 0); });
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        graph.AddDependency(corner[chunk], eating);
+        graph.AddDependency(touching[chunk], eating);
+    }
+
+    std::vector<TaskGraph::TaskId> home(chunk_count_);
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        TaskGraph::TaskId sense = graph.AddTask([this, chunk]() { RunPhase(PHASE_SENSE_NEAREST_FOOD, chunk); });
+        graph.AddDependency(eating, sense);
+
+        home[chunk] = graph.AddTask([this, chunk]() { RunPhase(PHASE_STEER_HOME, chunk); });
+        graph.AddDependency(sense, home[chunk]);
+    }
+
+    // Collisions look at every creature at once, so they are a barrier when enabled.
+    bool has_collisions = broad_phase_ != nullptr;
+    TaskGraph::TaskId collisions = 0;
+    if (has_collisions) {
+        collisions = graph.AddTask([this]() { RunPhase(PHASE_RESOLVE_COLLISIONS, 0); });
+        for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+            graph.AddDependency(home[chunk], collisions);
+        }
+    }
+
+    for (size_t chunk = 0; chunk < chunk_count_; chunk++) {
+        TaskGraph::TaskId move = graph.AddTask([this, chunk]() { RunPhase(PHASE_MOVE, chunk); });
+        graph.AddDependency(has_collisions ? collisions : home[chunk], move);
+    }
+}
+
+void TickGraph::BuildPhaseGraph(int phase, TaskGraph &graph) {
+    size_t task_count = IsSerialPhase(phase) ? 1 : chunk_count_;
+    for (size_t chunk = 0; chunk < task_count; chunk++) {
+        graph.AddTask([this, phase, chunk]() { RunPhase(phase, chunk); });
+    }
+}
+
+bool TickGraph::RunSliced(TaskScheduler *scheduler, std::chrono::steady_clock::time_point deadline) {
+    // Phase by phase is stricter than BuildGraph's dependencies, so it gives the same tick.
+    size_t round_size = scheduler != nullptr ? scheduler->GetThreadCount() : 1;
+    bool ran_round = false;
+    while (slice_phase_ < PHASE_COUNT) {
+        if (ran_round && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        ran_round = true;
+
+        if (slice_phase_ == PHASE_RESOLVE_COLLISIONS && broad_phase_ == nullptr) {
+            slice_phase_++;
+            continue;
+        }
+        if (IsSerialPhase(slice_phase_)) {
+            RunPhase(slice_phase_, 0);
+            slice_phase_++;
+            continue;
+        }
+
+        size_t end = std::min(slice_chunk_ + round_size, chunk_count_);
+        if (scheduler != nullptr && end - slice_chunk_ > 1) {
+            slice_tasks_.Clear();
+            for (size_t chunk = slice_chunk_; chunk < end; chunk++) {
+                int phase = slice_phase_;
+                slice_tasks_.AddTask([this, phase, chunk]() { RunPhase(phase, chunk); });
+            }
+            scheduler->Run(slice_tasks_);
+        } else {
+            for (size_t chunk = slice_chunk_; chunk < end; chunk++) {
+                RunPhase(slice_phase_, chunk);
+            }
+        }
+
+        slice_chunk_ = end;
+        if (slice_chunk_ == chunk_count_) {
+            slice_phase_++;
+            slice_chunk_ = 0;
+        }
+    }
+    return true;
+}
+
+const std::vector<std::pair<uint32_t, uint32_t>> &TickGraph::GetMeals() const {
+    return meals_;
+}
+
+void TickGraph::CollectRemainingFood(std::vector<Food> &remaining) {
+    remaining.clear();
+    for (size_t i = 0; i < food_->size(); i++) {
+        if (eaten_by_[i] == NOT_EATEN) {
+            next_uneaten_[i] = (uint32_t) remaining.size(); // Done with the links, so reused as the new index
+            remaining.push_back(food_->at(i));
+        }
+    }
+
+    if (remaining.size() != food_->size()) {
+        for (size_t i = 0; i < sense_target_.size(); i++) {
+            uint32_t target = sense_target_[i];
+            if (target == NO_TARGET) {
+                continue;
+            }
+            if (eaten_by_[target] != NOT_EATEN) {
+                sense_current_[i] = 0;
+                sense_target_[i] = NO_TARGET;
+            } else {
+                sense_target_[i] = next_uneaten_[target];
+            }
+        }
+    }
+    expected_food_count_ = remaining.size();
+}
+
+void TickGraph::InvalidateSensing() {
+    std::fill(sense_current_.begin(), sense_current_.end(), 0);
+}
+
+// Moves values[order[i]] to values[i] for every i.
+template <typename T>
+static void Permute(std::vector<T> &values, const std::vector<uint32_t> &order, std::vector<T> &scratch) {
+    scratch.resize(values.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        scratch[i] = values[order[i]];
+    }
+    values.swap(scratch);
+}
+
+void TickGraph::Reorder(const std::vector<uint32_t> *creature_order, const std::vector<uint32_t> *food_order) {
+    // Anything that doesn't match the remembered state is left for Prepare to throw away.
+    if (creature_order != nullptr && creature_order->size() == sense_target_.size()) {
+        std::vector<uint32_t> uint_scratch;
+        std::vector<uint8_t> byte_scratch;
+        std::vector<float> float_scratch;
+        Permute(sense_target_, *creature_order, uint_scratch);
+        Permute(sense_current_, *creature_order, byte_scratch);
+        Permute(sensed_x_, *creature_order, float_scratch);
+        Permute(sensed_y_, *creature_order, float_scratch);
+        Permute(sensed_nearest_, *creature_order, float_scratch);
+        Permute(sensed_runner_up_, *creature_order, float_scratch);
+    }
+
+    if (food_order != nullptr && food_order->size() == expected_food_count_) {
+        std::vector<uint32_t> new_index(food_order->size());
+        for (size_t i = 0; i < food_order->size(); i++) {
+            new_index[food_order->at(i)] = (uint32_t) i;
+        }
+        for (size_t i = 0; i < sense_target_.size(); i++) {
+            if (sense_target_[i] != NO_TARGET) {
+                sense_target_[i] = new_index[sense_target_[i]];
+            }
+        }
+    }
+}
+
+void TickGraph::AddFood(const std::vector<Food> &food, size_t first_added) {
+    if (first_added != expected_food_count_ || first_added > food.size()) {
+        return; // Not the food this graph left, so Prepare throws the targets away anyway
+    }
+    expected_food_count_ = food.size();
+    if (food.size() - first_added > MAX_FOOD_ADDED_WITHOUT_SEARCHING) {
+        InvalidateSensing();
+        return;
+    }
+
+    for (size_t i = 0; i < sense_current_.size(); i++) {
+        if (!sense_current_[i]) {
+            continue;
+        }
+
+        // New food further than the room leaves things as they were; nearer, it becomes the bound.
+        float nearest_added = sensed_runner_up_[i];
+        for (size_t j = first_added; j < food.size(); j++) {
+            nearest_added = std::min(nearest_added, FoodDistance(sensed_x_[i], sensed_y_[i],
+                                                                 food[j].GetPosition().x, food[j].GetPosition().y));
+        }
+        sensed_runner_up_[i] = nearest_added;
+        if (sense_target_[i] == NO_TARGET) {
+            sensed_nearest_[i] = std::min(sensed_nearest_[i], nearest_added);
+        }
+    }
+}
+
+void TickGraph::TruncateFood(size_t food_count) {
+    if (food_count > expected_food_count_) {
+        return;
+    }
+    expected_food_count_ = food_count;
+    for (size_t i = 0; i < sense_target_.size(); i++) {
+        if (sense_target_[i] != NO_TARGET && sense_target_[i] >= food_count) {
+            sense_current_[i] = 0;
+            sense_target_[i] = NO_TARGET;
+        }
+    }
+}
+
+void TickGraph::RemoveFood(const std::vector<uint32_t> &food_order) {
+    if (food_order.size() > expected_food_count_) {
+        return;
+    }
+
+    std::vector<uint32_t> new_index(expected_food_count_, NO_TARGET);
+    for (size_t i = 0; i < food_order.size(); i++) {
+        if (food_order[i] >= expected_food_count_) {
+            return; // Not the food this graph left, so Prepare throws the targets away anyway
+        }
+        new_index[food_order[i]] = (uint32_t) i;
+    }
+    expected_food_count_ = food_order.size();
+    for (size_t i = 0; i < sense_target_.size(); i++) {
+        if (sense_target_[i] == NO_TARGET) {
+            continue;
+        }
+        sense_target_[i] = new_index[sense_target_[i]];
+        if (sense_target_[i] == NO_TARGET) {
+            sense_current_[i] = 0;
+        }
+    }
+}
+
+size_t TickGraph::GetSenseCount() const {
+    size_t count = 0;
+    for (size_t chunk = 0; chunk < sense_counts_.size(); chunk++) {
+        count += sense_counts_[chunk];
+    }
+    return count;
+}
+
+void TickGraph::SteerToCorner(size_t begin, size_t end) {
+    // Creatures that changed course last tick head for the furthest corner.
+    SteeringKernel::TowardsFurthestCorner(*batch_, batch_->needs_movement, begin, end);
+    std::fill(batch_->needs_movement.begin() + begin, batch_->needs_movement.begin() + end, 0);
+}
+
+void TickGraph::FindTouchingFood(size_t chunk, size_t begin, size_t end) {
+    std::vector<std::pair<uint32_t, uint32_t>> &touching = touching_[chunk];
+    touching.clear();
+
+    std::vector<uint32_t> nearby;
+    for (size_t i = begin; i < end; i++) {
+        if (batch_->food[i] >= 2) { // Full creatures never eat
+            continue;
+        }
+
+        // Anywhere along the last move counts, as Creature::IsTouchingSpecificFood has it.
+        float x_pos = batch_->x[i];
+        float y_pos = batch_->y[i];
+        float from_x = batch_->previous_x[i];
+        float from_y = batch_->previous_y[i];
+        bool moved = from_x != x_pos || from_y != y_pos;
+        float min_x = std::min(from_x, x_pos);
+        float max_x = std::max(from_x, x_pos);
+        float min_y = std::min(from_y, y_pos);
+        float max_y = std::max(from_y, y_pos);
+        float half_move = std::max(max_x - min_x, max_y - min_y) / 2;
+        float radius = batch_->radius[i];
+        nearby.clear();
+        food_grid_->ForEachNear((min_x + max_x) / 2, (min_y + max_y) / 2,
+                                radius + max_food_radius_ + half_move + GRID_QUERY_MARGIN, [&](size_t j) {
+            // Distance is at least the gap to the move's bounding box, so this only skips food that can't touch.
+            float reach = radius + food_radius_[j];
+            if (min_x - food_x_[j] > reach || food_x_[j] - max_x > reach ||
+                min_y - food_y_[j] > reach || food_y_[j] - max_y > reach) {
+                return;
+            }
+            if (FoodDistance(x_pos, y_pos, food_x_[j], food_y_[j]) <= reach ||
+                (moved && SteeringKernel::SweptDistance(from_x, from_y, x_pos, y_pos, food_x_[j], food_y_[j]) <= reach)) {
+                nearby.push_back((uint32_t) j);
+            }
+        });
+
+        // Eating walks the food in its original order.
+        std::sort(nearby.begin(), nearby.end());
+        for (size_t k = 0; k < nearby.size(); k++) {
+            touching.push_back(std::make_pair((uint32_t) i, nearby[k]));
+        }
+    }
+}
+
+size_t TickGraph::FindNextUneaten(size_t food_index) {
+    while (next_uneaten_[food_index] != food_index) {
+        next_uneaten_[food_index] = next_uneaten_[next_uneaten_[food_index]];
+        food_index = next_uneaten_[food_index];
+    }
+    return food_index;
+}
+
+void TickGraph::ResolveEating() {
+    size_t food_count = food_x_.size();
+    eaten_by_.assign(food_count, NOT_EATEN);
+    meals_.clear();
+    next_uneaten_.resize(food_count + 1); // The last entry is a sentinel that is never eaten
+    for (size_t i = 0; i <= food_count; i++) {
+        next_uneaten_[i] = (uint32_t) i;
+    }
+
+    size_t remaining = food_count;
+    size_t creature_count = batch_->Size();
+    size_t chunk = 0;
+    size_t pair = 0;
+    for (size_t i = 0; i < creature_count; i++) {
+        food_empty_before_eating_[i] = remaining == 0 ? 1 : 0;
+        food_left_before_eating_[i] = remaining == 0 ? 0 : 1;
+
+        // The old loop erased food while iterating over it, which skipped the food right
+        // after each one eaten. skipped is that food, so it is passed over the same way.
+        size_t skipped = food_count;
+        while (chunk < touching_.size() && pair == touching_[chunk].size()) {
+            chunk++;
+            pair = 0;
+        }
+        while (chunk < touching_.size() && pair < touching_[chunk].size() && touching_[chunk][pair].first == i) {
+            size_t food_index = touching_[chunk][pair].second;
+            pair++;
+
+            if (eaten_by_[food_index] != NOT_EATEN || food_index == skipped || batch_->food[i] >= 2) {
+                continue;
+            }
+
+            batch_->food[i]++;
+            batch_->needs_movement[i] = 1;
+            sense_current_[i] = 0; // Its behaviour may change, so it looks around again
+            eaten_by_[food_index] = (uint32_t) i;
+            meals_.push_back(std::make_pair((uint32_t) i, (uint32_t) food_index));
+            next_uneaten_[food_index] = (uint32_t) (food_index + 1);
+            remaining--;
+            skipped = FindNextUneaten(food_index + 1);
+        }
+
+        food_empty_after_eating_[i] = remaining == 0 ? 1 : 0;
+    }
+}
+
+void TickGraph::SenseNearestFood(size_t begin, size_t end) {
+    size_t &sense_count = sense_counts_[begin / chunk_size_];
+    for (size_t i = begin; i < end; i++) {
+        // A full creature's velocity and movement flag are both overwritten on its way home,
+        // so whatever it would find makes no difference.
+        if (food_empty_after_eating_[i] || batch_->food[i] == 2) {
+            continue;
+        }
+
+        if (!IsSensingCurrent(i)) {
+            Sense(i);
+            sense_count++;
+        }
+
+        uint32_t target = sense_target_[i];
+        if (target != NO_TARGET) {
+            float x_diff = food_x_[target] - batch_->x[i];
+            float y_diff = food_y_[target] - batch_->y[i];
+            float inverse_length = 1.0f / std::sqrt(x_diff * x_diff + y_diff * y_diff);
+            batch_->x_velocity[i] = (x_diff * inverse_length) * batch_->max_velocity[i];
+            batch_->y_velocity[i] = (y_diff * inverse_length) * batch_->max_velocity[i];
+            batch_->needs_movement[i] = 1;
+        }
+    }
+}
+
+bool TickGraph::IsSensingCurrent(size_t creature) const {
+    if (!sense_current_[creature]) {
+        return false;
+    }
+
+    // Every food is now within moved of its distance at the last search.
+    float moved = FoodDistance(sensed_x_[creature], sensed_y_[creature], batch_->x[creature], batch_->y[creature]);
+    double vision_radius = batch_->vision_radius[creature];
+    uint32_t target = sense_target_[creature];
+    if (target == NO_TARGET) { // Nothing can have come into vision yet
+        return sensed_nearest_[creature] - moved - SENSE_ROUNDING_MARGIN > vision_radius;
+    }
+
+    // The target is still there, still in vision, and nothing else can have caught up with it.
+    if (eaten_by_[target] <= creature) {
+        return false;
+    }
+    float target_distance = FoodDistance(batch_->x[creature], batch_->y[creature], food_x_[target], food_y_[target]);
+    return target_distance <= vision_radius &&
+           target_distance + SENSE_ROUNDING_MARGIN < sensed_runner_up_[creature] - moved;
+}
+
+void TickGraph::Sense(size_t creature) {
+    // Creature::ChangeVelocityTowardsNearestFood only turns if the nearest food is in
+    // vision, so the nearest food within vision (first index on ties) is the same answer.
+    // Only food still there after this creature and every one before it has eaten counts.
+    float x_pos = batch_->x[creature];
+    float y_pos = batch_->y[creature];
+    double vision_radius = batch_->vision_radius[creature];
+    float reach = (float) vision_radius + SENSE_REACH_SLACK;
+
+    // Food the grid doesn't visit is further than reach away, so reach bounds it.
+    uint32_t nearest = NO_TARGET;
+    float nearest_distance = 0;
+    float runner_up = reach;
+    food_grid_->ForEachNear(x_pos, y_pos, reach + GRID_QUERY_MARGIN, [&](size_t j) {
+        if (eaten_by_[j] <= creature) {
+            return;
+        }
+
+        float distance = FoodDistance(x_pos, y_pos, food_x_[j], food_y_[j]);
+        bool is_nearest = distance <= vision_radius &&
+                          (nearest == NO_TARGET || distance < nearest_distance ||
+                           (distance == nearest_distance && j < nearest));
+        if (!is_nearest) {
+            runner_up = std::min(runner_up, distance);
+            return;
+        }
+        if (nearest != NO_TARGET) {
+            runner_up = std::min(runner_up, nearest_distance);
+        }
+        nearest_distance = distance;
+        nearest = (uint32_t) j;
+    });
+
+    sense_target_[creature] = nearest;
+    sense_current_[creature] = 1;
+    sensed_x_[creature] = x_pos;
+    sensed_y_[creature] = y_pos;
+    sensed_nearest_[creature] = nearest == NO_TARGET ? runner_up : nearest_distance;
+    sensed_runner_up_[creature] = runner_up;
+}
+
+void TickGraph::SteerHome(size_t begin, size_t end) {
+    SteeringKernel::IfNotEnoughEnergy(*batch_, food_left_before_eating_, begin, end);
+    // If no food, then creatures should all return home.
+    SteeringKernel::TowardsNearestWall(*batch_, food_empty_before_eating_, begin, end);
+
+    for (size_t i = begin; i < end; i++) {
+        if (food_empty_before_eating_[i] || batch_->food[i] == 2) {
+            batch_->needs_movement[i] = 0;
+        }
+    }
+    SteeringKernel::IfEnoughFood(*batch_, begin, end); // Should go home if has two food.
+}
+
+void TickGraph::ResolveCollisions() {
+    // Creatures bounce off each other before walls get the final say.
+    broad_phase_->FindCandidatePairs(*batch_, collision_pairs_);
+    SweepAndPrune::ResolveCollisions(*batch_, collision_pairs_);
+}
+
+void TickGraph::Move(size_t begin, size_t end) {
+    SteeringKernel::ResolveWallHits(*batch_, bounds_, food_empty_after_eating_, begin, end);
+    SteeringKernel::Move(*batch_, bounds_, time_step_, begin, end); // Update all particle positions.
+}
+
+}
@@ -0,0 +1,110 @@
+#include "world_snapshot.h"
+#include "creature.h"
+#include "food.h"
+
+namespace naturalselection {
+
+using glm::vec2;
+
+ci::Color GetCreatureColor(int creature_type, int food) {
+    // Creatures get lighter as they eat.
+    if (creature_type == SPEED) {
+        if (food == 1) {
+            return ci::Color(1.0f, 0.4f, 0.4f);
+        } else if (food >= 2) {
+            return ci::Color(1.0f, 0.6f, 0.6f);
+        }
+        return ci::Color(1.0f, 0.0f, 0.0f);
+    } else if (creature_type == INTELLIGENCE) {
+        if (food == 1) {
+            return ci::Color(0.4f, 0.4f, 1.0f);
+        } else if (food >= 2) {
+            return ci::Color(0.6f, 0.6f, 1.0f);
+        }
+        return ci::Color(0.0f, 0.0f, 1.0f);
+    } else {
+        if (food == 1) {
+            return ci::Color(0.8f, 0.4f, 0.8f);
+        } else if (food >= 2) {
+            return ci::Color(0.8f, 0.6f, 0.8f);
+        }
+        return ci::Color(0.8f, 0.0f, 0.8f);
+    }
+}
+
+ci::Color CreatureRenderState::GetColor() const {
+    return GetCreatureColor(creature_type, food);
+}
+
+int PopulationCount::GetTotal() const {
+    return speed_count + intelligence_count + both_type_count;
+}
+
+void WorldSnapshot::Capture(const std::vector<Creature> &new_creatures, const std::vector<Food> &new_food,
+                            uint64_t current_tick, size_t current_trials_run) {
+    tick = current_tick;
+    trials_run = current_trials_run;
+    speed_count = 0;
+    intelligence_count = 0;
+    both_type_count = 0;
+
+    // resize() keeps the old capacity, so a warmed-up snapshot never reallocates.
+    creatures.resize(new_creatures.size());
+    for (size_t i = 0; i < new_creatures.size(); i++) {
+        const Creature &curr_creature = new_creatures[i];
+        CreatureRenderState &state = creatures[i];
+        state.position = curr_creature.GetPosition();
+        state.radius = curr_creature.GetRadius();
+        state.vision_radius = (float) curr_creature.GetVisionRadius();
+        state.creature_type = curr_creature.GetCreatureType();
+        state.food = curr_creature.GetFood();
+
+        if (state.creature_type == SPEED) {
+            speed_count++;
+        } else if (state.creature_type == INTELLIGENCE) {
+            intelligence_count++;
+        } else if (state.creature_type == BOTH) {
+            both_type_count++;
+        }
+    }
+
+    food.resize(new_food.size());
+    for (size_t i = 0; i < new_food.size(); i++) {
+        food[i].position = new_food[i].GetPosition();
+        food[i].radius = new_food[i].GetRadius();
+    }
+}
+
+SnapshotBuffer::SnapshotBuffer() : middle_(1), back_(0), front_(2) {}
+
+SnapshotBuffer::SnapshotBuffer(const SnapshotBuffer &other)
+        : slots_(other.slots_), middle_(other.middle_.load()), back_(other.back_), front_(other.front_) {}
+
+SnapshotBuffer &SnapshotBuffer::operator=(const SnapshotBuffer &other) {
+    slots_ = other.slots_;
+    middle_.store(other.middle_.load());
+    back_ = other.back_;
+    front_ = other.front_;
+    return *this;
+}
+
+WorldSnapshot &SnapshotBuffer::BeginWrite() {
+    return slots_[back_];
+}
+
+void SnapshotBuffer::Publish() {
+    // Hand the finished back buffer to the reader and reuse whatever slot was waiting in the middle.
+    uint8_t previous = middle_.exchange((uint8_t) (back_ | FRESH_BIT), std::memory_order_acq_rel);
+    back_ = (uint8_t) (previous & INDEX_MASK);
+}
+
+const WorldSnapshot &SnapshotBuffer::Acquire() const {
+    if (middle_.load(std::memory_order_relaxed) & FRESH_BIT) { // Only swap if the writer published since last time
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = (uint8_t) (previous & INDEX_MASK);
+    }
+
+    return slots_[front_];
+}
+
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch.hpp>
+
+#include "test_helpers.h"
+#include <carrying_capacity.h>
+#include <creature.h>
+#include <generation_turnover.h>
+#include <headless_runner.h>
+
+using naturalselection::CAPACITY_FITNESS;
+using naturalselection::CAPACITY_UNIFORM;
+using naturalselection::CarryingCapacity;
+using naturalselection::Creature;
+using naturalselection::GenerationTurnover;
+using naturalselection::HeadlessRunner;
+using naturalselection::SweepJob;
+using naturalselection::SweepResult;
+
+TEST_CASE("Uniform Sampling Picks Every Index Equally Often") {
+    std::vector<size_t> picks(20, 0);
+    std::vector<size_t> chosen;
+    for (uint64_t seed = 0; seed < 4000; seed++) {
+        CarryingCapacity::SampleUniform(20, 5, seed, chosen);
+        REQUIRE(chosen.size() == 5);
+        for (size_t i = 0; i < chosen.size(); i++) {
+            REQUIRE(chosen[i] < 20);
+            REQUIRE((i == 0 || chosen[i - 1] < chosen[i]));
+            picks[chosen[i]]++;
+        }
+    }
+
+    // Each index is expected 1000 times.
+    for (size_t i = 0; i < picks.size(); i++) {
+        REQUIRE(picks[i] > 900);
+        REQUIRE(picks[i] < 1100);
+    }
+}
+
+TEST_CASE("Weighted Sampling Favours Heavier Items") {
+    std::vector<float> weights = {1, 2, 0, 1, 2, 0, 1, 2};
+    std::vector<size_t> picks(weights.size(), 0);
+    std::vector<size_t> chosen;
+    for (uint64_t seed = 0; seed < 2000; seed++) {
+        CarryingCapacity::SampleWeighted(weights, 3, seed, chosen);
+        REQUIRE(chosen.size() == 3);
+        for (size_t i = 0; i < chosen.size(); i++) {
+            REQUIRE((i == 0 || chosen[i - 1] < chosen[i]));
+            picks[chosen[i]]++;
+        }
+    }
+
+    REQUIRE(picks[2] == 0);
+    REQUIRE(picks[5] == 0);
+    REQUIRE(picks[1] + picks[4] + picks[7] > picks[0] + picks[3] + picks[6]);
+
+    // Only when there are not enough weighted items does a zero weight get in.
+    CarryingCapacity::SampleWeighted(weights, 8, 1, chosen);
+    REQUIRE(chosen.size() == 8);
+}
+
+TEST_CASE("Carrying Capacity Keeps A Bounded Subset In Order") {
+    std::vector<Creature> parents = MakeFedPopulation(300);
+    std::vector<Creature> full_generation;
+    GenerationTurnover::Run(parents, full_generation, 11, 1);
+    REQUIRE(full_generation.size() > 250);
+
+    CarryingCapacity capacity;
+    std::vector<Creature> next_generation = full_generation;
+    REQUIRE(capacity.Apply(parents, next_generation, 11) == 0);
+    REQUIRE(next_generation.size() == full_generation.size());
+
+    capacity.limit = 100;
+    for (int policy = CAPACITY_UNIFORM; policy <= CAPACITY_FITNESS; policy++) {
+        capacity.policy = policy;
+        next_generation = full_generation;
+        REQUIRE(capacity.Apply(parents, next_generation, 11) == full_generation.size() - 100);
+        REQUIRE(next_generation.size() == 100);
+
+        // What is left appears in the same order as before. Survivors keep their id and
+        // children have their parent's, so the pair tells every creature apart.
+        size_t position = 0;
+        for (size_t i = 0; i < next_generation.size(); i++) {
+            while (position < full_generation.size() &&
+                   (full_generation[position].GetId() != next_generation[i].GetId() ||
+                    full_generation[position].GetParentId() != next_generation[i].GetParentId())) {
+                position++;
+            }
+            REQUIRE(position < full_generation.size());
+            position++;
+        }
+    }
+}
+
+TEST_CASE("Turnover Applies The Carrying Capacity As It Builds The Generation") {
+    std::vector<Creature> parents = MakeFedPopulation(40000); // Enough for several chunks
+    CarryingCapacity capacity;
+    capacity.limit = 15000;
+    for (int policy = CAPACITY_UNIFORM; policy <= CAPACITY_FITNESS; policy++) {
+        capacity.policy = policy;
+        std::vector<Creature> applied_after;
+        GenerationTurnover::Run(parents, applied_after, 5, 1);
+        size_t removed = capacity.Apply(parents, applied_after, 5);
+
+        for (size_t thread_count = 1; thread_count <= 4; thread_count += 3) {
+            std::vector<Creature> applied_during;
+            REQUIRE(GenerationTurnover::Run(parents, applied_during, 5, capacity, thread_count) == removed);
+            REQUIRE(applied_during.capacity() <= capacity.limit); // The full generation never existed
+            REQUIRE(applied_during.size() == applied_after.size());
+            for (size_t i = 0; i < applied_during.size(); i++) {
+                REQUIRE(applied_during[i].GetId() == applied_after[i].GetId());
+                REQUIRE(applied_during[i].GetParentId() == applied_after[i].GetParentId());
+                REQUIRE(applied_during[i].GetMaxVelocity() == applied_after[i].GetMaxVelocity());
+                REQUIRE(applied_during[i].GetVisionRadius() == applied_after[i].GetVisionRadius());
+            }
+        }
+    }
+}
+
+TEST_CASE("Capped Runs Stay Under Their Carrying Capacity") {
+    SweepJob job;
+    job.seed = 3;
+    job.food_count = 200;
+    job.speed_creatures = true;
+    job.creatures_per_type = 20;
+    job.generations = 4;
+    job.max_ticks = 100000;
+    job.carrying_capacity = 25;
+    job.capacity_policy = CAPACITY_FITNESS;
+
+    SweepResult result = HeadlessRunner::Run(job);
+    REQUIRE(result.speed_count <= 25);
+    REQUIRE(result.capacity_removed > 0);
+    REQUIRE(result.capacity_policy == CAPACITY_FITNESS);
+    REQUIRE(result.ToCsvRow().find(",25,fitness,") != std::string::npos);
+}
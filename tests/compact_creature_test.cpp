@@ -0,0 +1,68 @@
+#include <catch2/catch.hpp>
+
+#include <compact_creature.h>
+#include <creature.h>
+#include <genome.h>
+#include <world_snapshot.h>
+
+using naturalselection::CompactCreature;
+using naturalselection::Creature;
+using naturalselection::Genome;
+
+TEST_CASE("Compact Creature Round Trip") {
+    Creature parent(BOTH, vec2(0, 0), vec2(0, 0), naturalselection::DEFAULT_CREATURE_RADIUS,
+                    naturalselection::DEFAULT_CREATURE_MASS, 0.0, 0, 11.0, 0.25, 2.5f);
+    Genome genome = Genome::FromCreature(parent);
+    Creature creature = genome.CreateCreature(parent, BOTH, genome);
+    creature.SetPosition(vec2(120.5f, 300.25f));
+    creature.SetVelocity(vec2(-1.5f, 0.75f));
+    creature.SetEnergy(42.5);
+    creature.SetFood(3);
+    creature.SetNeedsMovement(false);
+
+    Creature unpacked = CompactCreature::Pack(creature).Unpack();
+    REQUIRE(unpacked.GetCreatureType() == BOTH);
+    REQUIRE(unpacked.GetPosition() == creature.GetPosition());
+    REQUIRE(unpacked.GetVelocity() == creature.GetVelocity());
+    REQUIRE(unpacked.GetEnergy() == 42.5);
+    REQUIRE(unpacked.GetFood() == 3);
+    REQUIRE(unpacked.GetNeedsMovement() == false);
+    REQUIRE(unpacked.GetMaxVelocity() == creature.GetMaxVelocity());
+    REQUIRE(unpacked.GetVisionRadius() == creature.GetVisionRadius());
+    REQUIRE(unpacked.GetRadius() == creature.GetRadius());
+    REQUIRE(unpacked.GetMass() == creature.GetMass());
+
+    // The spend is not stored, but recomputing it from the traits gives the same value.
+    REQUIRE(unpacked.GetEnergySpend() == creature.GetEnergySpend());
+}
+
+TEST_CASE("Compact Creature Keeps Type Food And Movement Apart") {
+    for (int type = 0; type < 3; type++) {
+        for (int food = 0; food < 300; food += 37) {
+            Creature creature(type, vec2(0, 0), vec2(0, 0), 5, 10, 1.0, food);
+            creature.SetNeedsMovement(food % 2 == 0);
+
+            CompactCreature packed = CompactCreature::Pack(creature);
+            REQUIRE(packed.GetCreatureType() == type);
+            REQUIRE(packed.GetFood() == food);
+            REQUIRE(packed.GetNeedsMovement() == (food % 2 == 0));
+        }
+    }
+}
+
+TEST_CASE("Creature Colour Follows Food") {
+    Creature creature(SPEED, vec2(0, 0), vec2(0, 0), 5, 10, 1.0, 0);
+    REQUIRE(creature.GetColor() == ci::Color(1.0f, 0.0f, 0.0f));
+
+    creature.AddFood();
+    REQUIRE(creature.GetColor() == ci::Color(1.0f, 0.4f, 0.4f));
+    REQUIRE(CompactCreature::Pack(creature).GetColor() == creature.GetColor());
+
+    creature.AddFood();
+    REQUIRE(creature.GetColor() == ci::Color(1.0f, 0.6f, 0.6f));
+
+    std::vector<Creature> creatures;
+    creatures.push_back(creature);
+    Creature::ResetAllCreatures(creatures);
+    REQUIRE(creatures[0].GetColor() == ci::Color(1.0f, 0.0f, 0.0f));
+}
@@ -13,7 +13,7 @@ using naturalselection::Physics;
 TEST_CASE("Spawning Speed Children Test") {
     for (size_t i = 0; i < 100; i++) {
         Creature speed_creature = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5,
-                                           10, ci::Color("red"), 0.0, 0,
+                                           10, 0.0, 0,
                                            2.5, 0.25);
 
         Creature child = speed_creature.CreateChild(SPEED);
@@ -25,7 +25,7 @@ TEST_CASE("Spawning Speed Children Test") {
 TEST_CASE("Spawning Intelligence Children Test") {
     for (size_t i = 0; i < 100; i++) {
         Creature speed_creature = Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), 5,
-                                           10, ci::Color("red"), 0.0, 0,
+                                           10, 0.0, 0,
                                            2.5, 0.25);
 
         Creature child = speed_creature.CreateChild(INTELLIGENCE);
@@ -37,7 +37,7 @@ TEST_CASE("Spawning Intelligence Children Test") {
 TEST_CASE("Spawning Both Type Children Test") {
     for (size_t i = 0; i < 100; i++) {
         Creature speed_creature = Creature(BOTH, vec2(0, 0), vec2(0, 0), 5,
-                                           10, ci::Color("red"), 0.0, 0,
+                                           10, 0.0, 0,
                                            2.5, 0.25);
 
         Creature child = speed_creature.CreateChild(BOTH);
@@ -47,10 +47,27 @@ TEST_CASE("Spawning Both Type Children Test") {
     }
 }
 
+TEST_CASE("Fast Creatures Touch Food They Pass Over") {
+    naturalselection::Food food = naturalselection::Food(vec2(320, 300), 2.0f, ci::Color("green"));
+    Creature creature = Creature(SPEED, vec2(300, 301), vec2(10, 0), 5, 10, 10.0, 0);
+    REQUIRE_FALSE(creature.IsTouchingSpecificFood(food));
+
+    creature.Move(4.0f); // From 13 units short of the food to 27 past it
+    REQUIRE(creature.GetPosition() == vec2(340, 301));
+    REQUIRE(creature.IsTouchingSpecificFood(food));
+
+    creature.Move(4.0f); // Long gone
+    REQUIRE_FALSE(creature.IsTouchingSpecificFood(food));
+
+    // Starting over somewhere is not a move.
+    creature.ResetCreaturePosition();
+    REQUIRE(creature.GetPreviousPosition() == creature.GetPosition());
+}
+
 TEST_CASE("Energy Cost Speed Test") {
     for (size_t i = 0; i < 100; i++) {
         Creature speed_creature = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5,
-                                           10, ci::Color("red"), 0.0, 0,
+                                           10, 0.0, 0,
                                            2.5, 0.25);
 
         Creature child = speed_creature.CreateChild(SPEED);
@@ -68,7 +85,7 @@ TEST_CASE("Energy Cost Speed Test") {
 TEST_CASE("Energy Cost Intelligence Test") {
     for (size_t i = 0; i < 100; i++) {
         Creature speed_creature = Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), 5,
-                                           10, ci::Color("red"), 0.0, 0,
+                                           10, 0.0, 0,
                                            2.5, 0.25);
 
         Creature child = speed_creature.CreateChild(INTELLIGENCE);
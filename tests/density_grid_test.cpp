@@ -0,0 +1,101 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <density_grid.h>
+#include <environment.h>
+#include <world_snapshot.h>
+
+using naturalselection::DENSITY_BOTH;
+using naturalselection::DENSITY_FOOD;
+using naturalselection::DENSITY_INTELLIGENCE;
+using naturalselection::DENSITY_SPEED;
+using naturalselection::DensityGrid;
+using naturalselection::Environment;
+using naturalselection::WorldBounds;
+using naturalselection::WorldSnapshot;
+
+static void AddCreature(WorldSnapshot &snapshot, float x, float y, int creature_type) {
+    naturalselection::CreatureRenderState creature;
+    creature.position = vec2(x, y);
+    creature.radius = 5;
+    creature.vision_radius = 12;
+    creature.creature_type = creature_type;
+    creature.food = 0;
+    snapshot.creatures.push_back(creature);
+}
+
+static void AddFood(WorldSnapshot &snapshot, float x, float y) {
+    naturalselection::FoodRenderState food;
+    food.position = vec2(x, y);
+    food.radius = 2;
+    snapshot.food.push_back(food);
+}
+
+TEST_CASE("Density Grid Counts Each Type In Its Own Channel") {
+    WorldSnapshot snapshot;
+    AddCreature(snapshot, 105, 105, SPEED);
+    AddCreature(snapshot, 106, 107, SPEED);
+    AddCreature(snapshot, 108, 102, INTELLIGENCE);
+    AddCreature(snapshot, 795, 595, BOTH);
+    AddCreature(snapshot, 900, 900, BOTH); // Outside the region
+    AddFood(snapshot, 450, 350);
+
+    DensityGrid grid;
+    grid.Rasterize(snapshot, WorldBounds{100, 100, 700, 500}, 70, 50);
+    REQUIRE(grid.GetColumns() == 70);
+    REQUIRE(grid.GetRows() == 50);
+    REQUIRE(grid.GetCount(DENSITY_SPEED, 0, 0) == 2);
+    REQUIRE(grid.GetCount(DENSITY_INTELLIGENCE, 0, 0) == 1);
+    REQUIRE(grid.GetCount(DENSITY_BOTH, 69, 49) == 1);
+    REQUIRE(grid.GetCount(DENSITY_FOOD, 35, 25) == 1);
+    REQUIRE(grid.GetMaxCreatureCount() == 3);
+    REQUIRE(DensityGrid::CountInside(snapshot, WorldBounds{100, 100, 700, 500}) == 5);
+}
+
+TEST_CASE("Density Pixels Mix Type Colours And Leave Empty Cells Clear") {
+    WorldSnapshot snapshot;
+    AddCreature(snapshot, 5, 5, SPEED);
+    AddCreature(snapshot, 15, 5, INTELLIGENCE);
+    for (int i = 0; i < 9; i++) {
+        AddCreature(snapshot, 15, 6, INTELLIGENCE);
+    }
+    AddFood(snapshot, 25, 5);
+
+    DensityGrid grid;
+    grid.Rasterize(snapshot, WorldBounds{0, 0, 40, 10}, 4, 1);
+    std::vector<uint8_t> rgba;
+    grid.FillPixels(rgba);
+    REQUIRE(rgba.size() == 16);
+
+    // A lone speed creature is dim red, the crowded cell full-brightness blue.
+    REQUIRE(rgba[0] > 0);
+    REQUIRE(rgba[2] == 0);
+    REQUIRE(rgba[3] == 255);
+    REQUIRE(rgba[6] == 255);
+    REQUIRE(rgba[0] < rgba[6]);
+
+    // Food only is green, and the empty cell is transparent.
+    REQUIRE(rgba[8] == 0);
+    REQUIRE(rgba[9] > 0);
+    REQUIRE(rgba[11] == 255);
+    REQUIRE(rgba[15] == 0);
+}
+
+TEST_CASE("Environment Switches To Density Above The Threshold") {
+    Environment environment = Environment();
+    environment.AddSpeedCreatures(400);
+    environment.RefreshFood();
+    REQUIRE_FALSE(environment.IsDrawingDensity());
+
+    environment.SetLodEntityThreshold(100);
+    REQUIRE(environment.IsDrawingDensity());
+
+    // Zoomed in far enough, few enough are in view to draw one by one again.
+    environment.SetViewZoom(16);
+    REQUIRE(environment.GetViewBounds().width == Approx(700.0f / 16));
+    REQUIRE_FALSE(environment.IsDrawingDensity());
+
+    environment.SetViewZoom(1);
+    environment.SetLodEntityThreshold(0);
+    REQUIRE_FALSE(environment.IsDrawingDensity());
+}
@@ -25,6 +25,68 @@ TEST_CASE("Spawning Food within Bounds") {
     }
 }
 
+TEST_CASE("Adding And Removing Food Leaves The Rest In Place") {
+    Environment environment = Environment();
+    std::vector<naturalselection::Food> before = environment.GetFood();
+
+    environment.AddFood(5);
+    REQUIRE(environment.GetFood().size() == before.size() + 5);
+    std::vector<naturalselection::Food> added = environment.GetFood();
+    environment.RemoveFood(8);
+    REQUIRE(environment.GetFood().size() == before.size() - 3);
+
+    // Whatever is left is food that was there, each at most once.
+    std::vector<bool> matched(added.size(), false);
+    for (const naturalselection::Food &food : environment.GetFood()) {
+        size_t j = 0;
+        while (j < added.size() && (matched[j] || !(added[j].GetPosition() == food.GetPosition()))) {
+            j++;
+        }
+        REQUIRE(j < added.size());
+        matched[j] = true;
+    }
+}
+
+TEST_CASE("Removing Food Thins It Out Across The Whole Arena") {
+    Environment environment = Environment();
+    environment.AddFood(1000);
+    const float middle_x = DEFAULT_X_COOR + DEFAULT_WIDTH / 2.0f;
+    const float middle_y = DEFAULT_Y_COOR + DEFAULT_HEIGHT / 2.0f;
+    size_t before[4] = {0, 0, 0, 0};
+    for (const naturalselection::Food &food : environment.GetFood()) {
+        before[(food.GetPosition().x < middle_x ? 0 : 1) + (food.GetPosition().y < middle_y ? 0 : 2)]++;
+    }
+
+    environment.RemoveFood(environment.GetFood().size() / 2);
+    size_t after[4] = {0, 0, 0, 0};
+    for (const naturalselection::Food &food : environment.GetFood()) {
+        after[(food.GetPosition().x < middle_x ? 0 : 1) + (food.GetPosition().y < middle_y ? 0 : 2)]++;
+    }
+
+    // Each quarter keeps about half its food, instead of some quarters emptying first.
+    for (size_t quarter = 0; quarter < 4; quarter++) {
+        REQUIRE(after[quarter] > before[quarter] * 3 / 10);
+        REQUIRE(after[quarter] < before[quarter] * 7 / 10);
+    }
+}
+
+TEST_CASE("Food Grows Back Up To The Food Count") {
+    Environment environment = Environment();
+    size_t food_count = environment.GetFood().size();
+    environment.AddSpeedCreatures(3);
+    environment.RemoveFood(food_count / 2);
+    environment.SetFoodRegrowthRate(0.5f);
+    environment.SetIsRunning(true);
+
+    size_t most_food = 0;
+    for (int i = 0; i < 100 && environment.GetIsRunning(); i++) {
+        environment.AdvanceOneFrame();
+        most_food = std::max(most_food, environment.GetFood().size());
+        REQUIRE(environment.GetFood().size() <= food_count);
+    }
+    REQUIRE(most_food > food_count / 2 + 1);
+}
+
 TEST_CASE("Spawning Creatures on Bounds") {
     Environment environment = Environment();
 
@@ -35,4 +97,81 @@ TEST_CASE("Spawning Creatures on Bounds") {
                             environment.GetSpeedCreatures().at(i).GetPosition().y == DEFAULT_Y_COOR;
         REQUIRE(require_test);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Ticks Split Across Frames Match Whole Ticks") {
+    srand(11);
+    Environment whole = Environment();
+    whole.AddSpeedCreatures(3000); // A few chunks, so a tick can stop part way
+    srand(11);
+    Environment sliced = Environment();
+    sliced.AddSpeedCreatures(3000);
+    whole.SetIsRunning(true);
+    sliced.SetIsRunning(true);
+
+    // Both draw from the same rand(), so it is reseeded before each one does anything that might use it.
+    size_t unfinished_calls = 0;
+    for (int tick = 0; tick < 20; tick++) {
+        srand(tick);
+        whole.AdvanceOneFrame();
+        srand(tick);
+        // With no time at all, every call still gets through one round of chunks.
+        while (!sliced.AdvanceWithinBudget(std::chrono::steady_clock::duration::zero())) {
+            REQUIRE(sliced.GetTickInProgress());
+            unfinished_calls++;
+        }
+        if (tick == 10) { // Changing the food finishes the tick first
+            srand(100);
+            whole.AdvanceOneFrame();
+            whole.AddFood(1);
+            srand(100);
+            REQUIRE_FALSE(sliced.AdvanceWithinBudget(std::chrono::steady_clock::duration::zero()));
+            sliced.AddFood(1);
+            REQUIRE_FALSE(sliced.GetTickInProgress());
+        }
+
+        INFO("tick " << tick);
+        REQUIRE(sliced.GetTick() == whole.GetTick());
+        REQUIRE(sliced.GetFood().size() == whole.GetFood().size());
+        for (size_t i = 0; i < whole.GetCreatures().size(); i++) {
+            REQUIRE(sliced.GetCreatures()[i].GetPosition() == whole.GetCreatures()[i].GetPosition());
+            REQUIRE(sliced.GetCreatures()[i].GetVelocity() == whole.GetCreatures()[i].GetVelocity());
+            REQUIRE(sliced.GetCreatures()[i].GetEnergy() == whole.GetCreatures()[i].GetEnergy());
+        }
+    }
+    REQUIRE(unfinished_calls > 20);
+}
+
+TEST_CASE("Environments Built For Tests Start With No Tick In Progress") {
+    Environment empty = Environment(std::vector<Creature>());
+    REQUIRE_FALSE(empty.GetTickInProgress());
+    Environment sized = Environment(DEFAULT_WIDTH, DEFAULT_HEIGHT, DEFAULT_X_COOR, DEFAULT_Y_COOR,
+                                    std::vector<Creature>());
+    REQUIRE_FALSE(sized.GetTickInProgress());
+}
+
+TEST_CASE("Time Step Keeps Its Last Value When Given One That Never Moves") {
+    Environment environment = Environment();
+    environment.SetTimeStep(2.0f);
+    environment.SetTimeStep(0.0f);
+    REQUIRE(environment.GetTimeStep() == 2.0f);
+    environment.SetTimeStep(-1.0f);
+    REQUIRE(environment.GetTimeStep() == 2.0f);
+    environment.SetTimeStep(0.5f);
+    REQUIRE(environment.GetTimeStep() == 0.5f);
+}
+
+TEST_CASE("Removing Food Leaves One Item In Either Food Mode") {
+    Environment environment = Environment();
+    environment.RemoveFood(environment.GetFood().size() + 5);
+    REQUIRE(environment.GetFood().size() == 1);
+
+    Environment field = Environment();
+    field.SetFoodMode(naturalselection::FOOD_MODE_FIELD);
+    double total = field.GetFoodField().GetTotal();
+    REQUIRE(total > 2);
+    field.RemoveFood(1);
+    REQUIRE(field.GetFoodField().GetTotal() == Approx(total - 1));
+    field.RemoveFood((size_t) total + 5);
+    REQUIRE(field.GetFoodField().GetTotal() == Approx(1));
+}
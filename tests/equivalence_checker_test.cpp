@@ -0,0 +1,95 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <equivalence_checker.h>
+#include <food.h>
+
+using naturalselection::Creature;
+using naturalselection::EquivalenceChecker;
+using naturalselection::EquivalenceReport;
+using naturalselection::Food;
+using naturalselection::SweepJob;
+
+TEST_CASE("Engines Agree Over Several Generations") {
+    SweepJob job;
+    job.seed = 17;
+    job.food_count = 30;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.both_type_creatures = true;
+    job.generations = 3;
+    job.max_ticks = 100000;
+
+    EquivalenceReport report = EquivalenceChecker::Run(job, naturalselection::COMPARE_EVERY_GENERATION);
+    INFO(report.Describe());
+    REQUIRE(report.equivalent);
+    REQUIRE(report.checkpoints_compared == 4); // The start and every turnover
+}
+
+TEST_CASE("Engines Agree Tick By Tick On A Large World") {
+    SweepJob job;
+    job.seed = 3;
+    job.food_count = 1500;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.both_type_creatures = true;
+    job.creatures_per_type = 3400; // Enough that the optimized tick runs on the scheduler
+    job.generations = 1;
+    job.max_ticks = 20;
+
+    EquivalenceReport report = EquivalenceChecker::Run(job, naturalselection::COMPARE_EVERY_TICK);
+    INFO(report.Describe());
+    REQUIRE(report.equivalent);
+    REQUIRE(report.frames_compared == 20);
+
+    job.creatures_per_type = 400;
+    job.collisions_enabled = true;
+    report = EquivalenceChecker::Run(job, naturalselection::COMPARE_EVERY_TICK);
+    INFO(report.Describe());
+    REQUIRE(report.equivalent);
+}
+
+TEST_CASE("Engines Agree While Food Grows Back") {
+    // Something is eaten and something grows back most ticks, so the food keeps being swapped about.
+    SweepJob job;
+    job.seed = 5;
+    job.food_count = 300;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.creatures_per_type = 200;
+    job.food_regrowth_rate = 2.0f;
+    job.generations = 2;
+    job.max_ticks = 400;
+
+    EquivalenceReport report = EquivalenceChecker::Run(job, naturalselection::COMPARE_EVERY_TICK);
+    INFO(report.Describe());
+    REQUIRE(report.equivalent);
+    REQUIRE(report.frames_compared > 100);
+}
+
+TEST_CASE("First Difference Names The Creature And Field") {
+    std::vector<Creature> reference;
+    for (size_t i = 0; i < 10; i++) {
+        reference.push_back(Creature((int) (i % 3), vec2(100 + i, 200), vec2(1, 0), 5, 10, 10.0, 0));
+    }
+    std::vector<Food> food;
+    food.push_back(Food(vec2(300, 300), 2.0f, ci::Color("green")));
+
+    std::vector<Creature> optimized = reference;
+    EquivalenceReport report;
+    REQUIRE_FALSE(EquivalenceChecker::FindFirstDifference(reference, food, optimized, food, report));
+    REQUIRE(EquivalenceChecker::HashState(reference, food) == EquivalenceChecker::HashState(optimized, food));
+
+    optimized[6].SetVelocity(vec2(1, 0.5f));
+    optimized[8].SetFood(1);
+    REQUIRE(EquivalenceChecker::HashState(reference, food) != EquivalenceChecker::HashState(optimized, food));
+    REQUIRE(EquivalenceChecker::FindFirstDifference(reference, food, optimized, food, report));
+    REQUIRE(report.subject == "creature 6");
+    REQUIRE(report.field == "y_velocity");
+    REQUIRE(report.reference_value == "0");
+    REQUIRE(report.optimized_value == "0.5");
+
+    std::vector<Food> no_food;
+    REQUIRE(EquivalenceChecker::FindFirstDifference(reference, food, reference, no_food, report));
+    REQUIRE(report.field == "food count");
+}
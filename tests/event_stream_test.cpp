@@ -0,0 +1,166 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <cstring>
+#include <environment.h>
+#include <event_stream.h>
+#include <headless_runner.h>
+#include <set>
+#include <unistd.h>
+
+using naturalselection::Creature;
+using naturalselection::Environment;
+using naturalselection::EventStreamReader;
+using naturalselection::EventStreamWriter;
+using naturalselection::HeadlessRunner;
+using naturalselection::LifeEvent;
+using naturalselection::SweepJob;
+
+static std::string GetStreamPath(const char *test) {
+    return std::string("/tmp/naturalselection_") + test + "_" + std::to_string(getpid()) + ".events";
+}
+
+// Runs job's generations with every event recorded to path.
+static void RecordRun(const SweepJob &job, int engine, const std::string &path, std::vector<uint32_t> &final_ids) {
+    EventStreamWriter writer;
+    REQUIRE(writer.Open(path, 64)); // Small buffers, so the run hands plenty to the writer thread
+    srand(job.seed);
+    Environment environment = Environment();
+    environment.SetEventStream(&writer);
+    HeadlessRunner::SetUp(job, environment);
+    environment.SetTickEngine(engine);
+
+    uint64_t frames = 0;
+    while (!HeadlessRunner::IsFinished(job, environment) && frames < job.max_ticks) {
+        HeadlessRunner::StepFrame(environment);
+        frames++;
+    }
+    writer.Close();
+    REQUIRE_FALSE(writer.GetWriteFailed());
+
+    final_ids.clear();
+    for (const Creature &creature : environment.GetCreatures()) {
+        final_ids.push_back(creature.GetId());
+    }
+}
+
+TEST_CASE("Event Stream Reader Sees What Was Written") {
+    std::string path = GetStreamPath("written");
+    EventStreamReader reader;
+    REQUIRE_FALSE(reader.Open(path));
+
+    EventStreamWriter writer;
+    REQUIRE(writer.Open(path, 3));
+    for (uint32_t i = 1; i <= 10; i++) {
+        writer.RecordMeal(i, i, 100 + i);
+    }
+    Creature child = Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), 5, 10, 0, 0,
+                              42.0, 1.5);
+    child.SetId(7);
+    child.SetParentId(3);
+    writer.RecordBirth(11, child);
+    writer.RecordDeath(12, 3, naturalselection::DEATH_STARVED);
+    writer.RecordGeneration(12, 1, 20);
+    writer.Flush();
+    REQUIRE(writer.GetEventsRecorded() == 13);
+
+    REQUIRE(reader.Open(path));
+    REQUIRE(reader.Size() == 13);
+    REQUIRE(reader[4].type == naturalselection::EVENT_MEAL);
+    REQUIRE(reader[4].tick == 5);
+    REQUIRE(reader[4].creature_id == 5);
+    REQUIRE(reader[4].other_id == 105);
+    REQUIRE(reader[10].type == naturalselection::EVENT_BIRTH);
+    REQUIRE(reader[10].creature_id == 7);
+    REQUIRE(reader[10].other_id == 3);
+    REQUIRE(reader[10].vision_radius == 42.0f);
+    REQUIRE(reader[10].detail == INTELLIGENCE);
+    REQUIRE(reader[11].type == naturalselection::EVENT_DEATH);
+    REQUIRE(reader[12].type == naturalselection::EVENT_GENERATION);
+    REQUIRE(reader[12].other_id == 20);
+
+    // A reader only sees what was there when it mapped the file.
+    writer.RecordMeal(13, 1, 1);
+    writer.Close();
+    REQUIRE(reader.Size() == 13);
+    REQUIRE(reader.Open(path));
+    REQUIRE(reader.Size() == 14);
+
+    // Anything that isn't an event stream is turned away.
+    FILE *other = fopen(path.c_str(), "wb");
+    const char *text = "not an event stream at all";
+    fwrite(text, 1, strlen(text), other);
+    fclose(other);
+    REQUIRE_FALSE(reader.Open(path));
+    unlink(path.c_str());
+}
+
+TEST_CASE("Event Stream Accounts For Every Creature") {
+    SweepJob job;
+    job.seed = 5;
+    job.food_count = 40;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.creatures_per_type = 30;
+    job.generations = 3;
+    job.max_ticks = 100000;
+    job.carrying_capacity = 35; // Some creatures get culled, not only starved
+    std::string path = GetStreamPath("accounts");
+    std::vector<uint32_t> final_ids;
+    RecordRun(job, naturalselection::TICK_ENGINE_OPTIMIZED, path, final_ids);
+
+    EventStreamReader reader;
+    REQUIRE(reader.Open(path));
+    std::set<uint32_t> alive;
+    std::set<uint32_t> eaten;
+    size_t generations = 0;
+    size_t births_to_parents = 0;
+    size_t culled = 0;
+    for (const LifeEvent &event : reader) {
+        if (event.type == naturalselection::EVENT_BIRTH) {
+            REQUIRE((event.other_id == 0 || alive.count(event.other_id) == 1));
+            REQUIRE(alive.insert(event.creature_id).second);
+            births_to_parents += event.other_id != 0 ? 1 : 0;
+        } else if (event.type == naturalselection::EVENT_DEATH) {
+            REQUIRE(alive.erase(event.creature_id) == 1);
+            culled += event.detail == naturalselection::DEATH_CULLED ? 1 : 0;
+        } else if (event.type == naturalselection::EVENT_MEAL) {
+            REQUIRE(alive.count(event.creature_id) == 1);
+            REQUIRE(eaten.insert(event.other_id).second); // No food is eaten twice
+        } else {
+            REQUIRE(event.type == naturalselection::EVENT_GENERATION);
+            REQUIRE(event.other_id == alive.size());
+            generations++;
+        }
+    }
+    REQUIRE(generations == 3);
+    REQUIRE(births_to_parents > 0);
+    REQUIRE(culled > 0);
+    REQUIRE(alive == std::set<uint32_t>(final_ids.begin(), final_ids.end()));
+    REQUIRE(eaten.count(0) == 0);
+    unlink(path.c_str());
+}
+
+TEST_CASE("Both Engines Record The Same Events") {
+    SweepJob job;
+    job.seed = 9;
+    job.food_count = 30;
+    job.speed_creatures = true;
+    job.both_type_creatures = true;
+    job.generations = 2;
+    job.max_ticks = 100000;
+    std::string reference_path = GetStreamPath("reference");
+    std::string optimized_path = GetStreamPath("optimized");
+    std::vector<uint32_t> final_ids;
+    RecordRun(job, naturalselection::TICK_ENGINE_REFERENCE, reference_path, final_ids);
+    RecordRun(job, naturalselection::TICK_ENGINE_OPTIMIZED, optimized_path, final_ids);
+
+    EventStreamReader reference;
+    EventStreamReader optimized;
+    REQUIRE(reference.Open(reference_path));
+    REQUIRE(optimized.Open(optimized_path));
+    REQUIRE(reference.Size() == optimized.Size());
+    REQUIRE(memcmp(reference.begin(), optimized.begin(), reference.Size() * sizeof(LifeEvent)) == 0);
+    unlink(reference_path.c_str());
+    unlink(optimized_path.c_str());
+}
@@ -0,0 +1,131 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <environment.h>
+#include <food.h>
+#include <food_field.h>
+#include <headless_runner.h>
+
+using naturalselection::Creature;
+using naturalselection::Environment;
+using naturalselection::Food;
+using naturalselection::FoodField;
+using naturalselection::HeadlessRunner;
+using naturalselection::SteeringBatch;
+using naturalselection::SweepJob;
+using naturalselection::WorldBounds;
+
+TEST_CASE("Food Field Spreads Without Losing Food") {
+    FoodField field;
+    field.Build(WorldBounds{100, 100, 160, 120}, 16.0f);
+    REQUIRE(field.GetColumns() == 10);
+    REQUIRE(field.GetRows() == 8);
+
+    // Against a wall, so the reflecting edges are exercised from the start.
+    field.Deposit(101, 150, 40);
+    float start = field.GetDensityAt(101, 150);
+    for (size_t step = 0; step < 200; step++) {
+        field.Step(0.2f, 0);
+    }
+
+    REQUIRE(field.GetTotal() == Approx(40).epsilon(1e-4));
+    double cell_total = 0;
+    for (size_t row = 0; row < field.GetRows(); row++) {
+        for (size_t column = 0; column < field.GetColumns(); column++) {
+            REQUIRE(field.GetDensity(column, row) >= 0);
+            cell_total += field.GetDensity(column, row);
+        }
+    }
+    REQUIRE(cell_total == Approx(40).epsilon(1e-4));
+    REQUIRE(field.GetDensityAt(101, 150) < start / 4);
+    REQUIRE(field.GetDensity(9, 7) > 0); // The far corner
+}
+
+TEST_CASE("Food Field Grows Back Towards What Was Seeded") {
+    std::vector<Food> food;
+    food.push_back(Food(vec2(110, 110), 2.0f, ci::Color("green")));
+    food.push_back(Food(vec2(112, 114), 2.0f, ci::Color("green")));
+    food.push_back(Food(vec2(200, 180), 2.0f, ci::Color("green")));
+
+    FoodField field;
+    field.Build(WorldBounds{100, 100, 160, 120}, 16.0f);
+    field.Seed(food);
+    REQUIRE(field.GetTotal() == 3);
+    REQUIRE(field.GetDensityAt(110, 110) == 2);
+
+    field.RemoveEvenly(1.5f);
+    REQUIRE(field.GetTotal() == Approx(1.5));
+    REQUIRE(field.GetDensityAt(110, 110) == Approx(1));
+    for (size_t step = 0; step < 100; step++) {
+        field.Step(0, 0.1f);
+    }
+    REQUIRE(field.GetDensityAt(110, 110) == Approx(2).epsilon(1e-3));
+    REQUIRE(field.GetDensityAt(200, 180) == Approx(1).epsilon(1e-3));
+    REQUIRE(field.GetDensityAt(150, 150) == 0); // Nothing grows where nothing was seeded
+}
+
+TEST_CASE("Creatures Eat From Their Cell And Steer Up The Field") {
+    std::vector<Creature> creatures;
+    for (int i = 0; i < 3; i++) {
+        creatures.push_back(Creature(SPEED, vec2(150, 150), vec2(0, 1), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 40.0, 0.25, 2.5f));
+    }
+    creatures[2].SetPosition(vec2(250, 210)); // Somewhere with nothing around it
+
+    FoodField field;
+    field.Build(WorldBounds{100, 100, 160, 120}, 16.0f);
+    field.Deposit(150, 150, 1.75f);
+    field.Deposit(180, 150, 5); // Two cells to the right, within vision
+
+    SteeringBatch batch;
+    batch.Gather(creatures);
+    std::vector<float> meal_progress(creatures.size(), 0);
+    std::vector<uint32_t> fed;
+    for (size_t tick = 0; tick < 3; tick++) {
+        field.Feed(batch, meal_progress, fed);
+        REQUIRE(fed.empty());
+    }
+
+    // The first creature comes first, so it takes the last bite and makes up a meal.
+    field.Feed(batch, meal_progress, fed);
+    REQUIRE(fed == std::vector<uint32_t>{0});
+    REQUIRE(batch.food[0] == 1);
+    REQUIRE(batch.needs_movement[0] == 1);
+    REQUIRE(batch.food[1] == 0);
+    REQUIRE(meal_progress[1] == Approx(0.75));
+    REQUIRE(field.GetDensityAt(150, 150) == 0);
+    REQUIRE(field.GetTotal() == Approx(5));
+
+    field.BuildSums();
+    field.SteerUpGradient(batch, std::vector<uint8_t>(creatures.size(), 1), 0, creatures.size());
+    REQUIRE(batch.x_velocity[1] == Approx(2.5f));
+    REQUIRE(batch.y_velocity[1] == Approx(0));
+    REQUIRE(batch.x_velocity[2] == 0); // Sees nothing, so keeps going as it was
+    REQUIRE(batch.y_velocity[2] == 1);
+}
+
+TEST_CASE("Food Field Mode Runs Whole Generations") {
+    SweepJob job;
+    job.seed = 6;
+    job.food_count = 60;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.creatures_per_type = 30;
+    job.generations = 3;
+    job.max_ticks = 100000;
+    job.food_mode = naturalselection::FOOD_MODE_FIELD;
+    srand(job.seed);
+    Environment environment = Environment();
+    HeadlessRunner::SetUp(job, environment);
+    REQUIRE(environment.GetFood().empty());
+    REQUIRE(environment.GetFoodField().GetTotal() == Approx(60));
+
+    uint64_t frames = 0;
+    while (!HeadlessRunner::IsFinished(job, environment) && frames < job.max_ticks) {
+        HeadlessRunner::StepFrame(environment);
+        frames++;
+    }
+    REQUIRE(frames < job.max_ticks);
+    REQUIRE(environment.GetTrialsRun() == 3);
+    REQUIRE(environment.AreThereCreaturesAlive());
+    REQUIRE(environment.GetFood().empty());
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch.hpp>
+
+#include <food.h>
+#include <food_grid.h>
+#include <set>
+
+using naturalselection::Food;
+using naturalselection::FoodGrid;
+using naturalselection::WorldBounds;
+
+TEST_CASE("Food Grid Visits Every Food In Range") {
+    std::vector<Food> food;
+    for (size_t i = 0; i < 2000; i++) {
+        vec2 position = vec2((float) (rand() % 7000) / 10.0f + 100, (float) (rand() % 5000) / 10.0f + 100);
+        food.push_back(Food(position, 2.0f, ci::Color("green")));
+    }
+
+    FoodGrid grid;
+    grid.Build(food, WorldBounds{100, 100, 700, 500}, 16.0f);
+    REQUIRE(grid.Size() == food.size());
+
+    for (size_t query = 0; query < 200; query++) {
+        float x = (float) (rand() % 9000) / 10.0f + 50; // Some queries start outside the world
+        float y = (float) (rand() % 7000) / 10.0f + 50;
+        float reach = (float) (rand() % 600) / 10.0f;
+
+        std::set<size_t> visited;
+        grid.ForEachNear(x, y, reach, [&](size_t j) { visited.insert(j); });
+        for (size_t j = 0; j < food.size(); j++) {
+            if (std::abs(food[j].GetPosition().x - x) <= reach && std::abs(food[j].GetPosition().y - y) <= reach) {
+                REQUIRE(visited.count(j) == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Food Grid Stays Right As Food Is Added And Removed") {
+    std::vector<Food> food;
+    for (size_t i = 0; i < 300; i++) {
+        vec2 position = vec2((float) (rand() % 7000) / 10.0f + 100, (float) (rand() % 5000) / 10.0f + 100);
+        food.push_back(Food(position, 2.0f, ci::Color("green")));
+    }
+
+    FoodGrid grid;
+    grid.Build(food, WorldBounds{100, 100, 700, 500}, 16.0f);
+    for (size_t round = 0; round < 20; round++) {
+        // Piles into one corner too, so some cells run out of room and the grid is laid out again.
+        for (size_t i = 0; i < 40; i++) {
+            vec2 position = i % 2 == 0 ? vec2(105, 105) : vec2((float) (rand() % 7000) / 10.0f + 100,
+                                                               (float) (rand() % 5000) / 10.0f + 100);
+            food.push_back(Food(position, 2.0f, ci::Color("green")));
+            grid.Add(food.back());
+        }
+        for (size_t i = 0; i < 25; i++) {
+            if (i % 2 == 0) {
+                food.pop_back();
+                grid.RemoveLast();
+            } else { // Swapped out from anywhere
+                size_t index = (size_t) rand() % food.size();
+                food[index] = food.back();
+                food.pop_back();
+                grid.Remove(index);
+            }
+        }
+    }
+    REQUIRE(grid.Size() == food.size());
+
+    // Visits exactly what a grid built from scratch visits.
+    FoodGrid rebuilt;
+    rebuilt.Build(food, WorldBounds{100, 100, 700, 500}, 16.0f);
+    for (size_t query = 0; query < 200; query++) {
+        float x = (float) (rand() % 7000) / 10.0f + 100;
+        float y = (float) (rand() % 5000) / 10.0f + 100;
+        float reach = (float) (rand() % 600) / 10.0f;
+
+        std::multiset<size_t> visited;
+        std::multiset<size_t> expected;
+        grid.ForEachNear(x, y, reach, [&](size_t j) { visited.insert(j); });
+        rebuilt.ForEachNear(x, y, reach, [&](size_t j) { expected.insert(j); });
+        REQUIRE(visited == expected);
+    }
+}
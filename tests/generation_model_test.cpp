@@ -0,0 +1,220 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <environment.h>
+#include <generation_model.h>
+#include <headless_runner.h>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+using naturalselection::Creature;
+using naturalselection::Environment;
+using naturalselection::FastForwardReport;
+using naturalselection::GenerationModel;
+using naturalselection::HeadlessRunner;
+using naturalselection::RandomStream;
+using naturalselection::SweepJob;
+
+// Chance a creature of this speed eats at all: faster is better, up to a point.
+static double TrueSurvival(float speed) {
+    return 1.0 / (1.0 + std::exp(-(3.0 * (speed - 2.5) - 2.0 * (speed - 2.5) * (speed - 2.5))));
+}
+
+// A generation whose food follows TrueSurvival, with an even chance of a second meal for those that ate.
+// Reversed, the fastest fare as the slowest would have.
+static std::vector<Creature> MakeGeneration(RandomStream &random, size_t population, bool reversed = false) {
+    std::vector<Creature> creatures;
+    for (size_t i = 0; i < population; i++) {
+        float speed = 1.0f + 3.0f * random.NextUnitFloat();
+        Creature creature = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 12.0, 0.25, speed);
+        int food = random.NextUnitFloat() < TrueSurvival(reversed ? 5.0f - speed : speed) ? 1 : 0;
+        food += food > 0 && random.NextUnitFloat() < 0.5f ? 1 : 0;
+        creature.SetFood(food);
+        creatures.push_back(creature);
+    }
+    return creatures;
+}
+
+TEST_CASE("Generation Model Recovers How Traits Decide Fates") {
+    RandomStream random(3, 1);
+    GenerationModel model;
+    model.SetWindow(4);
+    model.Observe(MakeGeneration(random, 10), 20);
+    REQUIRE_FALSE(model.Fit()); // Too few to go on
+    REQUIRE_FALSE(model.IsFitted());
+
+    for (size_t generation = 0; generation < 5; generation++) {
+        model.Observe(MakeGeneration(random, 2000), 20);
+    }
+    REQUIRE(model.GetObservedCount() == 4);
+    REQUIRE(model.Fit());
+    REQUIRE_FALSE(model.IsUsingBaseRates());
+
+    for (float speed = 1.25f; speed < 4.0f; speed += 0.5f) {
+        Creature creature = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 12.0, 0.25, speed);
+        std::array<double, 3> chances = model.Predict(creature, 2000, 20);
+        REQUIRE(chances[0] + chances[1] + chances[2] == Approx(1));
+        REQUIRE(chances[1] + chances[2] == Approx(TrueSurvival(speed)).margin(0.05));
+        if (TrueSurvival(speed) > 0.2) { // Otherwise too few ate to say
+            REQUIRE(chances[2] / (chances[1] + chances[2]) == Approx(0.5).margin(0.05));
+        }
+    }
+
+    // Drawn fates follow the chances, unless they come to more meals than there is food.
+    std::vector<Creature> generation = MakeGeneration(random, 2000);
+    std::vector<int> food;
+    model.DrawOutcomes(generation, 20, SIZE_MAX, 5, food);
+    size_t meals = 0;
+    double expected_meals = 0;
+    for (size_t i = 0; i < generation.size(); i++) {
+        std::array<double, 3> chances = model.Predict(generation[i], generation.size(), 20);
+        meals += food[i];
+        expected_meals += chances[1] + 2 * chances[2];
+    }
+    REQUIRE(meals == Approx(expected_meals).epsilon(0.05));
+    model.DrawOutcomes(generation, 20, 100, 5, food);
+    REQUIRE(std::accumulate(food.begin(), food.end(), 0) == 100);
+
+    // Against a generation it never saw, it does better than giving everyone the same chances.
+    FastForwardReport report = model.Score(MakeGeneration(random, 2000), 20);
+    REQUIRE(report.population == 2000);
+    REQUIRE(report.brier_score < report.baseline_brier_score);
+    REQUIRE(report.expected_survivors == Approx((double) report.survivors).epsilon(0.05));
+    REQUIRE(report.expected_births == Approx((double) report.births).epsilon(0.1));
+}
+
+TEST_CASE("Generation Model Tells Creature Types Apart") {
+    RandomStream random(4, 1);
+    GenerationModel model;
+    for (size_t generation = 0; generation < 5; generation++) {
+        std::vector<Creature> creatures;
+        for (size_t i = 0; i < 2000; i++) { // Same traits, but intelligence creatures eat far less often
+            int type = i % 2 == 0 ? SPEED : INTELLIGENCE;
+            Creature creature = Creature(type, vec2(0, 0), vec2(0, 0), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 12.0, 0.25, 2.5f);
+            creature.SetFood(random.NextUnitFloat() < (type == SPEED ? 0.8f : 0.2f) ? 1 : 0);
+            creatures.push_back(creature);
+        }
+        model.Observe(creatures, 20);
+    }
+    REQUIRE(model.Fit());
+
+    Creature speed = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 12.0, 0.25, 2.5f);
+    Creature intelligence = Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 12.0, 0.25, 2.5f);
+    REQUIRE(1 - model.Predict(speed, 2000, 20)[0] == Approx(0.8).margin(0.05));
+    REQUIRE(1 - model.Predict(intelligence, 2000, 20)[0] == Approx(0.2).margin(0.05));
+}
+
+TEST_CASE("Generation Model Falls Back To Base Rates When Its Fit Does Worse") {
+    RandomStream random(5, 1);
+    GenerationModel model;
+    model.SetWindow(4);
+    for (size_t generation = 0; generation < 3; generation++) {
+        model.Observe(MakeGeneration(random, 2000), 20);
+    }
+    model.Observe(MakeGeneration(random, 2000, true), 20); // The fast fared well until now
+    REQUIRE(model.Fit());
+    REQUIRE(model.IsUsingBaseRates());
+
+    // Every creature gets the same chances, whatever its speed.
+    Creature slow = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 12.0, 0.25, 1.25f);
+    Creature fast = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5, naturalselection::DEFAULT_CREATURE_MASS, 400.0, 0, 12.0, 0.25, 3.75f);
+    std::array<double, 3> slow_chances = model.Predict(slow, 2000, 20);
+    std::array<double, 3> fast_chances = model.Predict(fast, 2000, 20);
+    for (size_t k = 0; k < 3; k++) {
+        REQUIRE(slow_chances[k] == fast_chances[k]);
+    }
+    REQUIRE(slow_chances[0] + slow_chances[1] + slow_chances[2] == Approx(1));
+    FastForwardReport report = model.Score(MakeGeneration(random, 2000, true), 20);
+    REQUIRE(report.brier_score == Approx(report.baseline_brier_score));
+}
+
+TEST_CASE("Fast Forward Skips Generations And Checks Itself") {
+    SweepJob job;
+    job.seed = 8;
+    job.food_count = 40;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.creatures_per_type = 30;
+    job.generations = 12;
+    job.max_ticks = 200000;
+
+    srand(job.seed);
+    Environment full = Environment();
+    HeadlessRunner::SetUp(job, full);
+    while (!HeadlessRunner::IsFinished(job, full)) {
+        HeadlessRunner::StepFrame(full);
+    }
+
+    srand(job.seed);
+    Environment fast = Environment();
+    job.fast_forward_calibration = 2;
+    job.fast_forward_skipped = 3;
+    HeadlessRunner::SetUp(job, fast);
+    while (!HeadlessRunner::IsFinished(job, fast)) {
+        HeadlessRunner::StepFrame(fast);
+    }
+
+    // Two in full, three skipped, and so on, so fewer than half the generations took any ticks. The last
+    // fast-forward can run past the generations asked for, so ticks are compared per generation.
+    REQUIRE(fast.GetTrialsRun() >= job.generations);
+    REQUIRE(fast.GetTick() * job.generations < full.GetTick() * fast.GetTrialsRun() / 2);
+    REQUIRE(fast.GetPopulationHistory().size() == fast.GetTrialsRun() + 1);
+    REQUIRE(fast.GetPhylogeny().GetLivingCount() == fast.GetCreatures().size());
+
+    const std::vector<FastForwardReport> &reports = fast.GetFastForwardReports();
+    REQUIRE(reports.size() >= 2);
+    for (const FastForwardReport &report : reports) {
+        REQUIRE(report.generations_skipped == 3);
+        REQUIRE(report.population > 0);
+        REQUIRE(report.survivors <= report.population);
+        REQUIRE(report.births <= report.survivors);
+        REQUIRE(report.expected_survivors <= report.population);
+        REQUIRE(report.brier_score >= 0);
+        REQUIRE(report.brier_score <= 2);
+    }
+}
+
+TEST_CASE("Fast Forward Spawns One Food Layout Per Full Generation") {
+    SweepJob job;
+    job.seed = 8;
+    job.food_count = 40;
+    job.speed_creatures = true;
+    job.intelligence_creatures = true;
+    job.creatures_per_type = 30;
+    job.generations = 12;
+    job.max_ticks = 200000;
+    job.fast_forward_calibration = 2;
+    job.fast_forward_skipped = 3;
+
+    srand(job.seed);
+    Environment environment = Environment();
+    HeadlessRunner::SetUp(job, environment);
+
+    // Food ids are handed out in turn, so a layout spawned and thrown away would leave a gap in them.
+    uint32_t highest_id = 0;
+    for (const naturalselection::Food &food : environment.GetFood()) {
+        highest_id = std::max(highest_id, food.GetId());
+    }
+    size_t trials = environment.GetTrialsRun();
+    size_t skipped_generations = 0;
+    while (!HeadlessRunner::IsFinished(job, environment)) {
+        HeadlessRunner::StepFrame(environment);
+        if (environment.GetTrialsRun() == trials) {
+            continue;
+        }
+
+        skipped_generations += environment.GetTrialsRun() - trials - 1;
+        trials = environment.GetTrialsRun();
+        uint32_t previous_highest_id = highest_id;
+        uint32_t lowest_new_id = UINT32_MAX;
+        for (const naturalselection::Food &food : environment.GetFood()) {
+            lowest_new_id = std::min(lowest_new_id, food.GetId());
+            highest_id = std::max(highest_id, food.GetId());
+        }
+        INFO("generation " << trials);
+        REQUIRE(lowest_new_id == previous_highest_id + 1);
+        REQUIRE(highest_id == previous_highest_id + job.food_count);
+    }
+    REQUIRE(skipped_generations >= 3);
+}
@@ -0,0 +1,69 @@
+#include <catch2/catch.hpp>
+
+#include "test_helpers.h"
+#include <creature.h>
+#include <generation_turnover.h>
+
+using naturalselection::Creature;
+using naturalselection::GenerationTurnover;
+
+TEST_CASE("Turnover Keeps Survivors Then Children In Order") {
+    std::vector<Creature> parents = MakeFedPopulation(1000);
+    std::vector<Creature> next_generation;
+    GenerationTurnover::Run(parents, next_generation, 42, 1);
+
+    std::vector<size_t> survivors;
+    std::vector<size_t> breeders;
+    for (size_t i = 0; i < parents.size(); i++) {
+        if (parents[i].GetFood() > 0) {
+            survivors.push_back(i);
+        }
+        if (parents[i].GetFood() > 1) {
+            breeders.push_back(i);
+        }
+    }
+
+    REQUIRE(next_generation.size() == survivors.size() + breeders.size());
+    for (size_t i = 0; i < survivors.size(); i++) {
+        REQUIRE(next_generation[i].GetMaxVelocity() == parents[survivors[i]].GetMaxVelocity());
+        REQUIRE(next_generation[i].GetFood() == parents[survivors[i]].GetFood());
+    }
+
+    for (size_t i = 0; i < breeders.size(); i++) {
+        const Creature &child = next_generation[survivors.size() + i];
+        REQUIRE(child.GetCreatureType() == parents[breeders[i]].GetCreatureType());
+        REQUIRE(child.GetParentId() == parents[breeders[i]].GetId());
+        REQUIRE(child.GetId() == 0); // Handed out by the environment
+        REQUIRE(child.GetFood() == 0);
+    }
+}
+
+TEST_CASE("Turnover Is Independent Of Thread Count") {
+    std::vector<Creature> parents = MakeFedPopulation(100000);
+    std::vector<Creature> single_threaded;
+    std::vector<Creature> multi_threaded;
+    GenerationTurnover::Run(parents, single_threaded, 7, 1);
+    GenerationTurnover::Run(parents, multi_threaded, 7, 8);
+
+    REQUIRE(single_threaded.size() == multi_threaded.size());
+    bool identical = true;
+    for (size_t i = 0; i < single_threaded.size(); i++) {
+        if (single_threaded[i].GetMaxVelocity() != multi_threaded[i].GetMaxVelocity() ||
+            single_threaded[i].GetVisionRadius() != multi_threaded[i].GetVisionRadius() ||
+            single_threaded[i].GetEnergySpend() != multi_threaded[i].GetEnergySpend()) {
+            identical = false;
+        }
+    }
+    REQUIRE(identical);
+
+    // A different seed has to actually change the mutations.
+    std::vector<Creature> reseeded;
+    GenerationTurnover::Run(parents, reseeded, 8, 8);
+    bool any_different = false;
+    for (size_t i = 0; i < reseeded.size(); i++) {
+        if (reseeded[i].GetMaxVelocity() != single_threaded[i].GetMaxVelocity()) {
+            any_different = true;
+        }
+    }
+    REQUIRE(any_different);
+}
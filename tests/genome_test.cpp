@@ -0,0 +1,104 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <creature.h>
+#include <genome.h>
+#include <random_stream.h>
+
+using naturalselection::Creature;
+using naturalselection::Genome;
+using naturalselection::GenomeBatch;
+using naturalselection::RandomStream;
+
+TEST_CASE("Cost Table Matches Cost Curve") {
+    for (int trait = 0; trait < naturalselection::TRAIT_COUNT; trait++) {
+        const naturalselection::TraitSpec &spec = Genome::GetTraitSpec(trait);
+        REQUIRE(Genome::GetCostMultiplier(trait, spec.default_value) == Approx(1.0f));
+
+        for (float ratio = 0.05f; ratio < 6.0f; ratio += 0.05f) {
+            float multiplier = Genome::GetCostMultiplier(trait, spec.default_value * ratio);
+            REQUIRE(multiplier == Approx(spec.cost_curve(ratio)).epsilon(1e-3));
+        }
+    }
+}
+
+TEST_CASE("Genome Batch Matches Single Children") {
+    std::vector<Creature> parents;
+    for (size_t i = 0; i < 300; i++) {
+        parents.push_back(Creature((int) (i % 3), vec2(0, 0), vec2(0, 0), 5, 10,
+                                   0.0, 2, 8.0 + (double) (i % 11), 0.25, 1.5f + (float) (i % 13) / 10.0f));
+    }
+
+    GenomeBatch batch;
+    batch.Resize(parents.size());
+    for (size_t i = 0; i < parents.size(); i++) {
+        Genome genome = Genome::Inherit(parents[i]);
+        RandomStream stream = RandomStream::ForCreature(3, i);
+        for (size_t trait = 0; trait < naturalselection::TRAIT_COUNT; trait++) {
+            batch.traits[trait][i] = genome.GetTrait((int) trait);
+            batch.unit_samples[trait][i] = stream.NextUnitFloat();
+        }
+        batch.creature_type[i] = parents[i].GetCreatureType();
+    }
+    batch.Mutate();
+
+    for (size_t i = 0; i < parents.size(); i++) {
+        RandomStream stream = RandomStream::ForCreature(3, i);
+        Creature expected = parents[i].CreateChild(parents[i].GetCreatureType(), stream);
+        Creature child = batch.CreateCreature(i, parents[i]);
+        REQUIRE(child.GetMaxVelocity() == expected.GetMaxVelocity());
+        REQUIRE(child.GetVisionRadius() == expected.GetVisionRadius());
+        REQUIRE(child.GetEnergySpend() == expected.GetEnergySpend());
+    }
+}
+
+TEST_CASE("Genome Only Mutates Active Traits") {
+    Creature parent = Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), 5, 10,
+                               0.0, 2, 12.0, 0.25, 2.5f);
+    Genome genome = Genome::FromCreature(parent);
+    float unit_samples[naturalselection::TRAIT_COUNT] = {1.0f, 1.0f};
+    genome.Mutate(INTELLIGENCE, unit_samples);
+
+    REQUIRE(genome.GetTrait(naturalselection::TRAIT_MAX_VELOCITY) == 2.5f);
+    REQUIRE(genome.GetTrait(naturalselection::TRAIT_VISION_RADIUS) == Approx(18.0f));
+}
+
+TEST_CASE("Both Type Children Mutate Vision From The Default") {
+    // Their speed comes from the parent, but their vision starts over from the default each time.
+    Creature parent = Creature(BOTH, vec2(0, 0), vec2(0, 0), 5, 10,
+                               0.0, 2, 30.0, 0.25, 4.0f);
+    float default_vision = Genome::GetTraitSpec(naturalselection::TRAIT_VISION_RADIUS).default_value;
+    for (size_t i = 0; i < 50; i++) {
+        RandomStream stream = RandomStream::ForCreature(9, i);
+        Creature child = parent.CreateChild(BOTH, stream);
+        REQUIRE(child.GetMaxVelocity() >= 4.0f * 0.9f);
+        REQUIRE(child.GetMaxVelocity() <= 4.0f * 1.1f);
+        REQUIRE(child.GetVisionRadius() >= default_vision * 0.5f);
+        REQUIRE(child.GetVisionRadius() <= default_vision * 1.5f);
+    }
+
+    Creature intelligence_parent = Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), 5, 10,
+                                            0.0, 2, 30.0, 0.25, 2.5f);
+    RandomStream stream = RandomStream::ForCreature(9, 0);
+    REQUIRE(intelligence_parent.CreateChild(INTELLIGENCE, stream).GetVisionRadius() >= 15.0);
+}
+
+TEST_CASE("Children Pay Energy As They Always Have") {
+    // Speed children pay for their own speed, intelligence children for their parent's vision,
+    // and BOTH children the default spend.
+    for (size_t i = 0; i < 50; i++) {
+        RandomStream stream = RandomStream::ForCreature(11, i);
+        Creature speed_parent = Creature(SPEED, vec2(0, 0), vec2(0, 0), 5, 10, 0.0, 2, 12.0, 0.25, 3.5f);
+        Creature speed_child = speed_parent.CreateChild(SPEED, stream);
+        REQUIRE(speed_child.GetEnergySpend() == Approx(naturalselection::DEFAULT_ENERGY_SPEND *
+            Genome::GetCostMultiplier(naturalselection::TRAIT_MAX_VELOCITY, speed_child.GetMaxVelocity())));
+
+        Creature intelligence_parent = Creature(INTELLIGENCE, vec2(0, 0), vec2(0, 0), 5, 10, 0.0, 2, 20.0, 0.25, 2.5f);
+        Creature intelligence_child = intelligence_parent.CreateChild(INTELLIGENCE, stream);
+        REQUIRE(intelligence_child.GetEnergySpend() == Approx(naturalselection::DEFAULT_ENERGY_SPEND *
+            Genome::GetCostMultiplier(naturalselection::TRAIT_VISION_RADIUS, 20.0f)));
+
+        Creature both_parent = Creature(BOTH, vec2(0, 0), vec2(0, 0), 5, 10, 0.0, 2, 20.0, 0.25, 3.5f);
+        REQUIRE(both_parent.CreateChild(BOTH, stream).GetEnergySpend() == naturalselection::DEFAULT_ENERGY_SPEND);
+    }
+}
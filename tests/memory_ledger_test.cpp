@@ -0,0 +1,46 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <memory_ledger.h>
+
+using naturalselection::MemoryFootprint;
+using naturalselection::MemoryLedger;
+
+TEST_CASE("Memory Footprint Counts Capacity Of Nested Vectors") {
+    std::vector<std::vector<int>> records;
+    records.reserve(4);
+    records.push_back(std::vector<int>(10));
+    records.push_back(std::vector<int>());
+    records.back().reserve(3);
+    records.push_back(std::vector<int>()); // Never allocated, so not counted
+
+    MemoryFootprint footprint;
+    footprint.Add(records);
+    REQUIRE(footprint.allocations == 3);
+    REQUIRE(footprint.bytes == 4 * sizeof(std::vector<int>) + 10 * sizeof(int) + 3 * sizeof(int));
+}
+
+TEST_CASE("Memory Ledger Keeps Peaks Per Subsystem And In Total") {
+    MemoryLedger ledger;
+    std::array<MemoryFootprint, naturalselection::MEMORY_SUBSYSTEM_COUNT> footprints;
+    footprints[naturalselection::MEMORY_CREATURES].bytes = 800;
+    footprints[naturalselection::MEMORY_CREATURES].allocations = 1;
+    footprints[naturalselection::MEMORY_FOOD].bytes = 100;
+    footprints[naturalselection::MEMORY_FOOD].allocations = 1;
+    ledger.Record(footprints);
+
+    // Creatures shrink while food grows, but never to more than the first total.
+    footprints[naturalselection::MEMORY_CREATURES].bytes = 200;
+    footprints[naturalselection::MEMORY_FOOD].bytes = 500;
+    footprints[naturalselection::MEMORY_FOOD].allocations = 2;
+    ledger.Record(footprints);
+
+    REQUIRE(ledger.GetUsage(naturalselection::MEMORY_CREATURES).bytes == 200);
+    REQUIRE(ledger.GetUsage(naturalselection::MEMORY_CREATURES).peak_bytes == 800);
+    REQUIRE(ledger.GetUsage(naturalselection::MEMORY_FOOD).peak_bytes == 500);
+    REQUIRE(ledger.GetUsage(naturalselection::MEMORY_FOOD).peak_allocations == 2);
+    REQUIRE(ledger.GetTotal().bytes == 700);
+    REQUIRE(ledger.GetTotal().peak_bytes == 900);
+    REQUIRE(ledger.GetTotal().peak_allocations == 3);
+    REQUIRE(ledger.FormatLines().size() == naturalselection::MEMORY_SUBSYSTEM_COUNT + 1);
+}
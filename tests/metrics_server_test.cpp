@@ -0,0 +1,119 @@
+#include <catch2/catch.hpp>
+
+#include <arpa/inet.h>
+#include <environment.h>
+#include <headless_runner.h>
+#include <metrics_server.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using naturalselection::Environment;
+using naturalselection::HeadlessRunner;
+using naturalselection::MemoryFootprint;
+using naturalselection::MetricsServer;
+using naturalselection::SimulationMetrics;
+using naturalselection::SweepJob;
+using naturalselection::WorldSnapshot;
+
+static WorldSnapshot MakeSnapshot(uint64_t tick) {
+    WorldSnapshot snapshot;
+    snapshot.tick = tick;
+    snapshot.trials_run = 3;
+    snapshot.speed_count = 4;
+    snapshot.intelligence_count = 5;
+    snapshot.both_type_count = 6;
+    snapshot.food.resize(7);
+
+    std::array<MemoryFootprint, naturalselection::MEMORY_SUBSYSTEM_COUNT> footprints;
+    footprints[naturalselection::MEMORY_CREATURES].bytes = 2048;
+    snapshot.memory.Record(footprints);
+    return snapshot;
+}
+
+// Stands in for a Prometheus scraper: sends one request and reads until the server closes.
+static std::string Scrape(uint16_t port, const std::string &request) {
+    int connection = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    REQUIRE(connect(connection, (sockaddr *) &address, sizeof(address)) == 0);
+    REQUIRE(send(connection, request.data(), request.size(), 0) == (ssize_t) request.size());
+
+    std::string response;
+    char chunk[1024];
+    ssize_t received;
+    while ((received = recv(connection, chunk, sizeof(chunk), 0)) > 0) {
+        response.append(chunk, (size_t) received);
+    }
+    close(connection);
+    return response;
+}
+
+TEST_CASE("Simulation Metrics Format As Prometheus Text") {
+    SimulationMetrics metrics;
+    SimulationMetrics::Clock::time_point start = SimulationMetrics::Clock::now();
+    metrics.Record(MakeSnapshot(100), start);
+    metrics.Record(MakeSnapshot(150), start + std::chrono::milliseconds(500)); // Too soon for a rate
+    REQUIRE(metrics.Format().find("naturalselection_ticks_per_second 0\n") != std::string::npos);
+
+    metrics.Record(MakeSnapshot(300), start + std::chrono::seconds(2));
+    std::string text = metrics.Format();
+    REQUIRE(text.find("# TYPE naturalselection_ticks_total counter\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_ticks_total 300\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_ticks_per_second 100\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_generation 3\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_creatures{type=\"speed\"} 4\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_creatures{type=\"intelligence\"} 5\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_creatures{type=\"both\"} 6\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_food_remaining 7\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_memory_bytes{subsystem=\"creatures\"} 2048\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_memory_peak_bytes{subsystem=\"creatures\"} 2048\n") != std::string::npos);
+}
+
+TEST_CASE("Metrics Server Answers Scrapes While Recording Continues") {
+    SimulationMetrics metrics;
+    metrics.Record(MakeSnapshot(1));
+    MetricsServer server(metrics);
+    REQUIRE(server.Start(0));
+    REQUIRE(server.GetPort() != 0);
+
+    std::string response = Scrape(server.GetPort(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    REQUIRE(response.find("HTTP/1.1 200 OK\r\n") == 0);
+    REQUIRE(response.find("text/plain; version=0.0.4") != std::string::npos);
+    REQUIRE(response.find("naturalselection_ticks_total 1\n") != std::string::npos);
+
+    // The server only reads the atomics, so it sees new ticks without the simulation waiting on it.
+    metrics.Record(MakeSnapshot(42));
+    response = Scrape(server.GetPort(), "GET /metrics HTTP/1.1\r\n\r\n");
+    REQUIRE(response.find("naturalselection_ticks_total 42\n") != std::string::npos);
+
+    REQUIRE(Scrape(server.GetPort(), "GET / HTTP/1.1\r\n\r\n").find("HTTP/1.1 404") == 0);
+    REQUIRE(Scrape(server.GetPort(), "POST /metrics HTTP/1.1\r\n\r\n").find("HTTP/1.1 405") == 0);
+
+    server.Stop();
+    server.Stop(); // Stopping twice is harmless
+}
+
+TEST_CASE("Simulation Metrics Record Straight From An Environment") {
+    SweepJob job;
+    job.food_count = 12;
+    job.speed_creatures = true;
+    job.creatures_per_type = 9;
+    srand(4);
+    Environment environment = Environment();
+    HeadlessRunner::SetUp(job, environment);
+    for (int frame = 0; frame < 3; frame++) {
+        HeadlessRunner::StepFrame(environment);
+    }
+
+    SimulationMetrics metrics;
+    metrics.Record(environment);
+    std::string text = metrics.Format();
+    REQUIRE(text.find("naturalselection_ticks_total " + std::to_string(environment.GetTick()) + "\n") !=
+            std::string::npos);
+    REQUIRE(text.find("naturalselection_creatures{type=\"speed\"} 9\n") != std::string::npos);
+    REQUIRE(text.find("naturalselection_food_remaining " + std::to_string(environment.GetFood().size()) + "\n") !=
+            std::string::npos);
+}
@@ -0,0 +1,81 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <environment.h>
+#include <food.h>
+#include <morton_order.h>
+#include <set>
+
+using naturalselection::Creature;
+using naturalselection::Environment;
+using naturalselection::Food;
+using naturalselection::MortonSorter;
+using naturalselection::WorldBounds;
+
+static const WorldBounds BOUNDS = WorldBounds{100, 100, 700, 500};
+
+TEST_CASE("Morton Keys Interleave X And Y") {
+    REQUIRE(MortonSorter::GetKey(vec2(100, 100), BOUNDS) == 0);
+    REQUIRE(MortonSorter::GetKey(vec2(800, 600), BOUNDS) == 0xFFFFFFFF);
+    REQUIRE(MortonSorter::GetKey(vec2(0, 0), BOUNDS) == 0); // Clamped to the arena
+
+    // The top bit is y's: all of the top half of the arena comes before any of the bottom half.
+    REQUIRE(MortonSorter::GetKey(vec2(799, 349), BOUNDS) < MortonSorter::GetKey(vec2(101, 351), BOUNDS));
+    REQUIRE(MortonSorter::GetKey(vec2(449, 101), BOUNDS) < MortonSorter::GetKey(vec2(451, 101), BOUNDS));
+}
+
+TEST_CASE("Morton Sort Is Stable And Reports The Order") {
+    std::vector<Food> food;
+    food.push_back(Food(vec2(700, 500), 2, ci::Color("green")));
+    food.push_back(Food(vec2(150, 150), 2, ci::Color("green")));
+    food.push_back(Food(vec2(700, 500), 3, ci::Color("green")));
+    food.push_back(Food(vec2(150, 150), 4, ci::Color("green")));
+
+    MortonSorter sorter;
+    REQUIRE(sorter.Sort(food, BOUNDS));
+    REQUIRE(sorter.GetOrder() == std::vector<uint32_t>({1, 3, 0, 2}));
+    REQUIRE(food[0].GetRadius() == 2);
+    REQUIRE(food[1].GetRadius() == 4);
+    REQUIRE(food[2].GetRadius() == 2);
+    REQUIRE(food[3].GetRadius() == 3);
+    REQUIRE_FALSE(sorter.Sort(food, BOUNDS)); // Already in order
+}
+
+TEST_CASE("Creature Ids Stay Unique Across Re-sorting And Generations") {
+    srand(3);
+    Environment environment = Environment();
+    environment.AddSpeedCreatures(40);
+    environment.AddIntelligenceCreatures(40);
+    environment.SetSpatialSortInterval(1);
+
+    std::set<uint32_t> first_ids;
+    for (const Creature &creature : environment.GetCreatures()) {
+        first_ids.insert(creature.GetId());
+    }
+    REQUIRE(first_ids.size() == 80);
+    REQUIRE(first_ids.count(0) == 0);
+
+    environment.SetIsRunning(true);
+    for (int tick = 0; tick < 20; tick++) {
+        environment.AdvanceOneFrame();
+    }
+    std::set<uint32_t> ids;
+    for (const Creature &creature : environment.GetCreatures()) {
+        ids.insert(creature.GetId());
+    }
+    REQUIRE(ids == first_ids); // Same creatures, whatever order they are in now
+
+    // Children get new ids, survivors keep theirs.
+    while (environment.GetTrialsRun() < 2 && environment.AreThereCreaturesAlive()) {
+        if (!environment.GetIsRunning()) {
+            environment.SetIsRunning(true);
+        }
+        environment.AdvanceOneFrame();
+    }
+    std::set<uint32_t> next_ids;
+    for (const Creature &creature : environment.GetCreatures()) {
+        REQUIRE(creature.GetId() != 0);
+        next_ids.insert(creature.GetId());
+    }
+    REQUIRE(next_ids.size() == environment.GetCreatures().size());
+}
@@ -0,0 +1,184 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <environment.h>
+#include <headless_runner.h>
+#include <phylogeny.h>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+using naturalselection::Creature;
+using naturalselection::Environment;
+using naturalselection::HeadlessRunner;
+using naturalselection::Phylogeny;
+using naturalselection::SweepJob;
+
+// The common ancestor found by walking the whole family tree, kept in full.
+static uint32_t FindCommonAncestorSlowly(const std::unordered_map<uint32_t, uint32_t> &parents, uint32_t first,
+                                         uint32_t second) {
+    std::unordered_set<uint32_t> ancestors;
+    for (uint32_t id = first; id != 0; id = parents.at(id)) {
+        ancestors.insert(id);
+    }
+    for (uint32_t id = second; id != 0; id = parents.at(id)) {
+        if (ancestors.count(id) == 1) {
+            return id;
+        }
+    }
+    return 0;
+}
+
+// Runs generations of random deaths and births over a population of about population creatures.
+// Every check_interval generations, checks the tree against the full ancestry, if that is kept.
+static size_t RunRandomLineages(Phylogeny &phylogeny, size_t population, size_t generations, size_t check_interval,
+                                std::unordered_map<uint32_t, uint32_t> *parents) {
+    std::mt19937 random(7);
+    std::vector<uint32_t> living;
+    uint32_t next_id = 1;
+    for (size_t i = 0; i < population; i++) {
+        phylogeny.AddFounder(next_id);
+        if (parents != nullptr) {
+            (*parents)[next_id] = 0;
+        }
+        living.push_back(next_id++);
+    }
+
+    size_t births = 0;
+    for (size_t generation = 1; generation <= generations && !living.empty(); generation++) {
+        std::vector<uint32_t> next_living;
+        for (uint32_t id : living) {
+            uint32_t fate = random() % 4; // Grows by a quarter a generation, so the cap keeps it steady
+            if (fate == 0) {
+                phylogeny.RemoveCreature(id);
+                continue;
+            }
+            next_living.push_back(id);
+            if (fate >= 2) {
+                phylogeny.AddBirth(next_id, id);
+                if (parents != nullptr) {
+                    (*parents)[next_id] = id;
+                }
+                next_living.push_back(next_id++);
+                births++;
+            }
+        }
+        while (next_living.size() > population) { // Like the carrying capacity
+            size_t culled = random() % next_living.size();
+            phylogeny.RemoveCreature(next_living[culled]);
+            next_living[culled] = next_living.back();
+            next_living.pop_back();
+        }
+        living.swap(next_living);
+
+        phylogeny.Compact();
+        REQUIRE(phylogeny.GetLivingCount() == living.size());
+        REQUIRE(phylogeny.GetNodeCount() < 2 * living.size());
+        if (parents != nullptr && generation % check_interval == 0) {
+            for (size_t pair = 0; pair < 50; pair++) {
+                uint32_t first = living[random() % living.size()];
+                uint32_t second = living[random() % living.size()];
+                REQUIRE(phylogeny.FindCommonAncestor(first, second) ==
+                        FindCommonAncestorSlowly(*parents, first, second));
+            }
+        }
+    }
+    return births;
+}
+
+TEST_CASE("Phylogeny Finds Common Ancestors And Drops Extinct Lines") {
+    Phylogeny phylogeny;
+    phylogeny.AddFounder(1);
+    phylogeny.AddFounder(2);
+    phylogeny.AddBirth(3, 1);
+    phylogeny.AddBirth(4, 1);
+    phylogeny.AddBirth(5, 3);
+    phylogeny.AddBirth(6, 3);
+    phylogeny.AddBirth(7, 4);
+    phylogeny.AddBirth(8, 2);
+
+    REQUIRE(phylogeny.FindCommonAncestor(5, 6) == 3);
+    REQUIRE(phylogeny.FindCommonAncestor(5, 7) == 1);
+    REQUIRE(phylogeny.FindCommonAncestor(3, 5) == 3); // Its own ancestor
+    REQUIRE(phylogeny.FindCommonAncestor(5, 8) == 0); // Different founders
+    REQUIRE(phylogeny.GetFounder(7) == 1);
+    REQUIRE(phylogeny.GetLineageSize(1) == 6);
+    REQUIRE(phylogeny.GetLineageSize(2) == 2);
+
+    // The whole second lineage goes once its last member does.
+    phylogeny.RemoveCreature(8);
+    phylogeny.RemoveCreature(2);
+    REQUIRE(phylogeny.GetNodeCount() == 6);
+    REQUIRE(phylogeny.GetLineageCount() == 1);
+    REQUIRE(phylogeny.GetFounder(8) == 0);
+
+    // Dead ancestors stay while they have living descendants, but a line that never branched is spliced out.
+    phylogeny.RemoveCreature(1);
+    phylogeny.RemoveCreature(3);
+    phylogeny.RemoveCreature(4);
+    REQUIRE(phylogeny.GetNodeCount() == 6);
+    phylogeny.Compact();
+    REQUIRE(phylogeny.GetNodeCount() == 5);
+    REQUIRE(phylogeny.FindCommonAncestor(6, 7) == 1);
+    REQUIRE(phylogeny.GetFounder(7) == 1);
+
+    phylogeny.RemoveCreature(7);
+    phylogeny.Compact();
+    REQUIRE(phylogeny.GetNodeCount() == 3);
+    REQUIRE(phylogeny.FindCommonAncestor(5, 6) == 3);
+    REQUIRE(phylogeny.GetLineageSize(1) == 2);
+
+    phylogeny.TakeCensus(4);
+    REQUIRE(phylogeny.GetCensuses().back().lineage_count == 1);
+    REQUIRE(phylogeny.GetCensuses().back().largest[0] == std::make_pair((uint32_t) 1, (size_t) 2));
+}
+
+TEST_CASE("Phylogeny Matches The Full Family Tree") {
+    Phylogeny phylogeny;
+    std::unordered_map<uint32_t, uint32_t> parents;
+    RunRandomLineages(phylogeny, 200, 80, 5, &parents);
+}
+
+TEST_CASE("Phylogeny Stays Small Over Millions Of Births") {
+    Phylogeny phylogeny;
+    size_t births = RunRandomLineages(phylogeny, 1000, 2500, 0, nullptr);
+    REQUIRE(births > 1000000);
+    REQUIRE(phylogeny.GetMemoryFootprint().bytes < 512 * 1024);
+}
+
+TEST_CASE("Environment Tracks Every Creature's Lineage") {
+    SweepJob job;
+    job.seed = 4;
+    job.food_count = 40;
+    job.speed_creatures = true;
+    job.both_type_creatures = true;
+    job.creatures_per_type = 30;
+    job.generations = 3;
+    job.max_ticks = 100000;
+    srand(job.seed);
+    Environment environment = Environment();
+    HeadlessRunner::SetUp(job, environment);
+    while (!HeadlessRunner::IsFinished(job, environment)) {
+        HeadlessRunner::StepFrame(environment);
+    }
+
+    const Phylogeny &phylogeny = environment.GetPhylogeny();
+    REQUIRE(phylogeny.GetLivingCount() == environment.GetCreatures().size());
+    REQUIRE(phylogeny.GetCensuses().size() == 3);
+
+    std::set<uint32_t> founders;
+    size_t children = 0;
+    for (const Creature &creature : environment.GetCreatures()) {
+        REQUIRE(phylogeny.IsAlive(creature.GetId()));
+        founders.insert(phylogeny.GetFounder(creature.GetId()));
+        children += creature.GetParentId() != 0 ? 1 : 0;
+    }
+    REQUIRE(children > 0);
+    REQUIRE(founders.count(0) == 0);
+    size_t lineage_total = 0;
+    for (uint32_t founder : founders) {
+        lineage_total += phylogeny.GetLineageSize(founder);
+    }
+    REQUIRE(lineage_total == environment.GetCreatures().size());
+}
@@ -0,0 +1,157 @@
+#include <catch2/catch.hpp>
+
+#include <cerrno>
+#include <creature.h>
+#include <environment.h>
+#include <shared_world.h>
+#include <thread>
+#include <unistd.h>
+
+using naturalselection::Creature;
+using naturalselection::Environment;
+using naturalselection::Food;
+using naturalselection::SharedWorldFrame;
+using naturalselection::SharedWorldPublisher;
+using naturalselection::SharedWorldReader;
+
+static std::string GetSegmentName(const char *test) {
+    return std::string("/naturalselection_") + test + "_" + std::to_string(getpid());
+}
+
+static std::vector<Creature> MakeCreatures(size_t count, float x) {
+    std::vector<Creature> creatures;
+    for (size_t i = 0; i < count; i++) {
+        creatures.push_back(Creature((int) (i % 3), vec2(x, (float) i), vec2(1, -2), 5, 10,
+                                     100, (int) (i % 3)));
+    }
+    return creatures;
+}
+
+TEST_CASE("Shared World Reader Sees What Was Published") {
+    std::string name = GetSegmentName("publish");
+    SharedWorldReader reader;
+    REQUIRE_FALSE(reader.Open(name));
+
+    SharedWorldPublisher publisher;
+    REQUIRE(publisher.Create(name, 4, 2));
+    REQUIRE(reader.Open(name));
+    SharedWorldFrame frame;
+    REQUIRE_FALSE(reader.ReadLatest(frame)); // Nothing published yet
+
+    std::vector<Food> food = {Food(vec2(7, 8), 2, ci::Color("green")), Food(vec2(9, 10), 2, ci::Color("green")),
+                              Food(vec2(11, 12), 2, ci::Color("green"))};
+    publisher.Publish(MakeCreatures(6, 3), food, 17, 2);
+    REQUIRE(reader.ReadLatest(frame));
+    REQUIRE(frame.frame == 1);
+    REQUIRE(frame.tick == 17);
+    REQUIRE(frame.generation == 2);
+
+    // Only as many as fit, with the rest counted.
+    REQUIRE(frame.creatures.size() == 4);
+    REQUIRE(frame.dropped_creatures == 2);
+    REQUIRE(frame.food.size() == 2);
+    REQUIRE(frame.dropped_food == 1);
+    REQUIRE(frame.creatures[1].x == 3);
+    REQUIRE(frame.creatures[1].y == 1);
+    REQUIRE(frame.creatures[1].velocity_y == -2);
+    REQUIRE(frame.creatures[1].creature_type == 1);
+    REQUIRE(frame.food[1].x == 9);
+
+    // Publishing more than the ring holds wraps around to the newest frame.
+    for (int tick = 18; tick < 30; tick++) {
+        publisher.Publish(MakeCreatures(1, (float) tick), food, (uint64_t) tick, 2);
+    }
+    REQUIRE(reader.ReadLatest(frame));
+    REQUIRE(frame.frame == 13);
+    REQUIRE(frame.tick == 29);
+    REQUIRE(frame.creatures.size() == 1);
+    REQUIRE(frame.creatures[0].x == 29);
+}
+
+TEST_CASE("Shared World Reads Are Never Torn") {
+    std::string name = GetSegmentName("torn");
+    SharedWorldPublisher publisher;
+    REQUIRE(publisher.Create(name, 2000, 1, 2)); // Only two slots, so the writer laps readers often
+    SharedWorldReader reader;
+    REQUIRE(reader.Open(name));
+
+    // Every creature in a frame has x equal to the frame's tick, so a frame mixed from two writes shows up.
+    std::vector<std::vector<Creature>> frames = {MakeCreatures(2000, 0), MakeCreatures(2000, 1)};
+    std::thread writer([&publisher, &frames]() {
+        std::vector<Food> food;
+        for (uint64_t tick = 1; tick <= 3000; tick++) {
+            for (Creature &creature : frames[tick % 2]) {
+                creature.SetPosition(vec2((float) tick, creature.GetPosition().y));
+            }
+            publisher.Publish(frames[tick % 2], food, tick, 0);
+        }
+    });
+
+    size_t consistent_reads = 0;
+    SharedWorldFrame frame;
+    while (reader.GetLatestFrame() < 3000) {
+        if (reader.ReadLatest(frame, 1)) {
+            bool consistent = true;
+            for (size_t i = 0; i < frame.creatures.size(); i++) {
+                consistent = consistent && frame.creatures[i].x == (float) frame.tick;
+            }
+            REQUIRE(consistent);
+            consistent_reads++;
+        }
+    }
+    writer.join();
+    REQUIRE(reader.ReadLatest(frame));
+    REQUIRE(frame.tick == 3000);
+    REQUIRE(consistent_reads > 0);
+}
+
+TEST_CASE("Environment Publishes Every Tick To Shared Memory") {
+    std::string name = GetSegmentName("environment");
+    SharedWorldPublisher publisher;
+    REQUIRE(publisher.Create(name));
+
+    Environment environment = Environment();
+    environment.AddSpeedCreatures(5);
+    environment.SetSharedWorld(&publisher);
+    environment.SetIsRunning(true);
+    for (int i = 0; i < 3; i++) {
+        environment.AdvanceOneFrame();
+    }
+
+    SharedWorldReader reader;
+    REQUIRE(reader.Open(name));
+    SharedWorldFrame frame;
+    REQUIRE(reader.ReadLatest(frame));
+    REQUIRE(frame.tick == environment.GetTick());
+    REQUIRE(frame.creatures.size() == environment.GetCreatures().size());
+    REQUIRE(frame.food.size() == environment.GetFood().size());
+
+    // Frames without a new tick don't push the ones before out of the ring.
+    uint64_t frames_published = publisher.GetFramesPublished();
+    environment.SetIsRunning(false);
+    for (int i = 0; i < 3; i++) {
+        environment.AdvanceOneFrame();
+    }
+    REQUIRE(publisher.GetFramesPublished() == frames_published);
+}
+
+TEST_CASE("Shared World Is Never Taken Over From Another Publisher") {
+    std::string name = GetSegmentName("taken");
+    SharedWorldPublisher first;
+    REQUIRE(first.Create(name, 4, 2));
+    first.Publish(MakeCreatures(3, 1), std::vector<Food>(), 5, 0);
+
+    SharedWorldPublisher second;
+    REQUIRE_FALSE(second.Create(name, 4, 2));
+    REQUIRE(errno == EEXIST);
+    REQUIRE_FALSE(second.IsOpen());
+
+    SharedWorldReader reader;
+    REQUIRE(reader.Open(name));
+    SharedWorldFrame frame;
+    REQUIRE(reader.ReadLatest(frame));
+    REQUIRE(frame.tick == 5);
+
+    first.Close();
+    REQUIRE(second.Create(name, 4, 2)); // Free again once its owner is done
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch.hpp>
+
+#include <creature.h>
+#include <fstream>
+#include <png_writer.h>
+#include <software_renderer.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using naturalselection::CreatureRenderState;
+using naturalselection::FoodRenderState;
+using naturalselection::FrameLayout;
+using naturalselection::FrameRecorder;
+using naturalselection::PngWriter;
+using naturalselection::PopulationCount;
+using naturalselection::SoftwareRenderer;
+using naturalselection::TaskScheduler;
+using naturalselection::WorldBounds;
+using naturalselection::WorldSnapshot;
+
+static const WorldBounds ARENA = WorldBounds{100, 100, 700, 500};
+
+static WorldSnapshot MakeScene() {
+    WorldSnapshot snapshot;
+    CreatureRenderState creature;
+    creature.position = vec2(200.5f, 200.5f);
+    creature.radius = 5;
+    creature.vision_radius = 20;
+    creature.creature_type = SPEED;
+    creature.food = 0;
+    snapshot.creatures.push_back(creature);
+
+    FoodRenderState food;
+    food.position = vec2(400.5f, 300.5f);
+    food.radius = 2;
+    snapshot.food.push_back(food);
+
+    PopulationCount generation;
+    generation.speed_count = 10;
+    generation.intelligence_count = 5;
+    snapshot.population_history.push_back(generation);
+    return snapshot;
+}
+
+static uint32_t ReadBigEndian(const std::vector<uint8_t> &bytes, size_t offset) {
+    return ((uint32_t) bytes[offset] << 24) | ((uint32_t) bytes[offset + 1] << 16) |
+           ((uint32_t) bytes[offset + 2] << 8) | bytes[offset + 3];
+}
+
+TEST_CASE("Software Renderer Draws The Arena Like Display") {
+    FrameLayout layout = FrameLayout::AroundArena(ARENA);
+    REQUIRE(layout.width == 1500);
+    REQUIRE(layout.height == 700);
+
+    SoftwareRenderer renderer(layout);
+    renderer.Render(MakeScene());
+    REQUIRE(renderer.GetPixel(200, 200) == 0xFF0000FF); // Creature body
+    REQUIRE(renderer.GetPixel(220, 200) == 0xFF0000FF); // Vision ring
+    REQUIRE(renderer.GetPixel(210, 200) == 0x000000FF); // Inside the ring
+    REQUIRE(renderer.GetPixel(400, 300) == 0x008000FF); // Food
+    REQUIRE(renderer.GetPixel(100, 300) == 0xFFFFFFFF); // Arena border
+    REQUIRE(renderer.GetPixel(50, 50) == 0x000000FF);
+
+    // One generation of 10 speed and 5 intelligence: red at the bottom, blue above it.
+    const WorldBounds &graph = layout.population_graph;
+    REQUIRE(renderer.GetPixel((size_t) (graph.x_coor + 50), (size_t) (graph.y_coor + graph.height - 10)) ==
+            0xFF0000FF);
+    REQUIRE(renderer.GetPixel((size_t) (graph.x_coor + 50), (size_t) (graph.y_coor + 10)) == 0x0000FFFF);
+}
+
+TEST_CASE("Software Renderer Is Independent Of Thread Count") {
+    WorldSnapshot snapshot = MakeScene();
+    for (int i = 0; i < 2000; i++) {
+        CreatureRenderState creature = snapshot.creatures[0];
+        creature.position = vec2(100 + (float) (i * 37 % 700), 100 + (float) (i * 53 % 500));
+        creature.creature_type = i % 3;
+        creature.food = i % 3;
+        snapshot.creatures.push_back(creature);
+    }
+
+    FrameLayout layout = FrameLayout::AroundArena(ARENA);
+    SoftwareRenderer inline_renderer(layout);
+    TaskScheduler scheduler(4);
+    SoftwareRenderer threaded_renderer(layout, &scheduler);
+    inline_renderer.Render(snapshot);
+    threaded_renderer.Render(snapshot);
+    REQUIRE(inline_renderer.GetPixels() == threaded_renderer.GetPixels());
+}
+
+TEST_CASE("Png Writer Produces Valid Chunks") {
+    FrameLayout layout = FrameLayout::AroundArena(ARENA);
+    SoftwareRenderer renderer(layout);
+    renderer.Render(MakeScene());
+
+    std::vector<uint8_t> png;
+    PngWriter::Encode(renderer.GetPixels().data(), renderer.GetWidth(), renderer.GetHeight(), png);
+    REQUIRE(png[0] == 0x89);
+    REQUIRE(png[1] == 'P');
+
+    // Walk the chunks, checking every CRC.
+    size_t offset = 8;
+    std::vector<std::string> types;
+    while (offset < png.size()) {
+        uint32_t length = ReadBigEndian(png, offset);
+        types.push_back(std::string(png.begin() + offset + 4, png.begin() + offset + 8));
+        uint32_t crc = PngWriter::Crc32(&png[offset + 4], length + 4);
+        REQUIRE(crc == ReadBigEndian(png, offset + 8 + length));
+        offset += 12 + length;
+    }
+    REQUIRE(offset == png.size());
+    REQUIRE(types == std::vector<std::string>({"IHDR", "IDAT", "IEND"}));
+    REQUIRE(ReadBigEndian(png, 16) == 1500);
+    REQUIRE(ReadBigEndian(png, 20) == 700);
+
+    // A mostly black frame shrinks to a small fraction of its 4.2 MB.
+    REQUIRE(png.size() < renderer.GetPixels().size() / 20);
+}
+
+TEST_CASE("Frame Recorder Writes Every Nth Tick") {
+    char directory[] = "/tmp/frame_recorder_XXXXXX";
+    REQUIRE(mkdtemp(directory) != nullptr);
+
+    FrameRecorder recorder(directory, 10, FrameLayout::AroundArena(ARENA));
+    WorldSnapshot snapshot = MakeScene();
+    for (uint64_t tick = 0; tick < 25; tick++) {
+        snapshot.tick = tick;
+        REQUIRE(recorder.Capture(snapshot));
+        REQUIRE(recorder.Capture(snapshot)); // The same tick twice is only written once
+    }
+
+    REQUIRE(recorder.GetFramesWritten() == 3);
+    for (size_t frame = 0; frame < 4; frame++) {
+        std::string path = FrameRecorder::GetFramePath(directory, frame);
+        std::ifstream file(path);
+        REQUIRE((bool) file == (frame < 3));
+        unlink(path.c_str());
+    }
+    rmdir(directory);
+}
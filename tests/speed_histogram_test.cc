@@ -11,7 +11,7 @@ using naturalselection::SpeedHistogram;
 using naturalselection::Physics;
 
 TEST_CASE("Calculate Number of Bins Test") {
-  std::vector<Creature> particles = Creature::SpawnCreatures(0, 10, ci::Color("white"), 10, 10, 0, 0);
+  std::vector<Creature> particles = Creature::SpawnCreatures(0, 10, 10, 10, 0, 0);
   SpeedHistogram histogram = SpeedHistogram("White", 0, 0, 0, 0, particles);
 
   REQUIRE(histogram.CalculateNumOfBins() == 4);
@@ -19,17 +19,13 @@ TEST_CASE("Calculate Number of Bins Test") {
 
 TEST_CASE("Calculate Bin Width Test") {
     std::vector<Creature> particles;
-    Creature particle1 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle1 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10, 0, 0);
     particles.push_back(particle1);
-    Creature particle2 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle2 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10, 0, 0);
     particles.push_back(particle2);
-    Creature particle3 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle3 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10, 0, 0);
     particles.push_back(particle3);
-    Creature particle4 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle4 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10, 0, 0);
     particles.push_back(particle4);
 
     SpeedHistogram histogram = SpeedHistogram("White", 0, 0, 0, 0, particles);
@@ -38,17 +34,13 @@ TEST_CASE("Calculate Bin Width Test") {
 
 TEST_CASE("Create Bin Mapping Test") {
     std::vector<Creature> particles;
-    Creature particle1 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle1 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10, 0, 0);
     particles.push_back(particle1);
-    Creature particle2 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle2 = Creature(SPEED, vec2(6, 50), vec2(2, 0), 5, 10, 0, 0);
     particles.push_back(particle2);
-    Creature particle3 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle3 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10, 0, 0);
     particles.push_back(particle3);
-    Creature particle4 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10,
-                                  ci::Color("blue"), 0, 0);
+    Creature particle4 = Creature(SPEED, vec2(6, 50), vec2(-1, 0), 5, 10, 0, 0);
     particles.push_back(particle4);
 
     SpeedHistogram histogram = SpeedHistogram("White", 0, 0, 0, 0, particles);
@@ -60,7 +52,7 @@ TEST_CASE("Create Bin Mapping Test") {
 }
 
 TEST_CASE("Large Population (1000) Bin Mapping Test") {
-    std::vector<Creature> particles = Creature::SpawnCreatures(0, 1000, ci::Color("white"), 10, 10, 0, 0);
+    std::vector<Creature> particles = Creature::SpawnCreatures(0, 1000, 10, 10, 0, 0);
     SpeedHistogram histogram = SpeedHistogram("White", 0, 0, 0, 0, particles);
 
     std::map<int, int> bins = histogram.CreateBinMapping();
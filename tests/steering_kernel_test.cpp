@@ -0,0 +1,152 @@
+#include <catch2/catch.hpp>
+
+#include <environment.h>
+#include <creature.h>
+#include <steering_kernel.h>
+
+using naturalselection::Environment;
+using naturalselection::Creature;
+using naturalselection::SteeringBatch;
+using naturalselection::SteeringKernel;
+using naturalselection::WorldBounds;
+
+// Random creatures in and slightly beyond the arena, plus a few that sit exactly on ties.
+static std::vector<Creature> MakeSteeringCreatures() {
+    std::vector<Creature> creatures;
+    for (size_t i = 0; i < 500; i++) {
+        float x = (float) (rand() % 740 + 80) + 0.5f * (float) (rand() % 2);
+        float y = (float) (rand() % 540 + 80);
+        float x_vel = (float) (rand() % 5) - 2.0f;
+        float y_vel = (float) (rand() % 5) - 2.0f;
+        Creature creature = Creature(SPEED, vec2(x, y), vec2(x_vel, y_vel), 5, 10,
+                                     (double) (rand() % 40) - 5.0, rand() % 3,
+                                     2.0f + (float) (rand() % 10) / 10.0f, 0.25);
+        creatures.push_back(creature);
+    }
+
+    creatures.push_back(Creature(SPEED, vec2(450, 350), vec2(1, 1), 5, 10, 10.0, 0));
+    creatures.push_back(Creature(SPEED, vec2(100, 100), vec2(-1, -1), 5, 10, 10.0, 0));
+    creatures.push_back(Creature(SPEED, vec2(800, 600), vec2(1, 1), 5, 10, 0.0, 2));
+    return creatures;
+}
+
+static bool VelocitiesMatch(const std::vector<Creature> &creatures, const SteeringBatch &batch) {
+    for (size_t i = 0; i < creatures.size(); i++) {
+        if (creatures[i].GetVelocity().x != batch.x_velocity[i] ||
+            creatures[i].GetVelocity().y != batch.y_velocity[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TEST_CASE("Kernel Furthest Corner Matches Scalar") {
+    std::vector<Creature> creatures = MakeSteeringCreatures();
+    SteeringBatch batch;
+    batch.Gather(creatures);
+    std::vector<uint8_t> mask(creatures.size(), 1);
+
+    SteeringKernel::TowardsFurthestCorner(batch, mask);
+    for (size_t i = 0; i < creatures.size(); i++) {
+        creatures[i].ChangeVelocityTowardsFurthestCorner();
+    }
+
+    REQUIRE(VelocitiesMatch(creatures, batch));
+}
+
+TEST_CASE("Kernel Nearest Wall And Energy Checks Match Scalar") {
+    std::vector<Creature> creatures = MakeSteeringCreatures();
+    std::vector<Creature> energy_creatures = creatures;
+    std::vector<Creature> food_creatures = creatures;
+    std::vector<uint8_t> mask(creatures.size(), 1);
+
+    SteeringBatch wall_batch;
+    wall_batch.Gather(creatures);
+    SteeringKernel::TowardsNearestWall(wall_batch, mask);
+    for (size_t i = 0; i < creatures.size(); i++) {
+        creatures[i].ChangeVelocityTowardsNearestWall();
+    }
+    REQUIRE(VelocitiesMatch(creatures, wall_batch));
+
+    SteeringBatch energy_batch;
+    energy_batch.Gather(energy_creatures);
+    SteeringKernel::IfNotEnoughEnergy(energy_batch, mask);
+    for (size_t i = 0; i < energy_creatures.size(); i++) {
+        energy_creatures[i].ChangeVelocityIfNotEnoughEnergy();
+    }
+    REQUIRE(VelocitiesMatch(energy_creatures, energy_batch));
+
+    SteeringBatch food_batch;
+    food_batch.Gather(food_creatures);
+    SteeringKernel::IfEnoughFood(food_batch);
+    for (size_t i = 0; i < food_creatures.size(); i++) {
+        food_creatures[i].ChangeVelocityIfEnoughFood();
+    }
+    REQUIRE(VelocitiesMatch(food_creatures, food_batch));
+}
+
+TEST_CASE("Kernel Wall Hits Match Environment") {
+    std::vector<Creature> creatures = MakeSteeringCreatures();
+    std::vector<Creature> empty_creatures = creatures;
+    WorldBounds bounds = WorldBounds{100, 100, 700, 500};
+
+    Environment environment = Environment(); // Has food.
+    SteeringBatch batch;
+    batch.Gather(creatures);
+    SteeringKernel::ResolveWallHits(batch, bounds, std::vector<uint8_t>(creatures.size(), 0));
+    for (size_t i = 0; i < creatures.size(); i++) {
+        environment.DetectSpeedCreatureWallHits(creatures[i]);
+    }
+    REQUIRE(VelocitiesMatch(creatures, batch));
+
+    Environment empty_environment = Environment(std::vector<Creature>()); // No food.
+    SteeringBatch empty_batch;
+    empty_batch.Gather(empty_creatures);
+    SteeringKernel::ResolveWallHits(empty_batch, bounds, std::vector<uint8_t>(empty_creatures.size(), 1));
+    for (size_t i = 0; i < empty_creatures.size(); i++) {
+        empty_environment.DetectSpeedCreatureWallHits(empty_creatures[i]);
+    }
+    REQUIRE(VelocitiesMatch(empty_creatures, empty_batch));
+}
+
+TEST_CASE("Kernel Moves Stop At Walls And Match Creatures") {
+    std::vector<Creature> creatures = MakeSteeringCreatures();
+    creatures.push_back(Creature(SPEED, vec2(105, 300), vec2(-40, 3), 5, 10, 10.0, 0));
+    creatures.push_back(Creature(SPEED, vec2(90, 300), vec2(-1, 0), 5, 10, 10.0, 0)); // Already out
+    WorldBounds bounds = WorldBounds{100, 100, 700, 500};
+
+    // Far enough per tick that plenty of creatures would end up well outside.
+    Environment environment = Environment();
+    environment.SetTimeStep(8.0f);
+    SteeringBatch batch;
+    batch.Gather(creatures);
+    SteeringKernel::Move(batch, bounds, 8.0f);
+    for (size_t i = 0; i < creatures.size(); i++) {
+        vec2 start = creatures[i].GetPosition();
+        creatures[i].Move(8.0f);
+        REQUIRE(creatures[i].GetPreviousPosition() == start);
+        REQUIRE(batch.previous_x[i] == start.x);
+        REQUIRE(batch.previous_y[i] == start.y);
+    }
+    for (size_t i = 0; i < creatures.size(); i++) {
+        vec2 start = creatures[i].GetPreviousPosition();
+        float x = std::min(std::max(creatures[i].GetPosition().x, std::min(start.x, 100.0f)), std::max(start.x, 800.0f));
+        float y = std::min(std::max(creatures[i].GetPosition().y, std::min(start.y, 100.0f)), std::max(start.y, 600.0f));
+        REQUIRE(batch.x[i] == x);
+        REQUIRE(batch.y[i] == y);
+        REQUIRE(batch.energy[i] == creatures[i].GetEnergy());
+    }
+
+    size_t last = creatures.size() - 1;
+    REQUIRE(batch.x[last - 1] == 100); // Stopped at the wall instead of 215 past it
+    REQUIRE(batch.y[last - 1] == 324);
+    REQUIRE(batch.x[last] == 90); // No further out than it already was
+}
+
+TEST_CASE("Swept Distance Measures To The Nearest Point Of The Move") {
+    REQUIRE(SteeringKernel::SweptDistance(0, 0, 10, 0, 5, 3) == 3);
+    REQUIRE(SteeringKernel::SweptDistance(0, 0, 10, 0, -4, 3) == 5); // Before the start
+    REQUIRE(SteeringKernel::SweptDistance(0, 0, 10, 0, 13, 4) == 5); // Past the end
+    REQUIRE(SteeringKernel::SweptDistance(2, 2, 2, 2, 5, 6) == 5); // Didn't move
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+
+#include <set>
+#include <creature.h>
+#include <physics.h>
+#include <sweep_and_prune.h>
+
+using naturalselection::Creature;
+using naturalselection::Physics;
+using naturalselection::SteeringBatch;
+using naturalselection::SweepAndPrune;
+using naturalselection::CollisionPair;
+
+static std::vector<Creature> MakeCrowd(size_t count) {
+    std::vector<Creature> creatures;
+    for (size_t i = 0; i < count; i++) {
+        vec2 position = vec2((float) (rand() % 7000) / 10.0f + 100, (float) (rand() % 5000) / 10.0f + 100);
+        vec2 velocity = vec2((float) (rand() % 5) - 2.0f, (float) (rand() % 5) - 2.0f);
+        creatures.push_back(Creature(SPEED, position, velocity, 5, 10, 10.0, 0));
+    }
+
+    return creatures;
+}
+
+static std::set<std::pair<uint32_t, uint32_t>> BruteForcePairs(const SteeringBatch &batch) {
+    std::set<std::pair<uint32_t, uint32_t>> pairs;
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+        for (uint32_t j = i + 1; j < batch.Size(); j++) {
+            bool overlaps_x = batch.x[j] - batch.radius[j] <= batch.x[i] + batch.radius[i] &&
+                              batch.x[i] - batch.radius[i] <= batch.x[j] + batch.radius[j];
+            if (overlaps_x && std::abs(batch.y[i] - batch.y[j]) <= batch.radius[i] + batch.radius[j]) {
+                pairs.insert(std::make_pair(i, j));
+            }
+        }
+    }
+
+    return pairs;
+}
+
+static std::set<std::pair<uint32_t, uint32_t>> ToSet(const std::vector<CollisionPair> &pairs) {
+    std::set<std::pair<uint32_t, uint32_t>> pair_set;
+    for (size_t i = 0; i < pairs.size(); i++) {
+        pair_set.insert(std::make_pair(pairs[i].first, pairs[i].second));
+    }
+
+    return pair_set;
+}
+
+TEST_CASE("Sweep And Prune Finds Same Pairs As Brute Force") {
+    std::vector<Creature> creatures = MakeCrowd(2000);
+    SteeringBatch batch;
+    batch.Gather(creatures);
+
+    SweepAndPrune broad_phase;
+    std::vector<CollisionPair> pairs;
+
+    // Several ticks so the coherent insertion sort path gets exercised too.
+    for (size_t tick = 0; tick < 20; tick++) {
+        broad_phase.FindCandidatePairs(batch, pairs);
+        REQUIRE(pairs.size() == ToSet(pairs).size());
+        REQUIRE(ToSet(pairs) == BruteForcePairs(batch));
+
+        for (size_t i = 0; i < batch.Size(); i++) {
+            batch.x[i] += batch.x_velocity[i];
+            batch.y[i] += batch.y_velocity[i];
+        }
+    }
+}
+
+TEST_CASE("Sweep And Prune Finds Pairs Across Bands With Mixed Radii") {
+    // A few big creatures set the band height, and the rest are spread over a tall arena, so
+    // most pairs straddle two bands.
+    srand(4);
+    std::vector<Creature> creatures = MakeCrowd(1500);
+    for (size_t i = 0; i < creatures.size(); i++) {
+        vec2 position = creatures[i].GetPosition();
+        creatures[i].SetPosition(vec2(position.x, position.y * 4));
+        creatures[i].SetRadius(i % 100 == 0 ? 20.0f : (float) (1 + rand() % 8));
+    }
+    SteeringBatch batch;
+    batch.Gather(creatures);
+
+    SweepAndPrune broad_phase;
+    std::vector<CollisionPair> pairs;
+    broad_phase.FindCandidatePairs(batch, pairs);
+    REQUIRE(pairs.size() == ToSet(pairs).size());
+    REQUIRE(ToSet(pairs) == BruteForcePairs(batch));
+}
+
+TEST_CASE("Narrow Phase Matches Physics Bounce") {
+    std::vector<Creature> creatures;
+    creatures.push_back(Creature(SPEED, vec2(200, 200), vec2(1, 0), 5, 10, 10.0, 0));
+    creatures.push_back(Creature(SPEED, vec2(208, 201), vec2(-1, 0), 5, 20, 10.0, 0));
+    creatures.push_back(Creature(SPEED, vec2(400, 400), vec2(1, 0), 5, 10, 10.0, 0));
+
+    SteeringBatch batch;
+    batch.Gather(creatures);
+    SweepAndPrune broad_phase;
+    std::vector<CollisionPair> pairs;
+    broad_phase.FindCandidatePairs(batch, pairs);
+
+    REQUIRE(SweepAndPrune::ResolveCollisions(batch, pairs) == 1);
+
+    std::vector<vec2> expected = Physics::CalculateParticleBounceVelocity(creatures[0], creatures[1]);
+    REQUIRE(batch.x_velocity[0] == expected[0].x);
+    REQUIRE(batch.y_velocity[0] == expected[0].y);
+    REQUIRE(batch.x_velocity[1] == expected[1].x);
+    REQUIRE(batch.y_velocity[1] == expected[1].y);
+    REQUIRE(batch.x_velocity[2] == 1.0f); // Untouched.
+
+    // Now separating, so a second pass must not bounce them back together.
+    broad_phase.FindCandidatePairs(batch, pairs);
+    REQUIRE(SweepAndPrune::ResolveCollisions(batch, pairs) == 0);
+}
@@ -0,0 +1,161 @@
+#include <catch2/catch.hpp>
+
+#include <headless_runner.h>
+#include <parallel_for.h>
+#include <sstream>
+#include <sweep_coordinator.h>
+#include <unistd.h>
+
+using naturalselection::HeadlessRunner;
+using naturalselection::SweepCoordinator;
+using naturalselection::SweepJob;
+using naturalselection::SweepOptions;
+using naturalselection::SweepResult;
+
+static size_t CountLines(const std::string &text) {
+    size_t lines = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        lines += text[i] == '\n' ? 1 : 0;
+    }
+    return lines;
+}
+
+TEST_CASE("Sweep Job Round Trips Through A Line") {
+    SweepJob job;
+    job.id = 12;
+    job.attempt = 1;
+    job.seed = 99;
+    job.food_count = 40;
+    job.intelligence_creatures = true;
+    job.collisions_enabled = true;
+    job.generations = 5;
+    job.max_ticks = 1000;
+    job.carrying_capacity = 500;
+    job.capacity_policy = naturalselection::CAPACITY_FITNESS;
+    job.food_mode = naturalselection::FOOD_MODE_FIELD;
+    job.metrics_port = 9100;
+    job.time_step = 2.5f;
+    job.food_regrowth_rate = 0.3f;
+    job.fast_forward_calibration = 3;
+    job.fast_forward_skipped = 5;
+
+    SweepJob parsed;
+    REQUIRE(SweepJob::Parse(job.Serialize(), parsed));
+    REQUIRE(parsed.Serialize() == job.Serialize());
+    REQUIRE(parsed.capacity_policy == naturalselection::CAPACITY_FITNESS);
+    REQUIRE(parsed.food_mode == naturalselection::FOOD_MODE_FIELD);
+    REQUIRE(parsed.metrics_port == 9100);
+    REQUIRE(parsed.time_step == 2.5f);
+    REQUIRE(parsed.food_regrowth_rate == 0.3f);
+    REQUIRE(parsed.fast_forward_calibration == 3);
+    REQUIRE(parsed.fast_forward_skipped == 5);
+    REQUIRE_FALSE(SweepJob::Parse("result 1 2 3", parsed));
+
+    job.time_step = 0;
+    REQUIRE_FALSE(SweepJob::Parse(job.Serialize(), parsed));
+    job.time_step = -1;
+    REQUIRE_FALSE(SweepJob::Parse(job.Serialize(), parsed));
+}
+
+TEST_CASE("Headless Runs Are Reproducible From Their Seed") {
+    SweepJob job;
+    job.seed = 5;
+    job.food_count = 30;
+    job.speed_creatures = true;
+    job.generations = 2;
+    job.max_ticks = 100000;
+
+    SweepResult first = HeadlessRunner::Run(job);
+    SweepResult second = HeadlessRunner::Run(job);
+    REQUIRE(first.Serialize() == second.Serialize());
+    REQUIRE(first.generations_run == 2);
+    REQUIRE(first.peak_subsystem_bytes[naturalselection::MEMORY_POPULATION_RECORDS] > 0);
+    // The population graph shares the records instead of keeping a copy of its own.
+    REQUIRE(first.peak_subsystem_bytes[naturalselection::MEMORY_POPULATION_GRAPHS] <
+            first.peak_subsystem_bytes[naturalselection::MEMORY_POPULATION_RECORDS]);
+    REQUIRE(first.peak_memory_bytes >= first.peak_subsystem_bytes[naturalselection::MEMORY_CREATURES]);
+    REQUIRE_FALSE(first.hit_tick_limit);
+}
+
+TEST_CASE("Coordinator Retries Crashed Jobs") {
+    std::vector<SweepJob> jobs(8);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        jobs[i].id = i;
+    }
+
+    // Job 3 crashes its worker once, job 5 every time.
+    SweepCoordinator::JobRunner runner = [](const SweepJob &job) {
+        if ((job.id == 3 && job.attempt == 0) || job.id == 5) {
+            _exit(1);
+        }
+        SweepResult result;
+        result.job_id = job.id;
+        result.speed_count = (int) job.id * 2;
+        return result;
+    };
+
+    SweepOptions options;
+    options.worker_count = 3;
+    options.max_attempts = 2;
+    SweepCoordinator coordinator(jobs, options, runner);
+    std::ostringstream output;
+    REQUIRE_FALSE(coordinator.Run(output));
+
+    REQUIRE(coordinator.GetFailedJobs() == std::vector<size_t>{5});
+    REQUIRE(coordinator.GetRetryCount() == 2); // Job 3 once, job 5 once before giving up
+    REQUIRE(CountLines(output.str()) == 1 + 7); // Header and every job but 5
+    REQUIRE(output.str().find("\n3,0,0,0,6,") != std::string::npos);
+}
+
+TEST_CASE("Coordinator Keeps Each Worker To Its Thread Budget") {
+    std::vector<SweepJob> jobs(4);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        jobs[i].id = i;
+    }
+
+    SweepCoordinator::JobRunner runner = [](const SweepJob &job) {
+        SweepResult result;
+        result.job_id = job.id;
+        result.speed_count = (int) naturalselection::DefaultThreadCount();
+        return result;
+    };
+
+    SweepOptions options;
+    options.worker_count = 2;
+    options.threads_per_worker = 1;
+    SweepCoordinator coordinator(jobs, options, runner);
+    std::ostringstream output;
+    REQUIRE(coordinator.Run(output));
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        REQUIRE(output.str().find("\n" + std::to_string(i) + ",0,0,0,1,") != std::string::npos);
+    }
+    REQUIRE(naturalselection::ThreadBudget() == 0); // The coordinator itself is not capped
+}
+
+TEST_CASE("Coordinator Gives Each Worker Its Own Metrics Port") {
+    std::vector<SweepJob> jobs(6);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        jobs[i].id = i;
+    }
+
+    SweepCoordinator::JobRunner runner = [](const SweepJob &job) {
+        SweepResult result;
+        result.job_id = job.id;
+        result.speed_count = job.metrics_port;
+        return result;
+    };
+
+    SweepOptions options;
+    options.worker_count = 2;
+    options.metrics_port = 9200;
+    SweepCoordinator coordinator(jobs, options, runner);
+    std::ostringstream output;
+    REQUIRE(coordinator.Run(output));
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        std::string row_start = "\n" + std::to_string(i) + ",0,0,0,";
+        REQUIRE((output.str().find(row_start + "9200,") != std::string::npos ||
+                 output.str().find(row_start + "9201,") != std::string::npos));
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <creature.h>
+#include <vector>
+
+/**
+ * count creatures of each type in turn, with ids from 1. Every seventh has not eaten,
+ * and the rest have eaten 0, 1 or 2 food depending on their type, so a turnover has
+ * deaths, survivors and births to deal with.
+ */
+inline std::vector<naturalselection::Creature> MakeFedPopulation(size_t count) {
+    std::vector<naturalselection::Creature> creatures;
+    for (size_t i = 0; i < count; i++) {
+        int type = (int) (i % 3); // SPEED, INTELLIGENCE, BOTH
+        naturalselection::Creature creature = naturalselection::Creature(
+            type, vec2(0, 0), vec2(0, 0), 5, 10, 0.0, (int) (i % 7 == 0 ? 0 : i % 3), 12.0, 0.25,
+            2.5f + (float) (i % 5) / 10.0f);
+        creature.SetId((uint32_t) i + 1);
+        creatures.push_back(creature);
+    }
+
+    return creatures;
+}
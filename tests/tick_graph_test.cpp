@@ -0,0 +1,370 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <creature.h>
+#include <food.h>
+#include <morton_order.h>
+#include <task_scheduler.h>
+#include <thread>
+#include <tick_graph.h>
+
+using naturalselection::Creature;
+using naturalselection::Food;
+using naturalselection::MortonSorter;
+using naturalselection::SteeringBatch;
+using naturalselection::SteeringKernel;
+using naturalselection::TaskGraph;
+using naturalselection::TaskScheduler;
+using naturalselection::TickGraph;
+using naturalselection::WorldBounds;
+
+static const WorldBounds BOUNDS = WorldBounds{100, 100, 700, 500};
+
+// Creatures and food packed into a small square, so most creatures touch several food at once.
+static std::vector<Creature> MakeHungryCrowd(size_t count) {
+    std::vector<Creature> creatures;
+    for (size_t i = 0; i < count; i++) {
+        vec2 position = vec2((float) (rand() % 800) / 10.0f + 300, (float) (rand() % 800) / 10.0f + 300);
+        vec2 velocity = vec2((float) (rand() % 5) - 2.0f, (float) (rand() % 5) - 2.0f);
+        Creature creature = Creature((int) (i % 3), position, velocity, 5, 10,
+                                     10.0, (int) (i % 4 == 0 ? 1 : 0), 5.0 + (double) (i % 40), 0.25, 2.5f);
+        creature.SetNeedsMovement(i % 5 == 0);
+        creatures.push_back(creature);
+    }
+
+    return creatures;
+}
+
+// Food comes in pairs on the same spot, which is where the old erase-while-iterating loop skipped some.
+static std::vector<Food> MakeFoodPile(size_t count) {
+    std::vector<Food> food;
+    for (size_t i = 0; i < count; i++) {
+        vec2 position = vec2((float) (rand() % 1000) / 10.0f + 290, (float) (rand() % 1000) / 10.0f + 290);
+        food.push_back(Food(position, 2.0f, ci::Color("green")));
+        food.push_back(Food(position, 2.0f, ci::Color("green")));
+    }
+
+    return food;
+}
+
+// The tick as AdvanceOneFrame ran it before the task graph, one creature at a time.
+static void RunSequentialTick(std::vector<Creature> &creatures, std::vector<Food> &food, float time_step = 1.0f) {
+    SteeringBatch batch;
+    batch.Gather(creatures);
+    SteeringKernel::TowardsFurthestCorner(batch, batch.needs_movement);
+    std::fill(batch.needs_movement.begin(), batch.needs_movement.end(), 0);
+    batch.Scatter(creatures);
+
+    std::vector<uint8_t> empty_before(creatures.size(), 0);
+    std::vector<uint8_t> left_before(creatures.size(), 0);
+    std::vector<uint8_t> empty_after(creatures.size(), 0);
+    for (size_t i = 0; i < creatures.size(); i++) {
+        Creature &curr_creature = creatures.at(i);
+        empty_before[i] = food.empty() ? 1 : 0;
+        left_before[i] = food.empty() ? 0 : 1;
+        if (!food.empty()) {
+            for (size_t j = 0; j < food.size(); j++) {
+                if (curr_creature.IsTouchingSpecificFood(food.at(j)) && curr_creature.GetFood() < 2) {
+                    curr_creature.AddFood();
+                    food.erase(food.begin() + j);
+                    curr_creature.SetNeedsMovement(true);
+                }
+            }
+            if (!food.empty() && curr_creature.ChangeVelocityTowardsNearestFood(food)) {
+                curr_creature.SetNeedsMovement(true);
+            }
+        }
+        empty_after[i] = food.empty() ? 1 : 0;
+    }
+
+    batch.Gather(creatures);
+    SteeringKernel::IfNotEnoughEnergy(batch, left_before);
+    SteeringKernel::TowardsNearestWall(batch, empty_before);
+    for (size_t i = 0; i < creatures.size(); i++) {
+        if (empty_before[i] || batch.food[i] == 2) {
+            batch.needs_movement[i] = 0;
+        }
+    }
+    SteeringKernel::IfEnoughFood(batch);
+    SteeringKernel::ResolveWallHits(batch, BOUNDS, empty_after);
+    SteeringKernel::Move(batch, BOUNDS, time_step);
+    batch.Scatter(creatures);
+}
+
+static void RunGraphTick(std::vector<Creature> &creatures, std::vector<Food> &food, TaskScheduler *scheduler,
+                         TickGraph &tick_graph, float time_step = 1.0f) {
+    SteeringBatch batch;
+    batch.Gather(creatures);
+    tick_graph.Prepare(&batch, &food, nullptr, BOUNDS, nullptr, 64, time_step);
+    TaskGraph tasks;
+    tick_graph.BuildGraph(tasks);
+    if (scheduler != nullptr) {
+        scheduler->Run(tasks);
+    } else {
+        tasks.RunInline();
+    }
+
+    std::vector<Food> remaining;
+    tick_graph.CollectRemainingFood(remaining);
+    food.swap(remaining);
+    batch.Scatter(creatures);
+}
+
+static void RunGraphTick(std::vector<Creature> &creatures, std::vector<Food> &food, TaskScheduler *scheduler) {
+    TickGraph tick_graph;
+    RunGraphTick(creatures, food, scheduler, tick_graph);
+}
+
+static bool SameCreatures(const std::vector<Creature> &first, const std::vector<Creature> &second) {
+    for (size_t i = 0; i < first.size(); i++) {
+        if (first[i].GetPosition() != second[i].GetPosition() || first[i].GetVelocity() != second[i].GetVelocity() ||
+            first[i].GetFood() != second[i].GetFood() || first[i].GetEnergy() != second[i].GetEnergy() ||
+            first[i].GetNeedsMovement() != second[i].GetNeedsMovement()) {
+            return false;
+        }
+    }
+
+    return first.size() == second.size();
+}
+
+TEST_CASE("Tick Graph Matches Sequential Tick") {
+    std::vector<Creature> creatures = MakeHungryCrowd(500);
+    std::vector<Food> food = MakeFoodPile(150);
+    std::vector<Creature> expected_creatures = creatures;
+    std::vector<Food> expected_food = food;
+
+    for (size_t tick = 0; tick < 30; tick++) {
+        RunSequentialTick(expected_creatures, expected_food);
+        RunGraphTick(creatures, food, nullptr);
+        REQUIRE(SameCreatures(creatures, expected_creatures));
+        REQUIRE(food.size() == expected_food.size());
+    }
+    REQUIRE(food.size() < 300);
+}
+
+TEST_CASE("Tick Graph Matches Sequential Tick With Large Time Steps") {
+    // Creatures cover several times their own size each tick, so most food is only touched along the way.
+    std::vector<Creature> creatures = MakeHungryCrowd(500);
+    std::vector<Food> food = MakeFoodPile(150);
+    std::vector<Creature> expected_creatures = creatures;
+    std::vector<Food> expected_food = food;
+
+    TickGraph tick_graph;
+    for (size_t tick = 0; tick < 30; tick++) {
+        RunSequentialTick(expected_creatures, expected_food, 6.0f);
+        RunGraphTick(creatures, food, nullptr, tick_graph, 6.0f);
+        REQUIRE(SameCreatures(creatures, expected_creatures));
+        REQUIRE(food.size() == expected_food.size());
+    }
+    for (size_t i = 0; i < creatures.size(); i++) {
+        REQUIRE(creatures[i].GetPosition().x >= BOUNDS.x_coor);
+        REQUIRE(creatures[i].GetPosition().x <= BOUNDS.x_coor + BOUNDS.width);
+    }
+}
+
+TEST_CASE("Tick Graph Is Independent Of Thread Count") {
+    std::vector<Creature> creatures = MakeHungryCrowd(5000);
+    std::vector<Food> food = MakeFoodPile(200);
+    std::vector<Creature> threaded_creatures = creatures;
+    std::vector<Food> threaded_food = food;
+
+    TaskScheduler scheduler(4);
+    for (size_t tick = 0; tick < 10; tick++) {
+        RunGraphTick(creatures, food, nullptr);
+        RunGraphTick(threaded_creatures, threaded_food, &scheduler);
+        REQUIRE(SameCreatures(creatures, threaded_creatures));
+        REQUIRE(food.size() == threaded_food.size());
+    }
+}
+
+TEST_CASE("Sliced Ticks Match Whole Ticks") {
+    std::vector<Creature> creatures = MakeHungryCrowd(2000);
+    std::vector<Food> food = MakeFoodPile(200);
+    std::vector<Creature> sliced_creatures = creatures;
+    std::vector<Food> sliced_food = food;
+
+    TaskScheduler scheduler(3);
+    TickGraph tick_graph;
+    for (size_t tick = 0; tick < 10; tick++) {
+        RunGraphTick(creatures, food, nullptr);
+
+        SteeringBatch batch;
+        batch.Gather(sliced_creatures);
+        tick_graph.Prepare(&batch, &sliced_food, nullptr, BOUNDS, nullptr, 64);
+        // A deadline already past still lets each call through one round, so the tick gets done.
+        size_t calls = 1;
+        TaskScheduler *slice_scheduler = tick % 2 == 0 ? &scheduler : nullptr;
+        while (!tick_graph.RunSliced(slice_scheduler, std::chrono::steady_clock::time_point::min())) {
+            calls++;
+        }
+        REQUIRE(calls > 10);
+        std::vector<Food> remaining;
+        tick_graph.CollectRemainingFood(remaining);
+        sliced_food.swap(remaining);
+        batch.Scatter(sliced_creatures);
+
+        REQUIRE(SameCreatures(creatures, sliced_creatures));
+        REQUIRE(food.size() == sliced_food.size());
+    }
+}
+
+TEST_CASE("Remembered Food Targets Match Searching Every Tick") {
+    std::vector<Creature> creatures = MakeHungryCrowd(500);
+    std::vector<Food> food = MakeFoodPile(150);
+    std::vector<Creature> expected_creatures = creatures;
+    std::vector<Food> expected_food = food;
+
+    TickGraph tick_graph;
+    size_t sense_count = 0;
+    for (size_t tick = 0; tick < 30; tick++) {
+        RunSequentialTick(expected_creatures, expected_food);
+        RunGraphTick(creatures, food, nullptr, tick_graph);
+        REQUIRE(SameCreatures(creatures, expected_creatures));
+        REQUIRE(food.size() == expected_food.size());
+        if (tick > 0) {
+            sense_count += tick_graph.GetSenseCount();
+        }
+    }
+    REQUIRE(sense_count < 29 * creatures.size());
+}
+
+TEST_CASE("Remembered Food Targets Survive Spatial Re-sorting") {
+    std::vector<Creature> creatures = MakeHungryCrowd(500);
+    std::vector<Food> food = MakeFoodPile(150);
+    std::vector<Creature> expected_creatures = creatures;
+    std::vector<Food> expected_food = food;
+
+    TickGraph tick_graph;
+    MortonSorter sorter;
+    size_t sense_count = 0;
+    for (size_t tick = 0; tick < 30; tick++) {
+        if (tick % 5 == 4) {
+            // Both copies are in the same state, so they sort into the same order.
+            if (sorter.Sort(creatures, BOUNDS)) {
+                tick_graph.Reorder(&sorter.GetOrder(), nullptr);
+            }
+            sorter.Sort(expected_creatures, BOUNDS);
+            if (sorter.Sort(food, BOUNDS)) {
+                tick_graph.Reorder(nullptr, &sorter.GetOrder());
+            }
+            sorter.Sort(expected_food, BOUNDS);
+        }
+
+        RunSequentialTick(expected_creatures, expected_food);
+        RunGraphTick(creatures, food, nullptr, tick_graph);
+        REQUIRE(SameCreatures(creatures, expected_creatures));
+        REQUIRE(food.size() == expected_food.size());
+        if (tick > 0) {
+            sense_count += tick_graph.GetSenseCount();
+        }
+    }
+    REQUIRE(sense_count < 29 * creatures.size());
+}
+
+TEST_CASE("Remembered Food Targets Survive Food Coming And Going") {
+    std::vector<Creature> creatures = MakeHungryCrowd(500);
+    std::vector<Food> food = MakeFoodPile(150);
+    std::vector<Creature> expected_creatures = creatures;
+    std::vector<Food> expected_food = food;
+
+    TickGraph tick_graph;
+    size_t sense_count = 0;
+    for (size_t tick = 0; tick < 30; tick++) {
+        if (tick % 3 == 1) { // Grows a few between ticks, some of it right under the crowd
+            std::vector<Food> added = MakeFoodPile(3);
+            size_t first_added = food.size();
+            food.insert(food.end(), added.begin(), added.end());
+            expected_food.insert(expected_food.end(), added.begin(), added.end());
+            tick_graph.AddFood(food, first_added);
+        } else if (tick % 6 == 5 && food.size() > 4) { // Eaten from anywhere, as RemoveFood does
+            std::vector<uint32_t> food_order(food.size());
+            for (size_t i = 0; i < food_order.size(); i++) {
+                food_order[i] = (uint32_t) i;
+            }
+            for (size_t i = 0; i < 4; i++) {
+                size_t index = (size_t) rand() % food.size();
+                food[index] = food.back();
+                food.pop_back();
+                expected_food[index] = expected_food.back();
+                expected_food.pop_back();
+                food_order[index] = food_order.back();
+                food_order.pop_back();
+            }
+            tick_graph.RemoveFood(food_order);
+        } else if (tick % 3 == 2 && food.size() > 4) {
+            food.resize(food.size() - 4, food.front());
+            expected_food.resize(expected_food.size() - 4, expected_food.front());
+            tick_graph.TruncateFood(food.size());
+        }
+
+        RunSequentialTick(expected_creatures, expected_food);
+        RunGraphTick(creatures, food, nullptr, tick_graph);
+        REQUIRE(SameCreatures(creatures, expected_creatures));
+        REQUIRE(food.size() == expected_food.size());
+        if (tick > 0) {
+            sense_count += tick_graph.GetSenseCount();
+        }
+    }
+    REQUIRE(sense_count < 29 * creatures.size());
+}
+
+TEST_CASE("Task Scheduler Respects Dependencies") {
+    TaskScheduler scheduler(4);
+    std::atomic<int> first_done(0);
+    std::atomic<int> second_done(0);
+    std::atomic<int> early_starts(0);
+
+    TaskGraph graph;
+    std::vector<TaskGraph::TaskId> first;
+    for (size_t i = 0; i < 64; i++) {
+        first.push_back(graph.AddTask([&]() { first_done++; }));
+    }
+    TaskGraph::TaskId join = graph.AddTask([&]() {
+        if (first_done.load() != 64) {
+            early_starts++;
+        }
+    });
+    for (size_t i = 0; i < first.size(); i++) {
+        graph.AddDependency(first[i], join);
+    }
+    for (size_t i = 0; i < 64; i++) {
+        TaskGraph::TaskId after = graph.AddTask([&]() { second_done++; });
+        graph.AddDependency(join, after);
+    }
+
+    for (size_t run = 0; run < 20; run++) {
+        first_done = 0;
+        second_done = 0;
+        scheduler.Run(graph);
+        REQUIRE(first_done.load() == 64);
+        REQUIRE(second_done.load() == 64);
+    }
+    REQUIRE(early_starts.load() == 0);
+}
+
+TEST_CASE("Task Scheduler Takes Callers In Turn") {
+    TaskScheduler scheduler(4);
+    std::atomic<int> done(0);
+
+    // Two threads share the scheduler, and every task also runs a small graph of its own on it.
+    std::vector<std::thread> callers;
+    for (size_t caller = 0; caller < 2; caller++) {
+        callers.emplace_back([&]() {
+            for (size_t run = 0; run < 20; run++) {
+                TaskGraph graph;
+                for (size_t i = 0; i < 16; i++) {
+                    graph.AddTask([&]() {
+                        TaskGraph nested;
+                        nested.AddTask([&]() { done++; });
+                        scheduler.Run(nested);
+                    });
+                }
+                scheduler.Run(graph);
+            }
+        });
+    }
+    for (size_t i = 0; i < callers.size(); i++) {
+        callers[i].join();
+    }
+    REQUIRE(done.load() == 2 * 20 * 16);
+}
@@ -0,0 +1,101 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <environment.h>
+#include <creature.h>
+#include <world_graphs.h>
+#include <world_snapshot.h>
+#include <memory>
+
+using naturalselection::Environment;
+using naturalselection::Creature;
+using naturalselection::SnapshotBuffer;
+using naturalselection::WorldGraphs;
+using naturalselection::WorldSnapshot;
+
+TEST_CASE("Snapshot Buffer Returns Latest Publish") {
+    SnapshotBuffer buffer;
+    buffer.BeginWrite().tick = 1;
+    buffer.Publish();
+    buffer.BeginWrite().tick = 2;
+    buffer.Publish();
+
+    REQUIRE(buffer.Acquire().tick == 2);
+    REQUIRE(buffer.Acquire().tick == 2); // Nothing new published, so the same snapshot is kept.
+
+    buffer.BeginWrite().tick = 3;
+    buffer.Publish();
+    REQUIRE(buffer.Acquire().tick == 3);
+}
+
+TEST_CASE("Snapshot Reader Never Sees Writer Slot") {
+    SnapshotBuffer buffer;
+    const uint64_t last_tick = 100000;
+
+    // Each snapshot stores its tick in every creature slot, so a torn read would show mismatched values.
+    std::thread writer([&buffer, last_tick]() {
+        for (uint64_t tick = 1; tick <= last_tick; tick++) {
+            WorldSnapshot &snapshot = buffer.BeginWrite();
+            snapshot.tick = tick;
+            snapshot.creatures.resize(8);
+            for (size_t i = 0; i < snapshot.creatures.size(); i++) {
+                snapshot.creatures[i].food = (int) tick;
+            }
+            buffer.Publish();
+        }
+    });
+
+    bool consistent = true;
+    uint64_t previous_tick = 0;
+    while (previous_tick < last_tick) {
+        const WorldSnapshot &snapshot = buffer.Acquire();
+        for (size_t i = 0; i < snapshot.creatures.size(); i++) {
+            if ((uint64_t) snapshot.creatures[i].food != snapshot.tick) {
+                consistent = false;
+            }
+        }
+
+        if (snapshot.tick < previous_tick) { // Snapshots must never go back in time.
+            consistent = false;
+        }
+        previous_tick = snapshot.tick;
+    }
+
+    writer.join();
+    REQUIRE(consistent);
+}
+
+TEST_CASE("Environment Publishes Creature Counts") {
+    Environment environment = Environment();
+    environment.AddSpeedCreatures();
+    environment.AddIntelligenceCreatures();
+
+    const WorldSnapshot &snapshot = environment.GetSnapshot();
+    REQUIRE(snapshot.speed_count == environment.GetSpeedCount());
+    REQUIRE(snapshot.intelligence_count == environment.GetIntelligenceCount());
+    REQUIRE(snapshot.creatures.size() == environment.GetSpeedCreatures().size());
+    REQUIRE(snapshot.food.size() == environment.GetFood().size());
+}
+
+TEST_CASE("Snapshots Share Graphs Until They Change") {
+    Environment environment = Environment();
+    environment.AddSpeedCreatures();
+    environment.AddIntelligenceCreatures();
+    std::shared_ptr<const WorldGraphs> before = environment.GetSnapshot().graphs;
+    REQUIRE(before->speed_histograms.size() == 1);
+    REQUIRE(before->intelligence_histograms.size() == 1);
+
+    // Ticks within a generation don't touch the graphs, so every snapshot points at the same ones.
+    environment.SetIsRunning(true);
+    for (int i = 0; i < 3; i++) {
+        environment.AdvanceOneFrame();
+    }
+    REQUIRE(environment.GetSnapshot().graphs == before);
+
+    // Changing them leaves the copy a reader may still be drawing as it was.
+    environment.RemoveSpeedCreatures();
+    const WorldSnapshot &after = environment.GetSnapshot();
+    REQUIRE(after.graphs != before);
+    REQUIRE(after.graphs->speed_histograms.empty());
+    REQUIRE(before->speed_histograms.size() == 1);
+}